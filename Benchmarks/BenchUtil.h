@@ -0,0 +1,35 @@
+#ifndef AnonCam_BenchUtil_h
+#define AnonCam_BenchUtil_h
+
+#include <chrono>
+#include <cstdint>
+
+namespace AnonCam::Bench {
+
+// Keeps the optimizer from discarding a computed value
+template <typename T>
+inline void doNotOptimize(const T& value) {
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+/**
+ * Run `fn` `iterations` times after a short warm-up
+ * @return Mean nanoseconds per call
+ */
+template <typename Fn>
+double measureNs(int iterations, Fn&& fn) {
+    for (int i = 0; i < iterations / 10 + 1; ++i) {
+        fn();
+    }
+
+    const auto begin = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i) {
+        fn();
+    }
+    const auto elapsed = std::chrono::steady_clock::now() - begin;
+    return static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()) / iterations;
+}
+
+} // namespace AnonCam::Bench
+
+#endif /* AnonCam_BenchUtil_h */
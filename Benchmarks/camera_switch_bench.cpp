@@ -0,0 +1,220 @@
+//
+//  camera_switch_bench.cpp
+//  AnonCam
+//
+//  Camera switch and shutdown while a frame is in flight, on a 720p stream
+//  scanned by a cascade shaped like haarcascade_frontalface_default.xml,
+//  with tracking disabled so every frame runs a full detection. A capture
+//  thread processes frames continuously; the main thread calls reset() at
+//  varied points within a frame and switches the source. Reports how long
+//  reset() waited for the frame in flight, the latency from the reset to
+//  the first result on the new camera, and how long destroying a
+//  ShadowEvaluator takes while its candidate is mid-frame, against the
+//  frame time they would wait for without cancellation.
+//
+
+#include "BenchUtil.h"
+#include "FaceTracker.h"
+#include "ShadowEvaluator.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace AnonCam;
+
+namespace {
+
+constexpr int kWidth = 1280;
+constexpr int kHeight = 720;
+constexpr int kSwitches = 24;
+constexpr int kShutdowns = 12;
+
+constexpr int kStageStumps[] = {9,   16,  27,  32,  52,  53,  62,  72,  83,  91,  99,  115, 127,
+                                135, 136, 137, 159, 155, 169, 196, 197, 181, 199, 211, 200};
+
+struct Random {
+    uint32_t state = 12345;
+
+    uint32_t next() {
+        state = state * 1664525u + 1013904223u;
+        return state >> 8;
+    }
+    int range(int low, int high) { return low + static_cast<int>(next() % static_cast<uint32_t>(high - low + 1)); }
+    float uniform(float low, float high) { return low + (high - low) * static_cast<float>(next() % 10000) / 10000.0f; }
+};
+
+std::string makeCascade() {
+    Random random;
+    std::string features;
+    int featureCount = 0;
+    const auto addFeature = [&] {
+        // Two or three equal bands, horizontal or vertical, inside a block
+        const bool vertical = random.next() % 2 != 0;
+        const int bands = random.range(2, 3);
+        const int band = random.range(1, 6);
+        const int across = random.range(2, 12);
+        const int width = vertical ? band * bands : across;
+        const int height = vertical ? across : band * bands;
+        const int x = random.range(0, 24 - width);
+        const int y = random.range(0, 24 - height);
+        std::string rects = "<_>" + std::to_string(x) + " " + std::to_string(y) + " " + std::to_string(width) + " " +
+                            std::to_string(height) + " -1.</_>";
+        for (int b = 1; b < bands; b += 2) {
+            const int bx = vertical ? x + b * band : x;
+            const int by = vertical ? y : y + b * band;
+            rects += "<_>" + std::to_string(bx) + " " + std::to_string(by) + " " +
+                     std::to_string(vertical ? band : width) + " " + std::to_string(vertical ? height : band) + " " +
+                     std::to_string(bands) + ".</_>";
+        }
+        features += "<_><rects>" + rects + "</rects></_>";
+        return featureCount++;
+    };
+
+    std::string stages;
+    for (const int stumps : kStageStumps) {
+        std::string trees;
+        for (int t = 0; t < stumps; ++t) {
+            const int feature = addFeature();
+            const float left = random.uniform(-1.0f, 0.2f);
+            const float right = random.uniform(-0.2f, 1.0f);
+            trees += "<_><internalNodes>0 -1 " + std::to_string(feature) + " " +
+                     std::to_string(random.uniform(-0.01f, 0.01f)) + "</internalNodes><leafValues>" +
+                     std::to_string(left) + " " + std::to_string(right) + "</leafValues></_>";
+        }
+        // About one window in three passes a stage
+        const float threshold = 0.5f * std::sqrt(static_cast<float>(stumps));
+        stages += "<_><maxWeakCount>" + std::to_string(stumps) + "</maxWeakCount><stageThreshold>" +
+                  std::to_string(threshold) + "</stageThreshold><weakClassifiers>" + trees + "</weakClassifiers></_>";
+    }
+    return "<?xml version=\"1.0\"?><opencv_storage><cascade><stageType>BOOST</stageType>"
+           "<featureType>HAAR</featureType><height>24</height><width>24</width>"
+           "<stages>" + stages + "</stages><features>" + features + "</features></cascade></opencv_storage>";
+}
+
+std::vector<uint8_t> makeFrame(uint32_t seed) {
+    std::vector<uint8_t> pixels(static_cast<size_t>(kWidth) * kHeight);
+    uint32_t state = seed;
+    for (int y = 0; y < kHeight; ++y) {
+        for (int x = 0; x < kWidth; ++x) {
+            state = state * 1664525u + 1013904223u;
+            const float shade = 110.0f + 50.0f * std::sin(x * 0.013f * seed) * std::cos(y * 0.021f);
+            pixels[static_cast<size_t>(y) * kWidth + x] = static_cast<uint8_t>(shade + (state >> 28));
+        }
+    }
+    return pixels;
+}
+
+struct Summary {
+    double p50 = 0.0;
+    double max = 0.0;
+};
+
+Summary summarize(std::vector<double> samples) {
+    std::sort(samples.begin(), samples.end());
+    return {samples[samples.size() / 2], samples.back()};
+}
+
+} // anonymous namespace
+
+int main() {
+    const std::filesystem::path path = std::filesystem::temp_directory_path() / "anoncam_camera_switch_bench.xml";
+    {
+        std::ofstream file(path, std::ios::binary);
+        file << makeCascade();
+    }
+    const std::vector<uint8_t> cameraPixels[2] = {makeFrame(1), makeFrame(2)};
+    const ImageView cameras[2] = {ImageView::gray(cameraPixels[0].data(), kWidth, kHeight, kWidth),
+                                  ImageView::gray(cameraPixels[1].data(), kWidth, kHeight, kWidth)};
+
+    FaceTracker::Config config;
+    config.detector = FaceTracker::DetectorBackend::Cascade;
+    config.cascadePath = path.string();
+    config.minTrackingConfidence = 1.1f;   // Never keep a track: every frame is a full detection
+    FaceTracker tracker(config);
+    if (!tracker.isInitialized()) {
+        std::printf("cascade failed to load\n");
+        return 1;
+    }
+
+    int64_t timestamp = 0;
+    const double frameUs = Bench::measureNs(20, [&] {
+        Bench::doNotOptimize(tracker.processFrame(cameras[0], timestamp += 33333333).hasFace);
+    }) / 1e3;
+    std::printf("frame: %.0f us (what a reset or shutdown waited for without cancellation)\n\n", frameUs);
+
+    // Camera switches: the capture thread always processes the current camera
+    std::atomic<int> camera{0};
+    std::atomic<bool> running{true};
+    std::thread capture([&] {
+        int64_t captureTimestamp = 0;
+        while (running.load(std::memory_order_relaxed)) {
+            tracker.processFrame(cameras[camera.load(std::memory_order_relaxed)], captureTimestamp += 33333333);
+        }
+    });
+
+    // getStats() takes the lock a frame holds, so it is only read once a switch is done
+    std::vector<double> callUs, waitUs, switchUs;
+    int64_t latencyBefore = tracker.getStats().lastSwitchLatencyNs;
+    for (int s = 0; s < kSwitches; ++s) {
+        // Land at varied points within a frame
+        std::this_thread::sleep_for(std::chrono::microseconds(
+            static_cast<int64_t>(frameUs * (1.0 + static_cast<double>(s % 8) / 8.0))));
+        const auto begin = std::chrono::steady_clock::now();
+        tracker.reset();
+        camera.store(1 - camera.load());
+        callUs.push_back(std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - begin).count());
+
+        FaceTracker::Stats stats = tracker.getStats();
+        while (stats.lastSwitchLatencyNs == latencyBefore) {
+            std::this_thread::sleep_for(std::chrono::microseconds(200));
+            stats = tracker.getStats();
+        }
+        latencyBefore = stats.lastSwitchLatencyNs;
+        waitUs.push_back(stats.lastResetWaitNs / 1e3);
+        switchUs.push_back(stats.lastSwitchLatencyNs / 1e3);
+    }
+    running = false;
+    capture.join();
+
+    const FaceTracker::Stats stats = tracker.getStats();
+    std::printf("%-36s %12s %12s\n", "camera switch", "p50 (us)", "max (us)");
+    const Summary call = summarize(callUs);
+    const Summary wait = summarize(waitUs);
+    const Summary latency = summarize(switchUs);
+    std::printf("%-36s %12.0f %12.0f\n", "reset() call", call.p50, call.max);
+    std::printf("%-36s %12.0f %12.0f\n", "  waiting for the frame in flight", wait.p50, wait.max);
+    std::printf("%-36s %12.0f %12.0f\n", "reset to first new-camera result", latency.p50, latency.max);
+    std::printf("%llu frames cancelled over %d switches\n\n",
+                static_cast<unsigned long long>(stats.cancelledFrames), kSwitches);
+
+    // Shutdown: destroying a shadow evaluator whose candidate is mid-frame
+    ShadowEvaluator::Options shadowOptions;
+    shadowOptions.sampleRate = 1.0f;
+    shadowOptions.lowPriority = false;
+    std::vector<double> shutdownUs;
+    for (int s = 0; s < kShutdowns; ++s) {
+        auto evaluator = std::make_unique<ShadowEvaluator>(config, shadowOptions);
+        evaluator->offer(cameras[0], timestamp += 33333333, FaceResult{}, 0);
+        std::this_thread::sleep_for(std::chrono::microseconds(
+            static_cast<int64_t>(frameUs * (0.2 + 0.6 * s / kShutdowns))));
+        const auto begin = std::chrono::steady_clock::now();
+        evaluator.reset();
+        shutdownUs.push_back(std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - begin)
+                                 .count());
+    }
+    const Summary shutdown = summarize(shutdownUs);
+    std::printf("%-36s %12.0f %12.0f\n", "shadow evaluator shutdown", shutdown.p50, shutdown.max);
+
+    std::filesystem::remove(path);
+    std::filesystem::remove(path.string() + ".plan");
+    return 0;
+}
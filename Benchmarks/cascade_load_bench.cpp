@@ -0,0 +1,178 @@
+//
+//  cascade_load_bench.cpp
+//  AnonCam
+//
+//  Startup and per-frame cost of the load-time cascade optimizer on a
+//  cascade shaped like haarcascade_frontalface_default.xml (25 stages,
+//  2913 stumps over 24x24 two- and three-rectangle features). Compares
+//  parsing the XML, parsing plus optimizing and writing the plan, and
+//  mapping the cached plan; then a 720p scan with the cascade as written
+//  against the optimized one.
+//
+
+#include "BenchUtil.h"
+#include "CascadeDetector.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+using namespace AnonCam;
+
+namespace {
+
+constexpr int kStageStumps[] = {9,   16,  27,  32,  52,  53,  62,  72,  83,  91,  99,  115, 127,
+                                135, 136, 137, 159, 155, 169, 196, 197, 181, 199, 211, 200};
+
+struct Random {
+    uint32_t state = 12345;
+
+    uint32_t next() {
+        state = state * 1664525u + 1013904223u;
+        return state >> 8;
+    }
+    int range(int low, int high) { return low + static_cast<int>(next() % static_cast<uint32_t>(high - low + 1)); }
+    float uniform(float low, float high) { return low + (high - low) * static_cast<float>(next() % 10000) / 10000.0f; }
+};
+
+std::string makeCascade() {
+    Random random;
+    std::string features;
+    int featureCount = 0;
+    const auto addFeature = [&] {
+        // Two or three equal bands, horizontal or vertical, inside a block
+        const bool vertical = random.next() % 2 != 0;
+        const int bands = random.range(2, 3);
+        const int band = random.range(1, 6);
+        const int across = random.range(2, 12);
+        const int width = vertical ? band * bands : across;
+        const int height = vertical ? across : band * bands;
+        const int x = random.range(0, 24 - width);
+        const int y = random.range(0, 24 - height);
+        std::string rects = "<_>" + std::to_string(x) + " " + std::to_string(y) + " " + std::to_string(width) + " " +
+                            std::to_string(height) + " -1.</_>";
+        for (int b = 1; b < bands; b += 2) {
+            const int bx = vertical ? x + b * band : x;
+            const int by = vertical ? y : y + b * band;
+            rects += "<_>" + std::to_string(bx) + " " + std::to_string(by) + " " +
+                     std::to_string(vertical ? band : width) + " " + std::to_string(vertical ? height : band) + " " +
+                     std::to_string(bands) + ".</_>";
+        }
+        features += "<_><rects>" + rects + "</rects></_>";
+        return featureCount++;
+    };
+
+    std::string stages;
+    for (const int stumps : kStageStumps) {
+        std::string trees;
+        for (int t = 0; t < stumps; ++t) {
+            const int feature = addFeature();
+            const float left = random.uniform(-1.0f, 0.2f);
+            const float right = random.uniform(-0.2f, 1.0f);
+            trees += "<_><internalNodes>0 -1 " + std::to_string(feature) + " " +
+                     std::to_string(random.uniform(-0.01f, 0.01f)) + "</internalNodes><leafValues>" +
+                     std::to_string(left) + " " + std::to_string(right) + "</leafValues></_>";
+        }
+        // About one window in three passes a stage
+        const float threshold = 0.5f * std::sqrt(static_cast<float>(stumps));
+        stages += "<_><maxWeakCount>" + std::to_string(stumps) + "</maxWeakCount><stageThreshold>" +
+                  std::to_string(threshold) + "</stageThreshold><weakClassifiers>" + trees + "</weakClassifiers></_>";
+    }
+    return "<?xml version=\"1.0\"?><opencv_storage><cascade><stageType>BOOST</stageType>"
+           "<featureType>HAAR</featureType><height>24</height><width>24</width>"
+           "<stages>" + stages + "</stages><features>" + features + "</features></cascade></opencv_storage>";
+}
+
+std::vector<uint8_t> makeFrame(int width, int height) {
+    std::vector<uint8_t> pixels(static_cast<size_t>(width) * height);
+    uint32_t state = 1;
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) {
+            state = state * 1664525u + 1013904223u;
+            const float shade = 110.0f + 50.0f * std::sin(x * 0.013f) * std::cos(y * 0.021f);
+            pixels[static_cast<size_t>(y) * width + x] = static_cast<uint8_t>(shade + (state >> 28));
+        }
+    }
+    return pixels;
+}
+
+double medianMs(std::vector<double>& samples) {
+    std::sort(samples.begin(), samples.end());
+    return samples[samples.size() / 2];
+}
+
+} // anonymous namespace
+
+int main() {
+    constexpr int kLoads = 9;
+    const std::filesystem::path path = std::filesystem::temp_directory_path() / "anoncam_cascade_bench.xml";
+    const std::string planPath = path.string() + ".plan";
+    {
+        std::ofstream file(path, std::ios::binary);
+        file << makeCascade();
+    }
+
+    std::vector<double> parseMs, optimizeMs, planMs;
+    for (int i = 0; i < kLoads; ++i) {
+        CascadeDetector::Options options;
+        options.optimize = false;
+        options.cachePlan = false;
+        CascadeDetector asWritten(options);
+        asWritten.load(path.string());
+        parseMs.push_back(asWritten.stats().loadNs / 1e6);
+
+        // Cold start: no plan yet, so parse, optimize and write it
+        std::filesystem::remove(planPath);
+        CascadeDetector cold;
+        cold.load(path.string());
+        optimizeMs.push_back(cold.stats().loadNs / 1e6);
+
+        CascadeDetector cached;
+        cached.load(path.string());
+        if (!cached.stats().planCached) {
+            std::printf("plan was not reused\n");
+            return 1;
+        }
+        planMs.push_back(cached.stats().loadNs / 1e6);
+    }
+
+    std::printf("cascade xml %.0f KB, plan %.0f KB\n", std::filesystem::file_size(path) / 1024.0,
+                std::filesystem::file_size(planPath) / 1024.0);
+    std::printf("%-34s %9.2f ms\n", "parse xml", medianMs(parseMs));
+    std::printf("%-34s %9.2f ms\n", "parse + optimize + write plan", medianMs(optimizeMs));
+    std::printf("%-34s %9.2f ms\n", "map cached plan", medianMs(planMs));
+
+    constexpr int kWidth = 1280;
+    constexpr int kHeight = 720;
+    const std::vector<uint8_t> pixels = makeFrame(kWidth, kHeight);
+    const ImageView frame = ImageView::gray(pixels.data(), kWidth, kHeight, kWidth);
+
+    std::printf("\n%-34s %9s %7s\n", "720p scan", "ms/frame", "faces");
+    std::vector<Detection> reference;
+    for (const bool optimize : {false, true}) {
+        CascadeDetector::Options options;
+        options.optimize = optimize;
+        options.cachePlan = false;
+        CascadeDetector detector(options);
+        detector.load(path.string());
+
+        std::vector<Detection> detections;
+        const double ns = Bench::measureNs(10, [&] {
+            detector.detect(frame, detections);
+            Bench::doNotOptimize(detections.data());
+        });
+        const bool same = optimize && detections.size() == reference.size();
+        std::printf("%-34s %9.2f %7zu%s\n", optimize ? "optimized" : "as written", ns / 1e6, detections.size(),
+                    optimize ? (same ? "  (same as written)" : "  (differs)") : "");
+        reference = detections;
+    }
+
+    std::filesystem::remove(path);
+    std::filesystem::remove(planPath);
+    return 0;
+}
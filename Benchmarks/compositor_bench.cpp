@@ -0,0 +1,140 @@
+//
+//  compositor_bench.cpp
+//  AnonCam
+//
+//  Cost of the CPU compositing stage at 720p and 1080p: background blur or
+//  replacement fused with face pixelation, against running the background
+//  and face passes separately over the frame; then the track-loss
+//  fallbacks: a held face region without a mask, and the full-frame blur.
+//
+
+#include "BenchUtil.h"
+#include "Compositor.h"
+#include "Segmentation.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <vector>
+
+using namespace AnonCam;
+
+namespace {
+
+std::vector<uint8_t> ellipseMask(int width, int height, float cx, float cy, float rx, float ry) {
+    std::vector<uint8_t> mask(static_cast<size_t>(width) * height);
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) {
+            const float dx = (x + 0.5f - cx * width) / (rx * width);
+            const float dy = (y + 0.5f - cy * height) / (ry * height);
+            mask[static_cast<size_t>(y) * width + x] = dx * dx + dy * dy <= 1.0f ? 255 : 0;
+        }
+    }
+    return mask;
+}
+
+SegmentationMask viewOf(const std::vector<uint8_t>& data, int width, int height) {
+    SegmentationMask mask;
+    mask.data = data.data();
+    mask.width = width;
+    mask.height = height;
+    mask.bytesPerRow = static_cast<size_t>(width);
+    return mask;
+}
+
+ImageView bgraView(const std::vector<uint8_t>& data, int width, int height) {
+    ImageView view;
+    view.format = PixelFormat::BGRA;
+    view.width = width;
+    view.height = height;
+    view.planes[0] = data.data();
+    view.bytesPerRow[0] = static_cast<size_t>(width) * 4;
+    return view;
+}
+
+} // anonymous namespace
+
+int main() {
+    constexpr int kIterations = 40;
+    using Background = Compositor::BackgroundMode;
+    using Face = Compositor::FaceMode;
+
+    std::printf("%-10s %12s %12s %12s %12s %12s %12s %12s\n", "frame", "pixelate", "blur", "blur+pix",
+                "replace+pix", "separate", "held region", "full frame");
+
+    for (const auto& size : {std::pair<int, int>{1280, 720}, std::pair<int, int>{1920, 1080}}) {
+        const int width = size.first;
+        const int height = size.second;
+
+        std::vector<uint8_t> frame(static_cast<size_t>(width) * height * 4);
+        std::vector<uint8_t> replacement(frame.size());
+        for (size_t i = 0; i < frame.size(); ++i) {
+            frame[i] = static_cast<uint8_t>((i * 2654435761u) >> 24);
+            replacement[i] = static_cast<uint8_t>(i / 4 % 251);
+        }
+        std::vector<uint8_t> output(frame.size());
+
+        const auto faceData = ellipseMask(width, height, 0.5f, 0.4f, 0.12f, 0.22f);
+        const auto personData = ellipseMask(width, height, 0.5f, 0.7f, 0.3f, 0.6f);
+        const SegmentationMask face = viewOf(faceData, width, height);
+        const SegmentationMask person = viewOf(personData, width, height);
+        const ImageView source = bgraView(frame, width, height);
+        const ImageView replacementView = bgraView(replacement, width, height);
+        const ImageView intermediate = bgraView(output, width, height);
+
+        Compositor::Layers layers;
+        layers.foreground = &person;
+        layers.face = &face;
+        layers.replacement = &replacementView;
+
+        auto timeMode = [&](Background background, Face faceMode, const Compositor::Layers& with) {
+            Compositor::Options options;
+            options.background = background;
+            options.face = faceMode;
+            Compositor compositor(options);
+            return Bench::measureNs(kIterations, [&] {
+                compositor.composite(source, with, output.data(), static_cast<size_t>(width) * 4);
+                Bench::doNotOptimize(output.data());
+            });
+        };
+
+        const double pixelate = timeMode(Background::Keep, Face::Pixelate, layers);
+        const double blur = timeMode(Background::Blur, Face::Keep, layers);
+        const double fused = timeMode(Background::Blur, Face::Pixelate, layers);
+        const double replace = timeMode(Background::Replace, Face::Pixelate, layers);
+
+        // Face lost: no face mask, the held region or the whole frame instead
+        Anonymization held;
+        held.mode = AnonymizationMode::Region;
+        const float region[4] = {0.36f, 0.16f, 0.64f, 0.64f};
+        std::copy(region, region + 4, held.region);
+        Anonymization fullFrame;
+        fullFrame.mode = AnonymizationMode::FullFrame;
+        Compositor::Layers lost = layers;
+        lost.face = nullptr;
+        lost.anonymization = &held;
+        const double holding = timeMode(Background::Blur, Face::Pixelate, lost);
+        lost.anonymization = &fullFrame;
+        const double fallback = timeMode(Background::Blur, Face::Pixelate, lost);
+
+        // Same result in two passes: blur the background, then pixelate the output
+        Compositor::Options backgroundOnly;
+        backgroundOnly.face = Face::Keep;
+        Compositor::Options faceOnly;
+        faceOnly.background = Background::Keep;
+        Compositor first(backgroundOnly);
+        Compositor second(faceOnly);
+        Compositor::Layers faceLayer;
+        faceLayer.face = &face;
+        const double separate = Bench::measureNs(kIterations, [&] {
+            first.composite(source, layers, output.data(), static_cast<size_t>(width) * 4);
+            second.composite(intermediate, faceLayer, output.data(), static_cast<size_t>(width) * 4);
+            Bench::doNotOptimize(output.data());
+        });
+
+        char label[16];
+        std::snprintf(label, sizeof(label), "%dx%d", width, height);
+        std::printf("%-10s %10.2fms %10.2fms %10.2fms %10.2fms %10.2fms %10.2fms %10.2fms\n", label, pixelate / 1e6,
+                    blur / 1e6, fused / 1e6, replace / 1e6, separate / 1e6, holding / 1e6, fallback / 1e6);
+    }
+    return 0;
+}
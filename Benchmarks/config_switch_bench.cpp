@@ -0,0 +1,212 @@
+//
+//  config_switch_bench.cpp
+//  AnonCam
+//
+//  Cost of changing a running tracker's configuration on a 720p NV12
+//  stream (denoising, segmentation and eye / lip refinement on), with the
+//  model detector and with a cascade shaped like
+//  haarcascade_frontalface_default.xml: FaceTracker::updateConfig() and the
+//  frame after it, against creating a tracker with the new configuration
+//  and its first frame. Also reports whether that frame had to run the
+//  detector (a new tracker has no track; the synthetic cascade finds no
+//  face, so it scans every frame). Medians over several switches; the
+//  steady per-frame cost is shown for reference. Nothing in the tracker
+//  reads the detection threshold or max faces yet, so those rows show the
+//  bare cost of an update that changes no stage.
+//
+
+#include "BenchUtil.h"
+#include "FaceTracker.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace AnonCam;
+
+namespace {
+
+constexpr int kWidth = 1280;
+constexpr int kHeight = 720;
+constexpr int kWarmupFrames = 10;
+constexpr int kSwitches = 9;
+
+constexpr int kStageStumps[] = {9,   16,  27,  32,  52,  53,  62,  72,  83,  91,  99,  115, 127,
+                                135, 136, 137, 159, 155, 169, 196, 197, 181, 199, 211, 200};
+
+struct Random {
+    uint32_t state = 12345;
+
+    uint32_t next() {
+        state = state * 1664525u + 1013904223u;
+        return state >> 8;
+    }
+    int range(int low, int high) { return low + static_cast<int>(next() % static_cast<uint32_t>(high - low + 1)); }
+    float uniform(float low, float high) { return low + (high - low) * static_cast<float>(next() % 10000) / 10000.0f; }
+};
+
+std::string makeCascade() {
+    Random random;
+    std::string features;
+    int featureCount = 0;
+    const auto addFeature = [&] {
+        // Two or three equal bands, horizontal or vertical, inside a block
+        const bool vertical = random.next() % 2 != 0;
+        const int bands = random.range(2, 3);
+        const int band = random.range(1, 6);
+        const int across = random.range(2, 12);
+        const int width = vertical ? band * bands : across;
+        const int height = vertical ? across : band * bands;
+        const int x = random.range(0, 24 - width);
+        const int y = random.range(0, 24 - height);
+        std::string rects = "<_>" + std::to_string(x) + " " + std::to_string(y) + " " + std::to_string(width) + " " +
+                            std::to_string(height) + " -1.</_>";
+        for (int b = 1; b < bands; b += 2) {
+            const int bx = vertical ? x + b * band : x;
+            const int by = vertical ? y : y + b * band;
+            rects += "<_>" + std::to_string(bx) + " " + std::to_string(by) + " " +
+                     std::to_string(vertical ? band : width) + " " + std::to_string(vertical ? height : band) + " " +
+                     std::to_string(bands) + ".</_>";
+        }
+        features += "<_><rects>" + rects + "</rects></_>";
+        return featureCount++;
+    };
+
+    std::string stages;
+    for (const int stumps : kStageStumps) {
+        std::string trees;
+        for (int t = 0; t < stumps; ++t) {
+            const int feature = addFeature();
+            const float left = random.uniform(-1.0f, 0.2f);
+            const float right = random.uniform(-0.2f, 1.0f);
+            trees += "<_><internalNodes>0 -1 " + std::to_string(feature) + " " +
+                     std::to_string(random.uniform(-0.01f, 0.01f)) + "</internalNodes><leafValues>" +
+                     std::to_string(left) + " " + std::to_string(right) + "</leafValues></_>";
+        }
+        // About one window in three passes a stage
+        const float threshold = 0.5f * std::sqrt(static_cast<float>(stumps));
+        stages += "<_><maxWeakCount>" + std::to_string(stumps) + "</maxWeakCount><stageThreshold>" +
+                  std::to_string(threshold) + "</stageThreshold><weakClassifiers>" + trees + "</weakClassifiers></_>";
+    }
+    return "<?xml version=\"1.0\"?><opencv_storage><cascade><stageType>BOOST</stageType>"
+           "<featureType>HAAR</featureType><height>24</height><width>24</width>"
+           "<stages>" + stages + "</stages><features>" + features + "</features></cascade></opencv_storage>";
+}
+
+struct Change {
+    const char* name;
+    std::function<void(FaceTracker::Config&)> apply;
+};
+
+double median(std::vector<double> samples) {
+    std::sort(samples.begin(), samples.end());
+    return samples[samples.size() / 2];
+}
+
+template <typename Fn>
+double elapsedUs(Fn&& fn) {
+    const auto begin = std::chrono::steady_clock::now();
+    fn();
+    return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - begin).count();
+}
+
+} // anonymous namespace
+
+int main() {
+    std::vector<uint8_t> pixels(static_cast<size_t>(kWidth) * kHeight * 3 / 2, 128);
+    for (int y = 0; y < kHeight; ++y) {
+        for (int x = 0; x < kWidth; ++x) {
+            pixels[static_cast<size_t>(y) * kWidth + x] =
+                static_cast<uint8_t>(128.0f + 60.0f * std::sin(x * 0.21f) * std::cos(y * 0.17f));
+        }
+    }
+    ImageView frame;
+    frame.format = PixelFormat::NV12;
+    frame.width = kWidth;
+    frame.height = kHeight;
+    frame.planes[0] = pixels.data();
+    frame.planes[1] = pixels.data() + static_cast<size_t>(kWidth) * kHeight;
+    frame.bytesPerRow[0] = kWidth;
+    frame.bytesPerRow[1] = kWidth;
+
+    const std::filesystem::path path = std::filesystem::temp_directory_path() / "anoncam_config_switch_bench.xml";
+    {
+        std::ofstream file(path, std::ios::binary);
+        file << makeCascade();
+    }
+
+    const Change changes[] = {
+        {"detection threshold", [](FaceTracker::Config& c) { c.minDetectionConfidence = 0.7f; }},
+        {"max faces", [](FaceTracker::Config& c) { c.maxNumFaces = 2; }},
+        {"segmentation off", [](FaceTracker::Config& c) { c.enableSegmentation = false; }},
+        {"denoise strength", [](FaceTracker::Config& c) { c.denoising.strength = 0.5f; }},
+        {"cascade scale factor", [](FaceTracker::Config& c) { c.cascade.scaleFactor = 1.2f; }},
+        {"worker threads", [](FaceTracker::Config& c) { c.workerThreads = c.workerThreads == 1 ? 2 : 1; }},
+    };
+
+    int64_t timestamp = 0;
+    const auto process = [&](FaceTracker& tracker) { return tracker.processFrame(frame, timestamp += 33333333); };
+
+    FaceTracker::Config base;
+    base.enableDenoising = true;
+    base.enableSegmentation = true;
+    base.refineEyesAndLips = true;
+
+    for (const bool cascade : {false, true}) {
+        if (cascade) {
+            base.detector = FaceTracker::DetectorBackend::Cascade;
+            base.cascadePath = path.string();
+        }
+
+        FaceTracker steady(base);
+        for (int i = 0; i < kWarmupFrames; ++i) {
+            process(steady);
+        }
+        const double frameUs = Bench::measureNs(20, [&] { Bench::doNotOptimize(process(steady).hasFace); }) / 1e3;
+        std::printf("%s detector, steady frame: %.0f us\n", cascade ? "cascade" : "model", frameUs);
+
+        std::printf("%-22s %14s %14s %14s %14s %14s\n", "change", "create (us)", "update (us)", "frame after",
+                    "frame after", "detect after");
+        std::printf("%-22s %14s %14s %14s %14s\n", "", "", "", "create (us)", "update (us)");
+        for (const Change& change : changes) {
+            std::vector<double> createUs, updateUs, createdFrameUs, updatedFrameUs;
+            bool createdDetects = false, updatedDetects = false;
+            for (int s = 0; s < kSwitches; ++s) {
+                FaceTracker::Config from = base;
+                FaceTracker::Config to = base;
+                change.apply(to);
+
+                auto recreated = std::make_unique<FaceTracker>(from);
+                for (int i = 0; i < kWarmupFrames; ++i) {
+                    process(*recreated);
+                }
+                createUs.push_back(elapsedUs([&] { recreated = std::make_unique<FaceTracker>(to); }));
+                createdFrameUs.push_back(elapsedUs([&] { process(*recreated); }));
+                createdDetects = recreated->getStats().detections > 0;
+
+                FaceTracker updated(from);
+                for (int i = 0; i < kWarmupFrames; ++i) {
+                    process(updated);
+                }
+                const uint64_t detections = updated.getStats().detections;
+                updateUs.push_back(elapsedUs([&] { updated.updateConfig(to); }));
+                updatedFrameUs.push_back(elapsedUs([&] { process(updated); }));
+                updatedDetects = updated.getStats().detections > detections;
+            }
+            std::printf("%-22s %14.0f %14.1f %14.0f %14.0f %14s\n", change.name, median(createUs), median(updateUs),
+                        median(createdFrameUs), median(updatedFrameUs),
+                        createdDetects ? (updatedDetects ? "both" : "create") : (updatedDetects ? "update" : "none"));
+        }
+        std::printf("\n");
+    }
+    std::filesystem::remove(path);
+    std::filesystem::remove(path.string() + ".plan");
+    return 0;
+}
@@ -0,0 +1,204 @@
+//
+//  denoiser_bench.cpp
+//  AnonCam
+//
+//  Cost of the temporal denoise stage at 720p and 1080p (NV12, inline and
+//  tiled on a WorkerPool), and what it does to the face region of a
+//  synthetic dim scene at increasing sensor noise: the residual noise
+//  against the noise-free render, and the normalized correlation of the
+//  region between consecutive frames (what a tracker matching appearance
+//  would see). Both are measured on pixels; the tracker is not involved,
+//  since its stub landmark model does not score noise.
+//
+
+#include "BenchUtil.h"
+#include "TemporalDenoiser.h"
+#include "WorkerPool.h"
+
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+using namespace AnonCam;
+
+namespace {
+
+struct Nv12Frame {
+    int width;
+    int height;
+    std::vector<uint8_t> luma;
+    std::vector<uint8_t> chroma;
+
+    Nv12Frame(int w, int h)
+        : width(w), height(h), luma(static_cast<size_t>(w) * h),
+          chroma(static_cast<size_t>((w + 1) / 2) * 2 * ((h + 1) / 2), 128) {}
+
+    ImageView view() const {
+        ImageView view;
+        view.format = PixelFormat::NV12;
+        view.width = width;
+        view.height = height;
+        view.planes[0] = luma.data();
+        view.planes[1] = chroma.data();
+        view.bytesPerRow[0] = static_cast<size_t>(width);
+        view.bytesPerRow[1] = static_cast<size_t>((width + 1) / 2) * 2;
+        return view;
+    }
+};
+
+// Approximately Gaussian noise from the sum of four uniform bytes
+class NoiseSource {
+public:
+    explicit NoiseSource(uint32_t seed) : state_(seed) {}
+
+    int next(float sigma) {
+        state_ ^= state_ << 13;
+        state_ ^= state_ >> 17;
+        state_ ^= state_ << 5;
+        const int sum = static_cast<int>((state_ & 0xff) + ((state_ >> 8) & 0xff) + ((state_ >> 16) & 0xff) +
+                                         (state_ >> 24)) - 510;
+        // Four uniform bytes have a standard deviation of ~147.8
+        return static_cast<int>(std::lround(sum * sigma / 147.8f));
+    }
+
+private:
+    uint32_t state_;
+};
+
+// Dim room: dark gradient with a low-contrast textured face drifting slowly
+void renderDimScene(Nv12Frame& frame, int index, float sigma, NoiseSource& noise) {
+    const float drift = 6.0f * std::sin(index * 0.05f);
+    for (int y = 0; y < frame.height; ++y) {
+        uint8_t* row = frame.luma.data() + static_cast<size_t>(y) * frame.width;
+        for (int x = 0; x < frame.width; ++x) {
+            const float u = (x - drift) / frame.width - 0.5f;
+            const float v = static_cast<float>(y) / frame.height - 0.5f;
+            float value = 30.0f + 10.0f * v;
+            if ((u * u) / (0.15f * 0.15f) + (v * v) / (0.2f * 0.2f) <= 1.0f) {
+                value = 55.0f + 8.0f * std::sin((x - drift) * 0.11f) * std::sin(y * 0.09f);
+            }
+            const int sample = static_cast<int>(value) + noise.next(sigma);
+            row[x] = static_cast<uint8_t>(sample < 0 ? 0 : (sample > 255 ? 255 : sample));
+        }
+    }
+}
+
+// Central part of the face ellipse, inside it whatever the drift
+struct FaceRegion {
+    int x0, y0, x1, y1;
+};
+
+FaceRegion faceRegion(int width, int height) {
+    return {width * 42 / 100, height * 40 / 100, width * 58 / 100, height * 60 / 100};
+}
+
+std::vector<uint8_t> regionLuma(const ImageView& frame, const FaceRegion& region) {
+    std::vector<uint8_t> samples;
+    samples.reserve(static_cast<size_t>(region.x1 - region.x0) * (region.y1 - region.y0));
+    for (int y = region.y0; y < region.y1; ++y) {
+        const uint8_t* row = frame.row(0, y);
+        samples.insert(samples.end(), row + region.x0, row + region.x1);
+    }
+    return samples;
+}
+
+double meanSquaredError(const std::vector<uint8_t>& a, const std::vector<uint8_t>& b) {
+    double sum = 0.0;
+    for (size_t i = 0; i < a.size(); ++i) {
+        const double difference = static_cast<double>(a[i]) - b[i];
+        sum += difference * difference;
+    }
+    return sum / a.size();
+}
+
+double normalizedCorrelation(const std::vector<uint8_t>& a, const std::vector<uint8_t>& b) {
+    double sumA = 0.0, sumB = 0.0, sumAA = 0.0, sumBB = 0.0, sumAB = 0.0;
+    for (size_t i = 0; i < a.size(); ++i) {
+        sumA += a[i];
+        sumB += b[i];
+        sumAA += static_cast<double>(a[i]) * a[i];
+        sumBB += static_cast<double>(b[i]) * b[i];
+        sumAB += static_cast<double>(a[i]) * b[i];
+    }
+    const double n = static_cast<double>(a.size());
+    const double varA = sumAA - sumA * sumA / n;
+    const double varB = sumBB - sumB * sumB / n;
+    return varA > 0.0 && varB > 0.0 ? (sumAB - sumA * sumB / n) / std::sqrt(varA * varB) : 0.0;
+}
+
+} // anonymous namespace
+
+int main() {
+    constexpr int kIterations = 100;
+    const int threads = WorkerPool::defaultThreadCount();
+
+    std::printf("Denoise stage (NV12, %d worker threads + caller)\n", threads);
+    std::printf("%-10s %14s %14s %14s\n", "frame", "luma (ms)", "luma+chroma", "tiled");
+
+    for (const auto& size : {std::pair<int, int>{1280, 720}, std::pair<int, int>{1920, 1080}}) {
+        Nv12Frame frames[2] = {Nv12Frame(size.first, size.second), Nv12Frame(size.first, size.second)};
+        NoiseSource noise(1);
+        renderDimScene(frames[0], 0, 8.0f, noise);
+        renderDimScene(frames[1], 1, 8.0f, noise);
+
+        auto run = [&](const TemporalDenoiser::Options& options, WorkerPool* workers) {
+            TemporalDenoiser denoiser(options, workers);
+            int index = 0;
+            return Bench::measureNs(kIterations, [&] {
+                DenoisedFrame output;
+                denoiser.process(frames[index++ & 1].view(), output);
+                Bench::doNotOptimize(output.view.planes[0]);
+            }) / 1e6;
+        };
+
+        TemporalDenoiser::Options lumaOnly;
+        lumaOnly.denoiseChroma = false;
+        WorkerPool workers(threads);
+
+        std::printf("%4dx%-5d %14.3f %14.3f %14.3f\n", size.first, size.second, run(lumaOnly, nullptr),
+                    run(TemporalDenoiser::Options(), nullptr), run(TemporalDenoiser::Options(), &workers));
+    }
+
+    constexpr int kFrames = 150;
+    constexpr int kWarmUp = 10;   // Frames before the recursive filter settles
+    std::printf("\nFace region of a synthetic 1280x720 dim scene, frames %d-%d\n", kWarmUp, kFrames - 1);
+    std::printf("%-10s %16s %16s %16s %16s\n", "noise", "RMS noise raw", "denoised", "frame NCC raw", "denoised");
+
+    for (const float sigma : {4.0f, 8.0f, 10.0f, 12.0f, 16.0f, 24.0f}) {
+        Nv12Frame clean(1280, 720);
+        Nv12Frame frame(1280, 720);
+        NoiseSource noiseFree(0);
+        NoiseSource noise(7);
+        TemporalDenoiser denoiser;
+        const FaceRegion region = faceRegion(frame.width, frame.height);
+
+        std::vector<uint8_t> previous[2];
+        double squaredError[2] = {0.0, 0.0};
+        double correlation[2] = {0.0, 0.0};
+        for (int i = 0; i < kFrames; ++i) {
+            renderDimScene(clean, i, 0.0f, noiseFree);
+            renderDimScene(frame, i, sigma, noise);
+            DenoisedFrame denoised;
+            if (!denoiser.process(frame.view(), denoised)) {
+                std::fprintf(stderr, "denoise failed at frame %d\n", i);
+                return 1;
+            }
+
+            const ImageView outputs[2] = {frame.view(), denoised.view};
+            for (int mode = 0; mode < 2; ++mode) {
+                std::vector<uint8_t> samples = regionLuma(outputs[mode], region);
+                if (i >= kWarmUp) {
+                    squaredError[mode] += meanSquaredError(samples, regionLuma(clean.view(), region));
+                    correlation[mode] += normalizedCorrelation(previous[mode], samples);
+                }
+                previous[mode] = std::move(samples);
+            }
+        }
+
+        const int measured = kFrames - kWarmUp;
+        std::printf("sigma %-4.0f %16.2f %16.2f %16.3f %16.3f\n", sigma, std::sqrt(squaredError[0] / measured),
+                    std::sqrt(squaredError[1] / measured), correlation[0] / measured, correlation[1] / measured);
+    }
+
+    return 0;
+}
@@ -0,0 +1,137 @@
+//
+//  detection_slicing_bench.cpp
+//  AnonCam
+//
+//  Per-frame cost of cascade detection on a 720p scene with three faces:
+//  a full scan on every call against time-sliced scanning at several
+//  budgets. Reports the latency distribution, how many frames a full cycle
+//  takes, and whether the faces merged across slices match the full scan.
+//  The cascade is synthetic (bright lower half, bright center column) and
+//  padded with redundant trees so a window costs about as much as the early
+//  stages of a real frontal-face cascade; it is loaded unoptimized, since
+//  stumps sharing a feature would otherwise be evaluated once.
+//
+
+#include "BenchUtil.h"
+#include "CascadeDetector.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+using namespace AnonCam;
+
+namespace {
+
+std::string tree(int feature, float threshold) {
+    return "<_><internalNodes>0 -1 " + std::to_string(feature) + " " + std::to_string(threshold) +
+           "</internalNodes><leafValues>-1. 1.</leafValues></_>";
+}
+
+std::string makeCascade(int treesPerStage) {
+    std::string stages;
+    for (int stage = 0; stage < 2; ++stage) {
+        std::string trees;
+        for (int t = 0; t < treesPerStage; ++t) {
+            trees += tree(stage, 0.5f);
+        }
+        stages += "<_><maxWeakCount>" + std::to_string(treesPerStage) + "</maxWeakCount><stageThreshold>" +
+                  std::to_string(treesPerStage - 0.5f) + "</stageThreshold><weakClassifiers>" + trees +
+                  "</weakClassifiers></_>";
+    }
+    return "<?xml version=\"1.0\"?><opencv_storage><cascade><stageType>BOOST</stageType>"
+           "<featureType>HAAR</featureType><height>24</height><width>24</width>"
+           "<stages>" + stages + "</stages><features>"
+           "<_><rects><_>0 0 24 24 -1.</_><_>0 12 24 12 2.</_></rects></_>"
+           "<_><rects><_>0 0 24 24 -1.</_><_>8 0 8 24 3.</_></rects></_>"
+           "</features></cascade></opencv_storage>";
+}
+
+std::vector<uint8_t> makeScene(int width, int height) {
+    std::vector<uint8_t> pixels(static_cast<size_t>(width) * height);
+    uint32_t state = 1;
+    for (auto& p : pixels) {
+        state = state * 1664525u + 1013904223u;
+        p = static_cast<uint8_t>(100 + (state >> 28));
+    }
+    const int faces[3][3] = {{200, 180, 160}, {640, 260, 220}, {1020, 120, 120}};
+    for (const auto& face : faces) {
+        const int size = face[2];
+        for (int y = 0; y < size; ++y) {
+            for (int x = 0; x < size; ++x) {
+                const bool lower = y >= size / 2;
+                const bool center = x >= size / 3 && x < size * 2 / 3;
+                pixels[static_cast<size_t>(face[1] + y) * width + face[0] + x] =
+                    static_cast<uint8_t>((lower ? 170 : 70) + (center ? 50 : 0));
+            }
+        }
+    }
+    return pixels;
+}
+
+bool sameFaces(const std::vector<Detection>& a, const std::vector<Detection>& b) {
+    if (a.size() != b.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < a.size(); ++i) {
+        if (std::abs(a[i].x - b[i].x) > 1e-4f || std::abs(a[i].y - b[i].y) > 1e-4f ||
+            std::abs(a[i].width - b[i].width) > 1e-4f) {
+            return false;
+        }
+    }
+    return true;
+}
+
+} // anonymous namespace
+
+int main() {
+    constexpr int kWidth = 1280;
+    constexpr int kHeight = 720;
+    constexpr int kFrames = 120;
+
+    const std::vector<uint8_t> pixels = makeScene(kWidth, kHeight);
+    const ImageView frame = ImageView::gray(pixels.data(), kWidth, kHeight, kWidth);
+    const std::string cascade = makeCascade(24);
+
+    CascadeDetector::Options fullOptions;
+    fullOptions.optimize = false;
+    std::vector<Detection> reference;
+    {
+        CascadeDetector full(fullOptions);
+        full.loadFromString(cascade);
+        full.detect(frame, reference);
+    }
+
+    std::printf("%-12s %9s %9s %9s %7s %7s %6s %s\n", "mode", "p50 (us)", "p99 (us)", "max (us)", "items",
+                "frames", "faces", "matches full scan");
+    for (const int budgetUs : {0, 4000, 2000, 1000, 500}) {
+        CascadeDetector::Options options = fullOptions;
+        options.sliceBudgetUs = budgetUs;
+        CascadeDetector detector(options);
+        detector.loadFromString(cascade);
+
+        std::vector<Detection> detections;
+        std::vector<double> latencyUs;
+        int cycleFrames = 0;
+        for (int i = 0; i < kFrames; ++i) {
+            const auto begin = std::chrono::steady_clock::now();
+            detector.detect(frame, detections);
+            latencyUs.push_back(std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - begin)
+                                    .count());
+            if (cycleFrames == 0 && detector.stats().cycles > 0) {
+                cycleFrames = i + 1;
+            }
+        }
+        std::sort(latencyUs.begin(), latencyUs.end());
+
+        char mode[32];
+        std::snprintf(mode, sizeof(mode), budgetUs == 0 ? "full" : "slice %dus", budgetUs);
+        std::printf("%-12s %9.0f %9.0f %9.0f %7d %7d %6zu %s\n", mode, latencyUs[kFrames / 2],
+                    latencyUs[kFrames * 99 / 100], latencyUs.back(), detector.stats().itemCount, cycleFrames,
+                    detections.size(), sameFaces(detections, reference) ? "yes" : "no");
+    }
+    return 0;
+}
@@ -0,0 +1,100 @@
+//
+//  guided_filter_bench.cpp
+//  AnonCam
+//
+//  Cost of refining a 1/8-resolution mask to 1080p with the guided filter
+//  across window radii (should stay flat), against plain bilinear
+//  upsampling, plus the error of each against the ideal full-res mask.
+//
+
+#include "BenchUtil.h"
+#include "GuidedFilter.h"
+#include "Segmentation.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+using namespace AnonCam;
+
+namespace {
+
+constexpr int kWidth = 1920;
+constexpr int kHeight = 1080;
+constexpr int kDivisor = 8;
+
+bool insideFace(float x, float y) {
+    const float dx = (x - 0.5f * kWidth) / (0.16f * kWidth);
+    const float dy = (y - 0.45f * kHeight) / (0.3f * kHeight);
+    return dx * dx + dy * dy <= 1.0f;
+}
+
+double meanAbsError(const std::vector<uint8_t>& mask, const std::vector<uint8_t>& ideal) {
+    double total = 0.0;
+    for (size_t i = 0; i < mask.size(); ++i) {
+        total += std::abs(static_cast<int>(mask[i]) - static_cast<int>(ideal[i]));
+    }
+    return total / mask.size();
+}
+
+} // anonymous namespace
+
+int main() {
+    constexpr int kIterations = 30;
+    constexpr int lowWidth = kWidth / kDivisor;
+    constexpr int lowHeight = kHeight / kDivisor;
+
+    // Bright face on a darker textured background
+    std::vector<uint8_t> luma(static_cast<size_t>(kWidth) * kHeight);
+    std::vector<uint8_t> ideal(luma.size());
+    for (int y = 0; y < kHeight; ++y) {
+        for (int x = 0; x < kWidth; ++x) {
+            const bool face = insideFace(x + 0.5f, y + 0.5f);
+            const int texture = ((x * 7 + y * 13) % 23) - 11;
+            luma[y * kWidth + x] = static_cast<uint8_t>((face ? 180 : 70) + texture);
+            ideal[y * kWidth + x] = face ? 255 : 0;
+        }
+    }
+
+    // Area-sampled low-resolution mask (what a small model would produce)
+    std::vector<uint8_t> lowMask(static_cast<size_t>(lowWidth) * lowHeight);
+    for (int ly = 0; ly < lowHeight; ++ly) {
+        for (int lx = 0; lx < lowWidth; ++lx) {
+            int total = 0;
+            for (int y = 0; y < kDivisor; ++y) {
+                for (int x = 0; x < kDivisor; ++x) {
+                    total += ideal[(ly * kDivisor + y) * kWidth + lx * kDivisor + x];
+                }
+            }
+            lowMask[ly * lowWidth + lx] = static_cast<uint8_t>(total / (kDivisor * kDivisor));
+        }
+    }
+
+    const ImageView guide = ImageView::gray(luma.data(), kWidth, kHeight, kWidth);
+    std::vector<uint8_t> output(luma.size());
+
+    BilinearUpsampler upsampler;
+    const double bilinearNs = Bench::measureNs(kIterations, [&] {
+        upsampler.run(lowMask.data(), lowWidth, lowHeight, lowWidth, output.data(), kWidth, kHeight, kWidth);
+        Bench::doNotOptimize(output.data());
+    });
+    std::printf("%dx%d mask -> %dx%d\n", lowWidth, lowHeight, kWidth, kHeight);
+    std::printf("%-10s %10s %10s\n", "method", "time", "mean err");
+    std::printf("%-10s %8.2fms %10.2f\n", "bilinear", bilinearNs / 1e6, meanAbsError(output, ideal));
+
+    for (int radius : {1, 2, 4, 8, 16, 32, 64}) {
+        GuidedFilter::Options options;
+        options.radius = radius;
+        GuidedFilter filter(options);
+        const double ns = Bench::measureNs(kIterations, [&] {
+            filter.refine(guide, lowMask.data(), lowWidth, lowHeight, lowWidth, output.data(), kWidth);
+            Bench::doNotOptimize(output.data());
+        });
+
+        char label[16];
+        std::snprintf(label, sizeof(label), "guided r%d", radius);
+        std::printf("%-10s %8.2fms %10.2f\n", label, ns / 1e6, meanAbsError(output, ideal));
+    }
+    return 0;
+}
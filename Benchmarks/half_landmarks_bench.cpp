@@ -0,0 +1,78 @@
+//
+//  half_landmarks_bench.cpp
+//  AnonCam
+//
+//  Copy cost of fp32 vs fp16 landmark sets and the cost of converting
+//  between them, for single- and multi-face results.
+//
+
+#include "BenchUtil.h"
+#include "FaceTracker.h"
+#include "HalfLandmarks.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+using namespace AnonCam;
+
+int main() {
+    constexpr size_t kLandmarks = 478;
+    constexpr int kIterations = 50000;
+
+    std::printf("conversion backend: %s\n", halfConversionBackend());
+    std::printf("%-6s %10s %10s %10s %10s %10s %10s\n", "faces", "copy f32", "copy f16",
+                "f32->f16", "f16->f32", "half4", "max err");
+
+    for (size_t faces : {1, 2, 4}) {
+        const size_t count = kLandmarks * faces;
+        std::vector<Landmark> f32(count);
+        for (size_t i = 0; i < count; ++i) {
+            f32[i] = {0.3f + 0.4f * std::fmod(i * 0.618f, 1.0f), 0.2f + 0.5f * std::fmod(i * 0.414f, 1.0f),
+                      0.1f * std::sin(static_cast<float>(i))};
+        }
+
+        std::vector<LandmarkHalf> f16(count);
+        std::vector<Landmark> roundTrip(count);
+        std::vector<uint16_t> half4(count * 4);
+        std::vector<Landmark> f32Copy(count);
+        std::vector<LandmarkHalf> f16Copy(count);
+
+        const double copy32 = Bench::measureNs(kIterations, [&] {
+            std::memcpy(f32Copy.data(), f32.data(), count * sizeof(Landmark));
+            Bench::doNotOptimize(f32Copy.data());
+        });
+        convertLandmarksToHalf(f32.data(), count, f16.data());
+        const double copy16 = Bench::measureNs(kIterations, [&] {
+            std::memcpy(f16Copy.data(), f16.data(), count * sizeof(LandmarkHalf));
+            Bench::doNotOptimize(f16Copy.data());
+        });
+        const double toHalf = Bench::measureNs(kIterations, [&] {
+            convertLandmarksToHalf(f32.data(), count, f16.data());
+            Bench::doNotOptimize(f16.data());
+        });
+        const double fromHalf = Bench::measureNs(kIterations, [&] {
+            convertLandmarksFromHalf(f16.data(), count, roundTrip.data());
+            Bench::doNotOptimize(roundTrip.data());
+        });
+        const double pack = Bench::measureNs(kIterations, [&] {
+            packLandmarksHalf4(f32.data(), count, half4.data());
+            Bench::doNotOptimize(half4.data());
+        });
+
+        float maxError = 0.0f;
+        for (size_t i = 0; i < count; ++i) {
+            maxError = std::max({maxError, std::fabs(roundTrip[i].x - f32[i].x),
+                                 std::fabs(roundTrip[i].y - f32[i].y), std::fabs(roundTrip[i].z - f32[i].z)});
+        }
+
+        std::printf("%-6zu %8.1fns %8.1fns %8.1fns %8.1fns %8.1fns %10.2e\n", faces, copy32, copy16,
+                    toHalf, fromHalf, pack, maxError);
+    }
+
+    std::printf("bytes per face: fp32 %zu, fp16 %zu\n", kLandmarks * sizeof(Landmark),
+                kLandmarks * sizeof(LandmarkHalf));
+    return 0;
+}
@@ -0,0 +1,191 @@
+//
+//  inference_batching_bench.cpp
+//  AnonCam
+//
+//  Throughput of a landmark-sized model head shared by 2 / 4 / 8 camera
+//  streams, each on its own thread: every stream running the model on its
+//  own input against the streams batching through an InferenceBatcher.
+//  The head is a dense layer from a 32x32 input to 478 x 3 outputs (5.9 MB
+//  of weights); one call streams every weight once, a batch reuses each
+//  weight row for all of its inputs. Reports throughput, the gain over
+//  per-stream runs, and the batch-size histogram for each window.
+//
+
+#include "BenchUtil.h"
+#include "InferenceBatcher.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace AnonCam;
+
+namespace {
+
+constexpr int kInputs = 32 * 32;
+constexpr int kOutputs = 478 * 3;
+constexpr int kMaxBatch = 8;
+
+struct DenseHead {
+    std::vector<float> weights;    // kOutputs rows of kInputs
+    std::vector<float> bias;
+
+    DenseHead() : weights(static_cast<size_t>(kOutputs) * kInputs), bias(kOutputs) {
+        uint32_t state = 7;
+        for (auto& w : weights) {
+            state = state * 1664525u + 1013904223u;
+            w = static_cast<float>(static_cast<int32_t>(state) >> 16) * (1.0f / 32768.0f) * 0.03f;
+        }
+        for (int o = 0; o < kOutputs; ++o) {
+            bias[o] = 0.001f * static_cast<float>(o % 7);
+        }
+    }
+
+    // outputs[b] = weights * inputs[b] + bias. A batch reads each weight row
+    // once and multiplies every loaded weight into up to four inputs.
+    void run(const float* const* inputs, float* const* outputs, int count) const {
+        for (int o = 0; o < kOutputs; ++o) {
+            const float* row = weights.data() + static_cast<size_t>(o) * kInputs;
+            int b = 0;
+            for (; b + 4 <= count; b += 4) {
+                dot<4>(row, inputs + b, outputs + b, o);
+            }
+            for (; b + 2 <= count; b += 2) {
+                dot<2>(row, inputs + b, outputs + b, o);
+            }
+            for (; b < count; ++b) {
+                dot<1>(row, inputs + b, outputs + b, o);
+            }
+        }
+    }
+
+    // Vector extensions (GCC / Clang) keep the N x 8 accumulators in registers
+    template <int N>
+    void dot(const float* row, const float* const* inputs, float* const* outputs, int o) const {
+        typedef float Lanes __attribute__((vector_size(16)));
+        Lanes sums[N][2] = {};
+        for (int i = 0; i < kInputs; i += 8) {
+            Lanes w0, w1;
+            std::memcpy(&w0, row + i, sizeof(w0));
+            std::memcpy(&w1, row + i + 4, sizeof(w1));
+            for (int n = 0; n < N; ++n) {
+                Lanes x0, x1;
+                std::memcpy(&x0, inputs[n] + i, sizeof(x0));
+                std::memcpy(&x1, inputs[n] + i + 4, sizeof(x1));
+                sums[n][0] += w0 * x0;
+                sums[n][1] += w1 * x1;
+            }
+        }
+        for (int n = 0; n < N; ++n) {
+            const Lanes sum = sums[n][0] + sums[n][1];
+            outputs[n][o] = (sum[0] + sum[1]) + (sum[2] + sum[3]) + bias[o];
+        }
+    }
+};
+
+struct Request {
+    const float* input;
+    float* output;
+};
+
+struct Stream {
+    std::vector<float> input = std::vector<float>(kInputs);
+    std::vector<float> output = std::vector<float>(kOutputs);
+    int batcherStream = InferenceBatcher::kNoStream;
+};
+
+// Requests per second with `streams` threads each submitting `perStream` requests
+template <typename Submit>
+double throughput(int streams, int perStream, Submit submit, const std::vector<int>& batcherStreams = {}) {
+    std::vector<Stream> state(streams);
+    for (int s = 0; s < streams; ++s) {
+        if (s < static_cast<int>(batcherStreams.size())) {
+            state[s].batcherStream = batcherStreams[s];
+        }
+        for (int i = 0; i < kInputs; ++i) {
+            state[s].input[i] = static_cast<float>((i * 31 + s * 17) % 255) / 255.0f;
+        }
+    }
+    const auto begin = std::chrono::steady_clock::now();
+    std::vector<std::thread> threads;
+    for (int s = 0; s < streams; ++s) {
+        threads.emplace_back([&, s] {
+            for (int r = 0; r < perStream; ++r) {
+                submit(state[s]);
+                Bench::doNotOptimize(state[s].output[r % kOutputs]);
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+    return streams * perStream / seconds;
+}
+
+std::string histogram(const InferenceBatcher::Stats& stats) {
+    std::string text;
+    for (size_t size = 1; size < stats.batchSizes.size(); ++size) {
+        if (stats.batchSizes[size] > 0) {
+            char entry[48];
+            std::snprintf(entry, sizeof(entry), " %zu:%llu", size,
+                          static_cast<unsigned long long>(stats.batchSizes[size]));
+            text += entry;
+        }
+    }
+    return text;
+}
+
+} // anonymous namespace
+
+int main() {
+    constexpr int kRequestsPerStream = 60;
+    const DenseHead head;
+
+    std::printf("%7s %10s %14s %14s %7s %10s  %s\n", "streams", "window", "single (r/s)", "batched (r/s)", "gain",
+                "mean size", "batch sizes (size:count)");
+    for (const int streams : {2, 4, 8}) {
+        const double single = throughput(streams, kRequestsPerStream, [&](Stream& stream) {
+            const float* input = stream.input.data();
+            float* output = stream.output.data();
+            head.run(&input, &output, 1);
+        });
+
+        for (const int windowUs : {500, 2000}) {
+            InferenceBatcher::Options options;
+            options.maxBatch = kMaxBatch;
+            options.windowUs = windowUs;
+            InferenceBatcher batcher(
+                [&](void* const* requests, int count) {
+                    const float* inputs[kMaxBatch];
+                    float* outputs[kMaxBatch];
+                    for (int b = 0; b < count; ++b) {
+                        inputs[b] = static_cast<Request*>(requests[b])->input;
+                        outputs[b] = static_cast<Request*>(requests[b])->output;
+                    }
+                    head.run(inputs, outputs, count);
+                },
+                options);
+            std::vector<int> ids;
+            for (int s = 0; s < streams; ++s) {
+                ids.push_back(batcher.attachStream());
+            }
+
+            const double batched = throughput(streams, kRequestsPerStream, [&](Stream& stream) {
+                Request request{stream.input.data(), stream.output.data()};
+                batcher.run(&request, stream.batcherStream);
+            }, ids);
+
+            const InferenceBatcher::Stats stats = batcher.stats();
+            char window[16];
+            std::snprintf(window, sizeof(window), "%dus", windowUs);
+            std::printf("%7d %10s %14.0f %14.0f %6.2fx %10.2f %s\n", streams, window, single, batched,
+                        batched / single, static_cast<double>(stats.requests) / stats.batches,
+                        histogram(stats).c_str());
+        }
+    }
+    return 0;
+}
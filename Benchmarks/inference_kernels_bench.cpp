@@ -0,0 +1,172 @@
+//
+//  inference_kernels_bench.cpp
+//  AnonCam
+//
+//  Per-layer cost of the fp32, fp16 (fp16 or fp32 accumulation) and int8
+//  kernels on the pointwise, depthwise and dense layer shapes of BlazeFace
+//  and FaceMesh, with the fp16 error relative to fp32. Without NEON FP16
+//  the fp16 columns time the emulation, not fp16 arithmetic. int8 has no
+//  depthwise kernel.
+//
+
+#include "BenchUtil.h"
+#include "HalfLandmarks.h"
+#include "InferenceKernels.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+using namespace AnonCam;
+
+namespace {
+
+struct Layer {
+    const char* name;
+    bool depthwise;
+    int width, height;             // Depthwise: image size
+    int m, n, k;                   // GEMM: m = pixels, n = outputs, k = inputs; depthwise: n = channels
+};
+
+std::vector<float> values(size_t count, uint32_t seed, float scale) {
+    std::vector<float> out(count);
+    for (auto& v : out) {
+        seed = seed * 1664525u + 1013904223u;
+        v = scale * (static_cast<float>(seed >> 8) / 8388608.0f - 1.0f);
+    }
+    return out;
+}
+
+std::vector<uint16_t> toHalf(const std::vector<float>& in) {
+    std::vector<uint16_t> out(in.size());
+    for (size_t i = 0; i < in.size(); ++i) {
+        out[i] = floatToHalf(in[i]);
+    }
+    return out;
+}
+
+// Symmetric quantization to int8 with one scale for the tensor
+std::vector<int8_t> toInt8(const std::vector<float>& in, float& scale) {
+    float maxAbs = 0.0f;
+    for (float v : in) {
+        maxAbs = std::max(maxAbs, std::abs(v));
+    }
+    scale = maxAbs > 0.0f ? maxAbs / 127.0f : 1.0f;
+    std::vector<int8_t> out(in.size());
+    for (size_t i = 0; i < in.size(); ++i) {
+        out[i] = static_cast<int8_t>(std::lround(in[i] / scale));
+    }
+    return out;
+}
+
+// Largest error relative to the largest fp32 output
+template <typename T, typename Convert>
+double relativeError(const std::vector<float>& reference, const std::vector<T>& result, Convert convert) {
+    double maxError = 0.0, maxValue = 0.0;
+    for (size_t i = 0; i < reference.size(); ++i) {
+        maxError = std::max(maxError, std::abs(static_cast<double>(convert(result[i])) - reference[i]));
+        maxValue = std::max(maxValue, std::abs(static_cast<double>(reference[i])));
+    }
+    return maxValue > 0.0 ? maxError / maxValue : 0.0;
+}
+
+} // anonymous namespace
+
+int main() {
+    const Layer layers[] = {
+        {"pointwise 64x64 24->24", false, 0, 0, 64 * 64, 24, 24},
+        {"pointwise 32x32 48->48", false, 0, 0, 32 * 32, 48, 48},
+        {"pointwise 16x16 96->96", false, 0, 0, 16 * 16, 96, 96},
+        {"pointwise 8x8 96->96", false, 0, 0, 8 * 8, 96, 96},
+        {"dense 1152->1404", false, 0, 0, 1, 1404, 1152},
+        {"depthwise 64x64x24", true, 64, 64, 64 * 64, 24, 9},
+        {"depthwise 32x32x48", true, 32, 32, 32 * 32, 48, 9},
+        {"depthwise 16x16x96", true, 16, 16, 16 * 16, 96, 9},
+    };
+
+    std::printf("fp16 kernels: %s\n\n", halfArithmeticBackend());
+    std::printf("%-24s %10s %10s %12s %10s %11s %11s %11s\n", "layer", "fp32 (us)", "fp16 (us)", "f16/a32 (us)",
+                "int8 (us)", "fp16 err", "f16/a32 err", "int8 err");
+
+    const auto half = [](uint16_t h) { return halfToFloat(h); };
+    for (const Layer& layer : layers) {
+        const int n = layer.n;
+        const int k = layer.k;
+        const size_t inputs = static_cast<size_t>(layer.m) * (layer.depthwise ? n : k);
+        const size_t weights = static_cast<size_t>(k) * n;
+        const size_t outputs = static_cast<size_t>(layer.m) * n;
+        const double macs = static_cast<double>(layer.m) * n * k;
+        const int iterations = std::max(3, static_cast<int>(2e8 / macs));
+        const int halfIterations = halfArithmeticNative() ? iterations : std::max(1, iterations / 50);
+
+        const std::vector<float> input = values(inputs, 1, 1.0f);
+        const std::vector<float> weight = values(weights, 2, 1.0f / std::sqrt(static_cast<float>(k)));
+        const std::vector<float> bias = values(n, 3, 0.1f);
+        const std::vector<uint16_t> inputHalf = toHalf(input);
+        const std::vector<uint16_t> weightHalf = toHalf(weight);
+        const std::vector<uint16_t> biasHalf = toHalf(bias);
+
+        std::vector<float> reference(outputs);
+        std::vector<uint16_t> resultHalf(outputs);
+        std::vector<uint16_t> resultSingle(outputs);
+        double floatNs, halfNs, singleNs;
+        if (layer.depthwise) {
+            const auto run = [&] {
+                depthwiseConv3x3(input.data(), layer.width, layer.height, n, weight.data(), bias.data(),
+                                 reference.data());
+            };
+            floatNs = Bench::measureNs(iterations, run);
+            halfNs = Bench::measureNs(halfIterations, [&] {
+                depthwiseConv3x3Half(inputHalf.data(), layer.width, layer.height, n, weightHalf.data(),
+                                     biasHalf.data(), resultHalf.data(), HalfAccumulation::Half);
+            });
+            singleNs = Bench::measureNs(halfIterations, [&] {
+                depthwiseConv3x3Half(inputHalf.data(), layer.width, layer.height, n, weightHalf.data(),
+                                     biasHalf.data(), resultSingle.data(), HalfAccumulation::Single);
+            });
+            std::printf("%-24s %10.1f %10.1f %12.1f %10s %11.1e %11.1e %11s\n", layer.name, floatNs / 1e3,
+                        halfNs / 1e3, singleNs / 1e3, "-", relativeError(reference, resultHalf, half),
+                        relativeError(reference, resultSingle, half), "-");
+            continue;
+        }
+
+        floatNs = Bench::measureNs(iterations, [&] {
+            gemm(input.data(), weight.data(), bias.data(), reference.data(), layer.m, n, k);
+        });
+        halfNs = Bench::measureNs(halfIterations, [&] {
+            gemmHalf(inputHalf.data(), weightHalf.data(), biasHalf.data(), resultHalf.data(), layer.m, n, k,
+                     HalfAccumulation::Half);
+        });
+        singleNs = Bench::measureNs(halfIterations, [&] {
+            gemmHalf(inputHalf.data(), weightHalf.data(), biasHalf.data(), resultSingle.data(), layer.m, n, k,
+                     HalfAccumulation::Single);
+        });
+
+        // int8: weights transposed, bias in the product's scale
+        float inputScale, weightScale;
+        const std::vector<int8_t> inputInt8 = toInt8(input, inputScale);
+        const std::vector<int8_t> weightInt8 = toInt8(weight, weightScale);
+        std::vector<int8_t> weightTransposed(weights);
+        for (int p = 0; p < k; ++p) {
+            for (int j = 0; j < n; ++j) {
+                weightTransposed[static_cast<size_t>(j) * k + p] = weightInt8[static_cast<size_t>(p) * n + j];
+            }
+        }
+        const float productScale = inputScale * weightScale;
+        std::vector<int32_t> biasInt32(n);
+        for (int j = 0; j < n; ++j) {
+            biasInt32[j] = static_cast<int32_t>(std::lround(bias[j] / productScale));
+        }
+        std::vector<int32_t> resultInt8(outputs);
+        const double int8Ns = Bench::measureNs(iterations, [&] {
+            gemmInt8(inputInt8.data(), weightTransposed.data(), biasInt32.data(), resultInt8.data(), layer.m, n, k);
+        });
+
+        std::printf("%-24s %10.1f %10.1f %12.1f %10.1f %11.1e %11.1e %11.1e\n", layer.name, floatNs / 1e3,
+                    halfNs / 1e3, singleNs / 1e3, int8Ns / 1e3, relativeError(reference, resultHalf, half),
+                    relativeError(reference, resultSingle, half),
+                    relativeError(reference, resultInt8, [&](int32_t v) { return v * productScale; }));
+    }
+    return 0;
+}
@@ -0,0 +1,117 @@
+//
+//  landmark_codec_bench.cpp
+//  AnonCam
+//
+//  Bytes per frame and encode/decode cost of LandmarkCodec on a synthetic
+//  478-point face moving slowly with per-point jitter.
+//
+
+#include "BenchUtil.h"
+#include "LandmarkCodec.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+using namespace AnonCam;
+
+namespace {
+
+constexpr size_t kLandmarks = 478;
+constexpr int kFrames = 300;
+
+std::vector<std::vector<Landmark>> makeSequence() {
+    std::mt19937 rng(42);
+    std::normal_distribution<float> jitter(0.0f, 0.0004f);
+
+    std::vector<Landmark> base(kLandmarks);
+    for (size_t i = 0; i < kLandmarks; ++i) {
+        const float angle = static_cast<float>(i) * 0.37f;
+        const float radius = 0.05f + 0.1f * static_cast<float>(i % 23) / 22.0f;
+        base[i] = {0.5f + radius * std::cos(angle), 0.5f + radius * std::sin(angle),
+                   0.05f * std::cos(angle * 0.5f)};
+    }
+
+    std::vector<std::vector<Landmark>> frames(kFrames, base);
+    for (int f = 0; f < kFrames; ++f) {
+        const float dx = 0.05f * std::sin(f * 0.05f);
+        const float dy = 0.03f * std::cos(f * 0.04f);
+        for (auto& lm : frames[f]) {
+            lm.x += dx + jitter(rng);
+            lm.y += dy + jitter(rng);
+            lm.z += jitter(rng);
+        }
+    }
+    return frames;
+}
+
+void run(const char* label, const LandmarkEncoder::Options& options,
+         const std::vector<std::vector<Landmark>>& frames) {
+    std::vector<std::vector<uint8_t>> packets(frames.size());
+    std::vector<uint8_t> scratch(LandmarkEncoder::maxEncodedSize(kLandmarks));
+
+    // Size and accuracy over one pass of the sequence
+    LandmarkEncoder encoder(options);
+    LandmarkDecoder decoder;
+    std::vector<Landmark> decoded(kLandmarks);
+    size_t totalBytes = 0;
+    float maxError = 0.0f;
+    for (size_t f = 0; f < frames.size(); ++f) {
+        const size_t bytes = encoder.encode(frames[f].data(), kLandmarks, scratch.data());
+        packets[f].assign(scratch.begin(), scratch.begin() + bytes);
+        totalBytes += bytes;
+
+        size_t count = 0;
+        if (!decoder.decode(packets[f].data(), bytes, decoded.data(), decoded.size(), count)) {
+            std::printf("%s: decode failed at frame %zu\n", label, f);
+            return;
+        }
+        for (size_t i = 0; i < count; ++i) {
+            maxError = std::max({maxError, std::fabs(decoded[i].x - frames[f][i].x),
+                                 std::fabs(decoded[i].y - frames[f][i].y),
+                                 std::fabs(decoded[i].z - frames[f][i].z)});
+        }
+    }
+
+    // Steady-state cost, cycling through the sequence
+    size_t f = 0;
+    const double encodeNs = Bench::measureNs(20000, [&] {
+        Bench::doNotOptimize(encoder.encode(frames[f].data(), kLandmarks, scratch.data()));
+        f = (f + 1) % frames.size();
+    });
+
+    decoder.reset();
+    f = 0;
+    const double decodeNs = Bench::measureNs(20000, [&] {
+        size_t count = 0;
+        if (f == 0) {
+            decoder.reset();
+        }
+        Bench::doNotOptimize(decoder.decode(packets[f].data(), packets[f].size(),
+                                            decoded.data(), decoded.size(), count));
+        f = (f + 1) % packets.size();
+    });
+
+    std::printf("%-12s %8.1f B/frame  encode %7.1f ns  decode %7.1f ns  max err %.2e\n", label,
+                static_cast<double>(totalBytes) / frames.size(), encodeNs, decodeNs, maxError);
+}
+
+} // anonymous namespace
+
+int main() {
+    const auto frames = makeSequence();
+    std::printf("%zu landmarks, fp32 = %zu B/frame\n", kLandmarks, kLandmarks * sizeof(Landmark));
+
+    LandmarkEncoder::Options keyOnly;
+    keyOnly.deltaCoding = false;
+    run("key only", keyOnly, frames);
+
+    LandmarkEncoder::Options delta;
+    run("delta", delta, frames);
+
+    delta.keyframeInterval = 1 << 30;
+    run("delta (no KF)", delta, frames);
+    return 0;
+}
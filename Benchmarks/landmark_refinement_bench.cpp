@@ -0,0 +1,191 @@
+//
+//  landmark_refinement_bench.cpp
+//  AnonCam
+//
+//  Cost and steadiness of the eye / lip refinement stage on a 720p
+//  sequence: a textured face translating smoothly, with Face Mesh
+//  landmarks that follow the true motion plus the frame-to-frame wobble of
+//  a low-resolution face model (each feature displaced as a whole by
+//  Gaussian noise of 1.5 px, plus 0.2 px per point). Reports the refinement
+//  cost inline and on a worker pool, and the RMS error and frame-to-frame
+//  jitter of the eye and lip landmarks before and after refinement.
+//
+
+#include "BenchUtil.h"
+#include "FaceTracker.h"
+#include "LandmarkRefiner.h"
+#include "WorkerPool.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+using namespace AnonCam;
+
+namespace {
+
+constexpr int kWidth = 1280;
+constexpr int kHeight = 720;
+constexpr int kFrames = 120;
+constexpr float kWobblePx = 1.5f;
+
+// Smooth random texture: a few octaves of value noise
+std::vector<float> makeTexture(int width, int height) {
+    std::vector<float> texture(static_cast<size_t>(width) * height, 0.0f);
+    std::mt19937 random(3);
+    for (const int cell : {64, 16, 6}) {
+        const int cw = width / cell + 2;
+        const int ch = height / cell + 2;
+        std::vector<float> grid(static_cast<size_t>(cw) * ch);
+        for (auto& g : grid) {
+            g = std::uniform_real_distribution<float>(-1.0f, 1.0f)(random);
+        }
+        for (int y = 0; y < height; ++y) {
+            const float gy = static_cast<float>(y) / cell;
+            const int y0 = static_cast<int>(gy);
+            const float fy = gy - y0;
+            for (int x = 0; x < width; ++x) {
+                const float gx = static_cast<float>(x) / cell;
+                const int x0 = static_cast<int>(gx);
+                const float fx = gx - x0;
+                const float* g = grid.data() + static_cast<size_t>(y0) * cw + x0;
+                const float top = g[0] + (g[1] - g[0]) * fx;
+                const float bottom = g[cw] + (g[cw + 1] - g[cw]) * fx;
+                texture[static_cast<size_t>(y) * width + x] += 30.0f * (top + (bottom - top) * fy);
+            }
+        }
+    }
+    return texture;
+}
+
+// Frame = texture shifted by (sx, sy) pixels, bilinear
+void renderFrame(const std::vector<float>& texture, int textureWidth, float sx, float sy,
+                 std::vector<uint8_t>& pixels) {
+    for (int y = 0; y < kHeight; ++y) {
+        const float ty = y - sy + 40.0f;
+        const int y0 = static_cast<int>(ty);
+        const float fy = ty - y0;
+        for (int x = 0; x < kWidth; ++x) {
+            const float tx = x - sx + 40.0f;
+            const int x0 = static_cast<int>(tx);
+            const float fx = tx - x0;
+            const float* t = texture.data() + static_cast<size_t>(y0) * textureWidth + x0;
+            const float top = t[0] + (t[1] - t[0]) * fx;
+            const float bottom = t[textureWidth] + (t[textureWidth + 1] - t[textureWidth]) * fx;
+            pixels[static_cast<size_t>(y) * kWidth + x] =
+                static_cast<uint8_t>(std::clamp(128.0f + top + (bottom - top) * fy, 0.0f, 255.0f));
+        }
+    }
+}
+
+// Eye and lip landmarks the refiner moves, per region (as in LandmarkRefiner.cpp)
+const std::vector<std::vector<int>> kRegions = {
+    {33, 7, 163, 144, 145, 153, 154, 155, 133, 173, 157, 158, 159, 160, 161, 246, 468, 469, 470, 471, 472},
+    {263, 249, 390, 373, 374, 380, 381, 382, 362, 398, 384, 385, 386, 387, 388, 466, 473, 474, 475, 476, 477},
+    {61, 146, 91, 181, 84, 17, 314, 405, 321, 375, 291, 185, 40, 39, 37, 0, 267, 269, 270, 409,
+     78, 95, 88, 178, 87, 14, 317, 402, 318, 324, 308, 191, 80, 81, 82, 13, 312, 311, 310, 415},
+};
+
+// Rest position (pixels) of every landmark: each region on an ellipse around
+// its feature, everything else at the face center
+std::vector<Landmark> restLandmarks() {
+    const float centers[3][4] = {{580.0f, 320.0f, 30.0f, 12.0f}, {700.0f, 320.0f, 30.0f, 12.0f},
+                                 {640.0f, 450.0f, 45.0f, 18.0f}};
+    std::vector<Landmark> rest(478, Landmark{kWidth * 0.5f, kHeight * 0.5f, 0.0f});
+    for (size_t r = 0; r < kRegions.size(); ++r) {
+        const size_t count = kRegions[r].size();
+        for (size_t k = 0; k < count; ++k) {
+            const float angle = 6.2831853f * k / count;
+            rest[kRegions[r][k]] = {centers[r][0] + centers[r][2] * std::cos(angle),
+                                    centers[r][1] + centers[r][3] * std::sin(angle), 0.0f};
+        }
+    }
+    return rest;
+}
+
+struct Error {
+    double rms = 0.0;
+    double jitter = 0.0;  // RMS frame-to-frame change of the error
+};
+
+} // anonymous namespace
+
+int main() {
+    const int textureWidth = kWidth + 80;
+    const std::vector<float> texture = makeTexture(textureWidth, kHeight + 80);
+    const std::vector<Landmark> rest = restLandmarks();
+    std::vector<int> indices;
+    std::vector<int> regionOf(rest.size(), -1);
+    for (size_t r = 0; r < kRegions.size(); ++r) {
+        for (const int index : kRegions[r]) {
+            indices.push_back(index);
+            regionOf[index] = static_cast<int>(r);
+        }
+    }
+    std::vector<uint8_t> pixels(static_cast<size_t>(kWidth) * kHeight);
+    const ImageView frame = ImageView::gray(pixels.data(), kWidth, kHeight, kWidth);
+
+    WorkerPool pool(WorkerPool::defaultThreadCount());
+    std::printf("%-12s %12s %12s %12s %12s\n", "", "cost (us)", "rms (px)", "jitter (px)", "tracked");
+    for (const int mode : {0, 1, 2}) {
+        LandmarkRefiner refiner(LandmarkRefiner::Options(), mode == 2 ? &pool : nullptr);
+        std::mt19937 random(11);
+        std::normal_distribution<float> wobble(0.0f, 1.0f);
+
+        Error error;
+        std::vector<float> previousError(indices.size() * 2, 0.0f);
+        double costNs = 0.0;
+        std::vector<Landmark> landmarks(rest.size());
+        for (int f = 0; f < kFrames; ++f) {
+            const float sx = 25.0f * std::sin(f * 0.05f);
+            const float sy = 12.0f * std::sin(f * 0.031f);
+            renderFrame(texture, textureWidth, sx, sy, pixels);
+            // A low-resolution model misplaces a feature as a whole, plus a little per point
+            float regionWobble[3][2];
+            for (auto& w : regionWobble) {
+                w[0] = kWobblePx * wobble(random);
+                w[1] = kWobblePx * wobble(random);
+            }
+            for (size_t i = 0; i < rest.size(); ++i) {
+                const float wx = regionOf[i] >= 0 ? regionWobble[regionOf[i]][0] : 0.0f;
+                const float wy = regionOf[i] >= 0 ? regionWobble[regionOf[i]][1] : 0.0f;
+                landmarks[i] = {(rest[i].x + sx + wx + 0.2f * wobble(random)) / kWidth,
+                                (rest[i].y + sy + wy + 0.2f * wobble(random)) / kHeight, 0.0f};
+            }
+            if (mode > 0) {
+                const auto begin = std::chrono::steady_clock::now();
+                refiner.refine(frame, landmarks.data(), landmarks.size());
+                costNs += std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - begin).count();
+            }
+            for (size_t k = 0; k < indices.size(); ++k) {
+                const Landmark& lm = landmarks[indices[k]];
+                const float ex = lm.x * kWidth - (rest[indices[k]].x + sx);
+                const float ey = lm.y * kHeight - (rest[indices[k]].y + sy);
+                error.rms += ex * ex + ey * ey;
+                if (f > 0) {
+                    const float jx = ex - previousError[2 * k];
+                    const float jy = ey - previousError[2 * k + 1];
+                    error.jitter += jx * jx + jy * jy;
+                }
+                previousError[2 * k] = ex;
+                previousError[2 * k + 1] = ey;
+            }
+            Bench::doNotOptimize(landmarks.data());
+        }
+        error.rms = std::sqrt(error.rms / (static_cast<double>(kFrames) * indices.size()));
+        error.jitter = std::sqrt(error.jitter / (static_cast<double>(kFrames - 1) * indices.size()));
+
+        const char* label = mode == 0 ? "face model" : mode == 1 ? "refined" : "refined/pool";
+        if (mode == 0) {
+            std::printf("%-12s %12s %12.2f %12.2f %12s\n", label, "-", error.rms, error.jitter, "-");
+            continue;
+        }
+        const LandmarkRefiner::Stats& stats = refiner.stats();
+        std::printf("%-12s %12.1f %12.2f %12.2f %11.0f%%\n", label, costNs / kFrames / 1e3, error.rms, error.jitter,
+                    100.0 * stats.regionsTracked / (stats.regionsTracked + stats.regionsReset));
+    }
+    return 0;
+}
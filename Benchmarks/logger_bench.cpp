@@ -0,0 +1,117 @@
+//
+//  logger_bench.cpp
+//  AnonCam
+//
+//  What logging costs the thread that logs during an error storm: every
+//  frame-path call fails and logs. Logger (rate-limited site, per-thread
+//  ring, formatting on the background thread) against a synchronous
+//  fprintf, as print() does today. Both write to /dev/null, so the
+//  baseline pays formatting and the stdio lock but no terminal. Runs one
+//  logging thread and four at once; reports per-call latency and what the
+//  logger wrote, rate-limited and dropped.
+//
+
+#include "Logger.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace AnonCam;
+
+namespace {
+
+constexpr int kCallsPerThread = 500000;
+
+struct Latency {
+    double meanNs = 0.0;
+    double p99Ns = 0.0;
+    double maxNs = 0.0;
+};
+
+// Runs call(thread, i) kCallsPerThread times on each of threadCount threads
+template <typename Call>
+Latency measureCalls(int threadCount, Call&& call) {
+    std::vector<std::vector<double>> samples(threadCount, std::vector<double>(kCallsPerThread));
+    std::vector<std::thread> threads;
+    for (int t = 0; t < threadCount; ++t) {
+        threads.emplace_back([&, t] {
+            for (int i = 0; i < kCallsPerThread; ++i) {
+                const auto begin = std::chrono::steady_clock::now();
+                call(t, i);
+                samples[t][i] =
+                    std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - begin).count();
+            }
+        });
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+
+    std::vector<double> all;
+    for (const auto& perThread : samples) {
+        all.insert(all.end(), perThread.begin(), perThread.end());
+    }
+    Latency latency;
+    for (const double sample : all) {
+        latency.meanNs += sample;
+    }
+    latency.meanNs /= all.size();
+    std::sort(all.begin(), all.end());
+    latency.p99Ns = all[all.size() * 99 / 100];
+    latency.maxNs = all.back();
+    return latency;
+}
+
+void print(const char* label, const Latency& latency) {
+    std::printf("%-34s %12.1f %12.0f %12.0f\n", label, latency.meanNs, latency.p99Ns, latency.maxNs);
+}
+
+} // anonymous namespace
+
+int main() {
+    FILE* devNull = std::fopen("/dev/null", "w");
+    if (!devNull) {
+        std::fprintf(stderr, "cannot open /dev/null\n");
+        return 1;
+    }
+    const std::string error = "The operation couldn't be completed. (com.apple.Vision error 9.)";
+
+    std::printf("%-34s %12s %12s %12s\n", "call", "mean (ns)", "p99 (ns)", "max (ns)");
+    for (const int threadCount : {1, 4}) {
+        char label[64];
+
+        std::snprintf(label, sizeof(label), "fprintf, %d thread%s", threadCount, threadCount > 1 ? "s" : "");
+        print(label, measureCalls(threadCount, [&](int thread, int frame) {
+                  std::fprintf(devNull, "Vision error on thread %d, frame %d: %s\n", thread, frame, error.c_str());
+              }));
+
+        for (const int burst : {5, 1 << 30}) {
+            LogSite site("vision error on thread {}, frame {}: {}", LogLevel::Error, __FILE__, __LINE__);
+            Logger::Options options;
+            options.burst = burst;
+            options.sink = [devNull](LogLevel, const char* line) { std::fprintf(devNull, "%s\n", line); };
+            Logger logger(options);
+
+            const Latency latency = measureCalls(threadCount, [&](int thread, int frame) {
+                logger.log(site, thread, frame, error);
+            });
+            logger.flush();
+
+            std::snprintf(label, sizeof(label), "logger %s, %d thread%s", burst == 5 ? "5/s" : "unlimited",
+                          threadCount, threadCount > 1 ? "s" : "");
+            print(label, latency);
+            const Logger::Stats stats = logger.stats();
+            std::printf("  %llu written, %llu rate-limited, %llu dropped (ring full)\n",
+                        static_cast<unsigned long long>(stats.written),
+                        static_cast<unsigned long long>(stats.rateLimited),
+                        static_cast<unsigned long long>(stats.overflowed));
+        }
+    }
+
+    std::fclose(devNull);
+    return 0;
+}
@@ -0,0 +1,182 @@
+//
+//  luma_normalization_bench.cpp
+//  AnonCam
+//
+//  What luma normalization does to the tracker's 32x32 model input on
+//  backlit, dim and normal synthetic scenes, left alone, gain-stretched or
+//  equalized: the contrast of its center and the spread of its histogram,
+//  measured on the samples. The tracker is not run: its stub landmark model
+//  scores every input alike, so any tracking gain would be simulated. Also
+//  what the region histogram and lookup table cost.
+//
+
+#include "BenchUtil.h"
+#include "LumaNormalizer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+using namespace AnonCam;
+
+namespace {
+
+struct Scene {
+    const char* name;
+    float background;   // Luma outside the face
+    float face;         // Mean luma of the face
+    float texture;      // Amplitude of the facial detail
+};
+
+// Deterministic noise in [-amplitude, amplitude]
+class NoiseSource {
+public:
+    explicit NoiseSource(uint32_t seed) : state_(seed) {}
+
+    float next(float amplitude) {
+        state_ = state_ * 1664525u + 1013904223u;
+        return amplitude * (static_cast<float>(state_ >> 8) / 8388608.0f - 1.0f);
+    }
+
+private:
+    uint32_t state_;
+};
+
+void render(std::vector<uint8_t>& luma, int width, int height, const Scene& scene, int index,
+            NoiseSource& noise) {
+    const float drift = 5.0f * std::sin(index * 0.07f);
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) {
+            const float u = (x - drift) / width - 0.5f;
+            const float v = static_cast<float>(y) / height - 0.5f;
+            float value = scene.background;
+            if ((u * u) / (0.15f * 0.15f) + (v * v) / (0.2f * 0.2f) <= 1.0f) {
+                value = scene.face + scene.texture * std::sin((x - drift) * 0.1f) * std::sin(y * 0.08f);
+            }
+            value += noise.next(1.5f);
+            luma[static_cast<size_t>(y) * width + x] = static_cast<uint8_t>(std::clamp(value, 0.0f, 255.0f));
+        }
+    }
+}
+
+// Face box of the stub tracker (normalized x0, y0, x1, y1)
+constexpr float kFaceBox[4] = {0.35f, 0.3f, 0.65f, 0.7f};
+constexpr int kInputSize = 32;
+
+// The tracker's model input: the face box point-sampled to 32x32
+void sampleInput(const std::vector<uint8_t>& luma, int width, int height, uint8_t* input) {
+    for (int j = 0; j < kInputSize; ++j) {
+        const float v = kFaceBox[1] + (kFaceBox[3] - kFaceBox[1]) * (j + 0.5f) / kInputSize;
+        const int y = std::clamp(static_cast<int>(v * height), 0, height - 1);
+        for (int i = 0; i < kInputSize; ++i) {
+            const float u = kFaceBox[0] + (kFaceBox[2] - kFaceBox[0]) * (i + 0.5f) / kInputSize;
+            const int x = std::clamp(static_cast<int>(u * width), 0, width - 1);
+            input[j * kInputSize + i] = luma[static_cast<size_t>(y) * width + x];
+        }
+    }
+}
+
+// Standard deviation (levels) of the central half of the input
+double centerContrast(const uint8_t* input) {
+    constexpr int kBegin = kInputSize / 4;
+    constexpr int kEnd = kInputSize - kBegin;
+    double sum = 0.0, sumSquares = 0.0;
+    for (int j = kBegin; j < kEnd; ++j) {
+        for (int i = kBegin; i < kEnd; ++i) {
+            const double value = input[j * kInputSize + i];
+            sum += value;
+            sumSquares += value * value;
+        }
+    }
+    const double n = static_cast<double>((kEnd - kBegin) * (kEnd - kBegin));
+    return std::sqrt(std::max(0.0, sumSquares / n - (sum / n) * (sum / n)));
+}
+
+// Levels between the 5th and 95th percentile of the input
+int histogramSpread(const uint8_t* input) {
+    std::vector<uint8_t> sorted(input, input + kInputSize * kInputSize);
+    std::sort(sorted.begin(), sorted.end());
+    return sorted[sorted.size() * 95 / 100] - sorted[sorted.size() * 5 / 100];
+}
+
+} // anonymous namespace
+
+int main() {
+    constexpr int kWidth = 1280;
+    constexpr int kHeight = 720;
+    constexpr int kFrames = 120;
+
+    const Scene scenes[] = {
+        {"backlit", 215.0f, 28.0f, 2.0f},
+        {"dim", 22.0f, 34.0f, 2.0f},
+        {"normal", 90.0f, 130.0f, 24.0f},
+    };
+
+    struct Variant {
+        const char* name;
+        bool normalize;
+        LumaNormalizer::Mode mode;
+    };
+    const Variant variants[] = {
+        {"off", false, LumaNormalizer::Mode::Gain},
+        {"gain", true, LumaNormalizer::Mode::Gain},
+        {"equalize", true, LumaNormalizer::Mode::Equalize},
+    };
+
+    std::vector<uint8_t> luma(static_cast<size_t>(kWidth) * kHeight);
+    const ImageView frame = ImageView::gray(luma.data(), kWidth, kHeight, kWidth);
+
+    std::printf("Model input (%dx%d, %d frames, mean): center contrast (levels) and 5-95%% spread (levels)\n",
+                kWidth, kHeight, kFrames);
+    std::printf("%-10s %10s %10s %10s   %10s %10s %10s\n", "scene", "off", "gain", "equalize", "off", "gain",
+                "equalize");
+
+    for (const auto& scene : scenes) {
+        double contrast[3] = {0.0, 0.0, 0.0};
+        double spread[3] = {0.0, 0.0, 0.0};
+        NoiseSource noise(11);
+        for (int i = 0; i < kFrames; ++i) {
+            render(luma, kWidth, kHeight, scene, i, noise);
+            for (int v = 0; v < 3; ++v) {
+                uint8_t input[kInputSize * kInputSize];
+                sampleInput(luma, kWidth, kHeight, input);
+                if (variants[v].normalize) {
+                    LumaNormalizer::Options options;
+                    options.mode = variants[v].mode;
+                    LumaNormalizer normalizer(options);
+                    if (normalizer.analyze(frame, static_cast<int>(kFaceBox[0] * kWidth),
+                                           static_cast<int>(kFaceBox[1] * kHeight),
+                                           static_cast<int>(std::ceil(kFaceBox[2] * kWidth)),
+                                           static_cast<int>(std::ceil(kFaceBox[3] * kHeight)))) {
+                        normalizer.apply(input, sizeof(input));
+                    }
+                }
+                contrast[v] += centerContrast(input);
+                spread[v] += histogramSpread(input);
+            }
+        }
+        std::printf("%-10s %10.1f %10.1f %10.1f   %10.1f %10.1f %10.1f\n", scene.name, contrast[0] / kFrames,
+                    contrast[1] / kFrames, contrast[2] / kFrames, spread[0] / kFrames, spread[1] / kFrames,
+                    spread[2] / kFrames);
+    }
+
+    // Face region of the stub tracker at 720p: 384 x 288 pixels
+    NoiseSource noise(3);
+    render(luma, kWidth, kHeight, scenes[0], 0, noise);
+    uint8_t input[32 * 32] = {};
+    std::printf("\nNormalization cost (384x288 region, 32x32 input)\n");
+    for (const auto& variant : {variants[1], variants[2]}) {
+        LumaNormalizer::Options options;
+        options.mode = variant.mode;
+        LumaNormalizer normalizer(options);
+        const double ns = Bench::measureNs(2000, [&] {
+            normalizer.analyze(frame, 448, 216, 832, 504);
+            normalizer.apply(input, sizeof(input));
+            Bench::doNotOptimize(input[0]);
+        });
+        std::printf("%-10s %8.1f us\n", variant.name, ns / 1e3);
+    }
+
+    return 0;
+}
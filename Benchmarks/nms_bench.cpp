@@ -0,0 +1,160 @@
+//
+//  nms_bench.cpp
+//  AnonCam
+//
+//  Non-maximum suppression over 10 / 100 / 1000 detector candidates: the
+//  structure-of-arrays SIMD implementation (weighted and hard) against a
+//  direct port of MediaPipe's weighted NMS (full sort, scalar IoU, vectors
+//  rebuilt every pass). Candidates are jittered copies of a few faces plus
+//  scattered low-score noise, as an SSD decoder produces them.
+//
+
+#include "BenchUtil.h"
+#include "NonMaxSuppression.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <utility>
+#include <vector>
+
+using namespace AnonCam;
+
+namespace {
+
+float iou(const Detection& a, const Detection& b) {
+    const float w = std::max(0.0f, std::min(a.x + a.width, b.x + b.width) - std::max(a.x, b.x));
+    const float h = std::max(0.0f, std::min(a.y + a.height, b.y + b.height) - std::max(a.y, b.y));
+    const float intersection = w * h;
+    const float unionArea = a.width * a.height + b.width * b.height - intersection;
+    return unionArea > 0.0f ? intersection / unionArea : 0.0f;
+}
+
+// Reference: WeightedNonMaxSuppression from MediaPipe's NonMaxSuppressionCalculator
+void weightedReference(const std::vector<Detection>& candidates, float threshold, std::vector<Detection>& out) {
+    std::vector<std::pair<float, int>> remained;
+    for (int i = 0; i < static_cast<int>(candidates.size()); ++i) {
+        remained.emplace_back(candidates[i].score, i);
+    }
+    std::sort(remained.begin(), remained.end(), [](const auto& a, const auto& b) {
+        return a.first > b.first || (a.first == b.first && a.second < b.second);
+    });
+
+    out.clear();
+    while (!remained.empty()) {
+        const Detection& top = candidates[remained.front().second];
+        std::vector<std::pair<float, int>> cluster;
+        std::vector<std::pair<float, int>> rest;
+        for (const auto& entry : remained) {
+            (iou(top, candidates[entry.second]) > threshold ? cluster : rest).push_back(entry);
+        }
+
+        Detection merged = top;
+        float weight = 0.0f, x0 = 0.0f, y0 = 0.0f, x1 = 0.0f, y1 = 0.0f;
+        float keypoints[Detection::kMaxKeypoints][2] = {};
+        for (const auto& entry : cluster) {
+            const Detection& member = candidates[entry.second];
+            weight += member.score;
+            x0 += member.x * member.score;
+            y0 += member.y * member.score;
+            x1 += (member.x + member.width) * member.score;
+            y1 += (member.y + member.height) * member.score;
+            for (int k = 0; k < top.keypointCount; ++k) {
+                keypoints[k][0] += member.keypoints[k][0] * member.score;
+                keypoints[k][1] += member.keypoints[k][1] * member.score;
+            }
+        }
+        if (weight > 0.0f) {
+            merged.x = x0 / weight;
+            merged.y = y0 / weight;
+            merged.width = (x1 - x0) / weight;
+            merged.height = (y1 - y0) / weight;
+            for (int k = 0; k < top.keypointCount; ++k) {
+                merged.keypoints[k][0] = keypoints[k][0] / weight;
+                merged.keypoints[k][1] = keypoints[k][1] / weight;
+            }
+        }
+        out.push_back(merged);
+        remained = std::move(rest);
+    }
+}
+
+std::vector<Detection> makeCandidates(int count) {
+    constexpr int kFaces = 4;
+    std::vector<Detection> candidates(count);
+    for (int i = 0; i < count; ++i) {
+        const uint32_t hash = static_cast<uint32_t>(i + 1) * 2654435761u;
+        const float jitter = static_cast<float>(hash % 1000) / 1000.0f - 0.5f;
+        const float jitter2 = static_cast<float>((hash >> 10) % 1000) / 1000.0f - 0.5f;
+        Detection& d = candidates[i];
+        if (i % 5 != 4) {
+            // Around one of the faces
+            const int face = i % kFaces;
+            const float size = 0.12f + 0.03f * face;
+            d.x = 0.1f + 0.22f * face + jitter * 0.02f;
+            d.y = 0.3f + jitter2 * 0.02f;
+            d.width = size * (1.0f + jitter * 0.1f);
+            d.height = size * (1.0f + jitter2 * 0.1f);
+            d.score = 0.6f + static_cast<float>((hash >> 20) % 400) / 1000.0f;
+        } else {
+            // Scattered noise
+            d.x = static_cast<float>((hash >> 4) % 900) / 1000.0f;
+            d.y = static_cast<float>((hash >> 14) % 900) / 1000.0f;
+            d.width = 0.02f + static_cast<float>((hash >> 7) % 50) / 1000.0f;
+            d.height = d.width;
+            d.score = 0.5f + static_cast<float>((hash >> 22) % 100) / 1000.0f;
+        }
+        d.keypointCount = 6;
+        for (int k = 0; k < 6; ++k) {
+            d.keypoints[k][0] = d.x + d.width * (0.2f + 0.12f * k);
+            d.keypoints[k][1] = d.y + d.height * (0.3f + 0.08f * k);
+        }
+    }
+    return candidates;
+}
+
+} // anonymous namespace
+
+int main() {
+    std::printf("%6s %6s %14s %14s %14s %9s %10s\n", "cands", "faces", "weighted (ns)", "hard (ns)",
+                "reference (ns)", "speedup", "max err");
+
+    for (const int count : {10, 100, 1000}) {
+        const int iterations = 2000000 / count;
+        const std::vector<Detection> candidates = makeCandidates(count);
+        std::vector<Detection> output(count);
+        std::vector<Detection> reference;
+
+        NonMaxSuppression::Options options;
+        NonMaxSuppression weighted(options);
+        options.mode = NonMaxSuppression::Mode::Hard;
+        NonMaxSuppression hard(options);
+
+        int faces = 0;
+        const double weightedNs = Bench::measureNs(iterations, [&] {
+            faces = weighted.run(candidates.data(), count, output.data(), count);
+            Bench::doNotOptimize(faces);
+        });
+        const double hardNs = Bench::measureNs(iterations, [&] {
+            const int kept = hard.run(candidates.data(), count, output.data(), count);
+            Bench::doNotOptimize(kept);
+        });
+        const double referenceNs = Bench::measureNs(iterations, [&] {
+            weightedReference(candidates, options.iouThreshold, reference);
+            Bench::doNotOptimize(reference.data());
+        });
+
+        faces = weighted.run(candidates.data(), count, output.data(), count);
+        float maxError = 0.0f;
+        for (int f = 0; f < std::min<int>(faces, static_cast<int>(reference.size())); ++f) {
+            maxError = std::max({maxError, std::abs(output[f].x - reference[f].x),
+                                 std::abs(output[f].height - reference[f].height),
+                                 std::abs(output[f].keypoints[5][1] - reference[f].keypoints[5][1])});
+        }
+
+        std::printf("%6d %6d %14.0f %14.0f %14.0f %8.2fx %10.1e%s\n", count, faces, weightedNs, hardNs, referenceNs,
+                    referenceNs / weightedNs, maxError,
+                    faces == static_cast<int>(reference.size()) ? "" : "  COUNT MISMATCH");
+    }
+    return 0;
+}
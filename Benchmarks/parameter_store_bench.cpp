@@ -0,0 +1,130 @@
+//
+//  parameter_store_bench.cpp
+//  AnonCam
+//
+//  Cost of reading the render settings on the frame path while another
+//  thread changes them: ParameterStore snapshots against the same struct
+//  behind a mutex. The writer publishes either continuously (worst case)
+//  or at 120 Hz (a slider being dragged). Reports read latency and, for
+//  the store, how many replaced snapshots were reclaimed and how many were
+//  still pending at the end.
+//
+
+#include "BenchUtil.h"
+#include "ParameterStore.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace AnonCam;
+
+namespace {
+
+constexpr int kReads = 2000000;
+
+struct Latency {
+    double meanNs = 0.0;
+    double p99Ns = 0.0;
+    double maxNs = 0.0;
+};
+
+template <typename Read>
+Latency measureReads(Read&& read) {
+    std::vector<double> samples(kReads);
+    for (int i = 0; i < kReads; ++i) {
+        const auto begin = std::chrono::steady_clock::now();
+        read();
+        samples[i] = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - begin).count();
+    }
+    Latency latency;
+    for (const double sample : samples) {
+        latency.meanNs += sample;
+    }
+    latency.meanNs /= kReads;
+    std::sort(samples.begin(), samples.end());
+    latency.p99Ns = samples[kReads * 99 / 100];
+    latency.maxNs = samples.back();
+    return latency;
+}
+
+// Runs edit() on its own thread, continuously or every intervalUs, while measure() runs
+template <typename Edit, typename Measure>
+Latency withWriter(int intervalUs, Edit&& edit, Measure&& measure) {
+    std::atomic<bool> running{true};
+    std::thread writer([&] {
+        int step = 0;
+        while (running.load(std::memory_order_relaxed)) {
+            edit(step++);
+            if (intervalUs > 0) {
+                std::this_thread::sleep_for(std::chrono::microseconds(intervalUs));
+            }
+        }
+    });
+    const Latency latency = measure();
+    running = false;
+    writer.join();
+    return latency;
+}
+
+void print(const char* label, const Latency& latency) {
+    std::printf("%-28s %12.1f %12.0f %12.0f\n", label, latency.meanNs, latency.p99Ns, latency.maxNs);
+}
+
+} // anonymous namespace
+
+int main() {
+    std::printf("%-28s %12s %12s %12s\n", "read", "mean (ns)", "p99 (ns)", "max (ns)");
+
+    for (const int intervalUs : {0, 8333}) {
+        const char* rate = intervalUs == 0 ? "continuous" : "120 Hz";
+
+        ParameterStore store;
+        const Latency storeLatency = withWriter(
+            intervalUs,
+            [&](int step) {
+                store.update([step](RenderParameters& parameters) {
+                    parameters.maskScale = 1.0f + 0.01f * (step % 100);
+                    parameters.maskColor[0] = parameters.maskScale * 0.1f;
+                });
+            },
+            [&] {
+                return measureReads([&] {
+                    const ParameterStore::ReadGuard parameters = store.read();
+                    Bench::doNotOptimize(parameters->maskScale + parameters->maskColor[0]);
+                });
+            });
+
+        std::mutex mutex;
+        RenderParameters shared;
+        const Latency mutexLatency = withWriter(
+            intervalUs,
+            [&](int step) {
+                std::lock_guard<std::mutex> lock(mutex);
+                shared.maskScale = 1.0f + 0.01f * (step % 100);
+                shared.maskColor[0] = shared.maskScale * 0.1f;
+            },
+            [&] {
+                return measureReads([&] {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    Bench::doNotOptimize(shared.maskScale + shared.maskColor[0]);
+                });
+            });
+
+        char label[64];
+        std::snprintf(label, sizeof(label), "snapshot, %s", rate);
+        print(label, storeLatency);
+        std::snprintf(label, sizeof(label), "mutex, %s", rate);
+        print(label, mutexLatency);
+
+        const ParameterStore::Stats stats = store.stats();
+        std::printf("  %llu published, %llu reclaimed, %zu pending\n",
+                    static_cast<unsigned long long>(stats.published),
+                    static_cast<unsigned long long>(stats.reclaimed), stats.pending);
+    }
+    return 0;
+}
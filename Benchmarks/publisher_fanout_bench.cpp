@@ -0,0 +1,112 @@
+//
+//  publisher_fanout_bench.cpp
+//  AnonCam
+//
+//  Cost of LandmarkPublisher::publish() on the frame thread as the number
+//  of subscribers grows. A reader thread drains all subscribers with poll().
+//
+
+#include "BenchUtil.h"
+#include "LandmarkStream.h"
+
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <memory>
+#include <poll.h>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+using namespace AnonCam;
+
+namespace {
+
+FaceResult makeResult(int frame) {
+    FaceResult result;
+    result.hasFace = true;
+    result.confidence = 0.95f;
+    result.timestampNs = frame * 33'333'333LL;
+    result.landmarks.resize(478);
+    for (size_t i = 0; i < result.landmarks.size(); ++i) {
+        const float angle = static_cast<float>(i) * 0.37f;
+        result.landmarks[i] = {0.5f + 0.1f * std::cos(angle) + 0.0005f * frame,
+                               0.5f + 0.1f * std::sin(angle), 0.0f};
+    }
+    return result;
+}
+
+} // anonymous namespace
+
+int main() {
+    const std::string path = "/tmp/anoncam_fanout_bench.sock";
+    constexpr int kFrames = 2000;
+
+    std::vector<FaceResult> results;
+    for (int f = 0; f < 30; ++f) {
+        results.push_back(makeResult(f));
+    }
+
+    std::printf("%-12s %12s %12s %10s\n", "subscribers", "publish ns", "per client", "dropped");
+
+    for (int subscribers : {1, 8, 32, 128}) {
+        LandmarkPublisher publisher;
+        LandmarkPublisher::Options options;
+        options.maxClients = subscribers;
+        if (!publisher.start(path, options)) {
+            std::printf("failed to listen on %s\n", path.c_str());
+            return 1;
+        }
+
+        std::vector<std::unique_ptr<LandmarkSubscriber>> clients;
+        for (int i = 0; i < subscribers; ++i) {
+            clients.push_back(std::make_unique<LandmarkSubscriber>());
+            clients.back()->connect(path);
+        }
+        while (publisher.clientCount() < subscribers) {
+            publisher.publish(results[0]);
+        }
+
+        // Drain raw bytes; decoding cost belongs to the subscribers, not the publisher
+        std::atomic<bool> running{true};
+        std::thread reader([&] {
+            std::vector<pollfd> fds;
+            for (auto& client : clients) {
+                fds.push_back({client->fileDescriptor(), POLLIN, 0});
+            }
+            std::vector<uint8_t> sink(256 * 1024);
+            while (running.load(std::memory_order_relaxed)) {
+                if (::poll(fds.data(), fds.size(), 10) <= 0) {
+                    continue;
+                }
+                for (auto& pfd : fds) {
+                    if (pfd.revents & POLLIN) {
+                        Bench::doNotOptimize(::recv(pfd.fd, sink.data(), sink.size(), 0));
+                    }
+                }
+            }
+        });
+
+        // Only the publish() call is timed; the pause between frames lets the
+        // reader keep up, like a camera would
+        double totalNs = 0.0;
+        for (int frame = 0; frame < kFrames; ++frame) {
+            const auto begin = std::chrono::steady_clock::now();
+            publisher.publish(results[frame % results.size()]);
+            totalNs += std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - begin).count();
+            std::this_thread::sleep_for(std::chrono::microseconds(200));
+        }
+        const double ns = totalNs / kFrames;
+
+        running = false;
+        reader.join();
+
+        const auto stats = publisher.stats();
+        std::printf("%-12d %10.0fns %10.0fns %10llu\n", subscribers, ns, ns / subscribers,
+                    static_cast<unsigned long long>(stats.messagesDropped));
+        publisher.stop();
+    }
+    return 0;
+}
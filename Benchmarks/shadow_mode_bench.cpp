@@ -0,0 +1,111 @@
+//
+//  shadow_mode_bench.cpp
+//  AnonCam
+//
+//  Live-path cost of shadow evaluation: a 720p NV12 stream paced at 30 fps
+//  through the default tracker, without a shadow and with a heavier
+//  candidate (denoising + segmentation) sampled at 10%, 50% and every
+//  frame. Reports the live per-frame latency, how many sampled frames the
+//  candidate evaluated or dropped, and the candidate's own latency.
+//
+
+#include "BenchUtil.h"
+#include "FaceTracker.h"
+#include "ShadowEvaluator.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <memory>
+#include <thread>
+#include <vector>
+
+using namespace AnonCam;
+
+namespace {
+
+constexpr int kWidth = 1280;
+constexpr int kHeight = 720;
+constexpr int kFrames = 150;
+constexpr auto kFrameInterval = std::chrono::microseconds(33333);
+
+// Bright textured disc drifting over a dark background
+void drawFrame(std::vector<uint8_t>& pixels, int index) {
+    const float centerX = kWidth / 2.0f + 60.0f * std::sin(index * 0.1f);
+    const float centerY = kHeight / 2.0f;
+    for (int y = 0; y < kHeight; ++y) {
+        for (int x = 0; x < kWidth; ++x) {
+            const float dx = x - centerX;
+            const float dy = y - centerY;
+            const bool face = dx * dx + dy * dy < 180.0f * 180.0f;
+            pixels[static_cast<size_t>(y) * kWidth + x] =
+                face ? static_cast<uint8_t>(150.0f + 40.0f * std::sin(x * 0.2f) * std::cos(y * 0.2f)) : 40;
+        }
+    }
+    std::fill(pixels.begin() + static_cast<size_t>(kWidth) * kHeight, pixels.end(), 128);
+}
+
+} // anonymous namespace
+
+int main() {
+    std::vector<uint8_t> pixels(static_cast<size_t>(kWidth) * kHeight * 3 / 2);
+    ImageView frame;
+    frame.format = PixelFormat::NV12;
+    frame.width = kWidth;
+    frame.height = kHeight;
+    frame.planes[0] = pixels.data();
+    frame.planes[1] = pixels.data() + static_cast<size_t>(kWidth) * kHeight;
+    frame.bytesPerRow[0] = kWidth;
+    frame.bytesPerRow[1] = kWidth;
+
+    FaceTracker::Config candidate;
+    candidate.enableDenoising = true;
+    candidate.enableSegmentation = true;
+
+    std::printf("%-10s %14s %14s %10s %9s %16s\n", "shadow", "live mean (us)", "live p95 (us)", "evaluated", "dropped",
+                "candidate (us)");
+    for (const float rate : {0.0f, 0.1f, 0.5f, 1.0f}) {
+        FaceTracker live;
+        std::shared_ptr<ShadowEvaluator> shadow;
+        if (rate > 0.0f) {
+            ShadowEvaluator::Options options;
+            options.sampleRate = rate;
+            shadow = std::make_shared<ShadowEvaluator>(candidate, options);
+            live.startShadow(shadow);
+        }
+
+        std::vector<double> latencyUs;
+        auto next = std::chrono::steady_clock::now();
+        for (int i = 0; i < kFrames; ++i) {
+            drawFrame(pixels, i);
+            const auto begin = std::chrono::steady_clock::now();
+            const FaceResult result = live.processFrame(frame, i * 33333333LL);
+            latencyUs.push_back(std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - begin)
+                                    .count());
+            Bench::doNotOptimize(result.hasFace);
+            next += kFrameInterval;
+            std::this_thread::sleep_until(next);
+        }
+        live.stopShadow();
+
+        double mean = 0.0;
+        for (const double us : latencyUs) {
+            mean += us / latencyUs.size();
+        }
+        std::sort(latencyUs.begin(), latencyUs.end());
+        const double p95 = latencyUs[latencyUs.size() * 95 / 100];
+
+        char label[16];
+        std::snprintf(label, sizeof(label), rate > 0.0f ? "%.0f%%" : "off", rate * 100.0f);
+        if (!shadow) {
+            std::printf("%-10s %14.0f %14.0f %10s %9s %16s\n", label, mean, p95, "-", "-", "-");
+            continue;
+        }
+        const ShadowEvaluator::Stats stats = shadow->stats();
+        std::printf("%-10s %14.0f %14.0f %10llu %9llu %16.0f\n", label, mean, p95,
+                    static_cast<unsigned long long>(stats.evaluated), static_cast<unsigned long long>(stats.dropped),
+                    stats.candidate.meanUs);
+    }
+    return 0;
+}
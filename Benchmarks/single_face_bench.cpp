@@ -0,0 +1,136 @@
+//
+//  single_face_bench.cpp
+//  AnonCam
+//
+//  Per-inference cost of turning BlazeFace tensors into one face
+//  (maxFaces = 1): the general pipeline (decode every survivor into a
+//  candidate buffer, then NonMaxSuppression) against the single-face
+//  specialization (one pass listing the anchors above the threshold, the
+//  best of those, one sweep for its cluster; no candidate buffer, no NMS),
+//  both through DetectionPipeline as create() hands them out. One face
+//  covered by a cluster of anchors, plus 0 / 1 / 10% of the remaining
+//  anchors as scattered low-score noise. Reports the largest difference
+//  between the two results.
+//
+
+#include "BenchUtil.h"
+#include "DetectionPipeline.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+using namespace AnonCam;
+
+namespace {
+
+constexpr int kIterations = 20000;
+constexpr int kValuesPerAnchor = 16;
+constexpr float kFaceX = 0.5f;
+constexpr float kFaceY = 0.45f;
+constexpr float kFaceSize = 0.3f;
+
+struct Tensors {
+    std::vector<float> boxes;
+    std::vector<float> logits;
+};
+
+template <const SsdAnchorSpec& Spec>
+Tensors makeTensors(float noise) {
+    constexpr auto& anchors = kSsdAnchors<Spec>;
+    Tensors tensors;
+    tensors.boxes.resize(static_cast<size_t>(anchors.kCount) * kValuesPerAnchor);
+    tensors.logits.resize(anchors.kCount);
+    for (int i = 0; i < anchors.kCount; ++i) {
+        const uint32_t hash = static_cast<uint32_t>(i) * 2654435761u;
+        const float jitter = static_cast<float>(hash % 1000) / 1000.0f - 0.5f;
+        const float dx = kFaceX - anchors.x[i];
+        const float dy = kFaceY - anchors.y[i];
+        const float distance = std::sqrt(dx * dx + dy * dy);
+        float* raw = tensors.boxes.data() + static_cast<size_t>(i) * kValuesPerAnchor;
+
+        // Anchors near the face regress onto it; the rest onto small boxes of their own
+        const bool face = distance < 0.08f;
+        const float size = face ? kFaceSize * (1.0f + 0.05f * jitter) : 0.05f;
+        const float centerX = face ? dx + 0.01f * jitter : 0.0f;
+        const float centerY = face ? dy - 0.01f * jitter : 0.0f;
+        raw[0] = centerX * Spec.inputWidth;
+        raw[1] = centerY * Spec.inputHeight;
+        raw[2] = size * Spec.inputWidth;
+        raw[3] = size * Spec.inputHeight;
+        for (int k = 0; k < 6; ++k) {
+            raw[4 + k * 2] = (centerX + size * (0.12f * k - 0.3f)) * Spec.inputWidth;
+            raw[5 + k * 2] = (centerY + size * (0.08f * k - 0.2f)) * Spec.inputHeight;
+        }
+
+        if (face) {
+            tensors.logits[i] = 4.0f - distance * 40.0f + jitter;
+        } else if ((hash >> 12) % 10000 < noise * 10000) {
+            tensors.logits[i] = 0.2f + (hash % 89) * 0.02f;
+        } else {
+            tensors.logits[i] = -6.0f + (hash % 89) * 0.05f;
+        }
+    }
+    return tensors;
+}
+
+float difference(const Detection& a, const Detection& b) {
+    float error = std::max({std::abs(a.x - b.x), std::abs(a.y - b.y), std::abs(a.width - b.width),
+                            std::abs(a.height - b.height), std::abs(a.score - b.score)});
+    for (int k = 0; k < Detection::kMaxKeypoints; ++k) {
+        error = std::max({error, std::abs(a.keypoints[k][0] - b.keypoints[k][0]),
+                          std::abs(a.keypoints[k][1] - b.keypoints[k][1])});
+    }
+    return error;
+}
+
+template <const SsdAnchorSpec& Spec>
+void run(const char* name) {
+    for (const NonMaxSuppression::Mode mode : {NonMaxSuppression::Mode::Weighted, NonMaxSuppression::Mode::Hard}) {
+        for (const float noise : {0.0f, 0.01f, 0.1f}) {
+            const Tensors tensors = makeTensors<Spec>(noise);
+
+            DetectionPipeline::Options options;
+            options.suppression.mode = mode;
+            options.maxFaces = 1;
+            const auto single = DetectionPipeline::forSpec<Spec>(options);
+            const std::unique_ptr<DetectionPipeline> general = std::make_unique<SsdDetectionPipeline<kAnyFaceCount>>(
+                kSsdAnchors<Spec>.x.data(), kSsdAnchors<Spec>.y.data(), ssdAnchorCount(Spec), Spec.inputWidth,
+                Spec.inputHeight, options);
+
+            Detection generalFace;
+            Detection singleFace;
+            int generalCount = 0;
+            int singleCount = 0;
+            const double generalNs = Bench::measureNs(kIterations, [&] {
+                generalCount = general->run(tensors.boxes.data(), tensors.logits.data(), &generalFace);
+                Bench::doNotOptimize(generalCount);
+            });
+            const double singleNs = Bench::measureNs(kIterations, [&] {
+                singleCount = single->run(tensors.boxes.data(), tensors.logits.data(), &singleFace);
+                Bench::doNotOptimize(singleCount);
+            });
+
+            int survivors = 0;
+            for (const float logit : tensors.logits) {
+                survivors += logit >= 0.0f ? 1 : 0;
+            }
+            std::printf("%-12s %-9s %5.0f%% %6d %13.0f %13.0f %12.0f %8.2fx %10.1e%s\n", name,
+                        mode == NonMaxSuppression::Mode::Weighted ? "weighted" : "hard", noise * 100.0f, survivors,
+                        generalNs, singleNs, generalNs - singleNs, generalNs / singleNs,
+                        difference(generalFace, singleFace),
+                        generalCount == singleCount ? "" : "  COUNT MISMATCH");
+        }
+    }
+}
+
+} // anonymous namespace
+
+int main() {
+    std::printf("%-12s %-9s %6s %6s %13s %13s %12s %9s %10s\n", "spec", "mode", "noise", "cands",
+                "general (ns)", "single (ns)", "saved (ns)", "speedup", "max diff");
+    run<kBlazeFaceShortRange>("short-range");
+    run<kBlazeFaceFullRange>("full-range");
+    return 0;
+}
@@ -0,0 +1,75 @@
+#ifndef AnonCam_BufferPool_h
+#define AnonCam_BufferPool_h
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace AnonCam {
+
+// A 64-byte aligned byte buffer owned by a BufferPool
+class PooledBuffer {
+public:
+    explicit PooledBuffer(size_t size);
+    ~PooledBuffer();
+
+    PooledBuffer(const PooledBuffer&) = delete;
+    PooledBuffer& operator=(const PooledBuffer&) = delete;
+
+    uint8_t* data() { return data_; }
+    const uint8_t* data() const { return data_; }
+    size_t size() const { return size_; }
+
+private:
+    uint8_t* data_;
+    size_t size_;
+};
+
+/**
+ * BufferPool - recycles fixed-size buffers for per-frame outputs
+ *
+ * acquire() hands out a buffer whose last reference (e.g. a FaceResult
+ * handed to the app) returns it to the pool's free list, under the pool's
+ * lock: everything its holders did with it happens before the next
+ * acquire() that reuses it. The shared_ptr control blocks are recycled the
+ * same way, so acquire() never allocates after warm-up. Buffers may outlive
+ * the pool; they are freed when released.
+ *
+ * Thread-safe.
+ */
+class BufferPool {
+public:
+    /**
+     * @param bufferSize Size of every buffer in bytes
+     * @param maxBuffers Upper bound on buffers alive at once
+     */
+    BufferPool(size_t bufferSize, size_t maxBuffers);
+
+    BufferPool(const BufferPool&) = delete;
+    BufferPool& operator=(const BufferPool&) = delete;
+
+    /**
+     * Get a free buffer (contents undefined)
+     * @return nullptr if maxBuffers are all in use
+     */
+    std::shared_ptr<PooledBuffer> acquire();
+
+    size_t bufferSize() const;
+
+    // Buffers created so far (in use or free)
+    size_t allocatedCount() const;
+
+private:
+    struct State;
+    struct Recycler;
+    template <typename T>
+    struct BlockAllocator;
+
+    std::shared_ptr<State> state_;  // Shared with every buffer handed out
+};
+
+} // namespace AnonCam
+
+#endif /* AnonCam_BufferPool_h */
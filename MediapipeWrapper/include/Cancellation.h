@@ -0,0 +1,60 @@
+#ifndef AnonCam_Cancellation_h
+#define AnonCam_Cancellation_h
+
+#include <atomic>
+#include <cstdint>
+
+namespace AnonCam {
+
+class CancellationSource;
+
+/**
+ * CancellationToken - lets long-running work notice that it is no longer wanted
+ *
+ * Work checks isCancelled() between units of bounded cost (a detector work
+ * item, a band of rows, a landmark region) and returns early once it is
+ * set, so whoever cancelled waits at most one unit. Checking is one relaxed
+ * atomic load. A default-constructed token is never cancelled.
+ *
+ * Trivially copyable; must not outlive its CancellationSource.
+ */
+class CancellationToken {
+public:
+    CancellationToken() = default;
+
+    bool isCancelled() const {
+        return generation_ && generation_->load(std::memory_order_relaxed) != issued_;
+    }
+
+private:
+    friend class CancellationSource;
+    CancellationToken(const std::atomic<uint64_t>* generation, uint64_t issued)
+        : generation_(generation), issued_(issued) {}
+
+    const std::atomic<uint64_t>* generation_ = nullptr;
+    uint64_t issued_ = 0;
+};
+
+/**
+ * CancellationSource - issues tokens and cancels every token issued so far
+ *
+ * Tokens taken after cancel() are live again, so one source serves every
+ * frame of a stream: each frame takes a token, and reset() cancels the one
+ * in flight without affecting the next. Nothing is allocated per token.
+ * Thread-safe.
+ */
+class CancellationSource {
+public:
+    CancellationToken token() const {
+        return CancellationToken(&generation_, generation_.load(std::memory_order_relaxed));
+    }
+
+    void cancel() { generation_.fetch_add(1, std::memory_order_relaxed); }
+
+private:
+    std::atomic<uint64_t> generation_{0};
+};
+
+} // namespace AnonCam
+
+#endif /* AnonCam_Cancellation_h */
@@ -0,0 +1,269 @@
+#ifndef AnonCam_CaptureFile_h
+#define AnonCam_CaptureFile_h
+
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "FaceTracker.h"
+#include "ImageView.h"
+
+namespace AnonCam {
+
+// ============================================================================
+// On-disk layout (little-endian, every section 8-byte aligned)
+// ============================================================================
+//
+//   CaptureFileHeader
+//   record 0 .. N-1:
+//       CaptureRecordHeader
+//       Landmark[landmarkCount]                         (or uint16_t[landmarkCount * 3]
+//                                                        with kCaptureFlagQuantizedLandmarks)
+//       uint8_t frame[frameHeight * frameBytesPerRow]   (optional, padded to 8)
+//   uint64_t recordOffsets[N]                          (index, at header.indexOffset)
+//
+// The header is rewritten on close() with the record count and index offset,
+// so a capture that was not closed cleanly is rejected by the reader.
+
+constexpr uint32_t kCaptureMagic = 0x524D4341;  // "ACMR" - AnonCam Recording
+constexpr uint16_t kCaptureVersion = 2;
+
+// Landmarks stored as 16-bit fixed point (see LandmarkCodec.h). Every record
+// is self-contained so random access still works.
+constexpr uint32_t kCaptureFlagQuantizedLandmarks = 1u << 0;
+
+struct CaptureFileHeader {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t headerSize;
+    uint32_t flags;
+    uint32_t frameDownscale;   // Divisor applied to stored frames (0 = frames not stored)
+    uint64_t recordCount;
+    uint64_t indexOffset;
+    int64_t firstTimestampNs;
+    uint64_t reserved[2];
+};
+static_assert(sizeof(CaptureFileHeader) % 8 == 0, "CaptureFileHeader must keep 8-byte alignment");
+
+struct CaptureRecordHeader {
+    int64_t timestampNs;
+    uint32_t frameWidth;       // 0 when no frame is stored for this record
+    uint32_t frameHeight;
+    uint32_t frameBytesPerRow;
+    uint32_t landmarkCount;
+    uint32_t landmarkBytes;    // Size of the landmark payload before padding
+    uint32_t reserved;
+    uint32_t hasFace;
+    float confidence;
+    HeadPose pose;
+    FaceResult::KeyPoints keyPoints;
+};
+static_assert(sizeof(CaptureRecordHeader) % 8 == 0, "CaptureRecordHeader must keep 8-byte alignment");
+
+/**
+ * CaptureWriter - appends frame timestamps, optional downscaled luma frames
+ * and the FaceResult stream to a capture file
+ *
+ * Not thread-safe; append() is expected to be called from the frame path.
+ * The scratch buffer for downscaled frames is reused across appends.
+ */
+class CaptureWriter {
+public:
+    struct Options {
+        // Store the luma plane of every frame, box-downscaled by this divisor.
+        // 0 records results only.
+        int frameDownscale = 4;
+        // Store landmarks as 16-bit fixed point (half the size, ~3e-5 error)
+        bool quantizeLandmarks = false;
+    };
+
+    CaptureWriter() = default;
+    ~CaptureWriter();
+
+    CaptureWriter(const CaptureWriter&) = delete;
+    CaptureWriter& operator=(const CaptureWriter&) = delete;
+
+    /**
+     * Create (or truncate) a capture file
+     * @return false if the file could not be created
+     */
+    bool open(const std::string& path);
+    bool open(const std::string& path, const Options& options);
+
+    /**
+     * Append one record
+     * @param frame Source frame, or nullptr to record only the result
+     * @return false on I/O error (the writer is closed in that case)
+     */
+    bool append(int64_t timestampNs, const ImageView* frame, const FaceResult& result);
+
+    /**
+     * Append one record whose frame was already reduced with downscaleLuma()
+     * @param frame Gray8 frame at 1 / Options::frameDownscale, or nullptr
+     * @return false on I/O error (the writer is closed in that case)
+     */
+    bool appendDownscaled(int64_t timestampNs, const ImageView* frame, const FaceResult& result);
+
+    /**
+     * Box-downscale the luma of a Gray8, NV12 or BGRA frame by divisor
+     * @param out Receives rows of alignUp(outWidth, 8) bytes; keeps its capacity
+     */
+    static void downscaleLuma(const ImageView& frame, int divisor, std::vector<uint8_t>& out,
+                              int& outWidth, int& outHeight);
+
+    /**
+     * Write the index and finalize the header
+     */
+    bool close();
+
+    bool isOpen() const { return file_ != nullptr; }
+    uint64_t recordCount() const { return offsets_.size(); }
+
+private:
+    bool write(const void* data, size_t size);
+
+    std::FILE* file_ = nullptr;
+    Options options_;
+    uint64_t position_ = 0;
+    int64_t firstTimestampNs_ = 0;
+    std::vector<uint64_t> offsets_;
+    std::vector<uint8_t> frameScratch_;
+    std::vector<uint16_t> landmarkScratch_;
+    std::vector<Landmark> widenedScratch_;
+};
+
+/**
+ * CaptureRecorder - CaptureWriter with the file I/O on its own thread
+ *
+ * append() runs on the frame path: it downscales the frame and copies the
+ * result into a free queue slot, and a writer thread writes the slots out
+ * in order. When the writer falls behind and every slot is queued, the
+ * record is dropped and counted rather than waited for. Slots are
+ * allocated by open() and keep their buffers, so appends do not allocate
+ * once every slot has been used.
+ *
+ * append() from one thread at a time; open() and close() not concurrently
+ * with it.
+ */
+class CaptureRecorder {
+public:
+    struct Options {
+        CaptureWriter::Options writer;
+        int queueCapacity = 8;          // Records waiting for the writer thread
+    };
+
+    struct Stats {
+        uint64_t written = 0;
+        uint64_t dropped = 0;           // Queue full: the writer fell behind
+        bool failed = false;            // I/O error; later records are dropped
+    };
+
+    CaptureRecorder() = default;
+    ~CaptureRecorder();
+
+    CaptureRecorder(const CaptureRecorder&) = delete;
+    CaptureRecorder& operator=(const CaptureRecorder&) = delete;
+
+    /**
+     * Create (or truncate) a capture file and start the writer thread
+     * @return false if the file could not be created
+     */
+    bool open(const std::string& path, const Options& options);
+
+    /**
+     * Queue one record without waiting for the disk
+     * @param frame Source frame, or nullptr to record only the result
+     * @return false if the record was dropped
+     */
+    bool append(int64_t timestampNs, const ImageView* frame, const FaceResult& result);
+
+    /**
+     * Write out the queued records, then the index
+     * @return false if any write failed
+     */
+    bool close();
+
+    bool isOpen() const { return thread_.joinable(); }
+    Stats stats() const;
+
+private:
+    struct Slot {
+        int64_t timestampNs = 0;
+        int frameWidth = 0;             // 0 when no frame is stored
+        int frameHeight = 0;
+        std::vector<uint8_t> frame;
+        FaceResult result;              // Recorded fields only
+    };
+
+    void writerLoop();
+
+    CaptureWriter writer_;
+    int frameDownscale_ = 0;
+    std::vector<Slot> slots_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable wake_;
+    std::vector<int> free_;
+    std::vector<int> queued_;           // Ring of slot indices, oldest at queuedHead_
+    size_t queuedHead_ = 0;
+    size_t queuedCount_ = 0;
+    bool stopping_ = false;
+    Stats stats_;
+    std::thread thread_;
+};
+
+// A decoded record. `frame` points into the reader's mapping.
+struct CaptureRecord {
+    int64_t timestampNs = 0;
+    ImageView frame;      // Gray8; isValid() is false if no frame was stored
+    FaceResult result;
+};
+
+/**
+ * CaptureReader - memory-maps a capture file for random access
+ *
+ * read() may be called concurrently; the mapping stays valid until close().
+ */
+class CaptureReader {
+public:
+    CaptureReader() = default;
+    ~CaptureReader();
+
+    CaptureReader(const CaptureReader&) = delete;
+    CaptureReader& operator=(const CaptureReader&) = delete;
+
+    /**
+     * Map and validate a capture file
+     * @return false if the file is missing, truncated or not a capture
+     */
+    bool open(const std::string& path);
+    void close();
+
+    bool isOpen() const { return base_ != nullptr; }
+    size_t recordCount() const { return recordCount_; }
+    int frameDownscale() const { return frameDownscale_; }
+    // False for a results-only capture (frameDownscale 0): nothing to replay
+    bool hasFrames() const { return frameDownscale_ > 0; }
+
+    /**
+     * Decode a record. Landmarks are copied into record.result (reusing its
+     * capacity); the frame view aliases the mapping.
+     */
+    bool read(size_t index, CaptureRecord& record) const;
+
+private:
+    const uint8_t* base_ = nullptr;
+    size_t size_ = 0;
+    size_t recordCount_ = 0;
+    int frameDownscale_ = 0;
+    bool quantizedLandmarks_ = false;
+    const uint64_t* offsets_ = nullptr;
+};
+
+} // namespace AnonCam
+
+#endif /* AnonCam_CaptureFile_h */
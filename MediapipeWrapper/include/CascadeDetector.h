@@ -0,0 +1,214 @@
+#ifndef AnonCam_CascadeDetector_h
+#define AnonCam_CascadeDetector_h
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "FaceDetector.h"
+
+namespace AnonCam {
+
+class WorkerPool;
+
+/**
+ * CascadeDetector - boosted Haar cascade over integral images
+ *
+ * CPU fallback for machines where the neural detector is unavailable or too
+ * slow. Loads a trained cascade in OpenCV's XML format (BOOST stages, HAAR
+ * features, e.g. haarcascade_frontalface_default.xml).
+ *
+ * The frame is box-downscaled to at most maxScanWidth, its integral and
+ * squared integral images are built once, and the window is scaled instead
+ * of the image. Every (scale, row band) pair is an independent work item on
+ * the optional WorkerPool; overlapping hits are then grouped into faces.
+ *
+ * Time-sliced mode (sliceBudgetUs > 0) bounds the cost of a call instead of
+ * scanning every item: each call resumes at the item where the previous one
+ * stopped and starts items while their last measured cost still fits the
+ * budget (at least one item per call). Hits are kept per item until the item
+ * is scanned again, so every call groups the latest hits of all items: a
+ * face is reported within one full cycle, its box at most one cycle old.
+ * Grouping reruns only when a rescanned item's hits differ.
+ *
+ * Loading optimizes the cascade once: trees whose leaves are all equal are
+ * folded into their stage threshold, stages that always pass are removed,
+ * duplicate and unused features are merged away, and each stage runs the
+ * kernel that suits it (single-split stumps evaluated inline, or the generic
+ * tree walk). load() keeps the result in "<path>.plan" and maps it on later
+ * loads of the same, unmodified file instead of parsing the XML again.
+ *
+ * Not thread-safe; scratch buffers are reused between frames.
+ */
+class CascadeDetector : public FaceDetector {
+public:
+    struct Options {
+        float scaleFactor = 1.1f;      // Window growth between scales
+        float minFaceSize = 0.1f;      // Smallest face, fraction of the frame height
+        float maxFaceSize = 1.0f;      // Largest face, fraction of the frame height
+        int maxScanWidth = 320;        // Frames are box-downscaled by an integer factor to at most this
+        int minNeighbors = 3;          // Overlapping hits needed to report a face
+        int tileRows = 24;             // Window rows per work item
+        int sliceBudgetUs = 0;         // > 0: time-sliced mode, scan budget per call
+        bool optimize = true;          // Optimize the cascade at load (false: evaluate it as written)
+        bool cachePlan = true;         // load(): reuse / write the loaded cascade as "<path>.plan"
+
+        bool operator==(const Options&) const = default;
+    };
+
+    struct Stats {
+        uint64_t calls = 0;
+        uint64_t cycles = 0;           // Completed passes over every work item
+        int itemCount = 0;             // Work items in a full pass
+        int lastItems = 0;             // Work items scanned by the last call
+        int64_t lastDetectNs = 0;
+        int64_t loadNs = 0;            // Last load, parsing and optimizing or mapping the plan
+        bool planCached = false;       // Last load() used the cached plan
+    };
+
+    CascadeDetector();
+    explicit CascadeDetector(const Options& options, WorkerPool* workers = nullptr);
+    ~CascadeDetector() override;
+
+    /**
+     * Load a cascade from an OpenCV cascade XML file, or from its cached plan
+     * when the plan was written for the file's current size and timestamp
+     * @return false if the file cannot be read or is not a BOOST/HAAR cascade
+     */
+    bool load(const std::string& path);
+
+    /**
+     * Load a cascade from OpenCV cascade XML held in memory
+     */
+    bool loadFromString(const std::string& xml);
+
+    bool isLoaded() const { return !stages_.empty(); }
+
+    // Detection score: hits / (hits + minNeighbors). Cancellation is checked
+    // per work item; a cancelled time-sliced call still keeps its progress.
+    bool detect(const ImageView& frame, std::vector<Detection>& detections,
+                const CancellationToken& cancel = {}) override;
+
+    bool isTimeSliced() const { return options_.sliceBudgetUs > 0; }
+
+    const Stats& stats() const { return stats_; }
+
+private:
+    struct Rect {
+        int x, y, width, height;
+        float weight;
+    };
+
+    struct Feature {
+        Rect rects[3];
+        int count;
+    };
+
+    struct Node {
+        int feature;
+        float threshold;
+        int left;                      // > 0: next node, <= 0: -leaf index
+        int right;
+    };
+
+    struct Tree {
+        int firstNode;
+        int firstLeaf;
+    };
+
+    // Single-split tree with its leaves inline
+    struct Stump {
+        int feature;
+        float threshold;
+        float left;
+        float right;
+    };
+
+    enum class StageKernel : int32_t {
+        Trees,                         // firstTree indexes trees_
+        Stumps,                        // firstTree indexes stumps_
+    };
+
+    struct Stage {
+        float threshold;
+        int firstTree;
+        int treeCount;
+        StageKernel kernel;
+    };
+
+    // Features resolved to integral image offsets for one window size
+    struct ScaledFeature {
+        int corners[3][4];             // Offsets of the four rectangle corners
+        float weights[3];
+        int count;
+    };
+
+    struct Scale {
+        int windowWidth;
+        int windowHeight;
+        int step;
+        int normCorners[4];            // Variance window (the detection window minus a border)
+        float inverseNormArea;
+        std::vector<ScaledFeature> features;
+    };
+
+    struct Hit {
+        int x, y, width, height;
+
+        bool operator==(const Hit&) const = default;
+    };
+
+    void optimizeCascade();
+    bool loadPlan(const std::string& path, uint64_t sourceSize, int64_t sourceTime);
+    bool savePlan(const std::string& path, uint64_t sourceSize, int64_t sourceTime) const;
+    bool cascadeValid() const;
+    void prepareScan(const ImageView& frame);
+    void buildScales();
+    void scanBand(const Scale& scale, int rowBegin, int rowEnd, std::vector<Hit>& hits) const;
+    int scanItems(int first, int count, int64_t deadlineNs, const CancellationToken& cancel, bool& hitsChanged);
+    bool evaluate(const Scale& scale, int offset) const;
+    void groupHits(std::vector<Detection>& detections);
+
+    Options options_;
+    WorkerPool* workers_;
+
+    // Cascade
+    int windowWidth_ = 0;
+    int windowHeight_ = 0;
+    std::vector<Feature> features_;
+    std::vector<Node> nodes_;
+    std::vector<float> leaves_;
+    std::vector<Tree> trees_;
+    std::vector<Stump> stumps_;
+    std::vector<Stage> stages_;
+
+    // Per-frame scan state
+    int frameWidth_ = 0;
+    int frameHeight_ = 0;
+    int downscale_ = 1;
+    int scanWidth_ = 0;
+    int scanHeight_ = 0;
+    std::vector<uint8_t> scan_;        // Downscaled luma
+    std::vector<uint32_t> rowAccumulator_;
+    std::vector<uint32_t> sum_;        // Integral image, (scanWidth_ + 1) x (scanHeight_ + 1)
+    std::vector<uint64_t> squareSum_;
+    std::vector<Scale> scales_;        // Rebuilt when the scan size changes
+    std::vector<std::pair<int, int>> items_;   // (scale, first row) per work item
+    std::vector<std::vector<Hit>> itemHits_;   // Latest hits of every item
+    std::vector<std::vector<Hit>> previousHits_;   // Scratch: an item's hits before its rescan
+    std::vector<uint8_t> itemSkipped_; // Time-sliced: not started this call
+    std::vector<int64_t> itemCostNs_;  // Time-sliced: cost of each item's last scan
+    int nextItem_ = 0;                 // Time-sliced: where the next call resumes
+    int64_t groupNs_ = 0;              // Cost of the last grouping
+    std::vector<Detection> faces_;     // Grouped hits; regrouped only when hits change
+    bool regroup_ = true;
+    std::vector<Hit> hits_;
+    std::vector<int> labels_;
+
+    Stats stats_;
+};
+
+} // namespace AnonCam
+
+#endif /* AnonCam_CascadeDetector_h */
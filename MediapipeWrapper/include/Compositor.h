@@ -0,0 +1,124 @@
+#ifndef AnonCam_Compositor_h
+#define AnonCam_Compositor_h
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "ImageView.h"
+#include "TrackLossPolicy.h"
+
+namespace AnonCam {
+
+struct SegmentationMask;
+
+/**
+ * Compositor - CPU background blur/replacement and face anonymization
+ *
+ * One pass reduces the frame to quarter resolution; the background blur
+ * and the pixelation blocks are both computed there. A second, fused pass
+ * reads each source row once and writes the output:
+ *
+ *   out = lerp(lerp(background, source, foreground alpha), face, face alpha)
+ *
+ * where `background` is the upsampled blurred frame, a replacement image or
+ * the source itself, and `face` is the anonymized rendition of the face.
+ *
+ * Given the tracker's anonymization (FaceResult::anonymization), a held
+ * region is anonymized like the face while the track is lost (so is the
+ * tracked face's region when there is no face mask), and a
+ * full-frame fallback outputs the upsampled blurred frame alone: the cost
+ * of the blur path, whatever the face mode.
+ *
+ * The background treatment needs a person mask (Layers::foreground) from
+ * outside the tracker: FaceResult::segmentationMask covers the face only, so
+ * passing it as the foreground blurs or replaces everything but the face.
+ * Without a foreground the background is kept and backgroundDropped() says so.
+ *
+ * BGRA in, BGRA out (dst may equal the source). Not thread-safe; scratch
+ * buffers are reused between frames of the same size.
+ */
+class Compositor {
+public:
+    enum class BackgroundMode {
+        Keep,       // Background untouched
+        Blur,       // Downsample-blur-upsample at quarter resolution
+        Replace,    // Layers::replacement
+    };
+
+    enum class FaceMode {
+        Keep,
+        Pixelate,   // Blocks of pixelBlockSize
+        Blur,       // Same blur as the background
+        Fill,       // Solid fillColor
+    };
+
+    struct Options {
+        BackgroundMode background = BackgroundMode::Blur;
+        FaceMode face = FaceMode::Pixelate;
+        int blurRadius = 3;                      // Box radius at quarter resolution (two passes)
+        int pixelBlockSize = 16;                 // Frame pixels, rounded to a multiple of 4
+        uint8_t fillColor[4] = {0, 0, 0, 255};   // BGRA
+    };
+
+    // Inputs besides the frame; masks must match the frame size
+    struct Layers {
+        const SegmentationMask* foreground = nullptr;  // Kept sharp (person); null = background kept
+        const SegmentationMask* face = nullptr;        // Anonymized; null = none
+        const ImageView* replacement = nullptr;        // BGRA at frame size, for BackgroundMode::Replace
+        const Anonymization* anonymization = nullptr;  // Track-loss handling; null = face mask only
+    };
+
+    Compositor();
+    explicit Compositor(const Options& options);
+
+    const Options& options() const { return options_; }
+    void setOptions(const Options& options);
+
+    /**
+     * Composite one frame
+     * @param frame BGRA source frame
+     * @param dst BGRA output, frame.width x frame.height (may be the source)
+     * @return false if a format or size does not match
+     */
+    bool composite(const ImageView& frame, const Layers& layers, uint8_t* dst, size_t dstBytesPerRow);
+
+    // Whether the last composite() kept the background, options().background
+    // notwithstanding, because Layers::foreground was missing
+    bool backgroundDropped() const { return backgroundDropped_; }
+
+private:
+    void resize(int width, int height);
+    void downsample(const ImageView& frame);
+    void blurQuarter();
+    void buildPixelGrid();
+    const uint8_t* expandedRow(int quarterRow);
+    void upsampleBlurredRow(int y);
+    void pixelatedRow(int y);
+
+    Options options_;
+    int width_ = 0;
+    int height_ = 0;
+    int quarterWidth_ = 0;
+    int quarterHeight_ = 0;
+    bool backgroundDropped_ = false;
+
+    std::vector<uint8_t> quarter_;        // Frame at quarter resolution, BGRA
+    std::vector<uint8_t> blurred_;        // Blurred quarter_
+    std::vector<uint8_t> blurScratch_;
+    std::vector<uint16_t> columnSums_;    // Vertical blur accumulators
+    std::vector<uint8_t> pixelGrid_;      // One BGRA color per pixelation block
+    int gridWidth_ = 0;
+
+    std::vector<uint8_t> expandedRows_[2];  // blurred_ rows upsampled horizontally
+    int cachedRow_[2] = {-1, -1};
+    std::vector<uint8_t> backgroundRow_;  // Upsampled blurred row
+    std::vector<uint8_t> faceRow_;        // Anonymized face row
+    std::vector<uint8_t> zeroAlpha_;      // Stand-in for absent masks
+    std::vector<uint8_t> regionAlpha_;    // Held region row (Anonymization::region)
+    std::vector<uint8_t> regionRow_;      // Union of the face mask row and regionAlpha_
+};
+
+} // namespace AnonCam
+
+#endif /* AnonCam_Compositor_h */
@@ -0,0 +1,147 @@
+#ifndef AnonCam_DetectionPipeline_h
+#define AnonCam_DetectionPipeline_h
+
+#include <array>
+#include <memory>
+#include <vector>
+
+#include "FaceDetector.h"
+#include "NonMaxSuppression.h"
+#include "SsdAnchors.h"
+#include "SsdDecoder.h"
+
+namespace AnonCam {
+
+/**
+ * DetectionPipeline - SSD detector tensors to faces, best first
+ *
+ * create() picks the implementation from Options::maxFaces once, at
+ * construction: SsdDetectionPipeline<1> when a single face is wanted (the
+ * common FaceTracker::Config::maxNumFaces = 1 case), the general
+ * SsdDetectionPipeline<kAnyFaceCount> otherwise. Both return the same
+ * faces for maxFaces = 1, up to float rounding of the scores.
+ *
+ * Neither allocates in run(). Not thread-safe.
+ */
+class DetectionPipeline {
+public:
+    struct Options {
+        SsdDecoder::Options decoder;
+        NonMaxSuppression::Options suppression;
+        int maxFaces = 1;
+    };
+
+    virtual ~DetectionPipeline() = default;
+
+    /**
+     * Decode and merge one inference
+     * @param boxes anchorCount x (4 + 2 * keypointCount) raw regressors
+     * @param logits anchorCount raw scores
+     * @param faces Output buffer of maxFaces() entries; coordinates are
+     *              normalized to the model input
+     * @return Faces written
+     */
+    virtual int run(const float* boxes, const float* logits, Detection* faces) = 0;
+
+    virtual int maxFaces() const = 0;
+
+    /**
+     * @param anchorX Anchor centers (normalized); must outlive the pipeline
+     */
+    static std::unique_ptr<DetectionPipeline> create(const float* anchorX, const float* anchorY, int anchorCount,
+                                                     int inputWidth, int inputHeight, const Options& options);
+
+    // Pipeline for a compile-time anchor table (kSsdAnchors<Spec>)
+    template <const SsdAnchorSpec& Spec>
+    static std::unique_ptr<DetectionPipeline> forSpec(const Options& options) {
+        return create(kSsdAnchors<Spec>.x.data(), kSsdAnchors<Spec>.y.data(), ssdAnchorCount(Spec),
+                      Spec.inputWidth, Spec.inputHeight, options);
+    }
+};
+
+// MaxFaces of the general pipeline: the count comes from Options::maxFaces
+inline constexpr int kAnyFaceCount = 0;
+
+/**
+ * SsdDetectionPipeline - any number of faces
+ *
+ * Every anchor above the score threshold is decoded into a candidate
+ * buffer (SsdDecoder), and NonMaxSuppression merges the candidates into
+ * up to maxFaces faces.
+ */
+template <int MaxFaces>
+class SsdDetectionPipeline final : public DetectionPipeline {
+    static_assert(MaxFaces == kAnyFaceCount, "only the general and single-face pipelines exist");
+
+public:
+    SsdDetectionPipeline(const float* anchorX, const float* anchorY, int anchorCount, int inputWidth,
+                         int inputHeight, const Options& options);
+
+    int run(const float* boxes, const float* logits, Detection* faces) override;
+    int maxFaces() const override { return maxFaces_; }
+
+private:
+    SsdDecoder decoder_;
+    NonMaxSuppression suppression_;
+    std::vector<Detection> candidates_;   // One per anchor
+    int maxFaces_;
+};
+
+/**
+ * SsdDetectionPipeline<1> - the single face
+ *
+ * One face needs neither decoded candidates nor suppression. A single
+ * vectorized pass over the logits lists the anchors above the threshold
+ * (index and clipped logit only, in a fixed-size array); the face is the
+ * listed anchor with the highest logit, and only its box is decoded. In
+ * Weighted mode the listed anchors whose box overlaps it are averaged in,
+ * which is the first cluster NonMaxSuppression would form. Keypoint
+ * accumulation is unrolled for BlazeFace's six keypoints.
+ *
+ * An inference with more anchors above the threshold than the list holds
+ * (a frame of noise, or minScore 0) goes through the general pipeline, so
+ * NonMaxSuppression::Options::maxCandidates applies as it would there.
+ */
+template <>
+class SsdDetectionPipeline<1> final : public DetectionPipeline {
+public:
+    static constexpr int kMaxSurvivors = 512;
+
+    SsdDetectionPipeline(const float* anchorX, const float* anchorY, int anchorCount, int inputWidth,
+                         int inputHeight, const Options& options);
+
+    int run(const float* boxes, const float* logits, Detection* faces) override;
+    int maxFaces() const override { return 1; }
+
+private:
+    // Lists the anchors above the threshold
+    // @return Anchors listed; more than listCapacity_ when the list overflowed
+    int collect(const float* logits);
+
+    // Weighted mean of the best anchor's cluster into face; Keypoints < 0
+    // takes the count from the options
+    template <int Keypoints>
+    void mergeCluster(const float* boxes, int survivors, int best, Detection& face);
+
+    const float* anchorX_;
+    const float* anchorY_;
+    int anchorCount_;
+    float inverseWidth_;
+    float inverseHeight_;
+    float logitThreshold_;   // Higher of the decoder and suppression score thresholds, as a logit
+    float scoreClip_;
+    int keypointCount_;
+    NonMaxSuppression::Mode mode_;
+    float iouThreshold_;
+    int listCapacity_;       // kMaxSurvivors, or maxCandidates if lower
+
+    // Anchors above the threshold; four slots of slack for the lanes stored past the last survivor
+    std::array<int, kMaxSurvivors + 4> survivors_;
+    std::array<float, kMaxSurvivors + 4> survivorScores_;   // Their clipped logits, then (Weighted) sigmoid scores
+
+    SsdDetectionPipeline<kAnyFaceCount> general_;   // Inferences that overflow the list
+};
+
+} // namespace AnonCam
+
+#endif /* AnonCam_DetectionPipeline_h */
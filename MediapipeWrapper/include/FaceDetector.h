@@ -0,0 +1,48 @@
+#ifndef AnonCam_FaceDetector_h
+#define AnonCam_FaceDetector_h
+
+#include <vector>
+
+#include "Cancellation.h"
+#include "ImageView.h"
+
+namespace AnonCam {
+
+// A face candidate from a detector, in normalized frame coordinates
+struct Detection {
+    static constexpr int kMaxKeypoints = 6;
+
+    float x = 0.0f;       // Top-left corner
+    float y = 0.0f;
+    float width = 0.0f;
+    float height = 0.0f;
+    float score = 0.0f;   // Backend-specific confidence in [0, 1]
+    // Coarse facial keypoints (x, y) from SSD backends; eyes, nose, mouth, ears for BlazeFace
+    int keypointCount = 0;
+    float keypoints[kMaxKeypoints][2] = {};
+};
+
+/**
+ * FaceDetector - full-frame face localization backend
+ *
+ * FaceTracker runs a detector only when it has no face to track or has
+ * lost it; landmarks always come from the landmark model on the detected
+ * region. Implementations need not be thread-safe.
+ */
+class FaceDetector {
+public:
+    virtual ~FaceDetector() = default;
+
+    /**
+     * Find faces in a frame (Gray8, NV12 or BGRA)
+     * @param detections Replaced with the faces found, best first
+     * @param cancel Checked between units of work; once set, detect() stops early
+     * @return false if the detector is not ready, the frame is unusable or the call was cancelled
+     */
+    virtual bool detect(const ImageView& frame, std::vector<Detection>& detections,
+                        const CancellationToken& cancel = {}) = 0;
+};
+
+} // namespace AnonCam
+
+#endif /* AnonCam_FaceDetector_h */
@@ -1,12 +1,28 @@
 #ifndef AnonCam_FaceTracker_h
 #define AnonCam_FaceTracker_h
 
+#include <cstdint>
+#include <string>
 #include <vector>
 #include <memory>
+#ifdef __APPLE__
 #include <CoreVideo/CoreVideo.h>
+#endif
+
+#include "CascadeDetector.h"
+#include "HalfLandmarks.h"
+#include "ImageView.h"
+#include "InferenceBatcher.h"
+#include "LandmarkRefiner.h"
+#include "LumaNormalizer.h"
+#include "Segmentation.h"
+#include "TemporalDenoiser.h"
+#include "TrackLossPolicy.h"
 
 namespace AnonCam {
 
+class ShadowEvaluator;
+
 // Single 3D landmark point
 struct Landmark {
     float x;  // Normalized [0, 1]
@@ -26,8 +42,22 @@ struct HeadPose {
 struct FaceResult {
     bool hasFace = false;
     float confidence = 0.0f;
+    int64_t timestampNs = 0;          // Capture timestamp of the source frame
     std::vector<Landmark> landmarks;  // 478 points for Face Mesh
-    HeadPose pose;
+    // Filled instead of `landmarks` when Config::halfPrecisionLandmarks is set
+    std::vector<LandmarkHalf> landmarksHalf;
+    HeadPose pose{};
+    // Face alpha mask at frame resolution (Config::enableSegmentation)
+    SegmentationMask segmentationMask;
+    // Frame the result was computed on (Config::enableDenoising); composite
+    // this instead of the camera frame so the output is denoised as well
+    DenoisedFrame denoisedFrame;
+    // What to anonymize, including while the track is lost (Config::trackLoss);
+    // hand to Compositor::Layers::anonymization
+    Anonymization anonymization;
+    // Abandoned by reset() or cancel() while in flight: no face, and the
+    // whole frame is marked for anonymization; drop it if a newer one follows
+    bool cancelled = false;
 
     // Quick access to key landmarks for mask alignment
     struct KeyPoints {
@@ -39,7 +69,7 @@ struct FaceResult {
         Landmark leftEar;
         Landmark rightEar;
         Landmark forehead;
-    } keyPoints;
+    } keyPoints{};
 };
 
 /**
@@ -50,6 +80,12 @@ struct FaceResult {
  */
 class FaceTracker {
 public:
+    // Backend of the full-frame detection step (landmarks always come from the model)
+    enum class DetectorBackend {
+        Model,      // Neural face detector
+        Cascade,    // CPU Haar cascade (CascadeDetector), e.g. when the model is too slow
+    };
+
     struct Config {
         int maxNumFaces = 1;
         float minDetectionConfidence = 0.5f;
@@ -57,9 +93,47 @@ public:
         bool enableSegmentation = false;
         // Use CPU backend (Metal GPU support for MediaPipe on macOS is limited)
         bool useGPU = false;
+        // Return landmarks as fp16 (FaceResult::landmarksHalf). Key points
+        // and pose are still computed from the fp32 landmarks.
+        bool halfPrecisionLandmarks = false;
+        // Temporal denoise in front of tracking and segmentation (low light)
+        bool enableDenoising = false;
+        TemporalDenoiser::Options denoising;
+        // Normalize the face region's luma in the model input (backlighting)
+        bool normalizeLuma = false;
+        LumaNormalizer::Options lumaNormalization;
+        // Refine eye and lip landmarks on native-resolution crops (steadier masks)
+        bool refineEyesAndLips = false;
+        LandmarkRefiner::Options refinement;
+        // Region hold and full-frame fallback when the face is lost (FaceResult::anonymization)
+        TrackLossPolicy::Options trackLoss;
+        DetectorBackend detector = DetectorBackend::Model;
+        std::string cascadePath;               // OpenCV cascade XML for DetectorBackend::Cascade
+        CascadeDetector::Options cascade;
+        // Background threads for tiled stages (-1 = WorkerPool::defaultThreadCount())
+        int workerThreads = -1;
+        // Shared by trackers running on their own threads (one per camera) to
+        // batch their landmark-model runs; from createLandmarkBatcher()
+        std::shared_ptr<InferenceBatcher> landmarkBatcher;
+    };
+
+    // Counters since construction (reset() keeps them)
+    struct Stats {
+        uint64_t framesProcessed = 0;
+        uint64_t detections = 0;       // Frames that needed a detection (full pass or merged slices)
+        uint64_t reDetections = 0;     // Detections caused by losing an active track
+        uint64_t detectionNs = 0;      // Time spent in the detector (every frame when time-sliced)
+        uint64_t denoiseNs = 0;        // Time spent in the denoise stage
+        uint64_t refinementNs = 0;     // Time spent refining eye and lip landmarks
+        uint64_t configUpdates = 0;    // Configurations applied by updateConfig()
+        uint64_t cancelledFrames = 0;  // Frames abandoned by reset() / cancel()
+        int64_t lastResetWaitNs = 0;   // Last reset() waiting for the frame in flight
+        int64_t lastSwitchLatencyNs = 0;  // Last reset() call to the end of the first frame started after it
+        uint64_t recordsDropped = 0;   // Records the current recording dropped because its writer fell behind
     };
 
-    explicit FaceTracker(const Config& config = Config());
+    FaceTracker();
+    explicit FaceTracker(const Config& config);
     ~FaceTracker();
 
     // Non-copyable, movable
@@ -68,32 +142,122 @@ public:
     FaceTracker(FaceTracker&&) noexcept;
     FaceTracker& operator=(FaceTracker&&) noexcept;
 
+    /**
+     * Batcher for Config::landmarkBatcher, running the landmark model on the
+     * inputs of every tracker that shares it
+     */
+    static std::shared_ptr<InferenceBatcher> createLandmarkBatcher(
+        const InferenceBatcher::Options& options = InferenceBatcher::Options());
+
+#ifdef __APPLE__
     /**
      * Process a frame and extract face landmarks
      * @param pixelBuffer CVPixelBufferRef from AVCaptureSession
      * @return FaceResult with landmarks and pose (hasFace = false if no face detected)
      */
     FaceResult processFrame(CVPixelBufferRef pixelBuffer);
+#endif
+
+    /**
+     * Process a frame held in memory (Gray8, NV12 or BGRA)
+     * @param frame View of the frame; only needs to stay valid for the call
+     * @param timestampNs Capture timestamp, carried through to the result
+     * @return FaceResult with landmarks and pose (hasFace = false if no face detected)
+     */
+    FaceResult processFrame(const ImageView& frame, int64_t timestampNs);
+
+    /**
+     * Switch to a new configuration at the next frame boundary, without a
+     * cold start: the track, the worker threads, the detector and every
+     * stage whose settings are unchanged are kept. A changed detector is
+     * loaded here, on the calling thread, so processFrame() only swaps it in.
+     * May be called from any thread; the latest update before a frame wins.
+     * @return false if the new detector could not be loaded (nothing changes)
+     */
+    bool updateConfig(const Config& config);
+
+    /**
+     * Most recently accepted configuration (applied from the next frame on)
+     */
+    Config getConfig() const;
 
     /**
      * Reset internal tracking state (call when camera restarts)
+     *
+     * A frame in flight is cancelled: its stages stop at their next check
+     * (a detector work item, a band of rows, a landmark region) and it
+     * returns with FaceResult::cancelled, so reset() waits for at most one
+     * such unit rather than for the whole frame.
      */
     void reset();
 
+    /**
+     * Cancel the frame in flight, if any, keeping the track; returns at once.
+     * Frames started afterwards run normally. Call before tearing down a
+     * camera session so its last frame does not hold up shutdown.
+     */
+    void cancel();
+
     /**
      * Get last result without processing new frame
      */
     FaceResult getLastResult() const;
 
     /**
-     * Check if tracker is initialized successfully
+     * Get stage counters (detections, re-detections, stage cost)
+     */
+    Stats getStats() const;
+
+    /**
+     * Record every processed frame and its result to a capture file
+     * (see CaptureFile.h) for offline replay. A writer thread does the file
+     * I/O; records it cannot keep up with are dropped (Stats::recordsDropped).
+     * @param frameDownscale Divisor for the stored luma frames (0 = results
+     *                       only, which ReplayDriver cannot replay)
+     * @return false if the file could not be created
+     */
+    bool startRecording(const std::string& path, int frameDownscale = 4);
+
+    /**
+     * Finalize the capture file started by startRecording()
+     */
+    void stopRecording();
+
+    /**
+     * Stream every result to local subscribers over a Unix domain socket
+     * (see LandmarkStream.h)
+     * @return false if the socket could not be created
+     */
+    bool startPublishing(const std::string& socketPath);
+
+    /**
+     * Close the publishing socket and disconnect all subscribers
+     */
+    void stopPublishing();
+
+    /**
+     * Offer every processed frame, its result and latency to a candidate
+     * configuration running in the background (see ShadowEvaluator.h);
+     * read the comparison from the evaluator. Never slows the live path
+     * beyond copying the sampled frames.
+     */
+    void startShadow(std::shared_ptr<ShadowEvaluator> evaluator);
+
+    /**
+     * Stop offering frames; the evaluator keeps its stats
+     */
+    void stopShadow();
+
+    /**
+     * Check if tracker is initialized successfully (false while the
+     * configured detector could not be loaded; an update that loads one
+     * makes it true from its first frame). Callable from any thread.
      */
-    bool isInitialized() const { return initialized_; }
+    bool isInitialized() const;
 
 private:
     class Impl;
     std::unique_ptr<Impl> impl_;
-    bool initialized_ = false;
 
     // Extract key points from full landmark set
     void extractKeyPoints(const std::vector<Landmark>& landmarks, FaceResult::KeyPoints& kp);
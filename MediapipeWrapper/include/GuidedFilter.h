@@ -0,0 +1,82 @@
+#ifndef AnonCam_GuidedFilter_h
+#define AnonCam_GuidedFilter_h
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "ImageView.h"
+
+namespace AnonCam {
+
+/**
+ * GuidedFilter - edge-aware upsampling of a low-resolution mask
+ *
+ * Fast guided filter (He & Sun): the linear model q = a * I + b is fitted
+ * at mask resolution against a downsampled copy of the luma plane, and the
+ * smoothed coefficients are upsampled and applied to the full-resolution
+ * luma. Mask edges therefore snap to image edges instead of showing the
+ * low-resolution grid.
+ *
+ * Every box filter is evaluated from integral images, so the cost does not
+ * depend on the radius. The first-pass integrals are uint32 with wraparound
+ * (exact as long as a single window sum fits in 31 bits, which caps the
+ * radius at kMaxRadius).
+ *
+ * Not thread-safe; scratch buffers are reused between calls.
+ */
+class GuidedFilter {
+public:
+    static constexpr int kMaxRadius = 64;
+
+    struct Options {
+        int radius = 2;            // Window radius in mask pixels
+        float epsilon = 1e-3f;     // Regularization, in normalized intensity squared
+    };
+
+    GuidedFilter();
+    explicit GuidedFilter(const Options& options);
+
+    const Options& options() const { return options_; }
+
+    /**
+     * Refine a mask to the resolution of the guide
+     * @param guide Frame whose luma plane guides the edges (Gray8 or NV12)
+     * @param mask Low-resolution 8-bit mask
+     * @param dst Output mask, guide.width x guide.height
+     * @return false if the guide has no luma plane or a size is invalid
+     */
+    bool refine(const ImageView& guide, const uint8_t* mask, int maskWidth, int maskHeight, size_t maskStride,
+                uint8_t* dst, size_t dstStride);
+
+private:
+    void downsampleGuide(const ImageView& guide);
+    void fitCoefficients(const uint8_t* mask, size_t maskStride);
+    void prepareUpsample(int dstWidth, int dstHeight);
+    int expandedRow(int row);
+    void applyModel(const ImageView& guide, uint8_t* dst, size_t dstStride);
+
+    Options options_;
+    int width_ = 0;        // Mask resolution
+    int height_ = 0;
+    int dstWidth_ = 0;     // Guide resolution
+    int dstHeight_ = 0;
+
+    std::vector<uint8_t> lowGuide_;
+    std::vector<uint32_t> columnSums_;          // Scratch for downsampleGuide
+    std::vector<uint32_t> sumI_, sumP_, sumII_, sumIP_;
+    std::vector<double> sumA_, sumB_;
+    std::vector<float> mean_[4];                // I, p, I*I, I*p
+    std::vector<float> a_, b_;
+    std::vector<float> meanA_, meanB_;
+
+    std::vector<int> xIndex_;       // Left mask column per output column
+    std::vector<float> xWeight_;    // Weight of the right column
+    std::vector<float> rowA_[2];    // Horizontally expanded meanA_/meanB_ rows
+    std::vector<float> rowB_[2];
+    int cachedRow_[2] = {-1, -1};
+};
+
+} // namespace AnonCam
+
+#endif /* AnonCam_GuidedFilter_h */
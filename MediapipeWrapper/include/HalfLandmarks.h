@@ -0,0 +1,48 @@
+#ifndef AnonCam_HalfLandmarks_h
+#define AnonCam_HalfLandmarks_h
+
+#include <cstddef>
+#include <cstdint>
+
+namespace AnonCam {
+
+struct Landmark;
+
+// Landmark stored as IEEE 754 binary16 bit patterns. Layout matches Metal's
+// packed_half3, so arrays can be uploaded to a vertex buffer as-is.
+struct LandmarkHalf {
+    uint16_t x;
+    uint16_t y;
+    uint16_t z;
+};
+static_assert(sizeof(LandmarkHalf) == 6, "LandmarkHalf must match packed_half3");
+
+/**
+ * Convert fp32 landmarks to fp16 (round to nearest even)
+ *
+ * Uses F16C on x86 (selected at runtime) and NEON on arm64, with a scalar
+ * fallback. All paths produce identical bits.
+ */
+void convertLandmarksToHalf(const Landmark* src, size_t count, LandmarkHalf* dst);
+
+/**
+ * Convert fp16 landmarks back to fp32
+ */
+void convertLandmarksFromHalf(const LandmarkHalf* src, size_t count, Landmark* dst);
+
+/**
+ * Pack fp32 landmarks as half4 (x, y, z, 1.0) for MTLVertexFormatHalf4
+ * @param dst Destination of count * 4 halves (8-byte stride per vertex)
+ */
+void packLandmarksHalf4(const Landmark* src, size_t count, uint16_t* dst);
+
+// Name of the conversion path selected on this machine ("F16C", "NEON", "scalar")
+const char* halfConversionBackend();
+
+// Scalar reference conversions
+uint16_t floatToHalf(float value);
+float halfToFloat(uint16_t value);
+
+} // namespace AnonCam
+
+#endif /* AnonCam_HalfLandmarks_h */
@@ -0,0 +1,49 @@
+#ifndef AnonCam_ImageView_h
+#define AnonCam_ImageView_h
+
+#include <cstddef>
+#include <cstdint>
+
+namespace AnonCam {
+
+// Pixel layouts understood by the CPU core
+enum class PixelFormat : uint32_t {
+    Gray8 = 0,  // Single 8-bit luma plane
+    NV12 = 1,   // 8-bit luma plane + interleaved CbCr plane at half resolution
+    BGRA = 2,   // Packed 32-bit BGRA
+};
+
+/**
+ * ImageView - non-owning view of a frame in memory
+ *
+ * Decouples the core from CVPixelBuffer so frames can come from the camera,
+ * a capture file or a test harness. Plane 1 is only used for NV12.
+ */
+struct ImageView {
+    PixelFormat format = PixelFormat::Gray8;
+    int width = 0;
+    int height = 0;
+    const uint8_t* planes[2] = {nullptr, nullptr};
+    size_t bytesPerRow[2] = {0, 0};
+
+    bool isValid() const { return planes[0] != nullptr && width > 0 && height > 0; }
+
+    // Luma plane for Gray8/NV12 (BGRA has no separate luma plane)
+    bool hasLumaPlane() const { return format == PixelFormat::Gray8 || format == PixelFormat::NV12; }
+
+    const uint8_t* row(int plane, int y) const { return planes[plane] + static_cast<size_t>(y) * bytesPerRow[plane]; }
+
+    static ImageView gray(const uint8_t* data, int width, int height, size_t bytesPerRow) {
+        ImageView view;
+        view.format = PixelFormat::Gray8;
+        view.width = width;
+        view.height = height;
+        view.planes[0] = data;
+        view.bytesPerRow[0] = bytesPerRow;
+        return view;
+    }
+};
+
+} // namespace AnonCam
+
+#endif /* AnonCam_ImageView_h */
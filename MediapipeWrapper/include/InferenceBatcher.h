@@ -0,0 +1,105 @@
+#ifndef AnonCam_InferenceBatcher_h
+#define AnonCam_InferenceBatcher_h
+
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+namespace AnonCam {
+
+/**
+ * InferenceBatcher - runs one model over requests from several streams
+ *
+ * When several trackers share a host, each would run the model on its own
+ * single face crop. Trackers instead hand their crop to a shared batcher
+ * from their own threads. The first request of a batch makes its caller the
+ * batch leader: it waits until every attached stream has submitted or
+ * skipped the frame (or the batch is full, or the window has passed) and the
+ * previous batch has run; a stream counts once per batch, however many of
+ * its requests and skips land in it, runs the batch function once on its own thread and
+ * wakes the other callers, whose requests now hold their outputs. There is
+ * no batcher thread; batches run one at a time, in order.
+ *
+ * Requests are opaque to the batcher: a caller-owned struct carrying the
+ * model input and space for its output, interpreted by the batch function.
+ *
+ * Thread-safe.
+ */
+class InferenceBatcher {
+public:
+    // Runs the model on `count` requests (count <= maxBatch)
+    using BatchFunction = std::function<void(void* const* requests, int count)>;
+
+    static constexpr int kNoStream = -1;
+
+    struct Options {
+        int maxBatch = 8;
+        int windowUs = 2000;           // Longest a leader waits for the other streams
+    };
+
+    struct Stats {
+        uint64_t requests = 0;
+        uint64_t batches = 0;
+        std::vector<uint64_t> batchSizes;   // Histogram; index = batch size
+        uint64_t collectNs = 0;        // Leaders waiting for their batch to fill and the previous one to run
+        uint64_t runNs = 0;            // Inside the batch function
+    };
+
+    explicit InferenceBatcher(BatchFunction function);
+    InferenceBatcher(BatchFunction function, const Options& options);
+
+    InferenceBatcher(const InferenceBatcher&) = delete;
+    InferenceBatcher& operator=(const InferenceBatcher&) = delete;
+
+    /**
+     * Streams expected to submit once per frame; a batch closes as soon as
+     * all of them have. Unattached callers still work, on the window alone.
+     * @return Id of the stream, for run(), skip() and detachStream()
+     */
+    int attachStream();
+    void detachStream(int stream);
+
+    /**
+     * Run the model on one request, batched with other streams' requests
+     * @param stream Id from attachStream(), or kNoStream: the request then
+     *        counts as one more stream
+     * @return once the request's output has been written; rethrows what the
+     *         batch function threw for the request's batch
+     */
+    void run(void* request, int stream = kNoStream);
+
+    // An attached stream with no request this frame: the open batch stops
+    // waiting for it. Never blocks.
+    void skip(int stream);
+
+    Stats stats() const;
+
+private:
+    bool batchReady() const;
+    void countStream(int stream);
+
+    BatchFunction function_;
+    Options options_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable arrived_;  // Leader: another request joined
+    std::condition_variable open_;     // The collecting batch was taken; a new one is open
+    std::condition_variable finished_; // A batch ran
+    std::vector<void*> pending_;       // Batch being collected
+    std::vector<std::exception_ptr*> pendingErrors_;   // Where each caller of pending_ expects a failure
+    std::vector<void*> running_;       // Batch being run, swapped with pending_ (both hold maxBatch)
+    std::vector<std::exception_ptr*> runningErrors_;
+    uint64_t openBatch_ = 0;           // Id of the batch being collected
+    uint64_t completed_ = 0;           // Batches [0, completed_) have run
+    int streams_ = 0;
+    int counted_ = 0;                  // Streams that submitted to or skipped the batch being collected
+    std::vector<uint64_t> streamBatch_;   // Per stream id: id + 1 of the last batch it was counted for
+    Stats stats_;
+};
+
+} // namespace AnonCam
+
+#endif /* AnonCam_InferenceBatcher_h */
@@ -0,0 +1,67 @@
+#ifndef AnonCam_InferenceKernels_h
+#define AnonCam_InferenceKernels_h
+
+#include <cstdint>
+
+namespace AnonCam {
+
+// ============================================================================
+// CPU kernels for the layers of BlazeFace / FaceMesh style models
+// ============================================================================
+//
+// A model picks its precision once, when its weights are packed: fp32, fp16
+// (uint16_t binary16 bit patterns, see HalfLandmarks.h) or symmetric int8.
+// Pointwise (1x1) convolutions and dense layers are GEMMs; depthwise 3x3
+// convolutions have their own kernels. Tensors are NHWC, row-major.
+//
+// fp16 arithmetic runs on NEON FP16 (ARMv8.2-A, every Apple Silicon core)
+// and doubles the lanes per instruction over fp32. Elsewhere it is emulated
+// in fp32, rounding to fp16 after every operation the way vfmaq_f16 does;
+// the emulation exists to test fp16 models on x86, only slower.
+//
+// The NEON FP16 path (ACM_HALF_ARITHMETIC) is untested: it is built only for
+// AArch64 with FP16 vector arithmetic, which no build of this tree has
+// compiled or run yet. Until one compares it against the emulation, results
+// may differ between the two paths (e.g. in fused versus separate rounding).
+
+// Accumulator of the fp16 kernels
+enum class HalfAccumulation {
+    Half,       // fp16 throughout
+    Single,     // fp32 accumulators, rounded to fp16 once per output (long reductions)
+};
+
+// True when the fp16 kernels run natively rather than emulated
+bool halfArithmeticNative();
+
+// Name of the fp16 path compiled in ("NEON FP16", "emulated")
+const char* halfArithmeticBackend();
+
+/**
+ * c[m x n] = a[m x k] * b[k x n] + bias[n]
+ * As a pointwise convolution: m = pixels, k = input channels, n = output channels.
+ */
+void gemm(const float* a, const float* b, const float* bias, float* c, int m, int n, int k);
+
+void gemmHalf(const uint16_t* a, const uint16_t* b, const uint16_t* bias, uint16_t* c, int m, int n, int k,
+              HalfAccumulation accumulation);
+
+/**
+ * c[m x n] = a[m x k] * bT[n x k]^T + bias[n], in int32
+ * Weights are stored transposed so every output is one contiguous dot
+ * product; requantization is left to the caller.
+ */
+void gemmInt8(const int8_t* a, const int8_t* bT, const int32_t* bias, int32_t* c, int m, int n, int k);
+
+/**
+ * Depthwise 3x3 convolution, stride 1, zero padding
+ * @param weights [3][3][channels]
+ */
+void depthwiseConv3x3(const float* input, int width, int height, int channels, const float* weights,
+                      const float* bias, float* output);
+
+void depthwiseConv3x3Half(const uint16_t* input, int width, int height, int channels, const uint16_t* weights,
+                          const uint16_t* bias, uint16_t* output, HalfAccumulation accumulation);
+
+} // namespace AnonCam
+
+#endif /* AnonCam_InferenceKernels_h */
@@ -0,0 +1,108 @@
+#ifndef AnonCam_LandmarkCodec_h
+#define AnonCam_LandmarkCodec_h
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "FaceTracker.h"
+
+namespace AnonCam {
+
+// ============================================================================
+// Packet layout (little-endian)
+// ============================================================================
+//
+//   LandmarkPacketHeader
+//   Key:    uint16_t q[count * 3]   x, y, z interleaved, 16-bit fixed point
+//   Delta8: int8_t   d[count * 3]   q - previous q (mod 2^16)
+//
+// x and y are quantized over [-0.5, 1.5] so landmarks slightly outside the
+// frame survive; z over [-1, 1]. The step is ~3e-5, about 0.06 px at 1080p.
+
+enum class LandmarkPacketType : uint8_t {
+    Key = 0,
+    Delta8 = 1,
+};
+
+struct LandmarkPacketHeader {
+    uint8_t type;        // LandmarkPacketType
+    uint8_t reserved;
+    uint16_t count;      // Number of landmarks
+    uint32_t sequence;   // Incremented per packet; a gap invalidates delta decoding
+};
+static_assert(sizeof(LandmarkPacketHeader) == 8, "LandmarkPacketHeader must stay 8 bytes");
+
+/**
+ * LandmarkEncoder - quantizes landmarks to 16-bit fixed point, optionally
+ * delta-coding against the previous packet
+ *
+ * A delta packet is emitted only if every component moved by at most
+ * +/-127 steps; otherwise (and every keyframeInterval packets) a keyframe
+ * is sent. Decoding is lossless with respect to the quantized values.
+ */
+class LandmarkEncoder {
+public:
+    struct Options {
+        bool deltaCoding = true;
+        int keyframeInterval = 30;  // Force a keyframe at least this often
+    };
+
+    LandmarkEncoder();
+    explicit LandmarkEncoder(const Options& options);
+
+    // Upper bound on encode() output for `count` landmarks
+    static size_t maxEncodedSize(size_t count) {
+        return sizeof(LandmarkPacketHeader) + count * 3 * sizeof(uint16_t);
+    }
+
+    /**
+     * Encode one set of landmarks
+     * @param out Buffer of at least maxEncodedSize(count) bytes
+     * @return Number of bytes written (0 if count exceeds 65535)
+     */
+    size_t encode(const Landmark* landmarks, size_t count, uint8_t* out);
+
+    // Force the next packet to be a keyframe
+    void reset();
+
+private:
+    Options options_;
+    std::vector<uint16_t> current_;
+    std::vector<uint16_t> previous_;
+    uint32_t sequence_ = 0;
+    int packetsSinceKey_ = 0;
+    bool hasPrevious_ = false;
+};
+
+/**
+ * LandmarkDecoder - reverses LandmarkEncoder
+ *
+ * Keeps the last decoded quantized set as the delta reference.
+ */
+class LandmarkDecoder {
+public:
+    /**
+     * Decode one packet
+     * @param out Destination for up to `capacity` landmarks
+     * @param count Receives the number of landmarks decoded
+     * @return false if the packet is malformed, too large for `out`, or a
+     *         delta packet that does not follow the previous packet
+     */
+    bool decode(const uint8_t* data, size_t size, Landmark* out, size_t capacity, size_t& count);
+
+    void reset();
+
+private:
+    std::vector<uint16_t> previous_;
+    uint32_t lastSequence_ = 0;
+    bool hasPrevious_ = false;
+};
+
+// Stateless helpers used by the codec (exposed for recording and benchmarks)
+void quantizeLandmarks(const Landmark* landmarks, size_t count, uint16_t* out);
+void dequantizeLandmarks(const uint16_t* quantized, size_t count, Landmark* out);
+
+} // namespace AnonCam
+
+#endif /* AnonCam_LandmarkCodec_h */
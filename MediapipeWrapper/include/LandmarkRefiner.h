@@ -0,0 +1,101 @@
+#ifndef AnonCam_LandmarkRefiner_h
+#define AnonCam_LandmarkRefiner_h
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "Cancellation.h"
+#include "ImageView.h"
+
+namespace AnonCam {
+
+struct Landmark;
+class WorkerPool;
+
+/**
+ * LandmarkRefiner - second pass over the eye and lip landmarks at native resolution
+ *
+ * The face model sees the whole face at its small input size, where an eye
+ * covers a few samples, so eye and lip landmarks wobble from frame to frame
+ * and masks aligned to them wobble with them. The refiner crops one region
+ * per eye and one around the mouth from the frame itself, placed and sized
+ * from the face model's landmarks of that feature, and runs a small region
+ * model on each crop that updates only that feature's landmarks (eye
+ * contour and iris, outer and inner lips). The three regions run in
+ * parallel on an optional WorkerPool.
+ *
+ * STUB: until the region models are integrated, each region is registered
+ * against its crop from the previous frame (sub-pixel Lucas-Kanade
+ * translation on the native-resolution crop). The feature keeps the face
+ * model's shape, placed at last frame's refined position plus the measured
+ * motion and eased toward the face model's position; where the two
+ * disagree by more than maxDisagreement, or the crop has no texture to
+ * register, the face model's position is taken as is.
+ *
+ * Not thread-safe; owned by one FaceTracker.
+ */
+class LandmarkRefiner {
+public:
+    struct Options {
+        int cropSize = 48;             // Crop side in samples; larger features are sampled with a stride
+        float margin = 0.3f;           // Crop padding around the feature, share of its extent
+        float anchor = 0.1f;           // Share of the way to the face model's position taken every frame
+        float maxDisagreement = 0.15f; // Share of the crop side beyond which the face model wins outright
+        int iterations = 6;            // Registration steps per region
+
+        bool operator==(const Options&) const = default;
+    };
+
+    struct Stats {
+        int64_t lastProcessNs = 0;
+        uint64_t regionsTracked = 0;   // Regions placed by registration
+        uint64_t regionsReset = 0;     // Regions placed at the face model's position
+    };
+
+    LandmarkRefiner();
+    explicit LandmarkRefiner(const Options& options, WorkerPool* workers = nullptr);
+
+    /**
+     * Refine the eye and lip landmarks of a Face Mesh result in place
+     * @param landmarks Normalized to the frame
+     * @param cancel Checked per region
+     * @return false if there are fewer than 478 landmarks, the frame is empty or the call was cancelled
+     */
+    bool refine(const ImageView& frame, Landmark* landmarks, size_t count, const CancellationToken& cancel = {});
+
+    /**
+     * Forget the previous crops (new face, camera restart)
+     */
+    void reset();
+
+    const Stats& stats() const { return stats_; }
+
+private:
+    // One feature: its crop from the previous frame and where it was refined to
+    struct Region {
+        bool valid = false;
+        float centerX = 0.0f;          // Refined feature centroid (pixels)
+        float centerY = 0.0f;
+        float step = 1.0f;             // Frame pixels per crop sample
+        std::vector<float> crop;
+        std::vector<float> gradientX;
+        std::vector<float> gradientY;
+        float hessian[3] = {};         // xx, xy, yy
+        bool tracked = false;          // Placed by registration this frame
+    };
+
+    void refineRegion(const ImageView& frame, int index, Landmark* landmarks);
+    void sampleCrop(const ImageView& frame, float originX, float originY, float step, float* crop) const;
+    bool updateTemplate(const ImageView& frame, Region& region) const;
+    bool registerRegion(const ImageView& frame, const Region& region, float& dx, float& dy) const;
+
+    Options options_;
+    WorkerPool* workers_ = nullptr;
+    std::vector<Region> regions_;
+    Stats stats_;
+};
+
+} // namespace AnonCam
+
+#endif /* AnonCam_LandmarkRefiner_h */
@@ -0,0 +1,185 @@
+#ifndef AnonCam_LandmarkStream_h
+#define AnonCam_LandmarkStream_h
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "FaceTracker.h"
+#include "LandmarkCodec.h"
+
+namespace AnonCam {
+
+// ============================================================================
+// Wire format (little-endian, stream socket)
+// ============================================================================
+//
+//   StreamMessageHeader
+//   StreamFaceSummary
+//   LandmarkPacket (LandmarkCodec.h)   only if summary.hasFace
+//
+// Landmark packets are delta-coded across messages. Whenever a client joins
+// or a message is dropped for any client, the publisher forces a keyframe,
+// so a subscriber that hits a sequence gap recovers on the next message.
+
+constexpr uint32_t kStreamMagic = 0x4C4D4341;  // "ACML" - AnonCam Landmarks
+constexpr uint16_t kStreamVersion = 1;
+
+struct StreamMessageHeader {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t headerSize;
+    uint32_t payloadSize;    // Bytes following this header
+    uint32_t frameNumber;
+    int64_t timestampNs;
+};
+static_assert(sizeof(StreamMessageHeader) == 24, "StreamMessageHeader must stay 24 bytes");
+
+struct StreamFaceSummary {
+    uint32_t hasFace;
+    float confidence;
+    float translation[3];
+    float rotation[3];
+};
+static_assert(sizeof(StreamFaceSummary) == 32, "StreamFaceSummary must stay 32 bytes");
+
+// Landmarks a message carries at most (Face Mesh with irises); larger sets are sent without landmarks
+constexpr size_t kStreamMaxLandmarks = 478;
+
+// Largest legal payload: the summary and a keyframe of kStreamMaxLandmarks
+constexpr size_t kStreamMaxPayloadSize = sizeof(StreamFaceSummary) + sizeof(LandmarkPacketHeader) +
+                                         kStreamMaxLandmarks * 3 * sizeof(uint16_t);
+
+/**
+ * LandmarkPublisher - streams FaceResults to local subscribers over a Unix
+ * domain socket
+ *
+ * publish() is meant to be called on the frame path: it encodes the result
+ * once, appends it to every client's preallocated send buffer and issues one
+ * non-blocking send per client. No memory is allocated per frame once the
+ * clients are connected. A client whose buffer cannot take a message is
+ * handled by the drop policy.
+ *
+ * Not thread-safe; call start/publish/stop from one thread.
+ */
+class LandmarkPublisher {
+public:
+    enum class DropPolicy {
+        DropNewest,  // Skip the message for the slow client
+        Disconnect,  // Close the slow client
+    };
+
+    struct Options {
+        int maxClients = 16;
+        size_t clientBufferBytes = 64 * 1024;  // Per-client send buffer
+        DropPolicy dropPolicy = DropPolicy::DropNewest;
+        int keyframeInterval = 30;
+    };
+
+    struct Stats {
+        uint64_t framesPublished = 0;
+        uint64_t messagesQueued = 0;
+        uint64_t messagesDropped = 0;
+        uint64_t clientsDisconnected = 0;
+        uint64_t bytesSent = 0;
+    };
+
+    LandmarkPublisher() = default;
+    ~LandmarkPublisher();
+
+    LandmarkPublisher(const LandmarkPublisher&) = delete;
+    LandmarkPublisher& operator=(const LandmarkPublisher&) = delete;
+
+    /**
+     * Bind and listen on `socketPath` (an existing socket file is replaced)
+     * @return false if the socket could not be created, or `socketPath`
+     *         exists and is not a socket (it is left alone)
+     */
+    bool start(const std::string& socketPath);
+    bool start(const std::string& socketPath, const Options& options);
+
+    void stop();
+
+    /**
+     * Accept pending clients, then queue and flush one message per client
+     */
+    void publish(const FaceResult& result);
+
+    bool isRunning() const { return listenFd_ >= 0; }
+    int clientCount() const { return clientCount_; }
+    Stats stats() const { return stats_; }
+
+private:
+    struct Client {
+        int fd = -1;
+        std::vector<uint8_t> buffer;  // Ring buffer, sized once at accept
+        size_t head = 0;              // Offset of the first unsent byte
+        size_t size = 0;              // Unsent bytes
+    };
+
+    void acceptClients();
+    bool enqueue(Client& client, const uint8_t* data, size_t size);
+    bool flush(Client& client);
+    void closeClient(Client& client);
+    size_t encodeMessage(const FaceResult& result);
+
+    Options options_;
+    std::string socketPath_;
+    int listenFd_ = -1;
+    int clientCount_ = 0;
+    std::vector<Client> clients_;
+    LandmarkEncoder encoder_;
+    bool forceKeyframe_ = false;
+    uint32_t frameNumber_ = 0;
+    std::vector<uint8_t> message_;       // Encoded message, reused per frame
+    std::vector<Landmark> widened_;      // fp16 results are widened before encoding
+    Stats stats_;
+};
+
+// A decoded message received by LandmarkSubscriber
+struct StreamFrame {
+    uint32_t frameNumber = 0;
+    int64_t timestampNs = 0;
+    StreamFaceSummary summary{};
+    std::vector<Landmark> landmarks;
+    bool landmarksValid = false;   // false while waiting for a keyframe
+};
+
+/**
+ * LandmarkSubscriber - reference client for LandmarkPublisher
+ */
+class LandmarkSubscriber {
+public:
+    LandmarkSubscriber() = default;
+    ~LandmarkSubscriber();
+
+    LandmarkSubscriber(const LandmarkSubscriber&) = delete;
+    LandmarkSubscriber& operator=(const LandmarkSubscriber&) = delete;
+
+    bool connect(const std::string& socketPath);
+    void disconnect();
+    bool isConnected() const { return fd_ >= 0; }
+
+    /**
+     * Block until one message is available (or timeout)
+     * @param timeoutMs Negative waits forever
+     * @return false on timeout, disconnect or protocol error
+     */
+    bool receive(StreamFrame& frame, int timeoutMs = -1);
+
+    int fileDescriptor() const { return fd_; }
+
+private:
+    bool readMore(int timeoutMs);
+
+    int fd_ = -1;
+    std::vector<uint8_t> buffer_;
+    size_t begin_ = 0;
+    size_t end_ = 0;
+    LandmarkDecoder decoder_;
+};
+
+} // namespace AnonCam
+
+#endif /* AnonCam_LandmarkStream_h */
@@ -0,0 +1,269 @@
+#ifndef AnonCam_Logger_h
+#define AnonCam_Logger_h
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace AnonCam {
+
+enum class LogLevel : uint8_t {
+    Debug = 0,
+    Info = 1,
+    Warning = 2,
+    Error = 3,
+};
+
+/**
+ * LogSite - one place in the code that logs, and its rate limit
+ *
+ * Declared static where it is used (ACM_LOG does this), so it is
+ * constant-initialized and must outlive the logger's background thread.
+ * The rate limit counters are shared by every thread logging through the
+ * site and only touched by Logger.
+ */
+struct LogSite {
+    /**
+     * @param format Static text; each "{}" is replaced by the next argument
+     * @param file Source file, or a category name when line is 0
+     */
+    constexpr LogSite(const char* format, LogLevel level, const char* file, int line)
+        : format(format), level(level), file(file), line(line) {}
+
+    const char* const format;
+    const LogLevel level;
+    const char* const file;
+    const int line;
+
+    std::atomic<int64_t> windowStartNs{0};
+    std::atomic<uint32_t> windowCount{0};  // Messages in the current window, let through or not
+    std::atomic<uint32_t> suppressed{0};   // Rate-limited since the last message that got through
+};
+
+/**
+ * Logger - asynchronous logging that never blocks the thread that logs
+ *
+ * log() copies the site pointer, a timestamp and the arguments in binary
+ * form into a ring buffer owned by the calling thread (single producer,
+ * single consumer, no lock and no allocation after the thread's first
+ * message) and returns. A background thread empties the rings every
+ * drainIntervalMs, orders the records by time, formats them and hands
+ * the lines to the sink, so formatting and I/O never run on the frame path.
+ *
+ * Each site lets through `burst` messages per window and counts the rest;
+ * the next message that gets through reports how many were dropped. A
+ * message that finds its thread's ring full is dropped and counted too:
+ * an error storm costs the logging thread a few atomic operations per
+ * call, never a wait.
+ *
+ * Thread-safe.
+ */
+class Logger {
+public:
+    // Receives each formatted line (without a newline) on the background thread
+    using Sink = std::function<void(LogLevel level, const char* line)>;
+
+    static constexpr int kMaxArguments = 6;
+    static constexpr int kRecordBytes = 512;
+
+    struct Options {
+        LogLevel minLevel = LogLevel::Info;
+        int recordsPerThread = 128;     // Ring capacity of each logging thread (rounded up to a power of two)
+        int burst = 5;                  // Messages per site and window; the rest are counted, not written
+        int windowMs = 1000;
+        int drainIntervalMs = 20;       // How often the background thread empties the rings
+        Sink sink;                      // Empty: stderr
+    };
+
+    struct Stats {
+        uint64_t written = 0;           // Lines handed to the sink
+        uint64_t rateLimited = 0;       // Dropped by a site's rate limit
+        uint64_t overflowed = 0;        // Dropped because the thread's ring was full
+        int threads = 0;                // Threads with a ring
+    };
+
+    Logger();
+    explicit Logger(const Options& options);
+    ~Logger();  // Writes what is queued, then stops the background thread
+
+    Logger(const Logger&) = delete;
+    Logger& operator=(const Logger&) = delete;
+
+    // Process-wide logger behind ACM_LOG and the bridge; never destroyed
+    static Logger& shared();
+
+    /**
+     * Queue a message; returns without formatting or waiting
+     * @param args Integers, floating point, bool, or text (copied, truncated
+     *             to what is left of the record); at most kMaxArguments
+     */
+    template <typename... Args>
+    void log(LogSite& site, const Args&... args) {
+        static_assert(sizeof...(Args) <= kMaxArguments, "too many log arguments");
+        Record* record = nullptr;
+        Ring* ring = reserve(site, record);
+        if (!ring) {
+            return;
+        }
+        int textUsed = 0;
+        (encode(*record, textUsed, args), ...);
+        commit(ring);
+    }
+
+    /**
+     * Block until everything logged before the call has reached the sink;
+     * must not be called from the sink
+     */
+    void flush();
+
+    void setMinLevel(LogLevel level) { minLevel_.store(level, std::memory_order_relaxed); }
+
+    // Takes effect from the next batch of lines
+    void setSink(Sink sink);
+
+    Stats stats() const;
+
+private:
+    struct Ring;
+
+    enum class ArgumentType : uint8_t {
+        Signed,
+        Unsigned,
+        Float,
+        Text,
+    };
+
+    union Argument {
+        int64_t i;
+        uint64_t u;
+        double f;
+        struct {
+            uint16_t offset;
+            uint16_t length;
+        } text;
+    };
+
+    static constexpr int kTextBytes = kRecordBytes - 80;
+
+    // One message as the logging thread leaves it: formatted later
+    struct Record {
+        const LogSite* site;
+        int64_t timestampNs;
+        uint32_t suppressed;            // Dropped by the site's rate limit just before this one
+        uint8_t argumentCount;
+        ArgumentType types[kMaxArguments];
+        Argument arguments[kMaxArguments];
+        char text[kTextBytes];          // Text arguments, back to back
+    };
+    static_assert(sizeof(Record) == kRecordBytes, "Record layout changed");
+
+    // A drained record, formatted
+    struct Line {
+        int64_t timestampNs;
+        LogLevel level;
+        std::string text;
+    };
+
+    // Ring of the calling thread with a free slot, or null when the message is
+    // below the level, rate-limited or does not fit
+    Ring* reserve(LogSite& site, Record*& record);
+    void commit(Ring* ring);
+    Ring* threadRing();
+
+    template <typename T>
+    static void encode(Record& record, int& textUsed, const T& value) {
+        const int index = record.argumentCount++;
+        Argument& argument = record.arguments[index];
+        ArgumentType& type = record.types[index];
+        if constexpr (std::is_same_v<T, bool>) {
+            type = ArgumentType::Text;
+            encodeText(record, textUsed, argument, value ? "true" : "false");
+        } else if constexpr (std::is_enum_v<T>) {
+            type = ArgumentType::Signed;
+            argument.i = static_cast<int64_t>(value);
+        } else if constexpr (std::is_integral_v<T> && std::is_signed_v<T>) {
+            type = ArgumentType::Signed;
+            argument.i = value;
+        } else if constexpr (std::is_integral_v<T>) {
+            type = ArgumentType::Unsigned;
+            argument.u = value;
+        } else if constexpr (std::is_floating_point_v<T>) {
+            type = ArgumentType::Float;
+            argument.f = value;
+        } else if constexpr (std::is_convertible_v<const T&, const char*>) {
+            type = ArgumentType::Text;
+            const char* text = value;
+            encodeText(record, textUsed, argument, text ? std::string_view(text) : std::string_view("(null)"));
+        } else {
+            static_assert(std::is_convertible_v<const T&, std::string_view>, "unsupported log argument");
+            type = ArgumentType::Text;
+            encodeText(record, textUsed, argument, std::string_view(value));
+        }
+    }
+
+    static void encodeText(Record& record, int& textUsed, Argument& argument, std::string_view text) {
+        const int length = static_cast<int>(std::min<size_t>(text.size(), kTextBytes - textUsed));
+        std::memcpy(record.text + textUsed, text.data(), length);
+        argument.text.offset = static_cast<uint16_t>(textUsed);
+        argument.text.length = static_cast<uint16_t>(length);
+        textUsed += length;
+    }
+
+    void run();
+    void drain();
+    void format(const Record& record, std::string& out) const;
+    double secondsSinceStart(int64_t timestampNs) const;
+
+    const uint64_t id_;                 // Tells this logger's rings apart in a thread's ring list
+    const int capacity_;
+    const int burst_;
+    const int64_t windowNs_;
+    const std::chrono::milliseconds drainInterval_;
+    const std::chrono::steady_clock::time_point start_;
+    std::atomic<LogLevel> minLevel_;
+
+    mutable std::mutex ringsMutex_;
+    std::vector<std::shared_ptr<Ring>> rings_;
+    uint64_t retiredRateLimited_ = 0;   // Counters of rings already removed
+    uint64_t retiredOverflowed_ = 0;
+
+    // Background thread only
+    std::vector<std::shared_ptr<Ring>> draining_;
+    std::vector<Line> lines_;
+
+    std::mutex sinkMutex_;
+    Sink sink_;
+    std::atomic<uint64_t> written_{0};
+
+    std::mutex wakeMutex_;
+    std::condition_variable wake_;
+    std::condition_variable drained_;
+    uint64_t drainsStarted_ = 0;
+    uint64_t drainsFinished_ = 0;
+    bool flushRequested_ = false;
+    bool stopping_ = false;
+    std::thread thread_;
+};
+
+} // namespace AnonCam
+
+// Log through the shared logger from a call site with its own rate limit:
+// ACM_LOG(Warning, "capture write failed after {} frames", count)
+#define ACM_LOG(level, format, ...)                                                                  \
+    do {                                                                                             \
+        static ::AnonCam::LogSite acmLogSite(format, ::AnonCam::LogLevel::level, __FILE__, __LINE__); \
+        ::AnonCam::Logger::shared().log(acmLogSite __VA_OPT__(, ) __VA_ARGS__);                      \
+    } while (0)
+
+#endif /* AnonCam_Logger_h */
@@ -0,0 +1,70 @@
+#ifndef AnonCam_LumaNormalizer_h
+#define AnonCam_LumaNormalizer_h
+
+#include <cstddef>
+#include <cstdint>
+
+#include "ImageView.h"
+
+namespace AnonCam {
+
+/**
+ * LumaNormalizer - brightness/contrast normalization of the model input
+ *
+ * Builds a 256-entry lookup table from the luma histogram of the face
+ * region only, so a bright window behind the user does not decide the
+ * exposure of the face:
+ *
+ *   Gain      stretches the [lowPercentile, highPercentile] range to full
+ *             scale (bounded by maxGain) - enough for a uniformly dim face
+ *   Equalize  clipped histogram equalization over the region (CLAHE with a
+ *             single tile) - lifts a dark face next to bright background
+ *
+ * The table is applied to the model input samples only; frames handed to
+ * segmentation and compositing are left untouched. Not thread-safe.
+ */
+class LumaNormalizer {
+public:
+    enum class Mode {
+        Gain,
+        Equalize,
+    };
+
+    struct Options {
+        Mode mode = Mode::Equalize;
+        float clipLimit = 3.0f;        // Equalize: bins clipped at this multiple of the mean bin count
+        float maxGain = 4.0f;          // Gain: upper bound on the stretch
+        float lowPercentile = 0.01f;   // Gain: mapped to 0
+        float highPercentile = 0.99f;  // Gain: mapped to 255
+        int rowStep = 2;               // Histogram every rowStep-th row of the region
+
+        bool operator==(const Options&) const = default;
+    };
+
+    LumaNormalizer();
+    explicit LumaNormalizer(const Options& options);
+
+    /**
+     * Build the lookup table from a frame region (pixels, clamped to the frame)
+     * @return false if the region is empty (the table is left as identity)
+     */
+    bool analyze(const ImageView& frame, int x0, int y0, int x1, int y1);
+
+    /**
+     * Map samples through the current table
+     */
+    void apply(uint8_t* samples, size_t count) const;
+
+    const uint8_t* lut() const { return lut_; }
+
+private:
+    void buildGain(const uint32_t* histogram, uint32_t total);
+    void buildEqualize(const uint32_t* histogram, uint32_t total);
+
+    Options options_;
+    uint8_t lut_[256];
+};
+
+} // namespace AnonCam
+
+#endif /* AnonCam_LumaNormalizer_h */
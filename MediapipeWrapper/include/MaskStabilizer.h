@@ -0,0 +1,71 @@
+#ifndef AnonCam_MaskStabilizer_h
+#define AnonCam_MaskStabilizer_h
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#include "BufferPool.h"
+
+namespace AnonCam {
+
+struct SegmentationMask;
+
+/**
+ * MaskStabilizer - temporal filter against flickering mask edges
+ *
+ * Each output pixel moves from the previous output towards the new mask by
+ * a weight that grows with the per-pixel change, so static edges settle
+ * while moving edges follow without lag. When the mean change over the
+ * whole mask exceeds resetThreshold (fast motion, cut, new face) the new
+ * mask is passed through unfiltered.
+ *
+ * The previous output is kept by reference in a pooled buffer; nothing is
+ * allocated per frame. Not thread-safe.
+ */
+class MaskStabilizer {
+public:
+    struct Options {
+        float smoothing = 0.7f;        // Share of the previous mask kept where nothing changed [0, 1)
+        int motionGain = 2;            // Extra weight (of 128) per level of per-pixel change
+        float resetThreshold = 0.08f;  // Mean absolute change (0..1) that restarts the filter
+        size_t maxMasksInFlight = 2;   // Pool size: the previous output plus the one being written
+    };
+
+    struct Stats {
+        uint64_t frames = 0;
+        uint64_t resets = 0;            // Frames passed through (first frame, size change, large motion)
+        float lastMeanChange = 0.0f;    // Mean absolute change of the last frame (0..1)
+    };
+
+    MaskStabilizer();
+    explicit MaskStabilizer(const Options& options);
+
+    /**
+     * Blend a mask with the previous output
+     * @param mask Current mask, width x height
+     * @param output Stabilized mask in a pooled buffer; kept as the next reference
+     * @return false if no pooled buffer was free
+     */
+    bool stabilize(const uint8_t* mask, int width, int height, size_t bytesPerRow, SegmentationMask& output);
+
+    /**
+     * Forget the previous mask (next frame passes through)
+     */
+    void reset();
+
+    const Stats& stats() const { return stats_; }
+
+private:
+    Options options_;
+    int baseWeight_;                   // Weight of the new mask where nothing changed, of 128
+    std::unique_ptr<BufferPool> pool_;
+    std::shared_ptr<const PooledBuffer> previous_;
+    int width_ = 0;
+    int height_ = 0;
+    Stats stats_;
+};
+
+} // namespace AnonCam
+
+#endif /* AnonCam_MaskStabilizer_h */
@@ -0,0 +1,71 @@
+#ifndef AnonCam_NonMaxSuppression_h
+#define AnonCam_NonMaxSuppression_h
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "FaceDetector.h"
+
+namespace AnonCam {
+
+/**
+ * NonMaxSuppression - merges overlapping detector candidates into faces
+ *
+ *   Hard      candidates are visited best first (partial sort, extended in
+ *             chunks only as far as needed) and kept unless their IoU with
+ *             an already kept box exceeds iouThreshold; IoU against the
+ *             kept boxes is computed four at a time
+ *   Weighted  MediaPipe's WEIGHTED algorithm: the best remaining candidate
+ *             absorbs every remaining candidate overlapping it by more
+ *             than iouThreshold, and the output box and keypoints are the
+ *             score-weighted mean of that cluster. The best candidate is
+ *             found by a max scan fused into the previous IoU sweep, so
+ *             the remainder never needs sorting
+ *
+ * Boxes are held as structure-of-arrays in buffers sized at construction;
+ * run() does not allocate. Not thread-safe.
+ */
+class NonMaxSuppression {
+public:
+    enum class Mode {
+        Hard,
+        Weighted,
+    };
+
+    struct Options {
+        Mode mode = Mode::Weighted;
+        float iouThreshold = 0.3f;   // MediaPipe face detection: min_suppression_threshold
+        float minScore = 0.0f;       // Candidates below are ignored
+        int maxCandidates = 1024;    // Larger inputs keep only their best maxCandidates
+    };
+
+    NonMaxSuppression();
+    explicit NonMaxSuppression(const Options& options);
+
+    /**
+     * Suppress overlapping candidates
+     * @param output Faces, best first (score of the best cluster member)
+     * @return Faces written (at most capacity)
+     */
+    int run(const Detection* candidates, int count, Detection* output, int capacity);
+
+    const Options& options() const { return options_; }
+
+private:
+    int load(const Detection* candidates, int count);
+    int runHard(const Detection* candidates, int count, Detection* output, int capacity);
+    int runWeighted(const Detection* candidates, int count, Detection* output, int capacity);
+
+    Options options_;
+
+    // Candidates (Weighted: the shrinking remainder; Hard: the kept boxes)
+    std::vector<float> x0_, y0_, x1_, y1_, area_, score_;
+    std::vector<int> index_;         // Position in the caller's candidate array
+    std::vector<uint8_t> masks_;     // Weighted: cluster membership, four candidates per entry
+    std::vector<int> order_;         // Hard: candidate indices, sorted lazily by score
+};
+
+} // namespace AnonCam
+
+#endif /* AnonCam_NonMaxSuppression_h */
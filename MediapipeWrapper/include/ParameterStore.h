@@ -0,0 +1,157 @@
+#ifndef AnonCam_ParameterStore_h
+#define AnonCam_ParameterStore_h
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace AnonCam {
+
+// Render and anonymization settings the UI changes while frames are drawn
+struct RenderParameters {
+    float maskColor[4] = {0.2f, 0.25f, 0.3f, 1.0f};  // RGBA
+    float maskScale = 1.0f;            // Mask size multiplier
+    float maskRoughness = 0.7f;
+    float maskMetallic = 0.0f;
+    float smoothingFactor = 0.15f;     // Face box smoothing (lower = smoother)
+    float velocityDamping = 0.8f;      // Momentum decay of the face box
+    float movementThreshold = 0.005f;  // Smallest face box movement that is followed
+    bool pixelationEnabled = true;
+    bool mask3DEnabled = false;
+    bool stickerMode = false;
+    bool debugEnabled = false;
+};
+
+/**
+ * ParameterStore - lock-free reads of settings written from another thread
+ *
+ * Writers publish a whole new RenderParameters as an immutable snapshot
+ * (several fields changed together become visible together); the render
+ * path reads the current one with a single atomic pointer load, so it
+ * never takes a lock, waits for a writer or sees a half-written update.
+ *
+ * Replaced snapshots are reclaimed by epoch: a read announces its starting
+ * epoch in one of kReaderSlots slots for as long as it holds the
+ * snapshot, and a writer frees a replaced snapshot once no slot shows an
+ * epoch at or before the one it was replaced in. Allocation and reclamation
+ * happen on the writer's thread only.
+ *
+ * Thread-safe: any number of writers (serialized among themselves) and up
+ * to kReaderSlots concurrent reads; a read beyond that yields until a slot
+ * frees up.
+ */
+class ParameterStore {
+    // Published settings; immutable once current
+    struct Snapshot {
+        RenderParameters parameters;
+        uint64_t version;
+    };
+
+public:
+    static constexpr int kReaderSlots = 16;
+
+    struct Stats {
+        uint64_t published = 0;
+        uint64_t reclaimed = 0;        // Replaced snapshots freed
+        size_t pending = 0;            // Replaced snapshots a read may still hold
+    };
+
+    /**
+     * A snapshot held by one read; keep it no longer than a frame
+     */
+    class ReadGuard {
+    public:
+        ReadGuard(ReadGuard&& other) noexcept;
+        ReadGuard(const ReadGuard&) = delete;
+        ReadGuard& operator=(const ReadGuard&) = delete;
+        ReadGuard& operator=(ReadGuard&&) = delete;
+        ~ReadGuard();
+
+        const RenderParameters& operator*() const { return snapshot_->parameters; }
+        const RenderParameters* operator->() const { return &snapshot_->parameters; }
+        uint64_t version() const { return snapshot_->version; }
+
+    private:
+        friend class ParameterStore;
+        ReadGuard(std::atomic<uint64_t>* slot, const Snapshot* snapshot)
+            : slot_(slot), snapshot_(snapshot) {}
+
+        std::atomic<uint64_t>* slot_;
+        const Snapshot* snapshot_;
+    };
+
+    ParameterStore();
+    explicit ParameterStore(const RenderParameters& initial);
+    ~ParameterStore();
+
+    ParameterStore(const ParameterStore&) = delete;
+    ParameterStore& operator=(const ParameterStore&) = delete;
+
+    /**
+     * Pin the current snapshot (lock-free)
+     */
+    ReadGuard read() const;
+
+    /**
+     * Copy of the current settings (lock-free)
+     * @param version Receives the snapshot's version if not null
+     */
+    RenderParameters load(uint64_t* version = nullptr) const;
+
+    /**
+     * Version of the current snapshot; starts at 1 and grows with every
+     * publish, so a reader can skip work when nothing changed
+     */
+    uint64_t version() const;
+
+    /**
+     * Replace the settings
+     * @return Version of the new snapshot
+     */
+    uint64_t publish(const RenderParameters& parameters);
+
+    /**
+     * Change some fields of the current settings and publish the result;
+     * updates from other writers cannot interleave
+     * @param edit Called with a copy of the current settings
+     */
+    template <typename Edit>
+    uint64_t update(Edit&& edit) {
+        std::lock_guard<std::mutex> lock(writerMutex_);
+        RenderParameters parameters = current_.load(std::memory_order_relaxed)->parameters;
+        edit(parameters);
+        return publishLocked(parameters);
+    }
+
+    Stats stats() const;
+
+private:
+    // Replaced snapshot and the epoch it was replaced in
+    struct Retired {
+        std::unique_ptr<const Snapshot> snapshot;
+        uint64_t epoch;
+    };
+
+    // One cache line per slot: reads on different threads do not share lines
+    struct alignas(64) ReaderSlot {
+        std::atomic<uint64_t> epoch{0};  // 0 = free
+    };
+
+    uint64_t publishLocked(const RenderParameters& parameters);
+    void reclaimLocked();
+
+    std::atomic<const Snapshot*> current_;
+    std::atomic<uint64_t> epoch_{1};
+    mutable ReaderSlot readers_[kReaderSlots];
+
+    mutable std::mutex writerMutex_;
+    std::vector<Retired> retired_;
+    Stats stats_;
+};
+
+} // namespace AnonCam
+
+#endif /* AnonCam_ParameterStore_h */
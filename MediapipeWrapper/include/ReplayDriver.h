@@ -0,0 +1,65 @@
+#ifndef AnonCam_ReplayDriver_h
+#define AnonCam_ReplayDriver_h
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+
+#include "CaptureFile.h"
+#include "FaceTracker.h"
+
+namespace AnonCam {
+
+/**
+ * ReplayDriver - feeds a recorded capture back through a FaceTracker
+ *
+ * The tracker is reset before the first frame and receives the recorded
+ * timestamps, so two replays of the same capture see identical input.
+ * Records without a stored frame are skipped, so a results-only capture
+ * (CaptureReader::hasFrames() false) replays nothing; check before run().
+ */
+class ReplayDriver {
+public:
+    enum class Pacing {
+        Recorded,  // Sleep to reproduce the recorded inter-frame timing
+        Maximum,   // Feed frames back-to-back
+    };
+
+    struct Options {
+        Pacing pacing = Pacing::Maximum;
+        // Compare replayed landmarks against the recorded ones
+        bool compareResults = true;
+        // Max per-coordinate difference before a frame counts as a mismatch
+        float landmarkTolerance = 1e-4f;
+    };
+
+    struct Report {
+        size_t framesReplayed = 0;
+        size_t framesSkipped = 0;      // Records without a stored frame
+        size_t mismatches = 0;         // hasFace differs or landmark error > tolerance
+        float maxLandmarkError = 0.0f;
+        uint64_t totalProcessNs = 0;   // Time spent inside processFrame()
+        uint64_t maxProcessNs = 0;
+    };
+
+    // Invoked after every replayed frame
+    using FrameCallback = std::function<void(size_t index, const CaptureRecord& recorded,
+                                             const FaceResult& replayed)>;
+
+    ReplayDriver(FaceTracker& tracker, const CaptureReader& reader)
+        : tracker_(tracker), reader_(reader) {}
+
+    /**
+     * Replay every record in the capture
+     */
+    Report run() { return run(Options()); }
+    Report run(const Options& options, const FrameCallback& callback = nullptr);
+
+private:
+    FaceTracker& tracker_;
+    const CaptureReader& reader_;
+};
+
+} // namespace AnonCam
+
+#endif /* AnonCam_ReplayDriver_h */
@@ -0,0 +1,132 @@
+#ifndef AnonCam_Segmentation_h
+#define AnonCam_Segmentation_h
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "BufferPool.h"
+#include "GuidedFilter.h"
+#include "ImageView.h"
+#include "MaskStabilizer.h"
+
+namespace AnonCam {
+
+struct Landmark;
+
+// 8-bit alpha mask (0 = background, 255 = face). `data` points into `buffer`,
+// which returns to its pool once the last copy of the mask is released.
+struct SegmentationMask {
+    std::shared_ptr<const PooledBuffer> buffer;
+    const uint8_t* data = nullptr;
+    int width = 0;
+    int height = 0;
+    size_t bytesPerRow = 0;
+
+    bool isValid() const { return data != nullptr; }
+};
+
+/**
+ * BilinearUpsampler - resizes an 8-bit mask with bilinear filtering
+ *
+ * Source rows are expanded horizontally once (table-driven) and cached, then
+ * every output row is a SIMD blend of two expanded rows. Tables and row
+ * cache are reused while the source/destination sizes stay the same.
+ */
+class BilinearUpsampler {
+public:
+    void run(const uint8_t* src, int srcWidth, int srcHeight, size_t srcStride,
+             uint8_t* dst, int dstWidth, int dstHeight, size_t dstStride);
+
+private:
+    void prepare(int srcWidth, int srcHeight, int dstWidth, int dstHeight);
+    const uint8_t* expandedRow(const uint8_t* src, size_t srcStride, int row);
+
+    int srcWidth_ = 0;
+    int srcHeight_ = 0;
+    int dstWidth_ = 0;
+    int dstHeight_ = 0;
+    std::vector<int> xIndex_;        // Left source column per output column
+    std::vector<uint16_t> xWeight_;  // Weight of the right column, 0..256
+    std::vector<uint8_t> rows_[2];   // Horizontally expanded source rows
+    int cachedRow_[2] = {-1, -1};
+};
+
+/**
+ * FaceSegmenter - produces the face alpha mask for a frame
+ *
+ * The CPU path rasterizes the convex hull of the landmarks into an
+ * anti-aliased low-resolution mask (frame size / lowResDivisor), which is
+ * upsampled to frame resolution into a pooled buffer. When the frame has a
+ * luma plane, the upsampling is edge-aware (GuidedFilter); otherwise it is
+ * plain bilinear. The low-resolution mask is temporally stabilized before
+ * upsampling, which is where the filter is cheapest.
+ *
+ * Not thread-safe; owned by one FaceTracker.
+ */
+class FaceSegmenter {
+public:
+    struct Options {
+        int lowResDivisor = 8;
+        size_t maxMasksInFlight = 4;  // Pool size; bounds masks held by consumers
+        bool refineEdges = true;      // Guided upsampling when a luma plane is available
+        GuidedFilter::Options refinement;
+        bool temporalStabilization = true;
+        MaskStabilizer::Options stabilization;
+    };
+
+    FaceSegmenter();
+    explicit FaceSegmenter(const Options& options);
+
+    /**
+     * Segment one frame
+     * @param landmarks Normalized landmarks of the face (may be empty)
+     * @return false if no pooled buffer was free
+     */
+    bool segment(const Landmark* landmarks, size_t count, int frameWidth, int frameHeight,
+                 SegmentationMask& mask);
+
+    /**
+     * Segment one frame, refining mask edges against the frame's luma
+     * @param frame Source frame; only needs to stay valid for the call
+     * @return false if no pooled buffer was free
+     */
+    bool segment(const Landmark* landmarks, size_t count, const ImageView& frame, SegmentationMask& mask);
+
+    /**
+     * Drop temporal state (call when the face is lost or the camera restarts)
+     */
+    void reset() { stabilizer_.reset(); }
+
+    const MaskStabilizer::Stats& stabilizerStats() const { return stabilizer_.stats(); }
+
+    // Rasterized low-resolution mask from the last segment() call
+    const uint8_t* lowResMask() const { return lowRes_.data(); }
+    int lowResWidth() const { return lowResWidth_; }
+    int lowResHeight() const { return lowResHeight_; }
+
+private:
+    void rasterizeHull(const Landmark* landmarks, size_t count);
+    bool segment(const Landmark* landmarks, size_t count, int frameWidth, int frameHeight,
+                 const ImageView* guide, SegmentationMask& mask);
+
+    Options options_;
+    std::unique_ptr<BufferPool> pool_;
+    int frameWidth_ = 0;
+    int frameHeight_ = 0;
+    int lowResWidth_ = 0;
+    int lowResHeight_ = 0;
+    std::vector<uint8_t> lowRes_;
+    std::vector<float> points_;     // Scratch: landmark positions in mask pixels
+    std::vector<int> order_;        // Scratch: landmark indices sorted by position
+    std::vector<int> hull_;         // Scratch: hull vertex indices
+    std::vector<float> coverage_;   // Scratch: per-row coverage accumulator
+    BilinearUpsampler upsampler_;
+    GuidedFilter refiner_;
+    MaskStabilizer stabilizer_;
+};
+
+} // namespace AnonCam
+
+#endif /* AnonCam_Segmentation_h */
@@ -0,0 +1,141 @@
+#ifndef AnonCam_ShadowEvaluator_h
+#define AnonCam_ShadowEvaluator_h
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "FaceTracker.h"
+
+namespace AnonCam {
+
+/**
+ * ShadowEvaluator - runs a candidate tracker configuration on live traffic
+ *
+ * The live tracker offers each frame together with its result and latency
+ * (FaceTracker::startShadow()). A sampled fraction is copied into a single
+ * slot and processed by a candidate FaceTracker on a low-priority thread;
+ * the candidate's face decision, landmarks, pose and latency are compared
+ * with the live ones and aggregated into Stats. offer() never waits: when
+ * the candidate is still busy with an earlier frame the new one is dropped
+ * and counted.
+ *
+ * The candidate only sees the sampled frames, so at low sample rates it
+ * tracks across larger motion and re-detects more often than the live
+ * tracker would with the same configuration. It never joins the live
+ * landmark batcher and runs its tiled stages inline on its own thread.
+ *
+ * Thread-safe: offer() from the live thread, stats() from any thread.
+ */
+class ShadowEvaluator {
+public:
+    struct Options {
+        float sampleRate = 0.1f;       // Fraction of offered frames run on the candidate (0, 1]
+        bool lowPriority = true;       // Background QoS (Apple) / lowest nice value (Linux) for the candidate thread
+        int latencyWindow = 256;       // Recent frames kept for the latency percentiles
+    };
+
+    struct Latency {
+        double meanUs = 0.0;           // Over every evaluated frame
+        double p50Us = 0.0;            // Over the latency window
+        double p95Us = 0.0;
+    };
+
+    struct Stats {
+        uint64_t offered = 0;
+        uint64_t sampled = 0;          // Picked by the sample rate
+        uint64_t dropped = 0;          // Sampled while the candidate was busy
+        uint64_t evaluated = 0;
+        uint64_t faceAgreements = 0;   // Both or neither found a face
+        uint64_t liveOnly = 0;         // Face found by the live tracker only
+        uint64_t candidateOnly = 0;
+        // Landmark distance over the live inter-ocular distance, frames where both found a face
+        double meanLandmarkError = 0.0;
+        double maxLandmarkError = 0.0; // Largest per-frame mean
+        double meanPoseErrorDeg = 0.0; // Mean absolute pitch / yaw / roll difference
+        Latency live;                  // Live tracker on the evaluated frames
+        Latency candidate;
+    };
+
+    /**
+     * @param candidate Configuration under evaluation; its landmarkBatcher
+     *        and workerThreads are overridden (see above)
+     */
+    explicit ShadowEvaluator(const FaceTracker::Config& candidate);
+    ShadowEvaluator(const FaceTracker::Config& candidate, const Options& options);
+    ~ShadowEvaluator();
+
+    ShadowEvaluator(const ShadowEvaluator&) = delete;
+    ShadowEvaluator& operator=(const ShadowEvaluator&) = delete;
+
+    /**
+     * Hand a live frame and its result to the candidate if sampled and idle
+     * @param liveLatencyNs Time the live tracker took for the frame
+     * @return true if the frame was queued for the candidate
+     */
+    bool offer(const ImageView& frame, int64_t timestampNs, const FaceResult& liveResult, int64_t liveLatencyNs);
+
+    // False if the candidate configuration failed to initialize (nothing is evaluated)
+    bool isReady() const { return candidate_.isInitialized(); }
+
+    Stats stats() const;
+
+private:
+    // Copy of an offered frame and the live tracker's answer for it
+    struct Sample {
+        ImageView frame;
+        std::vector<uint8_t> planes[2];
+        int64_t timestampNs = 0;
+        bool liveHasFace = false;
+        std::vector<Landmark> liveLandmarks;
+        HeadPose livePose{};
+        int64_t liveLatencyNs = 0;
+    };
+
+    static void copyFrame(const ImageView& frame, Sample& sample);
+    void run();
+    void evaluate(const Sample& sample);
+
+    Options options_;
+    FaceTracker candidate_;
+
+    // Live thread only
+    float sampleCredit_ = 0.0f;
+
+    std::mutex slotMutex_;             // Never waited on by offer()
+    std::condition_variable slotFilled_;
+    Sample slot_;
+    bool slotFull_ = false;
+    bool stopping_ = false;
+    Sample working_;                   // Candidate thread only
+
+    std::atomic<uint64_t> offered_{0};
+    std::atomic<uint64_t> sampled_{0};
+    std::atomic<uint64_t> dropped_{0};
+
+    // Comparison totals; candidate thread and stats()
+    mutable std::mutex statsMutex_;
+    uint64_t evaluated_ = 0;
+    uint64_t faceAgreements_ = 0;
+    uint64_t liveOnly_ = 0;
+    uint64_t candidateOnly_ = 0;
+    uint64_t compared_ = 0;            // Frames where both found a face
+    double landmarkErrorSum_ = 0.0;
+    double maxLandmarkError_ = 0.0;
+    double poseErrorSum_ = 0.0;
+    double liveLatencySumNs_ = 0.0;
+    double candidateLatencySumNs_ = 0.0;
+    std::vector<int64_t> liveLatencyNs_;       // Ring of the latency window
+    std::vector<int64_t> candidateLatencyNs_;
+    size_t latencyNext_ = 0;
+
+    std::thread thread_;
+};
+
+} // namespace AnonCam
+
+#endif /* AnonCam_ShadowEvaluator_h */
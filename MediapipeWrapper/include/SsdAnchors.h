@@ -0,0 +1,96 @@
+#ifndef AnonCam_SsdAnchors_h
+#define AnonCam_SsdAnchors_h
+
+#include <array>
+
+namespace AnonCam {
+
+/**
+ * SsdAnchorSpec - anchor layout of an SSD face detector
+ *
+ * Mirrors the subset of MediaPipe's SsdAnchorsCalculatorOptions used by the
+ * BlazeFace graphs: fixed anchor size (every anchor is 1 x 1, only centers
+ * differ) and consecutive layers with the same stride merged into one
+ * feature map.
+ */
+struct SsdAnchorSpec {
+    int inputWidth;
+    int inputHeight;
+    int layerCount;
+    int strides[8];
+    float anchorOffsetX;
+    float anchorOffsetY;
+    int anchorsPerLayer;   // Aspect ratios plus the interpolated scale
+};
+
+// face_detection_short_range: 128x128 input, 896 anchors
+inline constexpr SsdAnchorSpec kBlazeFaceShortRange{128, 128, 4, {8, 16, 16, 16}, 0.5f, 0.5f, 2};
+
+// face_detection_full_range: 192x192 input, 2304 anchors
+inline constexpr SsdAnchorSpec kBlazeFaceFullRange{192, 192, 1, {4}, 0.5f, 0.5f, 1};
+
+constexpr int ssdFeatureMapSize(int inputSize, int stride) {
+    return (inputSize + stride - 1) / stride;
+}
+
+constexpr int ssdAnchorCount(const SsdAnchorSpec& spec) {
+    int count = 0;
+    int layer = 0;
+    while (layer < spec.layerCount) {
+        int last = layer;
+        while (last + 1 < spec.layerCount && spec.strides[last + 1] == spec.strides[layer]) {
+            ++last;
+        }
+        count += ssdFeatureMapSize(spec.inputWidth, spec.strides[layer]) *
+                 ssdFeatureMapSize(spec.inputHeight, spec.strides[layer]) * (last - layer + 1) *
+                 spec.anchorsPerLayer;
+        layer = last + 1;
+    }
+    return count;
+}
+
+// Anchor centers in normalized input coordinates, in model output order
+template <int Count>
+struct SsdAnchorTable {
+    static constexpr int kCount = Count;
+    std::array<float, Count> x{};
+    std::array<float, Count> y{};
+};
+
+template <const SsdAnchorSpec& Spec>
+constexpr SsdAnchorTable<ssdAnchorCount(Spec)> makeSsdAnchors() {
+    SsdAnchorTable<ssdAnchorCount(Spec)> table;
+    int index = 0;
+    int layer = 0;
+    while (layer < Spec.layerCount) {
+        int last = layer;
+        while (last + 1 < Spec.layerCount && Spec.strides[last + 1] == Spec.strides[layer]) {
+            ++last;
+        }
+        const int width = ssdFeatureMapSize(Spec.inputWidth, Spec.strides[layer]);
+        const int height = ssdFeatureMapSize(Spec.inputHeight, Spec.strides[layer]);
+        const int perCell = (last - layer + 1) * Spec.anchorsPerLayer;
+        for (int y = 0; y < height; ++y) {
+            for (int x = 0; x < width; ++x) {
+                for (int a = 0; a < perCell; ++a) {
+                    table.x[index] = (x + Spec.anchorOffsetX) / width;
+                    table.y[index] = (y + Spec.anchorOffsetY) / height;
+                    ++index;
+                }
+            }
+        }
+        layer = last + 1;
+    }
+    return table;
+}
+
+// Generated at compile time; no anchor math at startup
+template <const SsdAnchorSpec& Spec>
+inline constexpr auto kSsdAnchors = makeSsdAnchors<Spec>();
+
+static_assert(ssdAnchorCount(kBlazeFaceShortRange) == 896, "BlazeFace short-range has 896 anchors");
+static_assert(ssdAnchorCount(kBlazeFaceFullRange) == 2304, "BlazeFace full-range has 2304 anchors");
+
+} // namespace AnonCam
+
+#endif /* AnonCam_SsdAnchors_h */
@@ -0,0 +1,78 @@
+#ifndef AnonCam_SsdDecoder_h
+#define AnonCam_SsdDecoder_h
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "FaceDetector.h"
+#include "SsdAnchors.h"
+
+namespace AnonCam {
+
+/**
+ * SsdDecoder - turns raw SSD detector tensors into face candidates
+ *
+ * Equivalent to MediaPipe's TensorsToDetectionsCalculator for BlazeFace
+ * (fixed-size anchors, clipped sigmoid scores), in three passes:
+ *
+ *   1. clip the logits and compare them with logit(minScore) four at a time,
+ *      compacting the surviving anchor indices (sigmoid is monotonic, so
+ *      nothing is lost by thresholding before it)
+ *   2. vectorized sigmoid over the survivors only
+ *   3. box and keypoint decoding of the survivors into the caller's buffer
+ *
+ * No allocation after construction. Not thread-safe (scratch buffers).
+ */
+class SsdDecoder {
+public:
+    struct Options {
+        float minScore = 0.5f;      // Candidates below are dropped
+        float scoreClip = 100.0f;   // Logits are clamped to [-scoreClip, scoreClip]
+        int keypointCount = 6;      // Keypoints per anchor (BlazeFace: 6)
+    };
+
+    /**
+     * @param anchorX Anchor centers (normalized); must outlive the decoder
+     * @param inputWidth Model input size; raw offsets are in input pixels
+     */
+    SsdDecoder(const float* anchorX, const float* anchorY, int anchorCount, int inputWidth, int inputHeight,
+               const Options& options);
+
+    // Decoder for a compile-time anchor table (kSsdAnchors<Spec>)
+    template <const SsdAnchorSpec& Spec>
+    static SsdDecoder forSpec(const Options& options) {
+        return SsdDecoder(kSsdAnchors<Spec>.x.data(), kSsdAnchors<Spec>.y.data(), ssdAnchorCount(Spec),
+                          Spec.inputWidth, Spec.inputHeight, options);
+    }
+
+    /**
+     * Decode one inference
+     * @param boxes anchorCount x (4 + 2 * keypointCount) raw regressors
+     * @param logits anchorCount raw scores
+     * @param candidates Output buffer, in anchor order; coordinates are
+     *                   normalized to the model input
+     * @return Candidates written (at most capacity; the highest-indexed
+     *         survivors are dropped when the buffer is full)
+     */
+    int decode(const float* boxes, const float* logits, Detection* candidates, int capacity);
+
+    int anchorCount() const { return anchorCount_; }
+    int valuesPerAnchor() const { return 4 + 2 * options_.keypointCount; }
+
+private:
+    const float* anchorX_;
+    const float* anchorY_;
+    int anchorCount_;
+    float inverseWidth_;
+    float inverseHeight_;
+    float logitThreshold_;
+    Options options_;
+
+    std::vector<int> indices_;    // Surviving anchors
+    std::vector<float> scores_;   // Their clipped logits, then sigmoid scores
+};
+
+} // namespace AnonCam
+
+#endif /* AnonCam_SsdDecoder_h */
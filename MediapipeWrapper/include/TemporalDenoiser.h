@@ -0,0 +1,96 @@
+#ifndef AnonCam_TemporalDenoiser_h
+#define AnonCam_TemporalDenoiser_h
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#include "BufferPool.h"
+#include "Cancellation.h"
+#include "ImageView.h"
+
+namespace AnonCam {
+
+class WorkerPool;
+
+// A denoised frame in a pooled buffer; the view stays valid while `buffer` is held
+struct DenoisedFrame {
+    std::shared_ptr<const PooledBuffer> buffer;
+    ImageView view;
+
+    bool isValid() const { return buffer != nullptr; }
+};
+
+/**
+ * TemporalDenoiser - motion-adaptive recursive filter for low-light frames
+ *
+ * Every sample moves from the previous output towards the new frame by a
+ * weight that grows with the per-sample change: sensor noise (small
+ * changes) is averaged over several frames while real motion (changes
+ * beyond motionThreshold) passes through without ghosting. Luma and the
+ * NV12 CbCr plane are filtered independently; BGRA is filtered per byte.
+ *
+ * The frame is processed in row bands on an optional WorkerPool. The
+ * previous output is kept by reference in the frame pool, so nothing is
+ * allocated per frame. Not thread-safe.
+ */
+class TemporalDenoiser {
+public:
+    struct Options {
+        float strength = 0.75f;        // Share of the previous frame kept where nothing moved [0, 1)
+        int motionThreshold = 32;      // Per-sample change (levels) from which the new frame is taken as is
+        bool denoiseChroma = true;     // Also filter the NV12 CbCr plane
+        int tileRows = 64;             // Luma rows per work item
+        size_t maxFramesInFlight = 3;  // Pool size: previous output, the one being written, one downstream
+
+        bool operator==(const Options&) const = default;
+    };
+
+    struct Stats {
+        uint64_t frames = 0;
+        uint64_t resets = 0;           // Frames passed through (first frame, format or size change)
+        int64_t lastProcessNs = 0;
+    };
+
+    TemporalDenoiser();
+    explicit TemporalDenoiser(const Options& options, WorkerPool* workers = nullptr);
+
+    /**
+     * Denoise one frame (Gray8, NV12 or BGRA)
+     * @param output Denoised frame in the source format; kept as the next reference
+     * @param cancel Checked per band; a cancelled frame is dropped and the reference kept
+     * @return false if the frame is invalid, no pooled buffer was free or the call was cancelled
+     */
+    bool process(const ImageView& frame, DenoisedFrame& output, const CancellationToken& cancel = {});
+
+    /**
+     * Forget the previous frame (next frame passes through)
+     */
+    void reset();
+
+    const Stats& stats() const { return stats_; }
+
+private:
+    void configure(const ImageView& frame);
+    void filterBand(const ImageView& frame, uint8_t* dst, bool passThrough, int band) const;
+
+    Options options_;
+    WorkerPool* workers_;
+    int baseWeight_;                   // Weight of the new frame where nothing moved, of 128
+    int motionGain_;                   // Extra weight per level of change, of 128
+
+    PixelFormat format_ = PixelFormat::Gray8;
+    int width_ = 0;
+    int height_ = 0;
+    size_t rowBytes_[2] = {0, 0};      // Packed row sizes of the pooled planes
+    int planeRows_[2] = {0, 0};
+    size_t planeOffset_ = 0;           // Start of plane 1 in the pooled buffer
+
+    std::unique_ptr<BufferPool> pool_;
+    std::shared_ptr<const PooledBuffer> previous_;
+    Stats stats_;
+};
+
+} // namespace AnonCam
+
+#endif /* AnonCam_TemporalDenoiser_h */
@@ -0,0 +1,75 @@
+#ifndef AnonCam_TrackLossPolicy_h
+#define AnonCam_TrackLossPolicy_h
+
+#include <cstddef>
+#include <cstdint>
+
+namespace AnonCam {
+
+struct Landmark;
+
+// What the compositor must anonymize in a frame
+enum class AnonymizationMode : uint32_t {
+    None = 0,       // Nothing (fail-closed handling disabled and no face)
+    Face = 1,       // Tracked face: its landmarks / segmentation mask
+    Region = 2,     // Track lost: the held region
+    FullFrame = 3,  // Hold expired without re-acquisition: the whole frame
+};
+
+struct Anonymization {
+    AnonymizationMode mode = AnonymizationMode::None;
+    float region[4] = {0.0f, 0.0f, 0.0f, 0.0f};   // Normalized x0, y0, x1, y1 (Face, Region)
+};
+
+/**
+ * TrackLossPolicy - keeps the face anonymized when tracking drops out
+ *
+ * A single missed frame would otherwise show the face unmasked. While a
+ * face is tracked the policy follows its landmark bounds and their
+ * velocity. When the track is lost it holds the last region, moved along
+ * the predicted motion and grown by the distance the face could have
+ * covered since, for holdMs; if the face is not re-acquired by then, the
+ * whole frame is anonymized until it is. With failClosedAtStart the frame
+ * is also anonymized before the first face is found.
+ *
+ * Needs no inference: constant work per frame on top of one pass over the
+ * landmarks. Not thread-safe; owned by one FaceTracker.
+ */
+class TrackLossPolicy {
+public:
+    struct Options {
+        int holdMs = 500;              // Region held after the track is lost
+        float margin = 0.15f;          // Padding around the landmark bounds, share of the face size
+        float growthPerSecond = 0.5f;  // Held region growth beyond the predicted motion, face sizes per second
+        float velocitySmoothing = 0.5f;  // Weight of the newest frame in the velocity estimate
+        bool failClosedAtStart = true; // Anonymize the whole frame until the first face
+
+        bool operator==(const Options&) const = default;
+    };
+
+    TrackLossPolicy();
+    explicit TrackLossPolicy(const Options& options);
+
+    /**
+     * Decide the anonymization of a frame from its tracking result
+     * @param landmarks Normalized landmarks (ignored when hasFace is false)
+     */
+    Anonymization update(bool hasFace, const Landmark* landmarks, size_t count, int64_t timestampNs);
+
+    /**
+     * Forget the track (camera restart); the next frame without a face
+     * falls back per failClosedAtStart
+     */
+    void reset();
+
+private:
+    Options options_;
+    bool seen_ = false;                // A face was tracked since the last reset
+    int64_t lastSeenNs_ = 0;
+    float box_[4] = {};                // Last tracked bounds with margin
+    float velocity_[2] = {};           // Normalized units per second
+};
+
+} // namespace AnonCam
+
+#endif /* AnonCam_TrackLossPolicy_h */
@@ -0,0 +1,67 @@
+#ifndef AnonCam_WorkerPool_h
+#define AnonCam_WorkerPool_h
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace AnonCam {
+
+/**
+ * WorkerPool - fixed set of threads for tiled per-frame stages
+ *
+ * parallelFor() splits a stage into independent work items (row bands,
+ * tiles) and runs them on the workers and the calling thread; it returns
+ * once every item has finished. Items are claimed from a shared counter, so
+ * uneven tiles balance themselves. With no worker threads everything runs
+ * inline on the caller.
+ *
+ * Thread-safe; concurrent parallelFor() calls are serialized.
+ */
+class WorkerPool {
+public:
+    /**
+     * @param threadCount Background threads (0 = run inline)
+     */
+    explicit WorkerPool(int threadCount);
+    ~WorkerPool();
+
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    /**
+     * Run task(0) .. task(count - 1) and wait for all of them
+     * @param task Must not throw; items may run in any order and concurrently
+     */
+    void parallelFor(int count, const std::function<void(int)>& task);
+
+    int threadCount() const { return static_cast<int>(threads_.size()); }
+
+    // Worker threads that leave one core to the caller (capped for frame-sized work)
+    static int defaultThreadCount();
+
+private:
+    void workerLoop();
+    void runItems();
+
+    std::vector<std::thread> threads_;
+    std::mutex callerMutex_;  // One parallelFor() at a time
+
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    std::condition_variable done_;
+    const std::function<void(int)>* task_ = nullptr;
+    int count_ = 0;
+    std::atomic<int> next_{0};
+    int busy_ = 0;            // Workers inside the current job
+    uint64_t generation_ = 0;
+    bool stopping_ = false;
+};
+
+} // namespace AnonCam
+
+#endif /* AnonCam_WorkerPool_h */
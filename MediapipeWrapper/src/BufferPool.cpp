@@ -0,0 +1,171 @@
+#include "BufferPool.h"
+
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+namespace {
+
+constexpr size_t kAlignment = 64;
+// Room for a shared_ptr control block with its deleter and allocator
+constexpr size_t kBlockBytes = 128;
+
+} // anonymous namespace
+
+namespace AnonCam {
+
+PooledBuffer::PooledBuffer(size_t size)
+    : data_(nullptr), size_(size) {
+    // aligned_alloc requires the size to be a multiple of the alignment
+    const size_t rounded = (size + kAlignment - 1) / kAlignment * kAlignment;
+    data_ = static_cast<uint8_t*>(std::aligned_alloc(kAlignment, rounded > 0 ? rounded : kAlignment));
+    if (!data_) {
+        throw std::bad_alloc();
+    }
+}
+
+PooledBuffer::~PooledBuffer() {
+    std::free(data_);
+}
+
+// ============================================================================
+// Pool state, shared by the pool and its outstanding buffers
+// ============================================================================
+
+struct BufferPool::State {
+    // Storage for one shared_ptr control block (buffer pointer, counts,
+    // Recycler and BlockAllocator)
+    struct alignas(std::max_align_t) Block {
+        unsigned char bytes[kBlockBytes];
+    };
+
+    State(size_t bufferSize, size_t maxBuffers)
+        : bufferSize(bufferSize), maxBuffers(maxBuffers) {
+        free.reserve(maxBuffers);
+    }
+
+    void* takeBlock() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (!freeBlocks.empty()) {
+                void* block = freeBlocks.back();
+                freeBlocks.pop_back();
+                return block;
+            }
+        }
+        auto block = std::make_unique<Block>();
+        void* storage = block.get();
+        std::lock_guard<std::mutex> lock(mutex);
+        // Reserved here so returning a block never allocates
+        freeBlocks.reserve(blocks.size() + 1);
+        blocks.push_back(std::move(block));
+        return storage;
+    }
+
+    void returnBlock(void* block) {
+        std::lock_guard<std::mutex> lock(mutex);
+        freeBlocks.push_back(block);
+    }
+
+    const size_t bufferSize;
+    const size_t maxBuffers;
+
+    std::mutex mutex;
+    std::vector<std::unique_ptr<PooledBuffer>> free;  // Released buffers
+    size_t allocated = 0;                             // Buffers created
+    std::vector<std::unique_ptr<Block>> blocks;       // Control blocks created
+    std::vector<void*> freeBlocks;                    // Released control blocks
+};
+
+// Deleter: the last reference returns the buffer to the free list
+struct BufferPool::Recycler {
+    void operator()(PooledBuffer* buffer) const {
+        // Cannot allocate: free has room for every buffer ever created
+        std::lock_guard<std::mutex> lock(state->mutex);
+        state->free.emplace_back(buffer);
+    }
+
+    std::shared_ptr<State> state;
+};
+
+// Places the control block in a recycled State::Block
+template <typename T>
+struct BufferPool::BlockAllocator {
+    using value_type = T;
+
+    explicit BlockAllocator(std::shared_ptr<State> state)
+        : state(std::move(state)) {}
+
+    template <typename U>
+    BlockAllocator(const BlockAllocator<U>& other)
+        : state(other.state) {}
+
+    T* allocate(size_t count) {
+        static_assert(sizeof(T) <= kBlockBytes && alignof(T) <= alignof(std::max_align_t),
+                      "control block does not fit State::Block");
+        if (count != 1) {
+            return std::allocator<T>().allocate(count);
+        }
+        return static_cast<T*>(state->takeBlock());
+    }
+
+    void deallocate(T* block, size_t count) {
+        if (count != 1) {
+            std::allocator<T>().deallocate(block, count);
+            return;
+        }
+        state->returnBlock(block);
+    }
+
+    template <typename U>
+    bool operator==(const BlockAllocator<U>& other) const { return state == other.state; }
+    template <typename U>
+    bool operator!=(const BlockAllocator<U>& other) const { return state != other.state; }
+
+    std::shared_ptr<State> state;
+};
+
+// ============================================================================
+// BufferPool
+// ============================================================================
+
+BufferPool::BufferPool(size_t bufferSize, size_t maxBuffers)
+    : state_(std::make_shared<State>(bufferSize, maxBuffers)) {}
+
+std::shared_ptr<PooledBuffer> BufferPool::acquire() {
+    std::unique_ptr<PooledBuffer> buffer;
+    {
+        std::lock_guard<std::mutex> lock(state_->mutex);
+        if (!state_->free.empty()) {
+            buffer = std::move(state_->free.back());
+            state_->free.pop_back();
+        } else if (state_->allocated < state_->maxBuffers) {
+            ++state_->allocated;
+        } else {
+            return nullptr;
+        }
+    }
+
+    if (!buffer) {
+        try {
+            buffer = std::make_unique<PooledBuffer>(state_->bufferSize);
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(state_->mutex);
+            --state_->allocated;
+            throw;
+        }
+    }
+    // Should the control block fail to allocate, the Recycler takes the buffer back
+    return std::shared_ptr<PooledBuffer>(buffer.release(), Recycler{state_}, BlockAllocator<PooledBuffer>(state_));
+}
+
+size_t BufferPool::bufferSize() const {
+    return state_->bufferSize;
+}
+
+size_t BufferPool::allocatedCount() const {
+    std::lock_guard<std::mutex> lock(state_->mutex);
+    return state_->allocated;
+}
+
+} // namespace AnonCam
@@ -0,0 +1,453 @@
+#include "CaptureFile.h"
+#include "LandmarkCodec.h"
+#include "Logger.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+constexpr size_t alignUp8(size_t value) {
+    return (value + 7) & ~static_cast<size_t>(7);
+}
+
+// BT.601 luma from packed BGRA, 8-bit fixed point
+inline uint8_t lumaFromBGRA(const uint8_t* px) {
+    return static_cast<uint8_t>((29 * px[0] + 150 * px[1] + 77 * px[2]) >> 8);
+}
+
+} // anonymous namespace
+
+namespace AnonCam {
+
+// ============================================================================
+// CaptureWriter
+// ============================================================================
+
+CaptureWriter::~CaptureWriter() {
+    close();
+}
+
+bool CaptureWriter::open(const std::string& path) {
+    return open(path, Options());
+}
+
+bool CaptureWriter::open(const std::string& path, const Options& options) {
+    close();
+
+    file_ = std::fopen(path.c_str(), "wb");
+    if (!file_) {
+        return false;
+    }
+
+    options_ = options;
+    options_.frameDownscale = std::max(0, options.frameDownscale);
+    position_ = 0;
+    firstTimestampNs_ = 0;
+    offsets_.clear();
+
+    // Placeholder header, rewritten by close()
+    CaptureFileHeader header{};
+    header.magic = kCaptureMagic;
+    header.version = kCaptureVersion;
+    header.headerSize = sizeof(CaptureFileHeader);
+    return write(&header, sizeof(header));
+}
+
+bool CaptureWriter::write(const void* data, size_t size) {
+    if (!file_) {
+        return false;
+    }
+    if (size > 0 && std::fwrite(data, 1, size, file_) != size) {
+        std::fclose(file_);
+        file_ = nullptr;
+        return false;
+    }
+    position_ += size;
+    return true;
+}
+
+void CaptureWriter::downscaleLuma(const ImageView& frame, int divisor, std::vector<uint8_t>& out,
+                                  int& outWidth, int& outHeight) {
+    const int d = divisor;
+    outWidth = frame.width / d;
+    outHeight = frame.height / d;
+    const size_t outStride = alignUp8(static_cast<size_t>(outWidth));
+    out.assign(outStride * outHeight, 0);
+
+    const int area = d * d;
+    const bool packed = frame.format == PixelFormat::BGRA;
+
+    for (int oy = 0; oy < outHeight; ++oy) {
+        uint8_t* dst = out.data() + oy * outStride;
+        for (int ox = 0; ox < outWidth; ++ox) {
+            int sum = 0;
+            for (int dy = 0; dy < d; ++dy) {
+                const uint8_t* src = frame.row(0, oy * d + dy);
+                for (int dx = 0; dx < d; ++dx) {
+                    const int x = ox * d + dx;
+                    sum += packed ? lumaFromBGRA(src + x * 4) : src[x];
+                }
+            }
+            dst[ox] = static_cast<uint8_t>((sum + area / 2) / area);
+        }
+    }
+}
+
+bool CaptureWriter::append(int64_t timestampNs, const ImageView* frame, const FaceResult& result) {
+    if (!file_) {
+        return false;
+    }
+
+    if (options_.frameDownscale > 0 && frame && frame->isValid()) {
+        int width = 0;
+        int height = 0;
+        downscaleLuma(*frame, options_.frameDownscale, frameScratch_, width, height);
+        const ImageView scaled = ImageView::gray(frameScratch_.data(), width, height, alignUp8(width));
+        return appendDownscaled(timestampNs, &scaled, result);
+    }
+    return appendDownscaled(timestampNs, nullptr, result);
+}
+
+bool CaptureWriter::appendDownscaled(int64_t timestampNs, const ImageView* frame, const FaceResult& result) {
+    if (!file_) {
+        return false;
+    }
+
+    if (offsets_.empty()) {
+        firstTimestampNs_ = timestampNs;
+    }
+
+    // Half-precision results are widened so every capture stores one format
+    const std::vector<Landmark>* landmarks = &result.landmarks;
+    if (landmarks->empty() && !result.landmarksHalf.empty()) {
+        widenedScratch_.resize(result.landmarksHalf.size());
+        convertLandmarksFromHalf(result.landmarksHalf.data(), result.landmarksHalf.size(), widenedScratch_.data());
+        landmarks = &widenedScratch_;
+    }
+
+    CaptureRecordHeader record{};
+    record.timestampNs = timestampNs;
+    record.landmarkCount = static_cast<uint32_t>(landmarks->size());
+    record.hasFace = result.hasFace ? 1 : 0;
+    record.confidence = result.confidence;
+    record.pose = result.pose;
+    record.keyPoints = result.keyPoints;
+
+    const bool storeFrame = options_.frameDownscale > 0 && frame && frame->isValid();
+    const size_t frameStride = storeFrame ? alignUp8(static_cast<size_t>(frame->width)) : 0;
+    if (storeFrame) {
+        record.frameWidth = static_cast<uint32_t>(frame->width);
+        record.frameHeight = static_cast<uint32_t>(frame->height);
+        record.frameBytesPerRow = static_cast<uint32_t>(frameStride);
+    }
+
+    const void* landmarkData = landmarks->data();
+    size_t landmarkBytes = landmarks->size() * sizeof(Landmark);
+    if (options_.quantizeLandmarks) {
+        landmarkScratch_.resize(landmarks->size() * 3);
+        if (!landmarks->empty()) {
+            quantizeLandmarks(landmarks->data(), landmarks->size(), landmarkScratch_.data());
+        }
+        landmarkData = landmarkScratch_.data();
+        landmarkBytes = landmarkScratch_.size() * sizeof(uint16_t);
+    }
+    record.landmarkBytes = static_cast<uint32_t>(landmarkBytes);
+
+    offsets_.push_back(position_);
+
+    static const uint8_t kPadding[8] = {};
+    if (!write(&record, sizeof(record)) ||
+        !write(landmarkData, landmarkBytes) ||
+        !write(kPadding, alignUp8(landmarkBytes) - landmarkBytes)) {
+        return false;
+    }
+    if (!storeFrame) {
+        return true;
+    }
+    if (frame->bytesPerRow[0] == frameStride) {
+        return write(frame->planes[0], frameStride * frame->height);
+    }
+    for (int y = 0; y < frame->height; ++y) {
+        if (!write(frame->row(0, y), frame->width) ||
+            !write(kPadding, frameStride - frame->width)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool CaptureWriter::close() {
+    if (!file_) {
+        return false;
+    }
+
+    const uint64_t indexOffset = position_;
+    bool ok = write(offsets_.data(), offsets_.size() * sizeof(uint64_t));
+
+    if (ok) {
+        CaptureFileHeader header{};
+        header.magic = kCaptureMagic;
+        header.version = kCaptureVersion;
+        header.headerSize = sizeof(CaptureFileHeader);
+        header.flags = options_.quantizeLandmarks ? kCaptureFlagQuantizedLandmarks : 0;
+        header.frameDownscale = static_cast<uint32_t>(options_.frameDownscale);
+        header.recordCount = offsets_.size();
+        header.indexOffset = indexOffset;
+        header.firstTimestampNs = firstTimestampNs_;
+
+        ok = std::fseek(file_, 0, SEEK_SET) == 0 &&
+             std::fwrite(&header, 1, sizeof(header), file_) == sizeof(header);
+    }
+
+    if (file_) {
+        ok = (std::fclose(file_) == 0) && ok;
+        file_ = nullptr;
+    }
+    offsets_.clear();
+    return ok;
+}
+
+// ============================================================================
+// CaptureRecorder
+// ============================================================================
+
+CaptureRecorder::~CaptureRecorder() {
+    close();
+}
+
+bool CaptureRecorder::open(const std::string& path, const Options& options) {
+    close();
+    if (!writer_.open(path, options.writer)) {
+        return false;
+    }
+
+    frameDownscale_ = std::max(0, options.writer.frameDownscale);
+    const int capacity = std::max(1, options.queueCapacity);
+    slots_ = std::vector<Slot>(capacity);
+    free_.clear();
+    for (int i = capacity - 1; i >= 0; --i) {
+        free_.push_back(i);
+    }
+    queued_.assign(capacity, 0);
+    queuedHead_ = 0;
+    queuedCount_ = 0;
+    stopping_ = false;
+    stats_ = Stats();
+    thread_ = std::thread([this] { writerLoop(); });
+    return true;
+}
+
+bool CaptureRecorder::append(int64_t timestampNs, const ImageView* frame, const FaceResult& result) {
+    int index = 0;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!thread_.joinable() || stats_.failed) {
+            return false;
+        }
+        if (free_.empty()) {
+            ++stats_.dropped;
+            return false;
+        }
+        index = free_.back();
+        free_.pop_back();
+    }
+
+    // The slot belongs to this thread until it is queued
+    Slot& slot = slots_[index];
+    slot.timestampNs = timestampNs;
+    slot.frameWidth = 0;
+    slot.frameHeight = 0;
+    if (frameDownscale_ > 0 && frame && frame->isValid()) {
+        CaptureWriter::downscaleLuma(*frame, frameDownscale_, slot.frame, slot.frameWidth, slot.frameHeight);
+    }
+    slot.result.hasFace = result.hasFace;
+    slot.result.confidence = result.confidence;
+    slot.result.timestampNs = result.timestampNs;
+    slot.result.pose = result.pose;
+    slot.result.keyPoints = result.keyPoints;
+    slot.result.landmarks.assign(result.landmarks.begin(), result.landmarks.end());
+    slot.result.landmarksHalf.assign(result.landmarksHalf.begin(), result.landmarksHalf.end());
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        queued_[(queuedHead_ + queuedCount_) % queued_.size()] = index;
+        ++queuedCount_;
+    }
+    wake_.notify_one();
+    return true;
+}
+
+void CaptureRecorder::writerLoop() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    for (;;) {
+        wake_.wait(lock, [&] { return queuedCount_ > 0 || stopping_; });
+        if (queuedCount_ == 0) {
+            return;
+        }
+        const int index = queued_[queuedHead_];
+        queuedHead_ = (queuedHead_ + 1) % queued_.size();
+        --queuedCount_;
+        const bool failed = stats_.failed;
+        lock.unlock();
+
+        const Slot& slot = slots_[index];
+        bool written = false;
+        if (!failed) {
+            const ImageView frame = ImageView::gray(slot.frame.data(), slot.frameWidth, slot.frameHeight,
+                                                    alignUp8(static_cast<size_t>(slot.frameWidth)));
+            written = writer_.appendDownscaled(slot.timestampNs, slot.frameWidth > 0 ? &frame : nullptr,
+                                               slot.result);
+            if (!written) {
+                ACM_LOG(Error, "capture write failed at {} ns, recording stopped", slot.timestampNs);
+            }
+        }
+
+        lock.lock();
+        if (written) {
+            ++stats_.written;
+        } else {
+            stats_.failed = true;
+        }
+        free_.push_back(index);
+    }
+}
+
+bool CaptureRecorder::close() {
+    if (!thread_.joinable()) {
+        return false;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    wake_.notify_one();
+    thread_.join();
+
+    const bool ok = writer_.close() && !stats_.failed;
+    slots_.clear();
+    return ok;
+}
+
+CaptureRecorder::Stats CaptureRecorder::stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
+
+// ============================================================================
+// CaptureReader
+// ============================================================================
+
+CaptureReader::~CaptureReader() {
+    close();
+}
+
+bool CaptureReader::open(const std::string& path) {
+    close();
+
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+
+    struct stat st {};
+    if (::fstat(fd, &st) != 0 || st.st_size < static_cast<off_t>(sizeof(CaptureFileHeader))) {
+        ::close(fd);
+        return false;
+    }
+
+    const size_t size = static_cast<size_t>(st.st_size);
+    void* mapping = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (mapping == MAP_FAILED) {
+        return false;
+    }
+
+    base_ = static_cast<const uint8_t*>(mapping);
+    size_ = size;
+
+    const auto* header = reinterpret_cast<const CaptureFileHeader*>(base_);
+    const bool valid = header->magic == kCaptureMagic &&
+                       header->version == kCaptureVersion &&
+                       header->headerSize == sizeof(CaptureFileHeader) &&
+                       header->indexOffset >= sizeof(CaptureFileHeader) &&
+                       header->indexOffset % 8 == 0 &&
+                       header->indexOffset <= size_ &&
+                       header->recordCount <= (size_ - header->indexOffset) / sizeof(uint64_t);
+    if (!valid) {
+        close();
+        return false;
+    }
+
+    recordCount_ = static_cast<size_t>(header->recordCount);
+    frameDownscale_ = static_cast<int>(header->frameDownscale);
+    quantizedLandmarks_ = (header->flags & kCaptureFlagQuantizedLandmarks) != 0;
+    offsets_ = reinterpret_cast<const uint64_t*>(base_ + header->indexOffset);
+    return true;
+}
+
+void CaptureReader::close() {
+    if (base_) {
+        ::munmap(const_cast<uint8_t*>(base_), size_);
+    }
+    base_ = nullptr;
+    size_ = 0;
+    recordCount_ = 0;
+    frameDownscale_ = 0;
+    quantizedLandmarks_ = false;
+    offsets_ = nullptr;
+}
+
+bool CaptureReader::read(size_t index, CaptureRecord& record) const {
+    if (!base_ || index >= recordCount_) {
+        return false;
+    }
+
+    const uint64_t offset = offsets_[index];
+    if (offset % 8 != 0 || offset > size_ || size_ - offset < sizeof(CaptureRecordHeader)) {
+        return false;
+    }
+
+    const auto* header = reinterpret_cast<const CaptureRecordHeader*>(base_ + offset);
+    const size_t landmarkBytes = static_cast<size_t>(header->landmarkCount) *
+                                 (quantizedLandmarks_ ? 3 * sizeof(uint16_t) : sizeof(Landmark));
+    const size_t frameBytes = static_cast<size_t>(header->frameHeight) * header->frameBytesPerRow;
+    const size_t payload = alignUp8(landmarkBytes) + frameBytes;
+    if (header->landmarkBytes != landmarkBytes || header->frameBytesPerRow < header->frameWidth ||
+        size_ - offset - sizeof(CaptureRecordHeader) < payload) {
+        return false;
+    }
+
+    const uint8_t* cursor = base_ + offset + sizeof(CaptureRecordHeader);
+
+    record.timestampNs = header->timestampNs;
+    record.result.hasFace = header->hasFace != 0;
+    record.result.confidence = header->confidence;
+    record.result.timestampNs = header->timestampNs;
+    record.result.pose = header->pose;
+    record.result.keyPoints = header->keyPoints;
+    record.result.landmarks.resize(header->landmarkCount);
+    if (quantizedLandmarks_) {
+        if (header->landmarkCount > 0) {
+            dequantizeLandmarks(reinterpret_cast<const uint16_t*>(cursor), header->landmarkCount,
+                                record.result.landmarks.data());
+        }
+    } else {
+        std::memcpy(record.result.landmarks.data(), cursor, landmarkBytes);
+    }
+    cursor += alignUp8(landmarkBytes);
+
+    if (header->frameWidth > 0 && header->frameHeight > 0) {
+        record.frame = ImageView::gray(cursor, static_cast<int>(header->frameWidth),
+                                       static_cast<int>(header->frameHeight), header->frameBytesPerRow);
+    } else {
+        record.frame = ImageView{};
+    }
+    return true;
+}
+
+} // namespace AnonCam
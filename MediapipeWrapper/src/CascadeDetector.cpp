@@ -0,0 +1,1144 @@
+#include "CascadeDetector.h"
+#include "Simd.h"
+#include "WorkerPool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <numeric>
+#include <sstream>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <unordered_map>
+
+namespace {
+
+// ============================================================================
+// Minimal XML reader for OpenCV cascade files (elements and text only)
+// ============================================================================
+
+struct XmlNode {
+    std::string name;
+    std::string text;
+    std::vector<XmlNode> children;
+
+    const XmlNode* child(const char* childName) const {
+        for (const auto& node : children) {
+            if (node.name == childName) {
+                return &node;
+            }
+        }
+        return nullptr;
+    }
+
+    std::string trimmedText() const {
+        const size_t begin = text.find_first_not_of(" \t\r\n");
+        if (begin == std::string::npos) {
+            return std::string();
+        }
+        return text.substr(begin, text.find_last_not_of(" \t\r\n") - begin + 1);
+    }
+};
+
+constexpr int kMaxXmlDepth = 32;
+
+// pos is at the '<' of a start tag
+bool parseElement(const std::string& xml, size_t& pos, XmlNode& node, int depth) {
+    const size_t end = xml.find('>', pos);
+    if (end == std::string::npos || depth > kMaxXmlDepth) {
+        return false;
+    }
+    std::string tag = xml.substr(pos + 1, end - pos - 1);
+    const bool selfClosing = !tag.empty() && tag.back() == '/';
+    if (selfClosing) {
+        tag.pop_back();
+    }
+    node.name = tag.substr(0, tag.find_first_of(" \t\r\n"));
+    pos = end + 1;
+    if (selfClosing) {
+        return true;
+    }
+
+    while (pos < xml.size()) {
+        const size_t open = xml.find('<', pos);
+        if (open == std::string::npos) {
+            return false;
+        }
+        node.text.append(xml, pos, open - pos);
+        pos = open;
+
+        if (xml.compare(pos, 4, "<!--") == 0) {
+            const size_t close = xml.find("-->", pos);
+            if (close == std::string::npos) {
+                return false;
+            }
+            pos = close + 3;
+        } else if (xml.compare(pos, 2, "</") == 0) {
+            const size_t close = xml.find('>', pos);
+            if (close == std::string::npos) {
+                return false;
+            }
+            pos = close + 1;
+            return true;
+        } else {
+            node.children.emplace_back();
+            if (!parseElement(xml, pos, node.children.back(), depth + 1)) {
+                return false;
+            }
+        }
+    }
+    return false;
+}
+
+bool parseDocument(const std::string& xml, XmlNode& root) {
+    size_t pos = 0;
+    for (;;) {
+        pos = xml.find('<', pos);
+        if (pos == std::string::npos) {
+            return false;
+        }
+        // Skip the prolog, comments and doctype
+        if (xml.compare(pos, 2, "<?") == 0 || xml.compare(pos, 2, "<!") == 0) {
+            pos = xml.find('>', pos);
+            if (pos == std::string::npos) {
+                return false;
+            }
+            continue;
+        }
+        return parseElement(xml, pos, root, 0);
+    }
+}
+
+std::vector<double> numbers(const XmlNode* node) {
+    std::vector<double> values;
+    if (!node) {
+        return values;
+    }
+    const char* cursor = node->text.c_str();
+    char* end = nullptr;
+    for (double value = std::strtod(cursor, &end); end != cursor; value = std::strtod(cursor, &end)) {
+        values.push_back(value);
+        cursor = end;
+    }
+    return values;
+}
+
+int integer(const XmlNode* node) {
+    const auto values = numbers(node);
+    return values.empty() ? 0 : static_cast<int>(values[0]);
+}
+
+// Add the previous integral row (SIMD) after the row prefix sums are in place
+template <typename T>
+void addPreviousRow(const T* previous, T* row, int count);
+
+template <>
+void addPreviousRow<uint32_t>(const uint32_t* previous, uint32_t* row, int count) {
+    int x = 0;
+#if ACM_SIMD_SSE2
+    for (; x + 4 <= count; x += 4) {
+        const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(previous + x));
+        const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row + x));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(row + x), _mm_add_epi32(a, b));
+    }
+#elif ACM_SIMD_NEON
+    for (; x + 4 <= count; x += 4) {
+        vst1q_u32(row + x, vaddq_u32(vld1q_u32(previous + x), vld1q_u32(row + x)));
+    }
+#endif
+    for (; x < count; ++x) {
+        row[x] += previous[x];
+    }
+}
+
+template <>
+void addPreviousRow<uint64_t>(const uint64_t* previous, uint64_t* row, int count) {
+    int x = 0;
+#if ACM_SIMD_SSE2
+    for (; x + 2 <= count; x += 2) {
+        const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(previous + x));
+        const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row + x));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(row + x), _mm_add_epi64(a, b));
+    }
+#elif ACM_SIMD_NEON
+    for (; x + 2 <= count; x += 2) {
+        vst1q_u64(row + x, vaddq_u64(vld1q_u64(previous + x), vld1q_u64(row + x)));
+    }
+#endif
+    for (; x < count; ++x) {
+        row[x] += previous[x];
+    }
+}
+
+// sums[x] = src[x] summed over `rows` rows, 16 columns per step
+void sumColumns(const uint8_t* src, size_t stride, int rows, int count, uint32_t* sums) {
+    int x = 0;
+#if ACM_SIMD_SSE2
+    const __m128i zero = _mm_setzero_si128();
+    for (; x + 16 <= count; x += 16) {
+        __m128i sum0 = zero, sum1 = zero, sum2 = zero, sum3 = zero;
+        const uint8_t* p = src + x;
+        for (int r = 0; r < rows; ++r, p += stride) {
+            const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+            const __m128i low = _mm_unpacklo_epi8(v, zero);
+            const __m128i high = _mm_unpackhi_epi8(v, zero);
+            sum0 = _mm_add_epi32(sum0, _mm_unpacklo_epi16(low, zero));
+            sum1 = _mm_add_epi32(sum1, _mm_unpackhi_epi16(low, zero));
+            sum2 = _mm_add_epi32(sum2, _mm_unpacklo_epi16(high, zero));
+            sum3 = _mm_add_epi32(sum3, _mm_unpackhi_epi16(high, zero));
+        }
+        __m128i* out = reinterpret_cast<__m128i*>(sums + x);
+        _mm_storeu_si128(out, sum0);
+        _mm_storeu_si128(out + 1, sum1);
+        _mm_storeu_si128(out + 2, sum2);
+        _mm_storeu_si128(out + 3, sum3);
+    }
+#elif ACM_SIMD_NEON
+    for (; x + 16 <= count; x += 16) {
+        uint32x4_t sum0 = vdupq_n_u32(0), sum1 = sum0, sum2 = sum0, sum3 = sum0;
+        const uint8_t* p = src + x;
+        for (int r = 0; r < rows; ++r, p += stride) {
+            const uint8x16_t v = vld1q_u8(p);
+            const uint16x8_t low = vmovl_u8(vget_low_u8(v));
+            const uint16x8_t high = vmovl_u8(vget_high_u8(v));
+            sum0 = vaddw_u16(sum0, vget_low_u16(low));
+            sum1 = vaddw_u16(sum1, vget_high_u16(low));
+            sum2 = vaddw_u16(sum2, vget_low_u16(high));
+            sum3 = vaddw_u16(sum3, vget_high_u16(high));
+        }
+        vst1q_u32(sums + x, sum0);
+        vst1q_u32(sums + x + 4, sum1);
+        vst1q_u32(sums + x + 8, sum2);
+        vst1q_u32(sums + x + 12, sum3);
+    }
+#endif
+    for (; x < count; ++x) {
+        uint32_t sum = 0;
+        const uint8_t* p = src + x;
+        for (int r = 0; r < rows; ++r, p += stride) {
+            sum += *p;
+        }
+        sums[x] = sum;
+    }
+}
+
+// ============================================================================
+// Plan cache: the loaded (optimized) cascade next to its XML
+// ============================================================================
+//
+//   PlanHeader
+//   Feature[featureCount] Node[nodeCount] float[leafCount] Tree[treeCount]
+//   Stump[stumpCount] Stage[stageCount]
+//
+// Sections are the in-memory structs as written by the same build; the
+// version changes with their layout. A plan whose source size or timestamp
+// differs from the XML's is rebuilt.
+
+constexpr uint32_t kPlanMagic = 0x50434341;    // "ACCP" - AnonCam Cascade Plan
+constexpr uint16_t kPlanVersion = 1;
+constexpr uint32_t kPlanFlagOptimized = 1u << 0;
+
+struct PlanHeader {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t headerSize;
+    uint32_t flags;
+    int32_t windowWidth;
+    int32_t windowHeight;
+    uint32_t featureCount;
+    uint32_t nodeCount;
+    uint32_t leafCount;
+    uint32_t treeCount;
+    uint32_t stumpCount;
+    uint32_t stageCount;
+    uint32_t reserved;
+    uint64_t sourceSize;       // Size of the XML the plan was built from
+    int64_t sourceTime;        // Its last write time (filesystem clock ticks)
+};
+static_assert(sizeof(PlanHeader) % 8 == 0, "PlanHeader must keep 8-byte alignment");
+
+template <typename T>
+bool readSection(const uint8_t*& cursor, const uint8_t* end, uint32_t count, std::vector<T>& values) {
+    const size_t bytes = static_cast<size_t>(count) * sizeof(T);
+    if (static_cast<size_t>(end - cursor) < bytes) {
+        return false;
+    }
+    values.resize(count);
+    if (bytes > 0) {
+        std::memcpy(values.data(), cursor, bytes);
+    }
+    cursor += bytes;
+    return true;
+}
+
+template <typename T>
+bool writeSection(std::FILE* file, const std::vector<T>& values) {
+    return values.empty() || std::fwrite(values.data(), sizeof(T), values.size(), file) == values.size();
+}
+
+constexpr int64_t kNoDeadline = std::numeric_limits<int64_t>::max();
+
+int64_t nowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+} // anonymous namespace
+
+namespace AnonCam {
+
+CascadeDetector::CascadeDetector()
+    : CascadeDetector(Options()) {}
+
+CascadeDetector::CascadeDetector(const Options& options, WorkerPool* workers)
+    : options_(options), workers_(workers) {
+    options_.scaleFactor = std::max(1.01f, options.scaleFactor);
+    options_.maxScanWidth = std::max(32, options.maxScanWidth);
+    options_.tileRows = std::max(1, options.tileRows);
+}
+
+CascadeDetector::~CascadeDetector() = default;
+
+// ============================================================================
+// Loading
+// ============================================================================
+
+bool CascadeDetector::load(const std::string& path) {
+    const int64_t begin = nowNs();
+    stats_.planCached = false;
+
+    // The plan is keyed on the XML's size and timestamp, so a cached load
+    // never reads the XML itself
+    std::error_code error;
+    const uint64_t sourceSize = std::filesystem::file_size(path, error);
+    const int64_t sourceTime =
+        error ? 0 : static_cast<int64_t>(std::filesystem::last_write_time(path, error).time_since_epoch().count());
+    const bool cache = options_.cachePlan && !error;
+    const std::string planPath = path + ".plan";
+    if (cache && loadPlan(planPath, sourceSize, sourceTime)) {
+        stats_.planCached = true;
+        stats_.loadNs = nowNs() - begin;
+        return true;
+    }
+
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        return false;
+    }
+    std::ostringstream contents;
+    contents << file.rdbuf();
+    if (!loadFromString(contents.str())) {
+        return false;
+    }
+    // Best effort: the directory may be read-only
+    if (cache) {
+        savePlan(planPath, sourceSize, sourceTime);
+    }
+    stats_.loadNs = nowNs() - begin;
+    return true;
+}
+
+bool CascadeDetector::loadFromString(const std::string& xml) {
+    const int64_t begin = nowNs();
+    stages_.clear();
+    scales_.clear();
+    scanWidth_ = scanHeight_ = 0;
+
+    XmlNode root;
+    if (!parseDocument(xml, root)) {
+        return false;
+    }
+    const XmlNode* cascade = root.name == "cascade" ? &root : root.child("cascade");
+    if (!cascade || !cascade->child("stageType") || !cascade->child("featureType") ||
+        cascade->child("stageType")->trimmedText() != "BOOST" ||
+        cascade->child("featureType")->trimmedText() != "HAAR") {
+        return false;
+    }
+    // Categorical (LBP) splits are not supported
+    if (const XmlNode* featureParams = cascade->child("featureParams")) {
+        if (integer(featureParams->child("maxCatCount")) > 0) {
+            return false;
+        }
+    }
+
+    const int width = integer(cascade->child("width"));
+    const int height = integer(cascade->child("height"));
+    const XmlNode* stagesNode = cascade->child("stages");
+    const XmlNode* featuresNode = cascade->child("features");
+    if (width < 3 || height < 3 || !stagesNode || !featuresNode) {
+        return false;
+    }
+
+    std::vector<Feature> features;
+    for (const auto& featureNode : featuresNode->children) {
+        const XmlNode* rects = featureNode.child("rects");
+        if (!rects || rects->children.empty() || rects->children.size() > 3 ||
+            integer(featureNode.child("tilted")) != 0) {
+            return false;
+        }
+        Feature feature{};
+        for (const auto& rectNode : rects->children) {
+            const auto values = numbers(&rectNode);
+            if (values.size() != 5) {
+                return false;
+            }
+            Rect& rect = feature.rects[feature.count++];
+            rect.x = static_cast<int>(values[0]);
+            rect.y = static_cast<int>(values[1]);
+            rect.width = static_cast<int>(values[2]);
+            rect.height = static_cast<int>(values[3]);
+            rect.weight = static_cast<float>(values[4]);
+            if (rect.x < 0 || rect.y < 0 || rect.width <= 0 || rect.height <= 0 ||
+                rect.x + rect.width > width || rect.y + rect.height > height) {
+                return false;
+            }
+        }
+        features.push_back(feature);
+    }
+
+    std::vector<Node> nodes;
+    std::vector<float> leaves;
+    std::vector<Tree> trees;
+    std::vector<Stage> stages;
+    for (const auto& stageNode : stagesNode->children) {
+        const XmlNode* weakClassifiers = stageNode.child("weakClassifiers");
+        const auto threshold = numbers(stageNode.child("stageThreshold"));
+        if (!weakClassifiers || threshold.empty()) {
+            return false;
+        }
+
+        Stage stage{static_cast<float>(threshold[0]), static_cast<int>(trees.size()), 0, StageKernel::Trees};
+        for (const auto& treeNode : weakClassifiers->children) {
+            const auto internal = numbers(treeNode.child("internalNodes"));
+            const auto leafValues = numbers(treeNode.child("leafValues"));
+            const int nodeCount = static_cast<int>(internal.size() / 4);
+            if (nodeCount == 0 || internal.size() % 4 != 0 ||
+                static_cast<int>(leafValues.size()) != nodeCount + 1) {
+                return false;
+            }
+
+            trees.push_back({static_cast<int>(nodes.size()), static_cast<int>(leaves.size())});
+            for (int i = 0; i < nodeCount; ++i) {
+                // left right featureIndex threshold; children <= 0 are leaves
+                Node node{static_cast<int>(internal[i * 4 + 2]), static_cast<float>(internal[i * 4 + 3]),
+                          static_cast<int>(internal[i * 4]), static_cast<int>(internal[i * 4 + 1])};
+                const bool childrenValid = node.left < nodeCount && node.right < nodeCount &&
+                                           -node.left <= nodeCount && -node.right <= nodeCount;
+                if (node.feature < 0 || node.feature >= static_cast<int>(features.size()) || !childrenValid ||
+                    (node.left > 0 && node.left <= i) || (node.right > 0 && node.right <= i)) {
+                    return false;
+                }
+                nodes.push_back(node);
+            }
+            for (double value : leafValues) {
+                leaves.push_back(static_cast<float>(value));
+            }
+            ++stage.treeCount;
+        }
+        if (stage.treeCount == 0) {
+            return false;
+        }
+        stages.push_back(stage);
+    }
+    if (stages.empty()) {
+        return false;
+    }
+
+    windowWidth_ = width;
+    windowHeight_ = height;
+    features_ = std::move(features);
+    nodes_ = std::move(nodes);
+    leaves_ = std::move(leaves);
+    trees_ = std::move(trees);
+    stumps_.clear();
+    stages_ = std::move(stages);
+    if (options_.optimize) {
+        optimizeCascade();
+    }
+    stats_.loadNs = nowNs() - begin;
+    return true;
+}
+
+// ============================================================================
+// Load-time optimization and the plan cache
+// ============================================================================
+
+void CascadeDetector::optimizeCascade() {
+    const auto nodeEnd = [this](int t) {
+        return t + 1 < static_cast<int>(trees_.size()) ? trees_[t + 1].firstNode : static_cast<int>(nodes_.size());
+    };
+
+    // Features are renumbered in order of first use; identical ones (zero
+    // padded, so compared bytewise) share a number
+    std::vector<Feature> features;
+    std::vector<int> featureIndex(features_.size(), -1);
+    std::unordered_map<std::string, int> uniqueFeatures;
+    const auto useFeature = [&](int f) {
+        if (featureIndex[f] < 0) {
+            const std::string key(reinterpret_cast<const char*>(&features_[f]), sizeof(Feature));
+            const auto [entry, added] = uniqueFeatures.emplace(key, static_cast<int>(features.size()));
+            if (added) {
+                features.push_back(features_[f]);
+            }
+            featureIndex[f] = entry->second;
+        }
+        return featureIndex[f];
+    };
+
+    std::vector<Node> nodes;
+    std::vector<float> leaves;
+    std::vector<Tree> trees;
+    std::vector<Stump> stumps;
+    std::vector<Stage> stages;
+    std::vector<int> kept;
+    for (const Stage& stage : stages_) {
+        // A tree whose leaves are all equal adds the same value for every
+        // window: fold it into the threshold
+        double constant = 0.0;
+        double minimum = 0.0;
+        bool allStumps = true;
+        kept.clear();
+        for (int t = stage.firstTree; t < stage.firstTree + stage.treeCount; ++t) {
+            const int nodeCount = nodeEnd(t) - trees_[t].firstNode;
+            const float* leaf = leaves_.data() + trees_[t].firstLeaf;
+            const auto [low, high] = std::minmax_element(leaf, leaf + nodeCount + 1);
+            minimum += *low;
+            if (*low == *high) {
+                constant += *low;
+                continue;
+            }
+            kept.push_back(t);
+            allStumps = allStumps && nodeCount == 1;
+        }
+        // Passes for every window
+        if (minimum >= stage.threshold) {
+            continue;
+        }
+
+        Stage optimized{static_cast<float>(stage.threshold - constant), 0, static_cast<int>(kept.size()),
+                        allStumps ? StageKernel::Stumps : StageKernel::Trees};
+        if (allStumps) {
+            optimized.firstTree = static_cast<int>(stumps.size());
+            for (int t : kept) {
+                const Node& node = nodes_[trees_[t].firstNode];
+                const float* leaf = leaves_.data() + trees_[t].firstLeaf;
+                stumps.push_back({useFeature(node.feature), node.threshold, leaf[-node.left], leaf[-node.right]});
+            }
+        } else {
+            optimized.firstTree = static_cast<int>(trees.size());
+            for (int t : kept) {
+                const int nodeCount = nodeEnd(t) - trees_[t].firstNode;
+                const float* leaf = leaves_.data() + trees_[t].firstLeaf;
+                trees.push_back({static_cast<int>(nodes.size()), static_cast<int>(leaves.size())});
+                for (int n = trees_[t].firstNode; n < trees_[t].firstNode + nodeCount; ++n) {
+                    Node node = nodes_[n];
+                    node.feature = useFeature(node.feature);
+                    nodes.push_back(node);
+                }
+                leaves.insert(leaves.end(), leaf, leaf + nodeCount + 1);
+            }
+        }
+        stages.push_back(optimized);
+    }
+    // Every stage always passed: one empty stage keeps the cascade loaded
+    if (stages.empty()) {
+        stages.push_back({-1.0f, 0, 0, StageKernel::Stumps});
+    }
+
+    features_ = std::move(features);
+    nodes_ = std::move(nodes);
+    leaves_ = std::move(leaves);
+    trees_ = std::move(trees);
+    stumps_ = std::move(stumps);
+    stages_ = std::move(stages);
+}
+
+bool CascadeDetector::loadPlan(const std::string& path, uint64_t sourceSize, int64_t sourceTime) {
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat st {};
+    if (::fstat(fd, &st) != 0 || st.st_size < static_cast<off_t>(sizeof(PlanHeader))) {
+        ::close(fd);
+        return false;
+    }
+    const size_t size = static_cast<size_t>(st.st_size);
+    void* mapping = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (mapping == MAP_FAILED) {
+        return false;
+    }
+
+    const auto* base = static_cast<const uint8_t*>(mapping);
+    PlanHeader header;
+    std::memcpy(&header, base, sizeof(header));
+    const uint8_t* cursor = base + sizeof(PlanHeader);
+    const uint8_t* end = base + size;
+
+    std::vector<Feature> features;
+    std::vector<Node> nodes;
+    std::vector<float> leaves;
+    std::vector<Tree> trees;
+    std::vector<Stump> stumps;
+    std::vector<Stage> stages;
+    const bool ok = header.magic == kPlanMagic && header.version == kPlanVersion &&
+                    header.headerSize == sizeof(PlanHeader) && header.sourceSize == sourceSize &&
+                    header.sourceTime == sourceTime &&
+                    ((header.flags & kPlanFlagOptimized) != 0) == options_.optimize &&
+                    readSection(cursor, end, header.featureCount, features) &&
+                    readSection(cursor, end, header.nodeCount, nodes) &&
+                    readSection(cursor, end, header.leafCount, leaves) &&
+                    readSection(cursor, end, header.treeCount, trees) &&
+                    readSection(cursor, end, header.stumpCount, stumps) &&
+                    readSection(cursor, end, header.stageCount, stages) && cursor == end;
+    ::munmap(mapping, size);
+    if (!ok) {
+        return false;
+    }
+
+    windowWidth_ = header.windowWidth;
+    windowHeight_ = header.windowHeight;
+    features_ = std::move(features);
+    nodes_ = std::move(nodes);
+    leaves_ = std::move(leaves);
+    trees_ = std::move(trees);
+    stumps_ = std::move(stumps);
+    stages_ = std::move(stages);
+    scales_.clear();
+    scanWidth_ = scanHeight_ = 0;
+    if (!cascadeValid()) {
+        stages_.clear();
+        return false;
+    }
+    return true;
+}
+
+bool CascadeDetector::savePlan(const std::string& path, uint64_t sourceSize, int64_t sourceTime) const {
+    // Renamed into place once complete, so a concurrent load never maps a
+    // partial plan
+    const std::string temporary = path + ".tmp";
+    std::FILE* file = std::fopen(temporary.c_str(), "wb");
+    if (!file) {
+        return false;
+    }
+
+    PlanHeader header{};
+    header.magic = kPlanMagic;
+    header.version = kPlanVersion;
+    header.headerSize = sizeof(PlanHeader);
+    header.flags = options_.optimize ? kPlanFlagOptimized : 0;
+    header.windowWidth = windowWidth_;
+    header.windowHeight = windowHeight_;
+    header.featureCount = static_cast<uint32_t>(features_.size());
+    header.nodeCount = static_cast<uint32_t>(nodes_.size());
+    header.leafCount = static_cast<uint32_t>(leaves_.size());
+    header.treeCount = static_cast<uint32_t>(trees_.size());
+    header.stumpCount = static_cast<uint32_t>(stumps_.size());
+    header.stageCount = static_cast<uint32_t>(stages_.size());
+    header.sourceSize = sourceSize;
+    header.sourceTime = sourceTime;
+
+    bool ok = std::fwrite(&header, 1, sizeof(header), file) == sizeof(header) && writeSection(file, features_) &&
+              writeSection(file, nodes_) && writeSection(file, leaves_) && writeSection(file, trees_) &&
+              writeSection(file, stumps_) && writeSection(file, stages_);
+    ok = (std::fclose(file) == 0) && ok;
+    if (ok && std::rename(temporary.c_str(), path.c_str()) == 0) {
+        return true;
+    }
+    std::remove(temporary.c_str());
+    return false;
+}
+
+// The checks loadFromString applies while parsing, for a cascade read from a plan
+bool CascadeDetector::cascadeValid() const {
+    if (windowWidth_ < 3 || windowHeight_ < 3 || stages_.empty()) {
+        return false;
+    }
+    const int featureCount = static_cast<int>(features_.size());
+    for (const Feature& feature : features_) {
+        if (feature.count < 1 || feature.count > 3) {
+            return false;
+        }
+        for (int k = 0; k < feature.count; ++k) {
+            const Rect& rect = feature.rects[k];
+            if (rect.x < 0 || rect.y < 0 || rect.width <= 0 || rect.height <= 0 ||
+                rect.x + rect.width > windowWidth_ || rect.y + rect.height > windowHeight_) {
+                return false;
+            }
+        }
+    }
+
+    const int treeCount = static_cast<int>(trees_.size());
+    for (int t = 0; t < treeCount; ++t) {
+        const int first = trees_[t].firstNode;
+        const int end = t + 1 < treeCount ? trees_[t + 1].firstNode : static_cast<int>(nodes_.size());
+        const int nodeCount = end - first;
+        if (first < 0 || nodeCount < 1 || end > static_cast<int>(nodes_.size()) || trees_[t].firstLeaf < 0 ||
+            trees_[t].firstLeaf + nodeCount + 1 > static_cast<int>(leaves_.size())) {
+            return false;
+        }
+        for (int i = 0; i < nodeCount; ++i) {
+            const Node& node = nodes_[first + i];
+            const auto childValid = [&](int child) {
+                return child > 0 ? child > i && child < nodeCount : -child <= nodeCount;
+            };
+            if (node.feature < 0 || node.feature >= featureCount || !childValid(node.left) ||
+                !childValid(node.right)) {
+                return false;
+            }
+        }
+    }
+    for (const Stump& stump : stumps_) {
+        if (stump.feature < 0 || stump.feature >= featureCount) {
+            return false;
+        }
+    }
+    for (const Stage& stage : stages_) {
+        const bool stumps = stage.kernel == StageKernel::Stumps;
+        const int count = static_cast<int>(stumps ? stumps_.size() : trees_.size());
+        if ((!stumps && stage.kernel != StageKernel::Trees) || stage.firstTree < 0 || stage.treeCount < 0 ||
+            stage.firstTree > count - stage.treeCount) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// ============================================================================
+// Scanning
+// ============================================================================
+
+void CascadeDetector::prepareScan(const ImageView& frame) {
+    const int downscale = std::max(1, (frame.width + options_.maxScanWidth - 1) / options_.maxScanWidth);
+    const int scanWidth = frame.width / downscale;
+    const int scanHeight = frame.height / downscale;
+    const bool resized = scanWidth != scanWidth_ || scanHeight != scanHeight_;
+
+    // Faces are scaled back to the frame size
+    regroup_ = regroup_ || frame.width != frameWidth_ || frame.height != frameHeight_;
+    frameWidth_ = frame.width;
+    frameHeight_ = frame.height;
+    downscale_ = downscale;
+    scanWidth_ = scanWidth;
+    scanHeight_ = scanHeight;
+    if (resized) {
+        scan_.resize(static_cast<size_t>(scanWidth) * scanHeight);
+        sum_.assign(static_cast<size_t>(scanWidth + 1) * (scanHeight + 1), 0);
+        squareSum_.assign(sum_.size(), 0);
+        buildScales();
+    }
+
+    // Box-downscale the luma. Gray and NV12 rows are summed per column first
+    // (16 columns per step) and folded horizontally once per output row.
+    const bool bgra = frame.format == PixelFormat::BGRA;
+    std::vector<uint32_t>& accumulator = rowAccumulator_;
+    accumulator.resize(bgra ? scanWidth : static_cast<size_t>(scanWidth) * downscale);
+    const uint32_t area = static_cast<uint32_t>(downscale * downscale);
+    for (int y = 0; y < scanHeight; ++y) {
+        uint8_t* dst = scan_.data() + static_cast<size_t>(y) * scanWidth;
+        if (!bgra) {
+            sumColumns(frame.row(0, y * downscale), frame.bytesPerRow[0], downscale,
+                       static_cast<int>(accumulator.size()), accumulator.data());
+            for (int x = 0; x < scanWidth; ++x) {
+                const uint32_t* column = accumulator.data() + static_cast<size_t>(x) * downscale;
+                const uint32_t sum = std::accumulate(column, column + downscale, 0u);
+                dst[x] = static_cast<uint8_t>((sum + area / 2) / area);
+            }
+            continue;
+        }
+
+        std::fill(accumulator.begin(), accumulator.end(), 0u);
+        for (int dy = 0; dy < downscale; ++dy) {
+            const uint8_t* src = frame.row(0, y * downscale + dy);
+            for (int x = 0; x < scanWidth; ++x) {
+                const uint8_t* p = src + static_cast<size_t>(x) * downscale * 4;
+                for (int dx = 0; dx < downscale; ++dx, p += 4) {
+                    accumulator[x] += (p[0] * 29u + p[1] * 150u + p[2] * 77u) >> 8;
+                }
+            }
+        }
+        for (int x = 0; x < scanWidth; ++x) {
+            dst[x] = static_cast<uint8_t>((accumulator[x] + area / 2) / area);
+        }
+    }
+
+    // Integral images with a zero first row and column
+    const int stride = scanWidth + 1;
+    for (int y = 0; y < scanHeight; ++y) {
+        const uint8_t* src = scan_.data() + static_cast<size_t>(y) * scanWidth;
+        uint32_t* sumRow = sum_.data() + static_cast<size_t>(y + 1) * stride;
+        uint64_t* squareRow = squareSum_.data() + static_cast<size_t>(y + 1) * stride;
+        uint32_t rowSum = 0;
+        uint64_t rowSquareSum = 0;
+        for (int x = 0; x < scanWidth; ++x) {
+            rowSum += src[x];
+            rowSquareSum += static_cast<uint32_t>(src[x]) * src[x];
+            sumRow[x + 1] = rowSum;
+            squareRow[x + 1] = rowSquareSum;
+        }
+        addPreviousRow(sumRow - stride + 1, sumRow + 1, scanWidth);
+        addPreviousRow(squareRow - stride + 1, squareRow + 1, scanWidth);
+    }
+}
+
+void CascadeDetector::buildScales() {
+    scales_.clear();
+    items_.clear();
+
+    const int stride = scanWidth_ + 1;
+    const auto corners = [stride](int x, int y, int width, int height, int* out) {
+        out[0] = y * stride + x;
+        out[1] = y * stride + x + width;
+        out[2] = (y + height) * stride + x;
+        out[3] = (y + height) * stride + x + width;
+    };
+
+    const float minHeight = options_.minFaceSize * scanHeight_;
+    const float maxHeight = options_.maxFaceSize * scanHeight_;
+    for (float scale = std::max(1.0f, minHeight / windowHeight_);; scale *= options_.scaleFactor) {
+        Scale data;
+        data.windowWidth = static_cast<int>(std::lround(windowWidth_ * scale));
+        data.windowHeight = static_cast<int>(std::lround(windowHeight_ * scale));
+        if (data.windowWidth > scanWidth_ || data.windowHeight > scanHeight_ || data.windowHeight > maxHeight) {
+            break;
+        }
+        data.step = std::max(2, static_cast<int>(std::lround(scale)));
+
+        // Variance is measured inside a one (base) pixel border
+        const int border = static_cast<int>(std::lround(scale));
+        const int normWidth = static_cast<int>(std::lround((windowWidth_ - 2) * scale));
+        const int normHeight = static_cast<int>(std::lround((windowHeight_ - 2) * scale));
+        corners(border, border, normWidth, normHeight, data.normCorners);
+        data.inverseNormArea = 1.0f / static_cast<float>(normWidth * normHeight);
+
+        // Rounded rectangles no longer cancel exactly; rebalance the first
+        // weight so every feature stays zero-mean at this scale
+        data.features.resize(features_.size());
+        for (size_t f = 0; f < features_.size(); ++f) {
+            const Feature& feature = features_[f];
+            ScaledFeature& scaled = data.features[f];
+            scaled.count = feature.count;
+            double weightedArea = 0.0;
+            int firstArea = 1;
+            for (int k = 0; k < feature.count; ++k) {
+                const Rect& rect = feature.rects[k];
+                const int x = static_cast<int>(std::lround(rect.x * scale));
+                const int y = static_cast<int>(std::lround(rect.y * scale));
+                const int width = std::max(1, static_cast<int>(std::lround(rect.width * scale)));
+                const int height = std::max(1, static_cast<int>(std::lround(rect.height * scale)));
+                corners(x, y, std::min(width, data.windowWidth - x), std::min(height, data.windowHeight - y),
+                        scaled.corners[k]);
+                scaled.weights[k] = rect.weight * data.inverseNormArea;
+                if (k == 0) {
+                    firstArea = width * height;
+                } else {
+                    weightedArea += static_cast<double>(scaled.weights[k]) * width * height;
+                }
+            }
+            if (feature.count > 1) {
+                scaled.weights[0] = static_cast<float>(-weightedArea / firstArea);
+            }
+        }
+
+        const int scaleIndex = static_cast<int>(scales_.size());
+        const int lastRow = scanHeight_ - data.windowHeight;
+        for (int row = 0; row <= lastRow; row += options_.tileRows) {
+            items_.emplace_back(scaleIndex, row);
+        }
+        scales_.push_back(std::move(data));
+    }
+
+    // Hits of the previous layout no longer map to these items
+    itemHits_.clear();
+    itemHits_.resize(items_.size());
+    previousHits_.resize(items_.size());
+    regroup_ = true;
+    itemSkipped_.resize(items_.size());
+    itemCostNs_.assign(items_.size(), 0);
+    nextItem_ = 0;
+    stats_.itemCount = static_cast<int>(items_.size());
+}
+
+bool CascadeDetector::evaluate(const Scale& scale, int offset) const {
+    const auto rectSum = [&](const int* c) {
+        return static_cast<float>(sum_[offset + c[0]] - sum_[offset + c[1]] - sum_[offset + c[2]] +
+                                  sum_[offset + c[3]]);
+    };
+
+    const float mean = rectSum(scale.normCorners) * scale.inverseNormArea;
+    const uint64_t squares = squareSum_[offset + scale.normCorners[0]] - squareSum_[offset + scale.normCorners[1]] -
+                             squareSum_[offset + scale.normCorners[2]] + squareSum_[offset + scale.normCorners[3]];
+    const float variance = static_cast<float>(squares) * scale.inverseNormArea - mean * mean;
+    const float normFactor = variance > 0.0f ? std::sqrt(variance) : 1.0f;
+
+    const auto featureValue = [&](const ScaledFeature& feature) {
+        float value = 0.0f;
+        for (int k = 0; k < feature.count; ++k) {
+            value += feature.weights[k] * rectSum(feature.corners[k]);
+        }
+        return value;
+    };
+
+    for (const Stage& stage : stages_) {
+        float stageSum = 0.0f;
+        if (stage.kernel == StageKernel::Stumps) {
+            // Consecutive stumps on the same feature share its value
+            int lastFeature = -1;
+            float value = 0.0f;
+            const Stump* stump = stumps_.data() + stage.firstTree;
+            for (const Stump* end = stump + stage.treeCount; stump != end; ++stump) {
+                if (stump->feature != lastFeature) {
+                    value = featureValue(scale.features[stump->feature]);
+                    lastFeature = stump->feature;
+                }
+                stageSum += value < stump->threshold * normFactor ? stump->left : stump->right;
+            }
+            if (stageSum < stage.threshold) {
+                return false;
+            }
+            continue;
+        }
+
+        for (int t = stage.firstTree; t < stage.firstTree + stage.treeCount; ++t) {
+            const Tree& tree = trees_[t];
+            int index = 0;
+            for (;;) {
+                const Node& node = nodes_[tree.firstNode + index];
+                const float value = featureValue(scale.features[node.feature]);
+                const int next = value < node.threshold * normFactor ? node.left : node.right;
+                if (next <= 0) {
+                    stageSum += leaves_[tree.firstLeaf - next];
+                    break;
+                }
+                index = next;
+            }
+        }
+        if (stageSum < stage.threshold) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void CascadeDetector::scanBand(const Scale& scale, int rowBegin, int rowEnd, std::vector<Hit>& hits) const {
+    const int stride = scanWidth_ + 1;
+    const int lastRow = std::min(rowEnd, scanHeight_ - scale.windowHeight + 1);
+    const int lastColumn = scanWidth_ - scale.windowWidth;
+    const int firstRow = (rowBegin + scale.step - 1) / scale.step * scale.step;
+
+    for (int y = firstRow; y < lastRow; y += scale.step) {
+        for (int x = 0; x <= lastColumn; x += scale.step) {
+            if (evaluate(scale, y * stride + x)) {
+                hits.push_back({x, y, scale.windowWidth, scale.windowHeight});
+            }
+        }
+    }
+}
+
+int CascadeDetector::scanItems(int first, int count, int64_t deadlineNs, const CancellationToken& cancel,
+                               bool& hitsChanged) {
+    const int itemCount = static_cast<int>(items_.size());
+    const bool timed = deadlineNs != kNoDeadline;
+    std::fill(itemSkipped_.begin(), itemSkipped_.begin() + count, 0);
+
+    // An item is started only if its cost at its last scan still fits
+    // before the deadline; after the first skip every later item is skipped
+    // too. The first always runs, so a tiny budget still advances; only
+    // cancellation skips it.
+    std::atomic<bool> stopped{false};
+    std::atomic<bool> changed{false};
+    auto scan = [&](int slot) {
+        const int item = (first + slot) % itemCount;
+        const int64_t start = timed ? nowNs() : 0;
+        if (cancel.isCancelled() ||
+            (slot > 0 && timed && (stopped.load(std::memory_order_relaxed) ||
+                                   start + itemCostNs_[item] > deadlineNs))) {
+            itemSkipped_[slot] = 1;
+            stopped.store(true, std::memory_order_relaxed);
+            return;
+        }
+        const auto [scaleIndex, row] = items_[item];
+        std::vector<Hit>& hits = itemHits_[item];
+        std::vector<Hit>& previous = previousHits_[item];
+        previous.swap(hits);
+        hits.clear();
+        scanBand(scales_[scaleIndex], row, row + options_.tileRows, hits);
+        if (hits != previous) {
+            changed.store(true, std::memory_order_relaxed);
+        }
+        if (timed) {
+            itemCostNs_[item] = nowNs() - start;
+        }
+    };
+    if (workers_) {
+        workers_->parallelFor(count, scan);
+    } else {
+        for (int slot = 0; slot < count; ++slot) {
+            scan(slot);
+        }
+    }
+
+    hitsChanged = changed.load();
+
+    // Resume at the first skipped item; a later item a worker started just
+    // before the first skip is simply scanned again next call
+    const auto skipped = std::find(itemSkipped_.begin(), itemSkipped_.begin() + count, 1);
+    return static_cast<int>(skipped - itemSkipped_.begin());
+}
+
+bool CascadeDetector::detect(const ImageView& frame, std::vector<Detection>& detections,
+                             const CancellationToken& cancel) {
+    detections.clear();
+    if (!isLoaded() || !frame.isValid() || cancel.isCancelled()) {
+        return false;
+    }
+
+    const int64_t begin = nowNs();
+    ++stats_.calls;
+    prepareScan(frame);
+
+    const int count = static_cast<int>(items_.size());
+    bool hitsChanged = false;
+    if (isTimeSliced()) {
+        // The budget covers the whole call: downscale and integral images
+        // before the scan, and grouping (as long as it took last time) after
+        const int64_t deadline = begin + static_cast<int64_t>(options_.sliceBudgetUs) * 1000 - groupNs_;
+        stats_.lastItems = scanItems(nextItem_, count, deadline, cancel, hitsChanged);
+        nextItem_ += stats_.lastItems;
+        if (nextItem_ >= count) {
+            nextItem_ -= count;
+            ++stats_.cycles;
+        }
+    } else {
+        stats_.lastItems = scanItems(0, count, kNoDeadline, cancel, hitsChanged);
+        if (stats_.lastItems == count) {
+            ++stats_.cycles;
+        }
+    }
+    if (cancel.isCancelled()) {
+        // The next call that completes groups what this one scanned
+        regroup_ = regroup_ || hitsChanged;
+        stats_.lastDetectNs = nowNs() - begin;
+        return false;
+    }
+
+    // Grouping is quadratic in the hits of a face; a static scene keeps its
+    // faces until a rescanned item reports different hits
+    if (hitsChanged || regroup_) {
+        const int64_t grouping = nowNs();
+        hits_.clear();
+        for (const auto& hits : itemHits_) {
+            hits_.insert(hits_.end(), hits.begin(), hits.end());
+        }
+        faces_.clear();
+        groupHits(faces_);
+        regroup_ = false;
+        groupNs_ = nowNs() - grouping;
+    }
+    detections = faces_;
+    const int64_t end = nowNs();
+    stats_.lastDetectNs = end - begin;
+    return true;
+}
+
+void CascadeDetector::groupHits(std::vector<Detection>& detections) {
+    const int count = static_cast<int>(hits_.size());
+
+    // Cluster similar windows (union-find). Sorted by x, the scan for a hit's
+    // neighbours stops once x is further away than any delta can reach.
+    std::sort(hits_.begin(), hits_.end(), [](const Hit& a, const Hit& b) { return a.x < b.x; });
+    labels_.resize(count);
+    std::iota(labels_.begin(), labels_.end(), 0);
+    const auto root = [this](int i) {
+        while (labels_[i] != i) {
+            labels_[i] = labels_[labels_[i]];
+            i = labels_[i];
+        }
+        return i;
+    };
+    constexpr float kEps = 0.2f;
+    for (int i = 0; i < count; ++i) {
+        const Hit& a = hits_[i];
+        const float reach = kEps * (a.width + a.height) * 0.5f;
+        for (int j = i + 1; j < count && hits_[j].x - a.x <= reach; ++j) {
+            const Hit& b = hits_[j];
+            const float delta = kEps * (std::min(a.width, b.width) + std::min(a.height, b.height)) * 0.5f;
+            if (std::abs(a.x - b.x) <= delta && std::abs(a.y - b.y) <= delta &&
+                std::abs(a.x + a.width - b.x - b.width) <= delta &&
+                std::abs(a.y + a.height - b.y - b.height) <= delta) {
+                labels_[root(i)] = root(j);
+            }
+        }
+    }
+
+    struct Group {
+        float x = 0, y = 0, width = 0, height = 0;
+        int hits = 0;
+    };
+    std::vector<Group> groups(count);
+    for (int i = 0; i < count; ++i) {
+        Group& group = groups[root(i)];
+        group.x += hits_[i].x;
+        group.y += hits_[i].y;
+        group.width += hits_[i].width;
+        group.height += hits_[i].height;
+        ++group.hits;
+    }
+
+    const int minNeighbors = std::max(1, options_.minNeighbors);
+    std::vector<Group> faces;
+    for (Group& group : groups) {
+        if (group.hits >= minNeighbors) {
+            group.x /= group.hits;
+            group.y /= group.hits;
+            group.width /= group.hits;
+            group.height /= group.hits;
+            faces.push_back(group);
+        }
+    }
+
+    // Drop small faces inside a larger, better supported one
+    std::vector<bool> dropped(faces.size(), false);
+    for (size_t i = 0; i < faces.size(); ++i) {
+        for (size_t j = 0; j < faces.size(); ++j) {
+            const Group& inner = faces[i];
+            const Group& outer = faces[j];
+            const float dx = outer.width * kEps;
+            const float dy = outer.height * kEps;
+            if (i != j && outer.hits > std::max(3, inner.hits) && inner.x >= outer.x - dx &&
+                inner.y >= outer.y - dy && inner.x + inner.width <= outer.x + outer.width + dx &&
+                inner.y + inner.height <= outer.y + outer.height + dy) {
+                dropped[i] = true;
+            }
+        }
+    }
+
+    const float scaleX = static_cast<float>(downscale_) / frameWidth_;
+    const float scaleY = static_cast<float>(downscale_) / frameHeight_;
+    for (size_t i = 0; i < faces.size(); ++i) {
+        if (dropped[i]) {
+            continue;
+        }
+        Detection detection;
+        detection.x = faces[i].x * scaleX;
+        detection.y = faces[i].y * scaleY;
+        detection.width = faces[i].width * scaleX;
+        detection.height = faces[i].height * scaleY;
+        detection.score = static_cast<float>(faces[i].hits) / static_cast<float>(faces[i].hits + minNeighbors);
+        detections.push_back(detection);
+    }
+    std::sort(detections.begin(), detections.end(),
+              [](const Detection& a, const Detection& b) { return a.score > b.score; });
+}
+
+} // namespace AnonCam
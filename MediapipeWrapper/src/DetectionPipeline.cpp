@@ -0,0 +1,348 @@
+#include "DetectionPipeline.h"
+#include "ScoreKernels.h"
+#include "Simd.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace {
+
+float sigmoid(float x) {
+    return 1.0f / (1.0f + std::exp(-x));
+}
+
+// Logit a score threshold maps to: sigmoid(x) >= score  <=>  x >= logit(score)
+float logitOf(float score) {
+    if (score <= 0.0f) {
+        return -std::numeric_limits<float>::infinity();
+    }
+    if (score >= 1.0f) {
+        return std::numeric_limits<float>::infinity();
+    }
+    return std::log(score / (1.0f - score));
+}
+
+// Box (x0, y0, x1, y1) of one anchor's regressors, negative sizes clamped
+// to zero as NonMaxSuppression does
+struct Box {
+    float x0, y0, x1, y1;
+};
+
+inline Box decodeBox(const float* raw, float anchorX, float anchorY, float inverseWidth, float inverseHeight) {
+    const float width = raw[2] * inverseWidth;
+    const float height = raw[3] * inverseHeight;
+    const float x0 = raw[0] * inverseWidth + anchorX - width * 0.5f;
+    const float y0 = raw[1] * inverseHeight + anchorY - height * 0.5f;
+    return {x0, y0, x0 + std::max(0.0f, width), y0 + std::max(0.0f, height)};
+}
+
+} // anonymous namespace
+
+namespace AnonCam {
+
+std::unique_ptr<DetectionPipeline> DetectionPipeline::create(const float* anchorX, const float* anchorY,
+                                                             int anchorCount, int inputWidth, int inputHeight,
+                                                             const Options& options) {
+    if (options.maxFaces == 1) {
+        return std::make_unique<SsdDetectionPipeline<1>>(anchorX, anchorY, anchorCount, inputWidth, inputHeight,
+                                                          options);
+    }
+    return std::make_unique<SsdDetectionPipeline<kAnyFaceCount>>(anchorX, anchorY, anchorCount, inputWidth,
+                                                                 inputHeight, options);
+}
+
+// ============================================================================
+// Any number of faces
+// ============================================================================
+
+template <int MaxFaces>
+SsdDetectionPipeline<MaxFaces>::SsdDetectionPipeline(const float* anchorX, const float* anchorY, int anchorCount,
+                                                     int inputWidth, int inputHeight, const Options& options)
+    : decoder_(anchorX, anchorY, anchorCount, inputWidth, inputHeight, options.decoder),
+      suppression_(options.suppression), candidates_(static_cast<size_t>(std::max(0, anchorCount))),
+      maxFaces_(std::max(1, options.maxFaces)) {}
+
+template <int MaxFaces>
+int SsdDetectionPipeline<MaxFaces>::run(const float* boxes, const float* logits, Detection* faces) {
+    const int count = decoder_.decode(boxes, logits, candidates_.data(), static_cast<int>(candidates_.size()));
+    return suppression_.run(candidates_.data(), count, faces, maxFaces_);
+}
+
+template class SsdDetectionPipeline<kAnyFaceCount>;
+
+// ============================================================================
+// Single face
+// ============================================================================
+
+SsdDetectionPipeline<1>::SsdDetectionPipeline(const float* anchorX, const float* anchorY, int anchorCount,
+                                              int inputWidth, int inputHeight, const Options& options)
+    : anchorX_(anchorX), anchorY_(anchorY), anchorCount_(std::max(0, anchorCount)),
+      inverseWidth_(1.0f / static_cast<float>(std::max(1, inputWidth))),
+      inverseHeight_(1.0f / static_cast<float>(std::max(1, inputHeight))),
+      logitThreshold_(std::max(logitOf(options.decoder.minScore), logitOf(options.suppression.minScore))),
+      scoreClip_(std::max(0.0f, options.decoder.scoreClip)),
+      keypointCount_(std::clamp(options.decoder.keypointCount, 0, Detection::kMaxKeypoints)),
+      mode_(options.suppression.mode), iouThreshold_(options.suppression.iouThreshold),
+      listCapacity_(std::min(kMaxSurvivors, std::max(1, options.suppression.maxCandidates))),
+      general_(anchorX, anchorY, anchorCount, inputWidth, inputHeight, options) {}
+
+int SsdDetectionPipeline<1>::run(const float* boxes, const float* logits, Detection* faces) {
+    if (faces == nullptr) {
+        return 0;
+    }
+    const int survivors = collect(logits);
+    if (survivors == 0) {
+        return 0;
+    }
+    if (survivors > listCapacity_) {
+        return general_.run(boxes, logits, faces);
+    }
+
+    // Highest clipped logit, the first on ties (as in NonMaxSuppression)
+    int best = 0;
+    for (int s = 1; s < survivors; ++s) {
+        best = survivorScores_[s] > survivorScores_[best] ? s : best;
+    }
+    const float bestLogit = survivorScores_[best];
+    const int anchor = survivors_[best];
+
+    // The best anchor decoded as SsdDecoder does
+    Detection& face = faces[0];
+    const float* raw = boxes + static_cast<size_t>(anchor) * (4 + 2 * keypointCount_);
+    const float ax = anchorX_[anchor];
+    const float ay = anchorY_[anchor];
+    face = Detection{};
+    face.width = raw[2] * inverseWidth_;
+    face.height = raw[3] * inverseHeight_;
+    face.x = raw[0] * inverseWidth_ + ax - face.width * 0.5f;
+    face.y = raw[1] * inverseHeight_ + ay - face.height * 0.5f;
+    face.score = sigmoid(bestLogit);
+    face.keypointCount = keypointCount_;
+    for (int k = 0; k < keypointCount_; ++k) {
+        face.keypoints[k][0] = raw[4 + k * 2] * inverseWidth_ + ax;
+        face.keypoints[k][1] = raw[5 + k * 2] * inverseHeight_ + ay;
+    }
+
+    if (mode_ == NonMaxSuppression::Mode::Weighted) {
+        if (keypointCount_ == Detection::kMaxKeypoints) {
+            mergeCluster<Detection::kMaxKeypoints>(boxes, survivors, anchor, face);
+        } else {
+            mergeCluster<-1>(boxes, survivors, anchor, face);
+        }
+    }
+    return 1;
+}
+
+int SsdDetectionPipeline<1>::collect(const float* logits) {
+    // Every lane is stored and the cursor only advances for survivors, as
+    // in SsdDecoder; the scan stops once the list is over capacity. Members
+    // are read into locals once; the list stores could otherwise alias them.
+    const int anchorCount = anchorCount_;
+    const int capacity = listCapacity_;
+    const float clip = scoreClip_;
+    const float logitThreshold = logitThreshold_;
+    int* survivors = survivors_.data();
+    float* survivorScores = survivorScores_.data();
+    int count = 0;
+    int i = 0;
+#if ACM_SIMD_SSE2
+    const __m128 low = _mm_set1_ps(-clip);
+    const __m128 high = _mm_set1_ps(clip);
+    const __m128 threshold = _mm_set1_ps(logitThreshold);
+    const auto above = [&](int at, __m128& clipped) {
+        clipped = _mm_max_ps(_mm_min_ps(_mm_loadu_ps(logits + at), high), low);
+        return _mm_cmpge_ps(clipped, threshold);
+    };
+    const auto list = [&](int at, __m128 clipped, __m128 over) {
+        const int mask = _mm_movemask_ps(over);
+        alignas(16) float lanes[4];
+        _mm_store_ps(lanes, clipped);
+        for (int k = 0; k < 4; ++k) {
+            survivors[count] = at + k;
+            survivorScores[count] = lanes[k];
+            count += (mask >> k) & 1;
+        }
+    };
+    // Sixteen logits per test: nearly every group is below the threshold
+    for (; i + 16 <= anchorCount; i += 16) {
+        __m128 c0, c1, c2, c3;
+        const __m128 a0 = above(i, c0);
+        const __m128 a1 = above(i + 4, c1);
+        const __m128 a2 = above(i + 8, c2);
+        const __m128 a3 = above(i + 12, c3);
+        if (_mm_movemask_ps(_mm_or_ps(_mm_or_ps(a0, a1), _mm_or_ps(a2, a3))) == 0) {
+            continue;
+        }
+        if (count + 16 > capacity + 4) {
+            break;   // The scalar loop finishes the group and stops at capacity
+        }
+        list(i, c0, a0);
+        list(i + 4, c1, a1);
+        list(i + 8, c2, a2);
+        list(i + 12, c3, a3);
+    }
+#elif ACM_SIMD_NEON
+    const float32x4_t low = vdupq_n_f32(-clip);
+    const float32x4_t high = vdupq_n_f32(clip);
+    const float32x4_t threshold = vdupq_n_f32(logitThreshold);
+    const auto above = [&](int at, float32x4_t& clipped) {
+        clipped = vmaxq_f32(vminq_f32(vld1q_f32(logits + at), high), low);
+        return vcgeq_f32(clipped, threshold);
+    };
+    const auto list = [&](int at, float32x4_t clipped, uint32x4_t over) {
+        float lanes[4];
+        uint32_t flags[4];
+        vst1q_f32(lanes, clipped);
+        vst1q_u32(flags, over);
+        for (int k = 0; k < 4; ++k) {
+            survivors[count] = at + k;
+            survivorScores[count] = lanes[k];
+            count += flags[k] & 1;
+        }
+    };
+    for (; i + 16 <= anchorCount; i += 16) {
+        float32x4_t c0, c1, c2, c3;
+        const uint32x4_t a0 = above(i, c0);
+        const uint32x4_t a1 = above(i + 4, c1);
+        const uint32x4_t a2 = above(i + 8, c2);
+        const uint32x4_t a3 = above(i + 12, c3);
+        if (vmaxvq_u32(vorrq_u32(vorrq_u32(a0, a1), vorrq_u32(a2, a3))) == 0) {
+            continue;
+        }
+        if (count + 16 > capacity + 4) {
+            break;
+        }
+        list(i, c0, a0);
+        list(i + 4, c1, a1);
+        list(i + 8, c2, a2);
+        list(i + 12, c3, a3);
+    }
+#endif
+    for (; i < anchorCount && count <= capacity; ++i) {
+        const float clipped = std::clamp(logits[i], -clip, clip);
+        survivors[count] = i;
+        survivorScores[count] = clipped;
+        count += clipped >= logitThreshold ? 1 : 0;
+    }
+    return count;
+}
+
+template <int Keypoints>
+void SsdDetectionPipeline<1>::mergeCluster(const float* boxes, int survivors, int best, Detection& face) {
+    const int keypoints = Keypoints >= 0 ? Keypoints : keypointCount_;
+    const int stride = 4 + 2 * keypointCount_;
+    const float* anchorX = anchorX_;
+    const float* anchorY = anchorY_;
+    const float inverseWidth = inverseWidth_;
+    const float inverseHeight = inverseHeight_;
+    const float threshold = iouThreshold_;
+    const int* anchors = survivors_.data();
+    float* scores = survivorScores_.data();
+
+    // Weights for the whole list at once, four per call where SIMD is available
+    sigmoidInPlace(scores, survivors);
+
+    const Box top = decodeBox(boxes + static_cast<size_t>(best) * stride, anchorX[best], anchorY[best],
+                              inverseWidth, inverseHeight);
+    const float topArea = (top.x1 - top.x0) * (top.y1 - top.y0);
+
+    float weight = 0.0f;
+    float sumX0 = 0.0f;
+    float sumY0 = 0.0f;
+    float sumX1 = 0.0f;
+    float sumY1 = 0.0f;
+    float sumKeypoints[Detection::kMaxKeypoints][2] = {};
+#if ACM_SIMD_SSE2
+    // Six keypoints are twelve interleaved (x, y) values: three vectors
+    constexpr bool kVectorKeypoints = Keypoints == 6;
+    const __m128 keypointScale = _mm_setr_ps(inverseWidth, inverseHeight, inverseWidth, inverseHeight);
+    __m128 sumKeypoints01 = _mm_setzero_ps();
+    __m128 sumKeypoints23 = _mm_setzero_ps();
+    __m128 sumKeypoints45 = _mm_setzero_ps();
+#elif ACM_SIMD_NEON
+    constexpr bool kVectorKeypoints = Keypoints == 6;
+    const float scaleLanes[4] = {inverseWidth, inverseHeight, inverseWidth, inverseHeight};
+    const float32x4_t keypointScale = vld1q_f32(scaleLanes);
+    float32x4_t sumKeypoints01 = vdupq_n_f32(0.0f);
+    float32x4_t sumKeypoints23 = vdupq_n_f32(0.0f);
+    float32x4_t sumKeypoints45 = vdupq_n_f32(0.0f);
+#else
+    constexpr bool kVectorKeypoints = false;
+#endif
+
+    for (int s = 0; s < survivors; ++s) {
+        // IoU > threshold without the division, as NonMaxSuppression tests
+        // it; the best anchor belongs to its own cluster even when degenerate
+        const int anchor = anchors[s];
+        const float* raw = boxes + static_cast<size_t>(anchor) * stride;
+        const float ax = anchorX[anchor];
+        const float ay = anchorY[anchor];
+        const Box box = decodeBox(raw, ax, ay, inverseWidth, inverseHeight);
+        const float w = std::max(0.0f, std::min(top.x1, box.x1) - std::max(top.x0, box.x0));
+        const float h = std::max(0.0f, std::min(top.y1, box.y1) - std::max(top.y0, box.y0));
+        const float intersection = w * h;
+        const float area = (box.x1 - box.x0) * (box.y1 - box.y0);
+        if (anchor != best && !(intersection > threshold * (topArea + area - intersection))) {
+            continue;
+        }
+
+        const float score = scores[s];
+        weight += score;
+        sumX0 += box.x0 * score;
+        sumY0 += box.y0 * score;
+        sumX1 += box.x1 * score;
+        sumY1 += box.y1 * score;
+        if constexpr (kVectorKeypoints) {
+#if ACM_SIMD_SSE2
+            const __m128 origin = _mm_setr_ps(ax, ay, ax, ay);
+            const __m128 weight4 = _mm_set1_ps(score);
+            const auto weighted = [&](const float* values) {
+                return _mm_mul_ps(_mm_add_ps(_mm_mul_ps(_mm_loadu_ps(values), keypointScale), origin), weight4);
+            };
+            sumKeypoints01 = _mm_add_ps(sumKeypoints01, weighted(raw + 4));
+            sumKeypoints23 = _mm_add_ps(sumKeypoints23, weighted(raw + 8));
+            sumKeypoints45 = _mm_add_ps(sumKeypoints45, weighted(raw + 12));
+#elif ACM_SIMD_NEON
+            const float originLanes[4] = {ax, ay, ax, ay};
+            const float32x4_t origin = vld1q_f32(originLanes);
+            const auto point = [&](const float* values) {
+                return vmlaq_f32(origin, vld1q_f32(values), keypointScale);
+            };
+            sumKeypoints01 = vmlaq_n_f32(sumKeypoints01, point(raw + 4), score);
+            sumKeypoints23 = vmlaq_n_f32(sumKeypoints23, point(raw + 8), score);
+            sumKeypoints45 = vmlaq_n_f32(sumKeypoints45, point(raw + 12), score);
+#endif
+        } else {
+            for (int p = 0; p < keypoints; ++p) {
+                sumKeypoints[p][0] += (raw[4 + p * 2] * inverseWidth + ax) * score;
+                sumKeypoints[p][1] += (raw[5 + p * 2] * inverseHeight + ay) * score;
+            }
+        }
+    }
+    if constexpr (kVectorKeypoints) {
+#if ACM_SIMD_SSE2
+        _mm_storeu_ps(&sumKeypoints[0][0], sumKeypoints01);
+        _mm_storeu_ps(&sumKeypoints[2][0], sumKeypoints23);
+        _mm_storeu_ps(&sumKeypoints[4][0], sumKeypoints45);
+#elif ACM_SIMD_NEON
+        vst1q_f32(&sumKeypoints[0][0], sumKeypoints01);
+        vst1q_f32(&sumKeypoints[2][0], sumKeypoints23);
+        vst1q_f32(&sumKeypoints[4][0], sumKeypoints45);
+#endif
+    }
+
+    if (weight > 0.0f) {
+        const float inverse = 1.0f / weight;
+        face.x = sumX0 * inverse;
+        face.y = sumY0 * inverse;
+        face.width = (sumX1 - sumX0) * inverse;
+        face.height = (sumY1 - sumY0) * inverse;
+        for (int p = 0; p < keypoints; ++p) {
+            face.keypoints[p][0] = sumKeypoints[p][0] * inverse;
+            face.keypoints[p][1] = sumKeypoints[p][1] * inverse;
+        }
+    }
+}
+
+} // namespace AnonCam
@@ -1,5 +1,13 @@
 #include "FaceTracker.h"
+#include "CaptureFile.h"
+#include "LandmarkStream.h"
+#include "Logger.h"
+#include "ShadowEvaluator.h"
+#include "WorkerPool.h"
 #include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
 #include <cmath>
 #include <mutex>
 
@@ -12,6 +20,58 @@ namespace {
 // Helper for 3D math
 constexpr float kPi = 3.14159265358979323846f;
 
+// Samples per side of the tracked face region
+constexpr int kTrackPatchSize = 32;
+// Face-presence score of the stub landmark model
+constexpr float kStubPresence = 0.95f;
+using TrackPatch = std::array<uint8_t, kTrackPatchSize * kTrackPatchSize>;
+
+// Luma of one pixel for any supported format
+inline int lumaAt(const AnonCam::ImageView& frame, int x, int y) {
+    const uint8_t* row = frame.row(0, y);
+    if (frame.format == AnonCam::PixelFormat::BGRA) {
+        const uint8_t* p = row + static_cast<size_t>(x) * 4;
+        return (p[0] * 29 + p[1] * 150 + p[2] * 77) >> 8;
+    }
+    return row[x];
+}
+
+// Point-sample a normalized region (x0, y0, x1, y1) onto a patch
+void sampleRegion(const AnonCam::ImageView& frame, const float* region, TrackPatch& patch) {
+    for (int j = 0; j < kTrackPatchSize; ++j) {
+        const float v = region[1] + (region[3] - region[1]) * (j + 0.5f) / kTrackPatchSize;
+        const int y = std::clamp(static_cast<int>(v * frame.height), 0, frame.height - 1);
+        for (int i = 0; i < kTrackPatchSize; ++i) {
+            const float u = region[0] + (region[2] - region[0]) * (i + 0.5f) / kTrackPatchSize;
+            const int x = std::clamp(static_cast<int>(u * frame.width), 0, frame.width - 1);
+            patch[j * kTrackPatchSize + i] = static_cast<uint8_t>(lumaAt(frame, x, y));
+        }
+    }
+}
+
+int64_t steadyNs(std::chrono::steady_clock::time_point time) {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(time.time_since_epoch()).count();
+}
+
+int64_t steadyNowNs() {
+    return steadyNs(std::chrono::steady_clock::now());
+}
+
+// One run of the landmark model. The stub's model output is its
+// face-presence score, a constant: it does not look at the input.
+struct LandmarkRequest {
+    const TrackPatch* input;
+    float presence;
+};
+
+// The stub landmark model in batch form (InferenceBatcher::BatchFunction)
+void runLandmarkBatch(void* const* requests, int count) {
+    for (int i = 0; i < count; ++i) {
+        auto* request = static_cast<LandmarkRequest*>(requests[i]);
+        request->presence = kStubPresence;
+    }
+}
+
 // Simple 3x3 matrix operations for pose calculation
 struct Matrix3x3 {
     float m[9]; // Row-major
@@ -77,24 +137,152 @@ namespace AnonCam {
 class FaceTracker::Impl {
 public:
     explicit Impl(const FaceTracker::Config& config)
-        : config_(config), lastResult_() {}
+        : config_(config), lastResult_(), trackLoss_(config.trackLoss) {
+        if (config_.enableDenoising) {
+            denoiser_ = std::make_unique<TemporalDenoiser>(config_.denoising, workerPool());
+        }
+        ready_.store(makeDetector(config_, workerPool(), detector_, slicedDetection_), std::memory_order_relaxed);
+        if (config_.normalizeLuma) {
+            normalizer_ = std::make_unique<LumaNormalizer>(config_.lumaNormalization);
+        }
+        if (config_.refineEyesAndLips) {
+            refiner_ = std::make_unique<LandmarkRefiner>(config_.refinement, workerPool());
+        }
+        if (config_.landmarkBatcher) {
+            batcherStream_ = config_.landmarkBatcher->attachStream();
+        }
+        latestConfig_ = std::make_shared<const FaceTracker::Config>(config_);
+    }
+
+    ~Impl() {
+        if (config_.landmarkBatcher) {
+            config_.landmarkBatcher->detachStream(batcherStream_);
+        }
+    }
+
+    // Prepares what the new configuration cannot share with the applied one
+    // (worker threads, detector) on the caller's thread, outside the config
+    // lock so a cascade load never holds up the frame thread; processFrame
+    // swaps it in at the start of the next frame. A later update replaces
+    // one that has not been applied yet.
+    bool updateConfig(const FaceTracker::Config& config) {
+        for (;;) {
+            FaceTracker::Config applied;
+            WorkerPool* appliedWorkers = nullptr;
+            uint64_t generation = 0;
+            {
+                std::lock_guard<std::mutex> lock(configMutex_);
+                applied = config_;
+                appliedWorkers = workers_.get();
+                generation = appliedConfigs_;
+            }
+
+            auto next = std::make_unique<PendingConfig>();
+            next->config = std::make_shared<const FaceTracker::Config>(config);
+            if (threadCount(config) != threadCount(applied)) {
+                next->workers = std::make_unique<WorkerPool>(threadCount(config));
+            }
+            if (next->workers || !sameDetector(config, applied)) {
+                next->replaceDetector = true;
+                WorkerPool* workers = next->workers ? next->workers.get() : appliedWorkers;
+                if (!makeDetector(config, workers, next->detector, next->slicedDetection)) {
+                    return false;
+                }
+            }
+
+            std::lock_guard<std::mutex> lock(configMutex_);
+            // Another update was applied meanwhile: prepare against that one
+            if (appliedConfigs_ != generation) {
+                continue;
+            }
+            latestConfig_ = next->config;
+            pendingConfig_ = std::move(next);
+            configPending_.store(true, std::memory_order_release);
+            return true;
+        }
+    }
 
-    ~Impl() = default;
+    FaceTracker::Config latestConfig() const {
+        std::lock_guard<std::mutex> lock(configMutex_);
+        return *latestConfig_;
+    }
+
+    // Frame boundary: switch to a pending configuration, keeping every
+    // stage (and its state) whose settings did not change
+    void applyPendingConfig() {
+        if (!configPending_.load(std::memory_order_acquire)) {
+            return;
+        }
+        // Destroyed last, after the stages that used it were replaced
+        std::unique_ptr<WorkerPool> retiredWorkers;
+
+        std::lock_guard<std::mutex> configLock(configMutex_);
+        configPending_.store(false, std::memory_order_relaxed);
+        const std::unique_ptr<PendingConfig> pending = std::move(pendingConfig_);
+        if (!pending) {
+            return;
+        }
+        const FaceTracker::Config previous = std::move(config_);
+        config_ = *pending->config;
+        ++appliedConfigs_;
+
+        const bool newWorkers = pending->workers != nullptr;
+        if (newWorkers) {
+            retiredWorkers = std::move(workers_);
+            workers_ = std::move(pending->workers);
+        }
+        if (pending->replaceDetector) {
+            detector_ = std::move(pending->detector);
+            slicedDetection_ = pending->slicedDetection;
+            detections_.clear();
+            ready_.store(true, std::memory_order_relaxed);
+        }
+        if (newWorkers || config_.enableDenoising != previous.enableDenoising ||
+            !(config_.denoising == previous.denoising)) {
+            denoiser_ = config_.enableDenoising
+                ? std::make_unique<TemporalDenoiser>(config_.denoising, workerPool()) : nullptr;
+        }
+        if (config_.normalizeLuma != previous.normalizeLuma ||
+            !(config_.lumaNormalization == previous.lumaNormalization)) {
+            normalizer_ = config_.normalizeLuma ? std::make_unique<LumaNormalizer>(config_.lumaNormalization) : nullptr;
+        }
+        if (newWorkers || config_.refineEyesAndLips != previous.refineEyesAndLips ||
+            !(config_.refinement == previous.refinement)) {
+            refiner_ = config_.refineEyesAndLips
+                ? std::make_unique<LandmarkRefiner>(config_.refinement, workerPool()) : nullptr;
+        }
+        if (!(config_.trackLoss == previous.trackLoss)) {
+            trackLoss_ = TrackLossPolicy(config_.trackLoss);
+        }
+        if (config_.enableSegmentation && !previous.enableSegmentation) {
+            segmenterResetPending_ = true;
+        }
+        if (config_.landmarkBatcher != previous.landmarkBatcher) {
+            if (previous.landmarkBatcher) {
+                previous.landmarkBatcher->detachStream(batcherStream_);
+            }
+            if (config_.landmarkBatcher) {
+                batcherStream_ = config_.landmarkBatcher->attachStream();
+            }
+        }
 
-    FaceResult processFrame(CVPixelBufferRef pixelBuffer) {
         std::lock_guard<std::mutex> lock(mutex_);
+        ++stats_.configUpdates;
+    }
+
+    FaceResult processFrame(const ImageView& frame, int64_t timestampNs, const CancellationToken& cancel) {
+        std::unique_lock<std::mutex> lock(mutex_);
 
         FaceResult result;
         result.hasFace = false;
+        result.timestampNs = timestampNs;
+        stageTrack();
 
-        if (!pixelBuffer) {
+        // A cancelled frame leaves the track and the last result alone
+        if (!frame.isValid() || cancel.isCancelled()) {
             return result;
         }
 
-        // Get frame dimensions
-        const int width = static_cast<int>(CVPixelBufferGetWidth(pixelBuffer));
-        const int height = static_cast<int>(CVPixelBufferGetHeight(pixelBuffer));
-
         // ================================================================
         // TODO: Integrate actual MediaPipe Face Mesh graph here
         // ================================================================
@@ -102,16 +290,13 @@ public:
         // Pseudo-code for MediaPipe integration:
         //
         // 1. Create a MediaPipe ImageFrame from CVPixelBuffer:
-        //    mediapipe::ImageFrame frame(mediapipe::ImageFormat::SRGBA, width, height);
-        //    CVPixelBufferLockBaseAddress(pixelBuffer, kCVPixelBufferLock_ReadOnly);
-        //    const uint8_t* src = static_cast<const uint8_t*>(CVPixelBufferGetBaseAddress(pixelBuffer));
-        //    std::memcpy(frame.MutablePixelData(), src, width * height * 4);
-        //    CVPixelBufferUnlockBaseAddress(pixelBuffer, kCVPixelBufferLock_ReadOnly);
+        //    mediapipe::ImageFrame image(mediapipe::ImageFormat::SRGBA, frame.width, frame.height);
+        //    std::memcpy(image.MutablePixelData(), frame.planes[0], frame.width * frame.height * 4);
         //
         // 2. Add packet to calculator graph:
         //    MP_RETURN_IF_ERROR(graph_.AddPacketToInputStream(
         //        "input_video",
-        //        mediapipe::Adopt(frame.release()).At(mediapipe::Timestamp(timestamp++))));
+        //        mediapipe::Adopt(image.release()).At(mediapipe::Timestamp(timestamp++))));
         //
         // 3. Get landmark output:
         //    mediapipe::Packet packet;
@@ -147,18 +332,66 @@ public:
         // ================================================================
         // In production, this would be replaced with actual MediaPipe calls
 
-        // Simulated face detection - return mock landmarks
+        // Tracking vs. detection: while a face is tracked the landmark model
+        // runs on the region found in the previous frame, and only a lost
+        // track falls back to the (much more expensive) full-frame detector.
+        // The stub's score is a constant, so the stub never loses a track
+        // on its own; nothing before the model (denoising, luma
+        // normalization) changes how often it re-detects.
+        //
+        // A time-sliced detector instead scans part of the frame on every
+        // frame, tracked or not, within its budget; a lost track then picks
+        // from the candidates merged so far instead of paying for a full pass.
+        ++stats_.framesProcessed;
+        if (slicedDetection_) {
+            runDetector(frame, cancel);
+        }
+        float trackingScore = 0.0f;
+        if (tracking_) {
+            TrackPatch input;
+            sampleModelInput(frame, input);
+            // A shared batch may wait for other streams: getStats() and
+            // reset() are not held up meanwhile
+            lock.unlock();
+            trackingScore = runLandmarkModel(input);
+            lock.lock();
+            if (cancel.isCancelled()) {
+                return result;
+            }
+        } else if (config_.landmarkBatcher) {
+            config_.landmarkBatcher->skip(batcherStream_);
+        }
+        const bool detect = !tracking_ || trackingScore < config_.minTrackingConfidence;
+
+        // Face box (x0, y0, x1, y1) for the landmark model: a new detection
+        // or the tracked region
+        float box[4] = {region_[0], region_[1], region_[2], region_[3]};
+        result.confidence = trackingScore;
+        if (detect) {
+            ++stats_.detections;
+            if (tracking_) {
+                ++stats_.reDetections;
+            }
+            if (!detectFace(frame, box, result.confidence, cancel)) {
+                if (cancel.isCancelled()) {
+                    return result;
+                }
+                staged_.tracking = false;
+                return result;
+            }
+        }
+
+        // Simulated landmark model - return mock landmarks in the face box
         result.hasFace = true;
-        result.confidence = 0.95f;
 
         const int kNumLandmarks = 478; // MediaPipe Face Mesh
         result.landmarks.reserve(kNumLandmarks);
 
-        // Create mock face mesh centered at frame center
-        const float centerX = 0.5f;
-        const float centerY = 0.5f;
-        const float faceWidth = 0.3f;
-        const float faceHeight = 0.4f;
+        // Create mock face mesh filling the face box
+        const float centerX = (box[0] + box[2]) * 0.5f;
+        const float centerY = (box[1] + box[3]) * 0.5f;
+        const float faceWidth = box[2] - box[0];
+        const float faceHeight = box[3] - box[1];
 
         // Simplified mesh generation - creates a face-like pattern
         for (int i = 0; i < kNumLandmarks; ++i) {
@@ -180,24 +413,442 @@ public:
             result.landmarks.push_back(lm);
         }
 
-        lastResult_ = result;
+        // The next frame tracks the bounds of these landmarks
+        updateRegion(result.landmarks, staged_.region);
+        staged_.tracking = true;
         return result;
     }
 
+    // The finished result of a frame, as processFrame() returned it; pooled
+    // buffers (mask, denoised frame) stay with the caller's copy
+    void storeLastResult(const FaceResult& result) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        lastResult_ = result;
+        lastResult_.segmentationMask = SegmentationMask{};
+        lastResult_.denoisedFrame = DenoisedFrame{};
+    }
+
     FaceResult getLastResult() const {
         std::lock_guard<std::mutex> lock(mutex_);
         return lastResult_;
     }
 
+    // Cancels the frame in flight so the lock is released at its next
+    // check. Holding the gate keeps the next frame from taking the lock
+    // back first; it starts once the reset is done.
     void reset() {
+        const int64_t requested = steadyNowNs();
+        std::lock_guard<std::mutex> gate(frameGate_);
+        resetRequestNs_.store(requested, std::memory_order_relaxed);
+        cancellation_.cancel();
+
         std::lock_guard<std::mutex> lock(mutex_);
+        stats_.lastResetWaitNs = steadyNowNs() - requested;
         lastResult_ = FaceResult{};
+        tracking_ = false;
+        segmenterResetPending_ = true;
+        denoiserResetPending_ = true;
+        refinerResetPending_ = true;
+        trackLossResetPending_ = true;
     }
 
+    FaceTracker::Stats getStats() const {
+        FaceTracker::Stats stats;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stats = stats_;
+        }
+        std::lock_guard<std::mutex> lock(recorderMutex_);
+        if (recorder_) {
+            stats.recordsDropped = recorder_->stats().dropped;
+        }
+        return stats;
+    }
+
+    void cancel() { cancellation_.cancel(); }
+
+    // Token for the frame about to start; reset() and cancel() cancel it.
+    // Waits while a reset() is in progress.
+    CancellationToken beginFrame() {
+        std::lock_guard<std::mutex> gate(frameGate_);
+        return cancellation_.token();
+    }
+
+    // Result of a frame cancelled at any stage: no face, whole frame anonymized
+    FaceResult abandon(FaceResult& result) {
+        result.hasFace = false;
+        result.cancelled = true;
+        result.landmarks.clear();
+        result.segmentationMask = SegmentationMask{};
+        result.anonymization.mode = AnonymizationMode::FullFrame;
+        std::fill(result.anonymization.region, result.anonymization.region + 4, 0.0f);
+        result.anonymization.region[2] = result.anonymization.region[3] = 1.0f;
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        ++stats_.cancelledFrames;
+        return std::move(result);
+    }
+
+    // A frame completed; the first one started after a reset() ends the switch
+    void finishFrame(std::chrono::steady_clock::time_point start) {
+        int64_t requested = resetRequestNs_.load(std::memory_order_relaxed);
+        if (requested == 0 || steadyNs(start) < requested ||
+            !resetRequestNs_.compare_exchange_strong(requested, 0, std::memory_order_relaxed)) {
+            return;
+        }
+        std::lock_guard<std::mutex> lock(mutex_);
+        stats_.lastSwitchLatencyNs = steadyNowNs() - requested;
+    }
+
+    const FaceTracker::Config& config() const { return config_; }
+
+    // Frame the rest of the pipeline works on: the denoised frame, or the
+    // camera frame when denoising is off or no pooled frame is free
+    ImageView denoise(const ImageView& frame, DenoisedFrame& denoised, const CancellationToken& cancel) {
+        if (!denoiser_) {
+            return frame;
+        }
+        if (denoiserResetPending_.exchange(false)) {
+            denoiser_->reset();
+        }
+        if (!denoiser_->process(frame, denoised, cancel)) {
+            return frame;
+        }
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        stats_.denoiseNs += static_cast<uint64_t>(denoiser_->stats().lastProcessNs);
+        return denoised.view;
+    }
+
+    bool startRecording(const std::string& path, int frameDownscale) {
+        auto writer = std::make_unique<CaptureRecorder>();
+        CaptureRecorder::Options options;
+        options.writer.frameDownscale = frameDownscale;
+        if (!writer->open(path, options)) {
+            ACM_LOG(Error, "could not create capture file {}", path);
+            return false;
+        }
+
+        std::lock_guard<std::mutex> lock(recorderMutex_);
+        recorder_ = std::move(writer);
+        return true;
+    }
+
+    void stopRecording() {
+        std::unique_ptr<CaptureRecorder> writer;
+        {
+            std::lock_guard<std::mutex> lock(recorderMutex_);
+            writer = std::move(recorder_);
+        }
+        if (writer) {
+            writer->close();
+        }
+    }
+
+    void refine(const ImageView& frame, FaceResult& result, const CancellationToken& cancel) {
+        if (!refiner_) {
+            return;
+        }
+        if (refinerResetPending_.exchange(false) || !result.hasFace) {
+            refiner_->reset();
+        }
+        if (!result.hasFace ||
+            !refiner_->refine(frame, result.landmarks.data(), result.landmarks.size(), cancel)) {
+            return;
+        }
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        stats_.refinementNs += static_cast<uint64_t>(refiner_->stats().lastProcessNs);
+    }
+
+    void anonymize(FaceResult& result) {
+        if (trackLossResetPending_.load()) {
+            staged_.trackLoss.reset();
+            staged_.trackLossReset = true;
+        }
+        result.anonymization = staged_.trackLoss.update(result.hasFace, result.landmarks.data(),
+                                                        result.landmarks.size(), result.timestampNs);
+    }
+
+    // Last check of a frame: applies what it changed in the track unless it
+    // was cancelled. reset() cancels before taking the lock, so a frame that
+    // passes here finished before the reset began.
+    bool commitFrame(const CancellationToken& cancel) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (cancel.isCancelled()) {
+            return false;
+        }
+        tracking_ = staged_.tracking;
+        std::copy(staged_.region, staged_.region + 4, region_);
+        trackLoss_ = staged_.trackLoss;
+        if (staged_.trackLossReset) {
+            trackLossResetPending_ = false;
+        }
+        return true;
+    }
+
+    void segment(const ImageView& frame, FaceResult& result, const CancellationToken& cancel) {
+        if (!config_.enableSegmentation || cancel.isCancelled()) {
+            return;
+        }
+        if (segmenterResetPending_.exchange(false) || !result.hasFace) {
+            segmenter_.reset();
+        }
+        if (!result.hasFace) {
+            return;
+        }
+        // An exhausted pool (consumers holding every mask) leaves the mask invalid
+        segmenter_.segment(result.landmarks.data(), result.landmarks.size(), frame, result.segmentationMask);
+    }
+
+    void record(const ImageView& frame, const FaceResult& result) {
+        // Downscale and copy only; the recorder's thread writes the file
+        std::lock_guard<std::mutex> lock(recorderMutex_);
+        if (recorder_) {
+            recorder_->append(result.timestampNs, &frame, result);
+        }
+    }
+
+    bool startPublishing(const std::string& socketPath) {
+        auto publisher = std::make_unique<LandmarkPublisher>();
+        if (!publisher->start(socketPath)) {
+            ACM_LOG(Error, "could not listen on {}", socketPath);
+            return false;
+        }
+
+        std::lock_guard<std::mutex> lock(publisherMutex_);
+        publisher_ = std::move(publisher);
+        return true;
+    }
+
+    void stopPublishing() {
+        std::lock_guard<std::mutex> lock(publisherMutex_);
+        publisher_.reset();
+    }
+
+    void publish(const FaceResult& result) {
+        std::lock_guard<std::mutex> lock(publisherMutex_);
+        if (publisher_) {
+            publisher_->publish(result);
+        }
+    }
+
+    void startShadow(std::shared_ptr<ShadowEvaluator> evaluator) {
+        std::lock_guard<std::mutex> lock(shadowMutex_);
+        shadow_ = std::move(evaluator);
+    }
+
+    void stopShadow() {
+        std::shared_ptr<ShadowEvaluator> evaluator;
+        {
+            std::lock_guard<std::mutex> lock(shadowMutex_);
+            evaluator = std::move(shadow_);
+        }
+        // Released here, outside the lock: the last owner joins the candidate thread
+    }
+
+    void shadow(const ImageView& frame, const FaceResult& result, int64_t latencyNs) {
+        std::lock_guard<std::mutex> lock(shadowMutex_);
+        if (shadow_) {
+            shadow_->offer(frame, result.timestampNs, result, latencyNs);
+        }
+    }
+
+    bool isReady() const { return ready_.load(std::memory_order_relaxed); }
+
 private:
+    // Configuration accepted by updateConfig() and what it could not share
+    struct PendingConfig {
+        std::shared_ptr<const FaceTracker::Config> config;
+        std::unique_ptr<WorkerPool> workers;       // Thread count changed
+        bool replaceDetector = false;
+        std::unique_ptr<FaceDetector> detector;    // Null = model detector
+        bool slicedDetection = false;
+    };
+
+    static int threadCount(const FaceTracker::Config& config) {
+        return config.workerThreads < 0 ? WorkerPool::defaultThreadCount() : config.workerThreads;
+    }
+
+    static bool sameDetector(const FaceTracker::Config& a, const FaceTracker::Config& b) {
+        return a.detector == b.detector &&
+               (a.detector != FaceTracker::DetectorBackend::Cascade ||
+                (a.cascadePath == b.cascadePath && a.cascade == b.cascade));
+    }
+
+    // Detection backend of a configuration (null = model detector)
+    // @return false if the cascade could not be loaded
+    static bool makeDetector(const FaceTracker::Config& config, WorkerPool* workers,
+                             std::unique_ptr<FaceDetector>& detector, bool& sliced) {
+        detector.reset();
+        sliced = false;
+        if (config.detector != FaceTracker::DetectorBackend::Cascade) {
+            return true;
+        }
+        auto cascade = std::make_unique<CascadeDetector>(config.cascade, workers);
+        const bool loaded = cascade->load(config.cascadePath);
+        if (!loaded) {
+            ACM_LOG(Error, "could not load cascade {}", config.cascadePath);
+        }
+        sliced = cascade->isTimeSliced();
+        detector = std::move(cascade);
+        return loaded;
+    }
+
+    WorkerPool* workerPool() {
+        if (!workers_) {
+            workers_ = std::make_unique<WorkerPool>(threadCount(config_));
+        }
+        return workers_.get();
+    }
+
+    // Full-frame detection; the stub model "finds" a face at the frame center.
+    // A time-sliced detector already ran this frame (processFrame).
+    bool detectFace(const ImageView& frame, float* box, float& score, const CancellationToken& cancel) {
+        if (!detector_) {
+            box[0] = 0.35f;
+            box[1] = 0.3f;
+            box[2] = 0.65f;
+            box[3] = 0.7f;
+            score = 0.95f;
+            return true;
+        }
+        if ((!slicedDetection_ && !runDetector(frame, cancel)) || detections_.empty()) {
+            return false;
+        }
+        const Detection& best = detections_.front();
+        box[0] = std::clamp(best.x, 0.0f, 1.0f);
+        box[1] = std::clamp(best.y, 0.0f, 1.0f);
+        box[2] = std::clamp(best.x + best.width, box[0], 1.0f);
+        box[3] = std::clamp(best.y + best.height, box[1], 1.0f);
+        score = best.score;
+        return true;
+    }
+
+    bool runDetector(const ImageView& frame, const CancellationToken& cancel) {
+        const auto begin = std::chrono::steady_clock::now();
+        const bool ok = detector_->detect(frame, detections_, cancel);
+        stats_.detectionNs += static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - begin).count());
+        return ok;
+    }
+
+    // Landmark model on the model input, batched with the other streams'
+    // inputs when trackers share a batcher (Config::landmarkBatcher)
+    float runLandmarkModel(const TrackPatch& input) {
+        LandmarkRequest request{&input, 0.0f};
+        void* requests[1] = {&request};
+        if (config_.landmarkBatcher) {
+            config_.landmarkBatcher->run(&request, batcherStream_);
+        } else {
+            runLandmarkBatch(requests, 1);
+        }
+        return request.presence;
+    }
+
+    // Model input: the tracked region resampled to the input size, with the
+    // region's luma normalized (Config::normalizeLuma)
+    void sampleModelInput(const ImageView& frame, TrackPatch& input) {
+        sampleRegion(frame, region_, input);
+        if (normalizer_ &&
+            normalizer_->analyze(frame, static_cast<int>(region_[0] * frame.width),
+                                 static_cast<int>(region_[1] * frame.height),
+                                 static_cast<int>(std::ceil(region_[2] * frame.width)),
+                                 static_cast<int>(std::ceil(region_[3] * frame.height)))) {
+            normalizer_->apply(input.data(), input.size());
+        }
+    }
+
+    // Start of a frame: the staged track starts from the committed one
+    void stageTrack() {
+        staged_.tracking = tracking_;
+        std::copy(region_, region_ + 4, staged_.region);
+        staged_.trackLoss = trackLoss_;
+        staged_.trackLossReset = false;
+    }
+
+    void updateRegion(const std::vector<Landmark>& landmarks, float* region) {
+        float minX = 1.0f, minY = 1.0f, maxX = 0.0f, maxY = 0.0f;
+        for (const auto& lm : landmarks) {
+            minX = std::min(minX, lm.x);
+            minY = std::min(minY, lm.y);
+            maxX = std::max(maxX, lm.x);
+            maxY = std::max(maxY, lm.y);
+        }
+        region[0] = std::clamp(minX, 0.0f, 1.0f);
+        region[1] = std::clamp(minY, 0.0f, 1.0f);
+        region[2] = std::clamp(maxX, region[0], 1.0f);
+        region[3] = std::clamp(maxY, region[1], 1.0f);
+    }
+
     FaceTracker::Config config_;
     FaceResult lastResult_;
-    std::mutex mutex_;
+    FaceTracker::Stats stats_;
+    mutable std::mutex mutex_;
+
+    // Tracked face region (normalized x0, y0, x1, y1), as of the last committed frame
+    bool tracking_ = false;
+    float region_[4] = {0.0f, 0.0f, 1.0f, 1.0f};
+    std::unique_ptr<LumaNormalizer> normalizer_;
+
+    // Shared by the tiled stages; created on first use
+    std::unique_ptr<WorkerPool> workers_;
+
+    // Hot-swapped configuration (updateConfig()); taken at the next frame
+    std::unique_ptr<PendingConfig> pendingConfig_;
+    std::shared_ptr<const FaceTracker::Config> latestConfig_;
+    std::atomic<bool> configPending_{false};
+    mutable std::mutex configMutex_;
+    uint64_t appliedConfigs_ = 0;      // Updates applied; config_ and workers_ change with it
+    int batcherStream_ = InferenceBatcher::kNoStream;  // Our id in config_.landmarkBatcher
+
+    // Detection backend (null = model detector)
+    std::unique_ptr<FaceDetector> detector_;
+    std::vector<Detection> detections_;
+    bool slicedDetection_ = false;     // Detector runs every frame (CascadeDetector::Options::sliceBudgetUs)
+    std::atomic<bool> ready_{true};    // Written by the frame thread, read by isReady() from any thread
+
+    // Low-light denoise (Config::enableDenoising); used by processFrame only
+    std::unique_ptr<TemporalDenoiser> denoiser_;
+    std::atomic<bool> denoiserResetPending_{false};
+
+    // Eye and lip refinement (Config::refineEyesAndLips); used by processFrame only
+    std::unique_ptr<LandmarkRefiner> refiner_;
+    std::atomic<bool> refinerResetPending_{false};
+
+    // Fail-closed anonymization on track loss; used by processFrame only
+    TrackLossPolicy trackLoss_;
+    std::atomic<bool> trackLossResetPending_{false};
+
+    // What the frame in flight changes in the track; commitFrame() applies it
+    struct StagedTrack {
+        bool tracking = false;
+        float region[4] = {0.0f, 0.0f, 1.0f, 1.0f};
+        TrackLossPolicy trackLoss;
+        bool trackLossReset = false;   // The frame started from a reset track-loss policy
+    };
+    StagedTrack staged_;
+
+    // Face alpha mask (Config::enableSegmentation); used by processFrame only
+    FaceSegmenter segmenter_;
+    std::atomic<bool> segmenterResetPending_{false};  // Set by reset() from any thread
+
+    // Cancels the frame in flight (reset(), cancel()); one token per frame
+    CancellationSource cancellation_;
+    std::mutex frameGate_;                     // Held by reset(); frames take their token through it
+    std::atomic<int64_t> resetRequestNs_{0};   // Last reset() not yet followed by a completed frame
+
+    // Optional capture of the input/result stream
+    std::unique_ptr<CaptureRecorder> recorder_;
+    mutable std::mutex recorderMutex_;
+
+    // Optional local streaming of results
+    std::unique_ptr<LandmarkPublisher> publisher_;
+    std::mutex publisherMutex_;
+
+    // Optional candidate configuration evaluated on sampled frames
+    std::shared_ptr<ShadowEvaluator> shadow_;
+    std::mutex shadowMutex_;
 
     // MediaPipe members (for actual integration):
     // std::unique_ptr<mediapipe::CalculatorGraph> graph_;
@@ -209,6 +860,9 @@ private:
 // FaceTracker implementation
 // ============================================================================
 
+FaceTracker::FaceTracker()
+    : FaceTracker(Config()) {}
+
 FaceTracker::FaceTracker(const Config& config)
     : impl_(std::make_unique<Impl>(config)) {
 
@@ -217,8 +871,6 @@ FaceTracker::FaceTracker(const Config& config)
     // 1. Setting up CalculatorGraph
     // 2. Loading FaceMesh graph config
     // 3. Starting the graph
-
-    initialized_ = true;
 }
 
 FaceTracker::~FaceTracker() = default;
@@ -227,8 +879,69 @@ FaceTracker::FaceTracker(FaceTracker&&) noexcept = default;
 
 FaceTracker& FaceTracker::operator=(FaceTracker&&) noexcept = default;
 
+std::shared_ptr<InferenceBatcher> FaceTracker::createLandmarkBatcher(const InferenceBatcher::Options& options) {
+    return std::make_shared<InferenceBatcher>(runLandmarkBatch, options);
+}
+
+#ifdef __APPLE__
 FaceResult FaceTracker::processFrame(CVPixelBufferRef pixelBuffer) {
-    auto result = impl_->processFrame(pixelBuffer);
+    if (!pixelBuffer) {
+        return FaceResult{};
+    }
+
+    const int64_t timestampNs = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+
+    if (CVPixelBufferLockBaseAddress(pixelBuffer, kCVPixelBufferLock_ReadOnly) != kCVReturnSuccess) {
+        return FaceResult{};
+    }
+
+    ImageView frame;
+    frame.width = static_cast<int>(CVPixelBufferGetWidth(pixelBuffer));
+    frame.height = static_cast<int>(CVPixelBufferGetHeight(pixelBuffer));
+
+    switch (CVPixelBufferGetPixelFormatType(pixelBuffer)) {
+        case kCVPixelFormatType_420YpCbCr8BiPlanarFullRange:
+        case kCVPixelFormatType_420YpCbCr8BiPlanarVideoRange:
+            frame.format = PixelFormat::NV12;
+            for (int plane = 0; plane < 2; ++plane) {
+                frame.planes[plane] = static_cast<const uint8_t*>(
+                    CVPixelBufferGetBaseAddressOfPlane(pixelBuffer, plane));
+                frame.bytesPerRow[plane] = CVPixelBufferGetBytesPerRowOfPlane(pixelBuffer, plane);
+            }
+            break;
+        case kCVPixelFormatType_OneComponent8:
+            frame.format = PixelFormat::Gray8;
+            frame.planes[0] = static_cast<const uint8_t*>(CVPixelBufferGetBaseAddress(pixelBuffer));
+            frame.bytesPerRow[0] = CVPixelBufferGetBytesPerRow(pixelBuffer);
+            break;
+        default:
+            frame.format = PixelFormat::BGRA;
+            frame.planes[0] = static_cast<const uint8_t*>(CVPixelBufferGetBaseAddress(pixelBuffer));
+            frame.bytesPerRow[0] = CVPixelBufferGetBytesPerRow(pixelBuffer);
+            break;
+    }
+
+    auto result = processFrame(frame, timestampNs);
+
+    CVPixelBufferUnlockBaseAddress(pixelBuffer, kCVPixelBufferLock_ReadOnly);
+    return result;
+}
+#endif
+
+FaceResult FaceTracker::processFrame(const ImageView& frame, int64_t timestampNs) {
+    const auto start = std::chrono::steady_clock::now();
+    // Stages check the token between units of work; reset() or cancel()
+    // ends the frame at the next check
+    const CancellationToken cancel = impl_->beginFrame();
+    impl_->applyPendingConfig();
+    DenoisedFrame denoised;
+    const ImageView input = impl_->denoise(frame, denoised, cancel);
+    auto result = impl_->processFrame(input, timestampNs, cancel);
+    impl_->refine(input, result, cancel);
+    if (cancel.isCancelled()) {
+        return impl_->abandon(result);
+    }
 
     if (result.hasFace) {
         extractKeyPoints(result.landmarks, result.keyPoints);
@@ -236,17 +949,82 @@ FaceResult FaceTracker::processFrame(CVPixelBufferRef pixelBuffer) {
         normalizeModelMatrix(result.pose, result.pose.modelMatrix);
     }
 
+    impl_->anonymize(result);
+    impl_->segment(input, result, cancel);
+    if (!impl_->commitFrame(cancel)) {
+        return impl_->abandon(result);
+    }
+    // Captures keep the camera frame so replays exercise the denoiser too
+    impl_->record(frame, result);
+    impl_->shadow(frame, result, std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - start).count());
+    result.denoisedFrame = std::move(denoised);
+
+    if (impl_->config().halfPrecisionLandmarks && !result.landmarks.empty()) {
+        result.landmarksHalf.resize(result.landmarks.size());
+        convertLandmarksToHalf(result.landmarks.data(), result.landmarks.size(), result.landmarksHalf.data());
+        result.landmarks = std::vector<Landmark>();
+    }
+
+    // Stored after the fp16 round-trip so getLastResult() honours halfPrecisionLandmarks
+    impl_->storeLastResult(result);
+    impl_->publish(result);
+    impl_->finishFrame(start);
     return result;
 }
 
+bool FaceTracker::isInitialized() const {
+    return impl_ && impl_->isReady();
+}
+
+bool FaceTracker::updateConfig(const Config& config) {
+    return impl_->updateConfig(config);
+}
+
+FaceTracker::Config FaceTracker::getConfig() const {
+    return impl_->latestConfig();
+}
+
 void FaceTracker::reset() {
     impl_->reset();
 }
 
+void FaceTracker::cancel() {
+    impl_->cancel();
+}
+
+bool FaceTracker::startRecording(const std::string& path, int frameDownscale) {
+    return impl_->startRecording(path, frameDownscale);
+}
+
+void FaceTracker::stopRecording() {
+    impl_->stopRecording();
+}
+
+bool FaceTracker::startPublishing(const std::string& socketPath) {
+    return impl_->startPublishing(socketPath);
+}
+
+void FaceTracker::stopPublishing() {
+    impl_->stopPublishing();
+}
+
+void FaceTracker::startShadow(std::shared_ptr<ShadowEvaluator> evaluator) {
+    impl_->startShadow(std::move(evaluator));
+}
+
+void FaceTracker::stopShadow() {
+    impl_->stopShadow();
+}
+
 FaceResult FaceTracker::getLastResult() const {
     return impl_->getLastResult();
 }
 
+FaceTracker::Stats FaceTracker::getStats() const {
+    return impl_->getStats();
+}
+
 // ============================================================================
 // Helper implementations
 // ============================================================================
@@ -7,6 +7,10 @@
 
 #import "FaceTrackerBridge.h"
 #include "FaceTracker.h"
+#include "Compositor.h"
+#include "Logger.h"
+#include "ParameterStore.h"
+#include <algorithm>
 #include <mutex>
 #include <vector>
 
@@ -15,9 +19,103 @@
 // ============================================================================
 
 namespace {
-    // Thread-local storage to keep C++ objects alive during C API usage
+    // Thread-local storage to keep C++ objects alive during C API usage:
+    // landmarks of the last ACMFaceTrackerProcess result, and separately of
+    // the last ACMFaceTrackerGetLastResult so neither overwrites the other's
     thread_local std::vector<AnonCam::Landmark> t_landmarkBuffer;
-    thread_local AnonCam::FaceResult t_lastResult;
+    thread_local std::vector<AnonCam::LandmarkHalf> t_landmarkHalfBuffer;
+    thread_local std::vector<AnonCam::Landmark> t_lastLandmarkBuffer;
+    thread_local std::vector<AnonCam::LandmarkHalf> t_lastLandmarkHalfBuffer;
+
+    // Pooled buffers an ACMFaceResult points into (ACMFaceResult::pixelBuffers),
+    // kept until ACMFaceResultRelease
+    struct RetainedPixels {
+        std::shared_ptr<const AnonCam::PooledBuffer> mask;
+        std::shared_ptr<const AnonCam::PooledBuffer> denoised;
+    };
+
+    // Locks a BGRA pixel buffer for the lifetime of the object
+    class LockedBGRA {
+    public:
+        LockedBGRA(CVPixelBufferRef buffer, CVPixelBufferLockFlags flags)
+            : buffer_(buffer), flags_(flags) {
+            if (buffer_ && CVPixelBufferGetPixelFormatType(buffer_) == kCVPixelFormatType_32BGRA &&
+                CVPixelBufferLockBaseAddress(buffer_, flags_) == kCVReturnSuccess) {
+                locked_ = true;
+                view_.format = AnonCam::PixelFormat::BGRA;
+                view_.width = static_cast<int>(CVPixelBufferGetWidth(buffer_));
+                view_.height = static_cast<int>(CVPixelBufferGetHeight(buffer_));
+                view_.planes[0] = static_cast<const uint8_t*>(CVPixelBufferGetBaseAddress(buffer_));
+                view_.bytesPerRow[0] = CVPixelBufferGetBytesPerRow(buffer_);
+            }
+        }
+
+        ~LockedBGRA() {
+            if (locked_) {
+                CVPixelBufferUnlockBaseAddress(buffer_, flags_);
+            }
+        }
+
+        bool isLocked() const { return locked_; }
+        const AnonCam::ImageView& view() const { return view_; }
+        uint8_t* mutableData() const { return static_cast<uint8_t*>(CVPixelBufferGetBaseAddress(buffer_)); }
+
+    private:
+        CVPixelBufferRef buffer_;
+        CVPixelBufferLockFlags flags_;
+        bool locked_ = false;
+        AnonCam::ImageView view_;
+    };
+
+    // C configuration onto a C++ one; settings the C API does not expose are left as they are
+    void applyConfig(const ACMFaceTrackerConfig& config, AnonCam::FaceTracker::Config& cppConfig) {
+        cppConfig.maxNumFaces = config.maxNumFaces > 0 ? config.maxNumFaces : 1;
+        cppConfig.minDetectionConfidence = config.minDetectionConfidence;
+        cppConfig.minTrackingConfidence = config.minTrackingConfidence;
+        cppConfig.enableSegmentation = config.enableSegmentation;
+        cppConfig.useGPU = config.useGPU;
+        cppConfig.halfPrecisionLandmarks = config.halfPrecisionLandmarks;
+        cppConfig.enableDenoising = config.enableDenoising;
+        if (config.cascadePath) {
+            cppConfig.detector = AnonCam::FaceTracker::DetectorBackend::Cascade;
+            cppConfig.cascadePath = config.cascadePath;
+            cppConfig.cascade.sliceBudgetUs = config.cascadeSliceBudgetUs;
+        } else {
+            cppConfig.detector = AnonCam::FaceTracker::DetectorBackend::Model;
+        }
+        cppConfig.trackLoss.holdMs = config.trackLossHoldMs > 0
+            ? config.trackLossHoldMs : AnonCam::TrackLossPolicy::Options().holdMs;
+    }
+
+    AnonCam::RenderParameters toRenderParameters(const ACMRenderParameters& parameters) {
+        AnonCam::RenderParameters out;
+        std::copy(parameters.maskColor, parameters.maskColor + 4, out.maskColor);
+        out.maskScale = parameters.maskScale;
+        out.maskRoughness = parameters.maskRoughness;
+        out.maskMetallic = parameters.maskMetallic;
+        out.smoothingFactor = parameters.smoothingFactor;
+        out.velocityDamping = parameters.velocityDamping;
+        out.movementThreshold = parameters.movementThreshold;
+        out.pixelationEnabled = parameters.pixelationEnabled;
+        out.mask3DEnabled = parameters.mask3DEnabled;
+        out.stickerMode = parameters.stickerMode;
+        out.debugEnabled = parameters.debugEnabled;
+        return out;
+    }
+
+    void fromRenderParameters(const AnonCam::RenderParameters& parameters, ACMRenderParameters& out) {
+        std::copy(parameters.maskColor, parameters.maskColor + 4, out.maskColor);
+        out.maskScale = parameters.maskScale;
+        out.maskRoughness = parameters.maskRoughness;
+        out.maskMetallic = parameters.maskMetallic;
+        out.smoothingFactor = parameters.smoothingFactor;
+        out.velocityDamping = parameters.velocityDamping;
+        out.movementThreshold = parameters.movementThreshold;
+        out.pixelationEnabled = parameters.pixelationEnabled;
+        out.mask3DEnabled = parameters.mask3DEnabled;
+        out.stickerMode = parameters.stickerMode;
+        out.debugEnabled = parameters.debugEnabled;
+    }
 }
 
 // ============================================================================
@@ -31,17 +129,15 @@ void* _Nullable ACMFaceTrackerCreate(const ACMFaceTrackerConfig* _Nullable confi
         AnonCam::FaceTracker::Config cppConfig;
 
         if (config) {
-            cppConfig.maxNumFaces = config->maxNumFaces > 0 ? config->maxNumFaces : 1;
-            cppConfig.minDetectionConfidence = config->minDetectionConfidence;
-            cppConfig.minTrackingConfidence = config->minTrackingConfidence;
-            cppConfig.enableSegmentation = config->enableSegmentation;
-            cppConfig.useGPU = config->useGPU;
+            applyConfig(*config, cppConfig);
         } else {
             cppConfig.maxNumFaces = ACM_DEFAULT_MAX_NUM_FACES;
             cppConfig.minDetectionConfidence = ACM_DEFAULT_MIN_DETECTION_CONFIDENCE;
             cppConfig.minTrackingConfidence = ACM_DEFAULT_MIN_TRACKING_CONFIDENCE;
             cppConfig.enableSegmentation = ACM_DEFAULT_ENABLE_SEGMENTATION;
             cppConfig.useGPU = ACM_DEFAULT_USE_GPU;
+            cppConfig.halfPrecisionLandmarks = ACM_DEFAULT_HALF_PRECISION_LANDMARKS;
+            cppConfig.enableDenoising = ACM_DEFAULT_ENABLE_DENOISING;
         }
 
         auto tracker = new AnonCam::FaceTracker(cppConfig);
@@ -56,6 +152,21 @@ void* _Nullable ACMFaceTrackerCreate(const ACMFaceTrackerConfig* _Nullable confi
     }
 }
 
+bool ACMFaceTrackerUpdateConfig(void* _Nullable handle, const ACMFaceTrackerConfig* _Nonnull config) {
+    if (!handle || !config) {
+        return false;
+    }
+
+    @try {
+        auto tracker = static_cast<AnonCam::FaceTracker*>(handle);
+        AnonCam::FaceTracker::Config cppConfig = tracker->getConfig();
+        applyConfig(*config, cppConfig);
+        return tracker->updateConfig(cppConfig);
+    } @catch (...) {
+        return false;
+    }
+}
+
 void ACMFaceTrackerDestroy(void* _Nullable handle) {
     if (handle) {
         delete static_cast<AnonCam::FaceTracker*>(handle);
@@ -74,67 +185,100 @@ ACMFaceResult ACMFaceTrackerProcess(void* _Nullable handle, CVPixelBufferRef _No
 
     @try {
         auto tracker = static_cast<AnonCam::FaceTracker*>(handle);
-        t_lastResult = tracker->processFrame(pixelBuffer);
+        const AnonCam::FaceResult frameResult = tracker->processFrame(pixelBuffer);
 
         // Convert C++ result to C struct
-        result.hasFace = t_lastResult.hasFace;
-        result.confidence = t_lastResult.confidence;
-        result.landmarkCount = static_cast<int>(t_lastResult.landmarks.size());
+        result.hasFace = frameResult.hasFace;
+        result.confidence = frameResult.confidence;
+        result.landmarkCount = static_cast<int>(std::max(frameResult.landmarks.size(),
+                                                         frameResult.landmarksHalf.size()));
 
         // Copy pose
-        std::memcpy(result.pose.translation, t_lastResult.pose.translation, sizeof(result.pose.translation));
-        std::memcpy(result.pose.rotation, t_lastResult.pose.rotation, sizeof(result.pose.rotation));
-        std::memcpy(result.pose.modelMatrix, t_lastResult.pose.modelMatrix, sizeof(result.pose.modelMatrix));
+        std::memcpy(result.pose.translation, frameResult.pose.translation, sizeof(result.pose.translation));
+        std::memcpy(result.pose.rotation, frameResult.pose.rotation, sizeof(result.pose.rotation));
+        std::memcpy(result.pose.modelMatrix, frameResult.pose.modelMatrix, sizeof(result.pose.modelMatrix));
 
         // Copy key points
         result.keyPoints.leftEye = {
-            t_lastResult.keyPoints.leftEye.x,
-            t_lastResult.keyPoints.leftEye.y,
-            t_lastResult.keyPoints.leftEye.z
+            frameResult.keyPoints.leftEye.x,
+            frameResult.keyPoints.leftEye.y,
+            frameResult.keyPoints.leftEye.z
         };
         result.keyPoints.rightEye = {
-            t_lastResult.keyPoints.rightEye.x,
-            t_lastResult.keyPoints.rightEye.y,
-            t_lastResult.keyPoints.rightEye.z
+            frameResult.keyPoints.rightEye.x,
+            frameResult.keyPoints.rightEye.y,
+            frameResult.keyPoints.rightEye.z
         };
         result.keyPoints.noseTip = {
-            t_lastResult.keyPoints.noseTip.x,
-            t_lastResult.keyPoints.noseTip.y,
-            t_lastResult.keyPoints.noseTip.z
+            frameResult.keyPoints.noseTip.x,
+            frameResult.keyPoints.noseTip.y,
+            frameResult.keyPoints.noseTip.z
         };
         result.keyPoints.upperLip = {
-            t_lastResult.keyPoints.upperLip.x,
-            t_lastResult.keyPoints.upperLip.y,
-            t_lastResult.keyPoints.upperLip.z
+            frameResult.keyPoints.upperLip.x,
+            frameResult.keyPoints.upperLip.y,
+            frameResult.keyPoints.upperLip.z
         };
         result.keyPoints.chin = {
-            t_lastResult.keyPoints.chin.x,
-            t_lastResult.keyPoints.chin.y,
-            t_lastResult.keyPoints.chin.z
+            frameResult.keyPoints.chin.x,
+            frameResult.keyPoints.chin.y,
+            frameResult.keyPoints.chin.z
         };
         result.keyPoints.leftEar = {
-            t_lastResult.keyPoints.leftEar.x,
-            t_lastResult.keyPoints.leftEar.y,
-            t_lastResult.keyPoints.leftEar.z
+            frameResult.keyPoints.leftEar.x,
+            frameResult.keyPoints.leftEar.y,
+            frameResult.keyPoints.leftEar.z
         };
         result.keyPoints.rightEar = {
-            t_lastResult.keyPoints.rightEar.x,
-            t_lastResult.keyPoints.rightEar.y,
-            t_lastResult.keyPoints.rightEar.z
+            frameResult.keyPoints.rightEar.x,
+            frameResult.keyPoints.rightEar.y,
+            frameResult.keyPoints.rightEar.z
         };
         result.keyPoints.forehead = {
-            t_lastResult.keyPoints.forehead.x,
-            t_lastResult.keyPoints.forehead.y,
-            t_lastResult.keyPoints.forehead.z
+            frameResult.keyPoints.forehead.x,
+            frameResult.keyPoints.forehead.y,
+            frameResult.keyPoints.forehead.z
         };
 
         // Store landmarks in thread-local buffer
-        t_landmarkBuffer = t_lastResult.landmarks;
-        result.landmarks = t_landmarkBuffer.data();
+        t_landmarkBuffer = frameResult.landmarks;
+        result.landmarks = t_landmarkBuffer.empty() ? nullptr : t_landmarkBuffer.data();
+        t_landmarkHalfBuffer = frameResult.landmarksHalf;
+        result.landmarksHalf = t_landmarkHalfBuffer.empty()
+            ? nullptr
+            : reinterpret_cast<ACMLandmarkHalf*>(t_landmarkHalfBuffer.data());
+
+        // Mask and frame memory stay pooled; the result holds the references
+        // until ACMFaceResultRelease
+        RetainedPixels pixels;
+        const auto& mask = frameResult.segmentationMask;
+        if (mask.isValid()) {
+            pixels.mask = mask.buffer;
+            result.segmentationMask = mask.data;
+            result.maskWidth = mask.width;
+            result.maskHeight = mask.height;
+            result.maskBytesPerRow = static_cast<int>(mask.bytesPerRow);
+        }
+
+        // Only a BGRA frame can stand in for the compositor source
+        const auto& denoised = frameResult.denoisedFrame;
+        if (denoised.isValid() && denoised.view.format == AnonCam::PixelFormat::BGRA) {
+            pixels.denoised = denoised.buffer;
+            result.denoisedPixels = denoised.view.planes[0];
+            result.denoisedBytesPerRow = static_cast<int>(denoised.view.bytesPerRow[0]);
+        }
+        if (pixels.mask || pixels.denoised) {
+            result.pixelBuffers = new RetainedPixels(std::move(pixels));
+        }
+
+        result.anonymizationMode = static_cast<ACMAnonymizationMode>(frameResult.anonymization.mode);
+        std::memcpy(result.anonymizationRegion, frameResult.anonymization.region,
+                    sizeof(result.anonymizationRegion));
 
         return result;
 
     } @catch (...) {
+        ACM_LOG(Error, "frame processing failed");
         result.hasFace = false;
         result.landmarkCount = 0;
         result.landmarks = nullptr;
@@ -165,18 +309,28 @@ ACMFaceResult ACMFaceTrackerGetLastResult(void* _Nullable handle) {
 
     @try {
         auto tracker = static_cast<AnonCam::FaceTracker*>(handle);
-        t_lastResult = tracker->getLastResult();
+        // Stored results carry no pooled buffers (FaceTracker::getLastResult)
+        const AnonCam::FaceResult lastResult = tracker->getLastResult();
+
+        result.hasFace = lastResult.hasFace;
+        result.confidence = lastResult.confidence;
+        result.landmarkCount = static_cast<int>(std::max(lastResult.landmarks.size(),
+                                                         lastResult.landmarksHalf.size()));
 
-        result.hasFace = t_lastResult.hasFace;
-        result.confidence = t_lastResult.confidence;
-        result.landmarkCount = static_cast<int>(t_lastResult.landmarks.size());
+        std::memcpy(result.pose.translation, lastResult.pose.translation, sizeof(result.pose.translation));
+        std::memcpy(result.pose.rotation, lastResult.pose.rotation, sizeof(result.pose.rotation));
+        std::memcpy(result.pose.modelMatrix, lastResult.pose.modelMatrix, sizeof(result.pose.modelMatrix));
 
-        std::memcpy(result.pose.translation, t_lastResult.pose.translation, sizeof(result.pose.translation));
-        std::memcpy(result.pose.rotation, t_lastResult.pose.rotation, sizeof(result.pose.rotation));
-        std::memcpy(result.pose.modelMatrix, t_lastResult.pose.modelMatrix, sizeof(result.pose.modelMatrix));
+        t_lastLandmarkBuffer = lastResult.landmarks;
+        result.landmarks = t_lastLandmarkBuffer.empty() ? nullptr : t_lastLandmarkBuffer.data();
+        t_lastLandmarkHalfBuffer = lastResult.landmarksHalf;
+        result.landmarksHalf = t_lastLandmarkHalfBuffer.empty()
+            ? nullptr
+            : reinterpret_cast<ACMLandmarkHalf*>(t_lastLandmarkHalfBuffer.data());
 
-        t_landmarkBuffer = t_lastResult.landmarks;
-        result.landmarks = t_landmarkBuffer.data();
+        result.anonymizationMode = static_cast<ACMAnonymizationMode>(lastResult.anonymization.mode);
+        std::memcpy(result.anonymizationRegion, lastResult.anonymization.region,
+                    sizeof(result.anonymizationRegion));
 
         return result;
     } @catch (...) {
@@ -187,6 +341,54 @@ ACMFaceResult ACMFaceTrackerGetLastResult(void* _Nullable handle) {
     }
 }
 
+bool ACMFaceTrackerStartRecording(void* _Nullable handle, const char* _Nonnull path, int frameDownscale) {
+    if (!handle || !path) {
+        return false;
+    }
+
+    @try {
+        auto tracker = static_cast<AnonCam::FaceTracker*>(handle);
+        return tracker->startRecording(path, frameDownscale);
+    } @catch (...) {
+        return false;
+    }
+}
+
+void ACMFaceTrackerStopRecording(void* _Nullable handle) {
+    if (handle) {
+        @try {
+            auto tracker = static_cast<AnonCam::FaceTracker*>(handle);
+            tracker->stopRecording();
+        } @catch (...) {
+            // Ignore
+        }
+    }
+}
+
+bool ACMFaceTrackerStartPublishing(void* _Nullable handle, const char* _Nonnull socketPath) {
+    if (!handle || !socketPath) {
+        return false;
+    }
+
+    @try {
+        auto tracker = static_cast<AnonCam::FaceTracker*>(handle);
+        return tracker->startPublishing(socketPath);
+    } @catch (...) {
+        return false;
+    }
+}
+
+void ACMFaceTrackerStopPublishing(void* _Nullable handle) {
+    if (handle) {
+        @try {
+            auto tracker = static_cast<AnonCam::FaceTracker*>(handle);
+            tracker->stopPublishing();
+        } @catch (...) {
+            // Ignore
+        }
+    }
+}
+
 bool ACMFaceTrackerIsInitialized(void* _Nullable handle) {
     if (!handle) {
         return false;
@@ -201,12 +403,202 @@ bool ACMFaceTrackerIsInitialized(void* _Nullable handle) {
 }
 
 void ACMFaceResultRelease(ACMFaceResult result) {
-    // No-op - landmarks are owned by thread-local storage
-    // This function exists for API completeness and future extensions
+    // Landmarks are owned by thread-local storage; pooled pixels go back here
+    delete static_cast<RetainedPixels*>(result.pixelBuffers);
 }
 
 } // extern "C"
 
+// ============================================================================
+// Compositor C API
+// ============================================================================
+
+extern "C" {
+
+void* _Nullable ACMCompositorCreate(const ACMCompositorConfig* _Nullable config) {
+    @try {
+        AnonCam::Compositor::Options options;
+        if (config) {
+            options.background = static_cast<AnonCam::Compositor::BackgroundMode>(config->backgroundMode);
+            options.face = static_cast<AnonCam::Compositor::FaceMode>(config->faceMode);
+            options.blurRadius = config->blurRadius;
+            options.pixelBlockSize = config->pixelBlockSize;
+            std::copy(config->fillColor, config->fillColor + 4, options.fillColor);
+        }
+        return static_cast<void*>(new AnonCam::Compositor(options));
+    } @catch (...) {
+        return nullptr;
+    }
+}
+
+void ACMCompositorDestroy(void* _Nullable handle) {
+    if (handle) {
+        delete static_cast<AnonCam::Compositor*>(handle);
+    }
+}
+
+bool ACMCompositorProcess(void* _Nullable handle, CVPixelBufferRef _Nonnull source,
+                          const ACMFaceResult* _Nullable result, const uint8_t* _Nullable foregroundMask,
+                          int foregroundBytesPerRow, CVPixelBufferRef _Nullable replacement,
+                          CVPixelBufferRef _Nonnull destination) {
+    if (!handle || !source || !destination) {
+        return false;
+    }
+
+    @try {
+        auto compositor = static_cast<AnonCam::Compositor*>(handle);
+        const bool inPlace = source == destination;
+
+        LockedBGRA output(destination, 0);
+        LockedBGRA input(inPlace ? nullptr : source, kCVPixelBufferLock_ReadOnly);
+        LockedBGRA background(replacement, kCVPixelBufferLock_ReadOnly);
+        if (!output.isLocked() || (!inPlace && !input.isLocked())) {
+            return false;
+        }
+
+        AnonCam::SegmentationMask face;
+        if (result && result->segmentationMask) {
+            face.data = result->segmentationMask;
+            face.width = result->maskWidth;
+            face.height = result->maskHeight;
+            face.bytesPerRow = static_cast<size_t>(result->maskBytesPerRow);
+        }
+
+        AnonCam::SegmentationMask person;
+        if (foregroundMask) {
+            person.data = foregroundMask;
+            person.width = output.view().width;
+            person.height = output.view().height;
+            person.bytesPerRow = static_cast<size_t>(foregroundBytesPerRow);
+        }
+
+        AnonCam::Anonymization anonymization;
+        if (result) {
+            anonymization.mode = static_cast<AnonCam::AnonymizationMode>(result->anonymizationMode);
+            std::memcpy(anonymization.region, result->anonymizationRegion, sizeof(anonymization.region));
+        }
+
+        AnonCam::Compositor::Layers layers;
+        layers.foreground = person.isValid() ? &person : nullptr;
+        layers.face = face.isValid() ? &face : nullptr;
+        layers.replacement = background.isLocked() ? &background.view() : nullptr;
+        layers.anonymization = result ? &anonymization : nullptr;
+
+        AnonCam::ImageView frame = inPlace ? output.view() : input.view();
+        if (result && result->denoisedPixels) {
+            frame.planes[0] = result->denoisedPixels;
+            frame.bytesPerRow[0] = static_cast<size_t>(result->denoisedBytesPerRow);
+        }
+        return compositor->composite(frame, layers, output.mutableData(), output.view().bytesPerRow[0]);
+    } @catch (...) {
+        return false;
+    }
+}
+
+bool ACMCompositorBackgroundDropped(void* _Nullable handle) {
+    return handle && static_cast<AnonCam::Compositor*>(handle)->backgroundDropped();
+}
+
+} // extern "C"
+
+// ============================================================================
+// Parameter Store C API
+// ============================================================================
+
+void* _Nullable ACMParameterStoreCreate(const ACMRenderParameters* _Nullable initial) {
+    @try {
+        auto store = initial ? new AnonCam::ParameterStore(toRenderParameters(*initial))
+                             : new AnonCam::ParameterStore();
+        return static_cast<void*>(store);
+    } @catch (...) {
+        return nullptr;
+    }
+}
+
+void ACMParameterStoreDestroy(void* _Nullable handle) {
+    if (handle) {
+        delete static_cast<AnonCam::ParameterStore*>(handle);
+    }
+}
+
+uint64_t ACMParameterStorePublish(void* _Nullable handle, const ACMRenderParameters* _Nonnull parameters) {
+    if (!handle || !parameters) {
+        return 0;
+    }
+
+    @try {
+        return static_cast<AnonCam::ParameterStore*>(handle)->publish(toRenderParameters(*parameters));
+    } @catch (...) {
+        return 0;
+    }
+}
+
+uint64_t ACMParameterStoreRead(void* _Nullable handle, ACMRenderParameters* _Nonnull parameters) {
+    if (!handle || !parameters) {
+        return 0;
+    }
+
+    const AnonCam::ParameterStore::ReadGuard snapshot = static_cast<AnonCam::ParameterStore*>(handle)->read();
+    fromRenderParameters(*snapshot, *parameters);
+    return snapshot.version();
+}
+
+uint64_t ACMParameterStoreVersion(void* _Nullable handle) {
+    return handle ? static_cast<AnonCam::ParameterStore*>(handle)->version() : 0;
+}
+
+// ============================================================================
+// Logging C API
+// ============================================================================
+
+namespace {
+    // Site behind an ACMLogSiteCreate handle; owns the category its messages print
+    struct BridgeLogSite {
+        BridgeLogSite(ACMLogLevel level, const char* name)
+            : category(name), site("{}", static_cast<AnonCam::LogLevel>(level), category.c_str(), 0) {}
+
+        const std::string category;
+        AnonCam::LogSite site;
+    };
+}
+
+void* _Nullable ACMLogSiteCreate(ACMLogLevel level, const char* _Nonnull category) {
+    if (!category) {
+        return nullptr;
+    }
+
+    @try {
+        // Never freed: queued messages point at their site
+        return static_cast<void*>(new BridgeLogSite(level, category));
+    } @catch (...) {
+        return nullptr;
+    }
+}
+
+void ACMLogWrite(void* _Nullable site, const char* _Nonnull message) {
+    if (site && message) {
+        AnonCam::Logger::shared().log(static_cast<BridgeLogSite*>(site)->site, message);
+    }
+}
+
+void ACMLogSetSink(ACMLogSink _Nullable sink, void* _Nullable context) {
+    if (!sink) {
+        AnonCam::Logger::shared().setSink(nullptr);
+        return;
+    }
+    AnonCam::Logger::shared().setSink([sink, context](AnonCam::LogLevel level, const char* line) {
+        sink(static_cast<ACMLogLevel>(level), line, context);
+    });
+}
+
+void ACMLogSetMinLevel(ACMLogLevel level) {
+    AnonCam::Logger::shared().setMinLevel(static_cast<AnonCam::LogLevel>(level));
+}
+
+void ACMLogFlush(void) {
+    AnonCam::Logger::shared().flush();
+}
+
 // ============================================================================
 // Objective-C Wrapper Implementation
 // ============================================================================
@@ -225,7 +617,9 @@ void ACMFaceResultRelease(ACMFaceResult result) {
         .minDetectionConfidence = ACM_DEFAULT_MIN_DETECTION_CONFIDENCE,
         .minTrackingConfidence = ACM_DEFAULT_MIN_TRACKING_CONFIDENCE,
         .enableSegmentation = ACM_DEFAULT_ENABLE_SEGMENTATION,
-        .useGPU = ACM_DEFAULT_USE_GPU
+        .useGPU = ACM_DEFAULT_USE_GPU,
+        .halfPrecisionLandmarks = ACM_DEFAULT_HALF_PRECISION_LANDMARKS,
+        .enableDenoising = ACM_DEFAULT_ENABLE_DENOISING
     }];
 }
 
@@ -245,6 +639,14 @@ void ACMFaceResultRelease(ACMFaceResult result) {
     return self;
 }
 
+- (BOOL)updateConfig:(ACMFaceTrackerConfig)config {
+    if (!_tracker || !ACMFaceTrackerUpdateConfig(_tracker.get(), &config)) {
+        return NO;
+    }
+    _config = config;
+    return YES;
+}
+
 - (void)dealloc {
     _tracker.reset();
 }
@@ -0,0 +1,394 @@
+#include "GuidedFilter.h"
+#include "Simd.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+// Clamped window [begin, end) of `radius` around `center` in [0, size)
+inline void window(int center, int radius, int size, int& begin, int& end) {
+    begin = std::max(0, center - radius);
+    end = std::min(size, center + radius + 1);
+}
+
+/**
+ * Window means from a uint32 integral image ((width + 1) x (height + 1)).
+ * Differences are taken in modular arithmetic, so wrapped totals are fine.
+ */
+void boxMean(const uint32_t* sum, int width, int height, int radius, float* out) {
+    const size_t stride = static_cast<size_t>(width) + 1;
+    // Columns whose window is not clipped horizontally
+    const int interiorBegin = std::min(radius, width);
+    const int interiorEnd = std::max(interiorBegin, width - radius);
+
+    for (int y = 0; y < height; ++y) {
+        int y1, y2;
+        window(y, radius, height, y1, y2);
+        const uint32_t* top = sum + y1 * stride;
+        const uint32_t* bottom = sum + y2 * stride;
+        float* row = out + static_cast<size_t>(y) * width;
+
+        auto scalar = [&](int x) {
+            int x1, x2;
+            window(x, radius, width, x1, x2);
+            const uint32_t total = bottom[x2] - bottom[x1] - top[x2] + top[x1];
+            row[x] = static_cast<float>(total) / static_cast<float>((y2 - y1) * (x2 - x1));
+        };
+
+        for (int x = 0; x < interiorBegin; ++x) {
+            scalar(x);
+        }
+
+        int x = interiorBegin;
+        const float invArea = 1.0f / static_cast<float>((y2 - y1) * (2 * radius + 1));
+#if ACM_SIMD_SSE2
+        const __m128 vInvArea = _mm_set1_ps(invArea);
+        for (; x + 4 <= interiorEnd; x += 4) {
+            const int x1 = x - radius;
+            const int x2 = x + radius + 1;
+            const __m128i b2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(bottom + x2));
+            const __m128i b1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(bottom + x1));
+            const __m128i t2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(top + x2));
+            const __m128i t1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(top + x1));
+            const __m128i total = _mm_add_epi32(_mm_sub_epi32(b2, b1), _mm_sub_epi32(t1, t2));
+            _mm_storeu_ps(row + x, _mm_mul_ps(_mm_cvtepi32_ps(total), vInvArea));
+        }
+#elif ACM_SIMD_NEON
+        for (; x + 4 <= interiorEnd; x += 4) {
+            const int x1 = x - radius;
+            const int x2 = x + radius + 1;
+            const uint32x4_t total = vaddq_u32(vsubq_u32(vld1q_u32(bottom + x2), vld1q_u32(bottom + x1)),
+                                               vsubq_u32(vld1q_u32(top + x1), vld1q_u32(top + x2)));
+            vst1q_f32(row + x, vmulq_n_f32(vcvtq_f32_u32(total), invArea));
+        }
+#endif
+        for (; x < interiorEnd; ++x) {
+            const uint32_t total = bottom[x + radius + 1] - bottom[x - radius] - top[x + radius + 1] + top[x - radius];
+            row[x] = static_cast<float>(total) * invArea;
+        }
+
+        for (x = interiorEnd; x < width; ++x) {
+            scalar(x);
+        }
+    }
+}
+
+// Window means from a double integral image (coefficients a and b are signed)
+void boxMean(const double* sum, int width, int height, int radius, float* out) {
+    const size_t stride = static_cast<size_t>(width) + 1;
+    const int interiorBegin = std::min(radius, width);
+    const int interiorEnd = std::max(interiorBegin, width - radius);
+
+    for (int y = 0; y < height; ++y) {
+        int y1, y2;
+        window(y, radius, height, y1, y2);
+        const double* top = sum + y1 * stride;
+        const double* bottom = sum + y2 * stride;
+        float* row = out + static_cast<size_t>(y) * width;
+
+        auto scalar = [&](int x) {
+            int x1, x2;
+            window(x, radius, width, x1, x2);
+            const double total = bottom[x2] - bottom[x1] - top[x2] + top[x1];
+            row[x] = static_cast<float>(total / ((y2 - y1) * (x2 - x1)));
+        };
+
+        for (int x = 0; x < interiorBegin; ++x) {
+            scalar(x);
+        }
+
+        int x = interiorBegin;
+        const double invArea = 1.0 / ((y2 - y1) * (2 * radius + 1));
+#if ACM_SIMD_SSE2
+        const __m128d vInvArea = _mm_set1_pd(invArea);
+        for (; x + 2 <= interiorEnd; x += 2) {
+            const int x1 = x - radius;
+            const int x2 = x + radius + 1;
+            const __m128d total = _mm_add_pd(_mm_sub_pd(_mm_loadu_pd(bottom + x2), _mm_loadu_pd(bottom + x1)),
+                                             _mm_sub_pd(_mm_loadu_pd(top + x1), _mm_loadu_pd(top + x2)));
+            _mm_storel_pi(reinterpret_cast<__m64*>(row + x), _mm_cvtpd_ps(_mm_mul_pd(total, vInvArea)));
+        }
+#elif ACM_SIMD_NEON
+        for (; x + 2 <= interiorEnd; x += 2) {
+            const int x1 = x - radius;
+            const int x2 = x + radius + 1;
+            const float64x2_t total = vaddq_f64(vsubq_f64(vld1q_f64(bottom + x2), vld1q_f64(bottom + x1)),
+                                                vsubq_f64(vld1q_f64(top + x1), vld1q_f64(top + x2)));
+            vst1_f32(row + x, vcvt_f32_f64(vmulq_n_f64(total, invArea)));
+        }
+#endif
+        for (; x < interiorEnd; ++x) {
+            const double total = bottom[x + radius + 1] - bottom[x - radius] - top[x + radius + 1] + top[x - radius];
+            row[x] = static_cast<float>(total * invArea);
+        }
+
+        for (x = interiorEnd; x < width; ++x) {
+            scalar(x);
+        }
+    }
+}
+
+// Integral image of a float plane, accumulated in double
+void integrate(const float* values, int width, int height, double* sum) {
+    const size_t stride = static_cast<size_t>(width) + 1;
+    std::fill(sum, sum + stride, 0.0);
+    for (int y = 0; y < height; ++y) {
+        const float* in = values + static_cast<size_t>(y) * width;
+        const double* above = sum + y * stride;
+        double* row = sum + (y + 1) * stride;
+        double running = 0.0;
+        row[0] = 0.0;
+        for (int x = 0; x < width; ++x) {
+            running += in[x];
+            row[x + 1] = above[x + 1] + running;
+        }
+    }
+}
+
+} // anonymous namespace
+
+namespace AnonCam {
+
+GuidedFilter::GuidedFilter()
+    : GuidedFilter(Options()) {}
+
+GuidedFilter::GuidedFilter(const Options& options)
+    : options_(options) {
+    options_.radius = std::clamp(options.radius, 0, kMaxRadius);
+    options_.epsilon = std::max(options.epsilon, 1e-6f);
+}
+
+void GuidedFilter::downsampleGuide(const ImageView& guide) {
+    const int width = guide.width;
+    const int height = guide.height;
+    columnSums_.resize(width);
+
+    for (int ly = 0; ly < height_; ++ly) {
+        const int y0 = static_cast<int>(static_cast<int64_t>(ly) * height / height_);
+        const int y1 = static_cast<int>(static_cast<int64_t>(ly + 1) * height / height_);
+
+        std::fill(columnSums_.begin(), columnSums_.end(), 0u);
+        for (int y = y0; y < y1; ++y) {
+            const uint8_t* in = guide.row(0, y);
+            for (int x = 0; x < width; ++x) {
+                columnSums_[x] += in[x];
+            }
+        }
+
+        uint8_t* out = lowGuide_.data() + static_cast<size_t>(ly) * width_;
+        for (int lx = 0; lx < width_; ++lx) {
+            const int x0 = static_cast<int>(static_cast<int64_t>(lx) * width / width_);
+            const int x1 = static_cast<int>(static_cast<int64_t>(lx + 1) * width / width_);
+            uint32_t total = 0;
+            for (int x = x0; x < x1; ++x) {
+                total += columnSums_[x];
+            }
+            const uint32_t count = static_cast<uint32_t>((x1 - x0) * (y1 - y0));
+            out[lx] = static_cast<uint8_t>((total + count / 2) / count);
+        }
+    }
+}
+
+void GuidedFilter::fitCoefficients(const uint8_t* mask, size_t maskStride) {
+    const int width = width_;
+    const int height = height_;
+    const size_t stride = static_cast<size_t>(width) + 1;
+    const size_t pixels = static_cast<size_t>(width) * height;
+    const int radius = options_.radius;
+
+    // First pass: integrals of I, p, I*I and I*p (8-bit inputs, exact)
+    for (auto* sum : {&sumI_, &sumP_, &sumII_, &sumIP_}) {
+        sum->assign(stride * (height + 1), 0u);
+    }
+    for (int y = 0; y < height; ++y) {
+        const uint8_t* guide = lowGuide_.data() + static_cast<size_t>(y) * width;
+        const uint8_t* alpha = mask + static_cast<size_t>(y) * maskStride;
+        const size_t above = y * stride;
+        const size_t row = (y + 1) * stride;
+        uint32_t runI = 0, runP = 0, runII = 0, runIP = 0;
+        for (int x = 0; x < width; ++x) {
+            const uint32_t i = guide[x];
+            const uint32_t p = alpha[x];
+            runI += i;
+            runP += p;
+            runII += i * i;
+            runIP += i * p;
+            sumI_[row + x + 1] = sumI_[above + x + 1] + runI;
+            sumP_[row + x + 1] = sumP_[above + x + 1] + runP;
+            sumII_[row + x + 1] = sumII_[above + x + 1] + runII;
+            sumIP_[row + x + 1] = sumIP_[above + x + 1] + runIP;
+        }
+    }
+
+    const std::vector<uint32_t>* sums[4] = {&sumI_, &sumP_, &sumII_, &sumIP_};
+    for (int k = 0; k < 4; ++k) {
+        mean_[k].resize(pixels);
+        boxMean(sums[k]->data(), width, height, radius, mean_[k].data());
+    }
+
+    // Per-window linear model p ~ a * I + b
+    const float epsilon = options_.epsilon * 255.0f * 255.0f;
+    a_.resize(pixels);
+    b_.resize(pixels);
+    for (size_t i = 0; i < pixels; ++i) {
+        const float meanI = mean_[0][i];
+        const float meanP = mean_[1][i];
+        const float variance = mean_[2][i] - meanI * meanI;
+        const float covariance = mean_[3][i] - meanI * meanP;
+        const float a = covariance / (variance + epsilon);
+        a_[i] = a;
+        b_[i] = meanP - a * meanI;
+    }
+
+    // Second pass: average the coefficients of every window covering a pixel
+    sumA_.resize(stride * (height + 1));
+    sumB_.resize(stride * (height + 1));
+    integrate(a_.data(), width, height, sumA_.data());
+    integrate(b_.data(), width, height, sumB_.data());
+    meanA_.resize(pixels);
+    meanB_.resize(pixels);
+    boxMean(sumA_.data(), width, height, radius, meanA_.data());
+    boxMean(sumB_.data(), width, height, radius, meanB_.data());
+}
+
+void GuidedFilter::prepareUpsample(int dstWidth, int dstHeight) {
+    cachedRow_[0] = cachedRow_[1] = -1;
+    if (dstWidth == dstWidth_ && dstHeight == dstHeight_) {
+        return;
+    }
+
+    dstWidth_ = dstWidth;
+    dstHeight_ = dstHeight;
+    xIndex_.resize(dstWidth);
+    xWeight_.resize(dstWidth);
+    const float scale = static_cast<float>(width_) / dstWidth;
+    for (int x = 0; x < dstWidth; ++x) {
+        const float sx = std::max(0.0f, (x + 0.5f) * scale - 0.5f);
+        const int x0 = std::min(static_cast<int>(sx), width_ - 1);
+        xIndex_[x] = x0;
+        xWeight_[x] = x0 + 1 < width_ ? sx - x0 : 0.0f;
+    }
+    for (int slot = 0; slot < 2; ++slot) {
+        rowA_[slot].resize(dstWidth);
+        rowB_[slot].resize(dstWidth);
+    }
+}
+
+int GuidedFilter::expandedRow(int row) {
+    for (int slot = 0; slot < 2; ++slot) {
+        if (cachedRow_[slot] == row) {
+            return slot;
+        }
+    }
+
+    const int slot = cachedRow_[0] < cachedRow_[1] ? 0 : 1;
+    const float* a = meanA_.data() + static_cast<size_t>(row) * width_;
+    const float* b = meanB_.data() + static_cast<size_t>(row) * width_;
+    float* outA = rowA_[slot].data();
+    float* outB = rowB_[slot].data();
+    const int last = width_ - 1;
+    for (int x = 0; x < dstWidth_; ++x) {
+        const int x0 = xIndex_[x];
+        const int x1 = std::min(x0 + 1, last);
+        const float w = xWeight_[x];
+        outA[x] = a[x0] + (a[x1] - a[x0]) * w;
+        outB[x] = b[x0] + (b[x1] - b[x0]) * w;
+    }
+    cachedRow_[slot] = row;
+    return slot;
+}
+
+void GuidedFilter::applyModel(const ImageView& guide, uint8_t* dst, size_t dstStride) {
+    const int width = dstWidth_;
+    const float scale = static_cast<float>(height_) / dstHeight_;
+
+    for (int y = 0; y < dstHeight_; ++y) {
+        const float sy = std::max(0.0f, (y + 0.5f) * scale - 0.5f);
+        const int y0 = std::min(static_cast<int>(sy), height_ - 1);
+        const int y1 = std::min(y0 + 1, height_ - 1);
+        const float wy = y1 != y0 ? sy - y0 : 0.0f;
+
+        const int s0 = expandedRow(y0);
+        const int s1 = expandedRow(y1);
+        const float* a0 = rowA_[s0].data();
+        const float* a1 = rowA_[s1].data();
+        const float* b0 = rowB_[s0].data();
+        const float* b1 = rowB_[s1].data();
+        const uint8_t* luma = guide.row(0, y);
+        uint8_t* out = dst + static_cast<size_t>(y) * dstStride;
+
+        int x = 0;
+#if ACM_SIMD_SSE2
+        const __m128 vwy = _mm_set1_ps(wy);
+        const __m128i zero = _mm_setzero_si128();
+        for (; x + 16 <= width; x += 16) {
+            const __m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(luma + x));
+            const __m128i lo16 = _mm_unpacklo_epi8(pixels, zero);
+            const __m128i hi16 = _mm_unpackhi_epi8(pixels, zero);
+            const __m128i words[4] = {_mm_unpacklo_epi16(lo16, zero), _mm_unpackhi_epi16(lo16, zero),
+                                      _mm_unpacklo_epi16(hi16, zero), _mm_unpackhi_epi16(hi16, zero)};
+            __m128i q[4];
+            for (int k = 0; k < 4; ++k) {
+                const int i = x + k * 4;
+                const __m128 va0 = _mm_loadu_ps(a0 + i);
+                const __m128 vb0 = _mm_loadu_ps(b0 + i);
+                const __m128 a = _mm_add_ps(va0, _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(a1 + i), va0), vwy));
+                const __m128 b = _mm_add_ps(vb0, _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(b1 + i), vb0), vwy));
+                q[k] = _mm_cvtps_epi32(_mm_add_ps(_mm_mul_ps(a, _mm_cvtepi32_ps(words[k])), b));
+            }
+            const __m128i packed = _mm_packus_epi16(_mm_packs_epi32(q[0], q[1]), _mm_packs_epi32(q[2], q[3]));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + x), packed);
+        }
+#elif ACM_SIMD_NEON
+        for (; x + 16 <= width; x += 16) {
+            const uint8x16_t pixels = vld1q_u8(luma + x);
+            const uint16x8_t lo16 = vmovl_u8(vget_low_u8(pixels));
+            const uint16x8_t hi16 = vmovl_u8(vget_high_u8(pixels));
+            const uint32x4_t words[4] = {vmovl_u16(vget_low_u16(lo16)), vmovl_u16(vget_high_u16(lo16)),
+                                         vmovl_u16(vget_low_u16(hi16)), vmovl_u16(vget_high_u16(hi16))};
+            int32x4_t q[4];
+            for (int k = 0; k < 4; ++k) {
+                const int i = x + k * 4;
+                const float32x4_t va0 = vld1q_f32(a0 + i);
+                const float32x4_t vb0 = vld1q_f32(b0 + i);
+                const float32x4_t a = vmlaq_n_f32(va0, vsubq_f32(vld1q_f32(a1 + i), va0), wy);
+                const float32x4_t b = vmlaq_n_f32(vb0, vsubq_f32(vld1q_f32(b1 + i), vb0), wy);
+                q[k] = vcvtnq_s32_f32(vmlaq_f32(b, a, vcvtq_f32_u32(words[k])));
+            }
+            const uint16x8_t lo = vcombine_u16(vqmovun_s32(q[0]), vqmovun_s32(q[1]));
+            const uint16x8_t hi = vcombine_u16(vqmovun_s32(q[2]), vqmovun_s32(q[3]));
+            vst1q_u8(out + x, vcombine_u8(vqmovn_u16(lo), vqmovn_u16(hi)));
+        }
+#endif
+        for (; x < width; ++x) {
+            const float a = a0[x] + (a1[x] - a0[x]) * wy;
+            const float b = b0[x] + (b1[x] - b0[x]) * wy;
+            const float q = std::nearbyint(a * luma[x] + b);
+            out[x] = static_cast<uint8_t>(std::clamp(q, 0.0f, 255.0f));
+        }
+    }
+}
+
+bool GuidedFilter::refine(const ImageView& guide, const uint8_t* mask, int maskWidth, int maskHeight,
+                          size_t maskStride, uint8_t* dst, size_t dstStride) {
+    if (!guide.isValid() || !guide.hasLumaPlane() || !mask || !dst || maskWidth <= 0 || maskHeight <= 0 ||
+        maskWidth > guide.width || maskHeight > guide.height) {
+        return false;
+    }
+
+    if (maskWidth != width_ || maskHeight != height_) {
+        width_ = maskWidth;
+        height_ = maskHeight;
+        lowGuide_.resize(static_cast<size_t>(maskWidth) * maskHeight);
+        dstWidth_ = 0;  // Column tables depend on the mask width
+    }
+
+    downsampleGuide(guide);
+    fitCoefficients(mask, maskStride);
+    prepareUpsample(guide.width, guide.height);
+    applyModel(guide, dst, dstStride);
+    return true;
+}
+
+} // namespace AnonCam
@@ -0,0 +1,263 @@
+#include "HalfLandmarks.h"
+#include "FaceTracker.h"
+#include "Simd.h"
+
+#include <cstring>
+
+#if ACM_SIMD_SSE2 && (defined(__GNUC__) || defined(__clang__))
+#define ACM_F16C_DISPATCH 1
+#include <immintrin.h>
+#endif
+
+namespace AnonCam {
+
+// ============================================================================
+// Scalar reference
+// ============================================================================
+
+uint16_t floatToHalf(float value) {
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+
+    const uint16_t sign = static_cast<uint16_t>((bits >> 16) & 0x8000);
+    const uint32_t abs = bits & 0x7FFFFFFF;
+
+    if (abs >= 0x7F800000) {
+        // Inf stays Inf; NaN keeps its top payload bits and stays quiet
+        return sign | 0x7C00 | (abs > 0x7F800000 ? 0x200 | ((abs >> 13) & 0x3FF) : 0);
+    }
+    if (abs >= 0x477FF000) {
+        // >= 65520 rounds to Inf
+        return sign | 0x7C00;
+    }
+    if (abs < 0x33000000) {
+        // <= 2^-25 rounds to zero
+        return sign;
+    }
+
+    uint32_t result;
+    uint32_t remainder;
+    uint32_t halfway;
+    if (abs < 0x38800000) {
+        // Half subnormal: value / 2^-24, rounded
+        const uint32_t exponent = abs >> 23;
+        const uint32_t mantissa = (abs & 0x7FFFFF) | 0x800000;
+        const uint32_t shift = 126 - exponent;
+        result = mantissa >> shift;
+        remainder = mantissa & ((1u << shift) - 1);
+        halfway = 1u << (shift - 1);
+    } else {
+        // Rebias exponent 127 -> 15 and drop 13 mantissa bits
+        result = (abs - 0x38000000) >> 13;
+        remainder = abs & 0x1FFF;
+        halfway = 0x1000;
+    }
+
+    if (remainder > halfway || (remainder == halfway && (result & 1))) {
+        ++result;
+    }
+    return sign | static_cast<uint16_t>(result);
+}
+
+float halfToFloat(uint16_t value) {
+    const uint32_t sign = static_cast<uint32_t>(value & 0x8000) << 16;
+    const uint32_t exponent = (value >> 10) & 0x1F;
+    const uint32_t mantissa = value & 0x3FF;
+
+    uint32_t bits;
+    if (exponent == 0) {
+        const float magnitude = static_cast<float>(mantissa) * 5.9604644775390625e-8f;  // 2^-24
+        std::memcpy(&bits, &magnitude, sizeof(bits));
+        bits |= sign;
+    } else if (exponent == 31) {
+        bits = sign | 0x7F800000 | (mantissa << 13);
+    } else {
+        bits = sign | ((exponent + 112) << 23) | (mantissa << 13);
+    }
+
+    float result;
+    std::memcpy(&result, &bits, sizeof(result));
+    return result;
+}
+
+namespace {
+
+void toHalfScalar(const float* src, size_t n, uint16_t* dst) {
+    for (size_t i = 0; i < n; ++i) {
+        dst[i] = floatToHalf(src[i]);
+    }
+}
+
+void fromHalfScalar(const uint16_t* src, size_t n, float* dst) {
+    for (size_t i = 0; i < n; ++i) {
+        dst[i] = halfToFloat(src[i]);
+    }
+}
+
+void packHalf4Scalar(const Landmark* src, size_t count, uint16_t* dst) {
+    constexpr uint16_t kOne = 0x3C00;
+    for (size_t i = 0; i < count; ++i) {
+        dst[i * 4 + 0] = floatToHalf(src[i].x);
+        dst[i * 4 + 1] = floatToHalf(src[i].y);
+        dst[i * 4 + 2] = floatToHalf(src[i].z);
+        dst[i * 4 + 3] = kOne;
+    }
+}
+
+// ============================================================================
+// F16C (x86, runtime-selected)
+// ============================================================================
+
+#if ACM_F16C_DISPATCH
+
+bool cpuHasF16C() {
+    static const bool supported = __builtin_cpu_supports("f16c");
+    return supported;
+}
+
+__attribute__((target("f16c")))
+void toHalfF16C(const float* src, size_t n, uint16_t* dst) {
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        const __m128i lo = _mm_cvtps_ph(_mm_loadu_ps(src + i), _MM_FROUND_TO_NEAREST_INT);
+        const __m128i hi = _mm_cvtps_ph(_mm_loadu_ps(src + i + 4), _MM_FROUND_TO_NEAREST_INT);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_unpacklo_epi64(lo, hi));
+    }
+    toHalfScalar(src + i, n - i, dst + i);
+}
+
+__attribute__((target("f16c")))
+void fromHalfF16C(const uint16_t* src, size_t n, float* dst) {
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        const __m128i h = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        _mm_storeu_ps(dst + i, _mm_cvtph_ps(h));
+        _mm_storeu_ps(dst + i + 4, _mm_cvtph_ps(_mm_unpackhi_epi64(h, h)));
+    }
+    fromHalfScalar(src + i, n - i, dst + i);
+}
+
+__attribute__((target("f16c")))
+void packHalf4F16C(const Landmark* src, size_t count, uint16_t* dst) {
+    const __m128 one = _mm_set1_ps(1.0f);
+    size_t i = 0;
+    // Loading 4 floats at landmark i reads x of landmark i + 1; the last
+    // landmark goes through the scalar path to stay in bounds.
+    for (; i + 1 < count; ++i) {
+        const __m128 v = _mm_blend_ps(_mm_loadu_ps(&src[i].x), one, 0x8);
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(dst + i * 4), _mm_cvtps_ph(v, _MM_FROUND_TO_NEAREST_INT));
+    }
+    packHalf4Scalar(src + i, count - i, dst + i * 4);
+}
+
+#endif
+
+// ============================================================================
+// NEON (arm64)
+// ============================================================================
+
+#if ACM_SIMD_NEON
+
+void toHalfNeon(const float* src, size_t n, uint16_t* dst) {
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        const float16x4_t lo = vcvt_f16_f32(vld1q_f32(src + i));
+        const float16x4_t hi = vcvt_f16_f32(vld1q_f32(src + i + 4));
+        vst1q_u16(dst + i, vcombine_u16(vreinterpret_u16_f16(lo), vreinterpret_u16_f16(hi)));
+    }
+    toHalfScalar(src + i, n - i, dst + i);
+}
+
+void fromHalfNeon(const uint16_t* src, size_t n, float* dst) {
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        const uint16x8_t h = vld1q_u16(src + i);
+        vst1q_f32(dst + i, vcvt_f32_f16(vreinterpret_f16_u16(vget_low_u16(h))));
+        vst1q_f32(dst + i + 4, vcvt_f32_f16(vreinterpret_f16_u16(vget_high_u16(h))));
+    }
+    fromHalfScalar(src + i, n - i, dst + i);
+}
+
+void packHalf4Neon(const Landmark* src, size_t count, uint16_t* dst) {
+    size_t i = 0;
+    for (; i + 1 < count; ++i) {
+        const float32x4_t v = vsetq_lane_f32(1.0f, vld1q_f32(&src[i].x), 3);
+        vst1_u16(dst + i * 4, vreinterpret_u16_f16(vcvt_f16_f32(v)));
+    }
+    packHalf4Scalar(src + i, count - i, dst + i * 4);
+}
+
+#endif
+
+} // anonymous namespace
+
+// ============================================================================
+// Public entry points
+// ============================================================================
+
+void convertLandmarksToHalf(const Landmark* src, size_t count, LandmarkHalf* dst) {
+    if (count == 0) {
+        return;
+    }
+
+    const float* in = &src->x;
+    uint16_t* out = &dst->x;
+    const size_t n = count * 3;
+
+#if ACM_F16C_DISPATCH
+    if (cpuHasF16C()) {
+        toHalfF16C(in, n, out);
+        return;
+    }
+#elif ACM_SIMD_NEON
+    toHalfNeon(in, n, out);
+    return;
+#endif
+    toHalfScalar(in, n, out);
+}
+
+void convertLandmarksFromHalf(const LandmarkHalf* src, size_t count, Landmark* dst) {
+    if (count == 0) {
+        return;
+    }
+
+    const uint16_t* in = &src->x;
+    float* out = &dst->x;
+    const size_t n = count * 3;
+
+#if ACM_F16C_DISPATCH
+    if (cpuHasF16C()) {
+        fromHalfF16C(in, n, out);
+        return;
+    }
+#elif ACM_SIMD_NEON
+    fromHalfNeon(in, n, out);
+    return;
+#endif
+    fromHalfScalar(in, n, out);
+}
+
+void packLandmarksHalf4(const Landmark* src, size_t count, uint16_t* dst) {
+#if ACM_F16C_DISPATCH
+    if (cpuHasF16C()) {
+        packHalf4F16C(src, count, dst);
+        return;
+    }
+#elif ACM_SIMD_NEON
+    packHalf4Neon(src, count, dst);
+    return;
+#endif
+    packHalf4Scalar(src, count, dst);
+}
+
+const char* halfConversionBackend() {
+#if ACM_F16C_DISPATCH
+    return cpuHasF16C() ? "F16C" : "scalar";
+#elif ACM_SIMD_NEON
+    return "NEON";
+#else
+    return "scalar";
+#endif
+}
+
+} // namespace AnonCam
@@ -0,0 +1,162 @@
+#include "InferenceBatcher.h"
+
+#include <algorithm>
+#include <chrono>
+
+namespace AnonCam {
+
+namespace {
+
+// InferenceBatcher::streamBatch_ values besides a counted batch (id + 1)
+constexpr uint64_t kDetached = 0;
+constexpr uint64_t kUncounted = UINT64_MAX;
+
+} // anonymous namespace
+
+InferenceBatcher::InferenceBatcher(BatchFunction function)
+    : InferenceBatcher(std::move(function), Options()) {}
+
+InferenceBatcher::InferenceBatcher(BatchFunction function, const Options& options)
+    : function_(std::move(function)), options_(options) {
+    options_.maxBatch = std::max(1, options.maxBatch);
+    options_.windowUs = std::max(0, options.windowUs);
+    pending_.reserve(options_.maxBatch);
+    pendingErrors_.reserve(options_.maxBatch);
+    running_.reserve(options_.maxBatch);
+    runningErrors_.reserve(options_.maxBatch);
+    stats_.batchSizes.assign(options_.maxBatch + 1, 0);
+}
+
+int InferenceBatcher::attachStream() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    ++streams_;
+    // Reuse the id of a detached stream
+    const auto free = std::find(streamBatch_.begin(), streamBatch_.end(), kDetached);
+    if (free != streamBatch_.end()) {
+        *free = kUncounted;
+        return static_cast<int>(free - streamBatch_.begin());
+    }
+    streamBatch_.push_back(kUncounted);
+    return static_cast<int>(streamBatch_.size()) - 1;
+}
+
+void InferenceBatcher::detachStream(int stream) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (stream < 0 || stream >= static_cast<int>(streamBatch_.size()) || streamBatch_[stream] == kDetached) {
+            return;
+        }
+        if (streamBatch_[stream] == openBatch_ + 1) {
+            --counted_;
+        }
+        streamBatch_[stream] = kDetached;
+        --streams_;
+    }
+    // A leader may have been waiting for this stream
+    arrived_.notify_all();
+}
+
+bool InferenceBatcher::batchReady() const {
+    return static_cast<int>(pending_.size()) >= options_.maxBatch || (streams_ > 0 && counted_ >= streams_);
+}
+
+// A stream's late skip of the previous frame and its request for this one
+// land in the same batch: counted once, it cannot close the batch early
+void InferenceBatcher::countStream(int stream) {
+    if (stream == kNoStream) {
+        ++counted_;
+        return;
+    }
+    if (stream < 0 || stream >= static_cast<int>(streamBatch_.size()) || streamBatch_[stream] == kDetached ||
+        streamBatch_[stream] == openBatch_ + 1) {
+        return;
+    }
+    streamBatch_[stream] = openBatch_ + 1;
+    ++counted_;
+}
+
+void InferenceBatcher::skip(int stream) {
+    bool ready = false;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        countStream(stream);
+        ready = !pending_.empty() && batchReady();
+    }
+    if (ready) {
+        arrived_.notify_all();
+    }
+}
+
+void InferenceBatcher::run(void* request, int stream) {
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    // A full batch its leader has not taken yet: join the next one
+    open_.wait(lock, [this] { return static_cast<int>(pending_.size()) < options_.maxBatch; });
+
+    const uint64_t batch = openBatch_;
+    std::exception_ptr error;
+    pending_.push_back(request);
+    pendingErrors_.push_back(&error);
+    countStream(stream);
+    ++stats_.requests;
+    if (pending_.size() > 1) {
+        if (batchReady()) {
+            arrived_.notify_all();
+        }
+        finished_.wait(lock, [&] { return completed_ > batch; });
+        if (error) {
+            std::rethrow_exception(error);
+        }
+        return;
+    }
+
+    // Leader: collect the batch and take it once the previous one has run,
+    // which leaves running_ free
+    const auto begin = std::chrono::steady_clock::now();
+    arrived_.wait_until(lock, begin + std::chrono::microseconds(options_.windowUs), [this] { return batchReady(); });
+    finished_.wait(lock, [&] { return completed_ == batch; });
+    running_.swap(pending_);
+    runningErrors_.swap(pendingErrors_);
+    pending_.clear();
+    pendingErrors_.clear();
+    counted_ = 0;
+    ++openBatch_;
+    open_.notify_all();
+    const auto collected = std::chrono::steady_clock::now();
+
+    lock.unlock();
+    const auto start = std::chrono::steady_clock::now();
+    std::exception_ptr failure;
+    try {
+        function_(running_.data(), static_cast<int>(running_.size()));
+    } catch (...) {
+        failure = std::current_exception();
+    }
+    const auto end = std::chrono::steady_clock::now();
+    lock.lock();
+
+    // Every caller of a failed batch gets the exception; none is left waiting
+    if (failure) {
+        for (std::exception_ptr* callerError : runningErrors_) {
+            *callerError = failure;
+        }
+    }
+    completed_ = batch + 1;
+    ++stats_.batches;
+    ++stats_.batchSizes[running_.size()];
+    stats_.collectNs += static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(collected - begin).count());
+    stats_.runNs += static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count());
+    finished_.notify_all();
+    lock.unlock();
+    if (error) {
+        std::rethrow_exception(error);
+    }
+}
+
+InferenceBatcher::Stats InferenceBatcher::stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
+
+} // namespace AnonCam
@@ -0,0 +1,507 @@
+#include "InferenceKernels.h"
+#include "HalfLandmarks.h"
+#include "Simd.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#if ACM_SIMD_NEON && defined(__ARM_FEATURE_FP16_VECTOR_ARITHMETIC)
+#define ACM_HALF_ARITHMETIC 1
+#endif
+
+namespace {
+
+using AnonCam::HalfAccumulation;
+using AnonCam::floatToHalf;
+using AnonCam::halfToFloat;
+
+// ============================================================================
+// fp16 emulation
+// ============================================================================
+//
+// Every fp16 value is held in a float. A product of two fp16 values is exact
+// in fp32, so fp32 accumulation matches a fused multiply-add as is; fp16
+// accumulation computes a * b + sum exactly in double and rounds it to fp16
+// once, like vfmaq_f16.
+
+// Going through float would round twice; rounding to odd first (truncate,
+// set the sticky bit) leaves the final rounding to fp16 exact
+float roundToHalf(double value) {
+    float rounded = static_cast<float>(value);
+    if (static_cast<double>(rounded) != value) {
+        uint32_t bits;
+        std::memcpy(&bits, &rounded, sizeof(bits));
+        if (std::abs(static_cast<double>(rounded)) > std::abs(value)) {
+            --bits;
+        }
+        bits |= 1;
+        std::memcpy(&rounded, &bits, sizeof(bits));
+    }
+    return halfToFloat(floatToHalf(rounded));
+}
+
+// Calls tap(sourcePixelIndex, tapIndex) for the taps of (x, y) inside the image
+template <typename Tap>
+inline void forEachTap(int x, int y, int width, int height, Tap tap) {
+    for (int ky = 0; ky < 3; ++ky) {
+        const int sy = y + ky - 1;
+        if (sy < 0 || sy >= height) {
+            continue;
+        }
+        for (int kx = 0; kx < 3; ++kx) {
+            const int sx = x + kx - 1;
+            if (sx >= 0 && sx < width) {
+                tap(static_cast<size_t>(sy) * width + sx, ky * 3 + kx);
+            }
+        }
+    }
+}
+
+// Emulated GEMM blocking: tiles of kEmulatedTile rows x kEmulatedTile columns,
+// their inputs converted kEmulatedDepth values of k at a time into stack
+// scratch (so the tail of the vector kernels never touches the heap)
+constexpr int kEmulatedTile = 16;
+constexpr int kEmulatedDepth = 64;
+
+// Columns [first, n): the whole GEMM when emulated, the tail of the vector kernels otherwise
+void gemmHalfEmulated(const uint16_t* a, const uint16_t* b, const uint16_t* bias, uint16_t* c, int m, int n, int k,
+                      int first, HalfAccumulation accumulation) {
+    float rows[kEmulatedTile][kEmulatedDepth];
+    float columns[kEmulatedTile][kEmulatedDepth];   // Transposed: a column per row
+    float sums[kEmulatedTile][kEmulatedTile];
+    for (int j0 = first; j0 < n; j0 += kEmulatedTile) {
+        const int width = std::min(kEmulatedTile, n - j0);
+        for (int i0 = 0; i0 < m; i0 += kEmulatedTile) {
+            const int height = std::min(kEmulatedTile, m - i0);
+            for (int r = 0; r < height; ++r) {
+                for (int q = 0; q < width; ++q) {
+                    sums[r][q] = halfToFloat(bias[j0 + q]);
+                }
+            }
+            // Each sum still runs over p in order, one block after the other
+            for (int p0 = 0; p0 < k; p0 += kEmulatedDepth) {
+                const int depth = std::min(kEmulatedDepth, k - p0);
+                for (int p = 0; p < depth; ++p) {
+                    for (int q = 0; q < width; ++q) {
+                        columns[q][p] = halfToFloat(b[static_cast<size_t>(p0 + p) * n + j0 + q]);
+                    }
+                }
+                for (int r = 0; r < height; ++r) {
+                    for (int p = 0; p < depth; ++p) {
+                        rows[r][p] = halfToFloat(a[static_cast<size_t>(i0 + r) * k + p0 + p]);
+                    }
+                }
+                for (int r = 0; r < height; ++r) {
+                    for (int q = 0; q < width; ++q) {
+                        float sum = sums[r][q];
+                        if (accumulation == HalfAccumulation::Half) {
+                            for (int p = 0; p < depth; ++p) {
+                                sum = roundToHalf(static_cast<double>(rows[r][p]) * columns[q][p] + sum);
+                            }
+                        } else {
+                            for (int p = 0; p < depth; ++p) {
+                                sum += rows[r][p] * columns[q][p];
+                            }
+                        }
+                        sums[r][q] = sum;
+                    }
+                }
+            }
+            for (int r = 0; r < height; ++r) {
+                for (int q = 0; q < width; ++q) {
+                    c[static_cast<size_t>(i0 + r) * n + j0 + q] = floatToHalf(sums[r][q]);
+                }
+            }
+        }
+    }
+}
+
+// Channels [first, channels) of every pixel; taps outside the image are skipped
+void depthwiseHalfEmulated(const uint16_t* input, int width, int height, int channels, const uint16_t* weights,
+                           const uint16_t* bias, uint16_t* output, int first, HalfAccumulation accumulation) {
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) {
+            for (int ch = first; ch < channels; ++ch) {
+                float sum = halfToFloat(bias[ch]);
+                forEachTap(x, y, width, height, [&](size_t pixel, int tap) {
+                    const float value = halfToFloat(input[pixel * channels + ch]);
+                    const float weight = halfToFloat(weights[tap * channels + ch]);
+                    sum = accumulation == HalfAccumulation::Half
+                              ? roundToHalf(static_cast<double>(value) * weight + sum)
+                              : sum + value * weight;
+                });
+                output[(static_cast<size_t>(y) * width + x) * channels + ch] = floatToHalf(sum);
+            }
+        }
+    }
+}
+
+// ============================================================================
+// NEON FP16
+// ============================================================================
+
+#if ACM_HALF_ARITHMETIC
+
+// R rows x (8 * V) columns with fp16 accumulators
+template <int R, int V>
+void gemmHalfTile(const float16_t* a, const float16_t* b, const float16_t* bias, float16_t* c, int n, int k, int j) {
+    float16x8_t sums[R][V];
+    for (int v = 0; v < V; ++v) {
+        const float16x8_t initial = vld1q_f16(bias + j + v * 8);
+        for (int r = 0; r < R; ++r) {
+            sums[r][v] = initial;
+        }
+    }
+    for (int p = 0; p < k; ++p) {
+        float16x8_t w[V];
+        for (int v = 0; v < V; ++v) {
+            w[v] = vld1q_f16(b + static_cast<size_t>(p) * n + j + v * 8);
+        }
+        for (int r = 0; r < R; ++r) {
+            const float16x8_t x = vld1q_dup_f16(a + static_cast<size_t>(r) * k + p);
+            for (int v = 0; v < V; ++v) {
+                sums[r][v] = vfmaq_f16(sums[r][v], x, w[v]);
+            }
+        }
+    }
+    for (int r = 0; r < R; ++r) {
+        for (int v = 0; v < V; ++v) {
+            vst1q_f16(c + static_cast<size_t>(r) * n + j + v * 8, sums[r][v]);
+        }
+    }
+}
+
+// R rows x 8 columns with fp32 accumulators
+template <int R>
+void gemmHalfTileSingle(const float16_t* a, const float16_t* b, const float16_t* bias, float16_t* c, int n, int k,
+                        int j) {
+    float32x4_t low[R], high[R];
+    const float16x8_t initial = vld1q_f16(bias + j);
+    for (int r = 0; r < R; ++r) {
+        low[r] = vcvt_f32_f16(vget_low_f16(initial));
+        high[r] = vcvt_f32_f16(vget_high_f16(initial));
+    }
+    for (int p = 0; p < k; ++p) {
+        const float16x8_t w = vld1q_f16(b + static_cast<size_t>(p) * n + j);
+        const float32x4_t wLow = vcvt_f32_f16(vget_low_f16(w));
+        const float32x4_t wHigh = vcvt_f32_f16(vget_high_f16(w));
+        for (int r = 0; r < R; ++r) {
+            const float32x4_t x = vdupq_n_f32(static_cast<float>(a[static_cast<size_t>(r) * k + p]));
+            low[r] = vfmaq_f32(low[r], x, wLow);
+            high[r] = vfmaq_f32(high[r], x, wHigh);
+        }
+    }
+    for (int r = 0; r < R; ++r) {
+        vst1q_f16(c + static_cast<size_t>(r) * n + j, vcombine_f16(vcvt_f16_f32(low[r]), vcvt_f16_f32(high[r])));
+    }
+}
+
+template <int R>
+void gemmHalfRows(const float16_t* a, const float16_t* b, const float16_t* bias, float16_t* c, int n, int k,
+                  HalfAccumulation accumulation) {
+    int j = 0;
+    if (accumulation == HalfAccumulation::Half) {
+        for (; j + 16 <= n; j += 16) {
+            gemmHalfTile<R, 2>(a, b, bias, c, n, k, j);
+        }
+        for (; j + 8 <= n; j += 8) {
+            gemmHalfTile<R, 1>(a, b, bias, c, n, k, j);
+        }
+    } else {
+        for (; j + 8 <= n; j += 8) {
+            gemmHalfTileSingle<R>(a, b, bias, c, n, k, j);
+        }
+    }
+}
+
+#endif
+
+// ============================================================================
+// fp32
+// ============================================================================
+
+// R rows x 8 columns
+template <int R>
+void gemmTile(const float* a, const float* b, const float* bias, float* c, int n, int k, int j) {
+#if ACM_SIMD_SSE2
+    __m128 low[R], high[R];
+    for (int r = 0; r < R; ++r) {
+        low[r] = _mm_loadu_ps(bias + j);
+        high[r] = _mm_loadu_ps(bias + j + 4);
+    }
+    for (int p = 0; p < k; ++p) {
+        const float* w = b + static_cast<size_t>(p) * n + j;
+        const __m128 wLow = _mm_loadu_ps(w);
+        const __m128 wHigh = _mm_loadu_ps(w + 4);
+        for (int r = 0; r < R; ++r) {
+            const __m128 x = _mm_set1_ps(a[static_cast<size_t>(r) * k + p]);
+            low[r] = _mm_add_ps(low[r], _mm_mul_ps(x, wLow));
+            high[r] = _mm_add_ps(high[r], _mm_mul_ps(x, wHigh));
+        }
+    }
+    for (int r = 0; r < R; ++r) {
+        _mm_storeu_ps(c + static_cast<size_t>(r) * n + j, low[r]);
+        _mm_storeu_ps(c + static_cast<size_t>(r) * n + j + 4, high[r]);
+    }
+#elif ACM_SIMD_NEON
+    float32x4_t low[R], high[R];
+    for (int r = 0; r < R; ++r) {
+        low[r] = vld1q_f32(bias + j);
+        high[r] = vld1q_f32(bias + j + 4);
+    }
+    for (int p = 0; p < k; ++p) {
+        const float* w = b + static_cast<size_t>(p) * n + j;
+        const float32x4_t wLow = vld1q_f32(w);
+        const float32x4_t wHigh = vld1q_f32(w + 4);
+        for (int r = 0; r < R; ++r) {
+            const float32x4_t x = vdupq_n_f32(a[static_cast<size_t>(r) * k + p]);
+            low[r] = vfmaq_f32(low[r], x, wLow);
+            high[r] = vfmaq_f32(high[r], x, wHigh);
+        }
+    }
+    for (int r = 0; r < R; ++r) {
+        vst1q_f32(c + static_cast<size_t>(r) * n + j, low[r]);
+        vst1q_f32(c + static_cast<size_t>(r) * n + j + 4, high[r]);
+    }
+#else
+    for (int r = 0; r < R; ++r) {
+        for (int q = j; q < j + 8; ++q) {
+            float sum = bias[q];
+            for (int p = 0; p < k; ++p) {
+                sum += a[static_cast<size_t>(r) * k + p] * b[static_cast<size_t>(p) * n + q];
+            }
+            c[static_cast<size_t>(r) * n + q] = sum;
+        }
+    }
+#endif
+}
+
+template <int R>
+void gemmRows(const float* a, const float* b, const float* bias, float* c, int n, int k) {
+    int j = 0;
+    for (; j + 8 <= n; j += 8) {
+        gemmTile<R>(a, b, bias, c, n, k, j);
+    }
+    for (; j < n; ++j) {
+        for (int r = 0; r < R; ++r) {
+            float sum = bias[j];
+            for (int p = 0; p < k; ++p) {
+                sum += a[static_cast<size_t>(r) * k + p] * b[static_cast<size_t>(p) * n + j];
+            }
+            c[static_cast<size_t>(r) * n + j] = sum;
+        }
+    }
+}
+
+// ============================================================================
+// int8
+// ============================================================================
+
+#if ACM_SIMD_SSE2
+inline int32_t horizontalSum(__m128i v) {
+    v = _mm_add_epi32(v, _mm_shuffle_epi32(v, _MM_SHUFFLE(1, 0, 3, 2)));
+    v = _mm_add_epi32(v, _mm_shuffle_epi32(v, _MM_SHUFFLE(2, 3, 0, 1)));
+    return _mm_cvtsi128_si32(v);
+}
+#endif
+
+// Q dot products of a against consecutive rows of bT, sharing the loads of a
+template <int Q>
+void dotInt8(const int8_t* a, const int8_t* bT, int k, int32_t* out) {
+    int p = 0;
+    for (int q = 0; q < Q; ++q) {
+        out[q] = 0;
+    }
+#if ACM_SIMD_SSE2
+    __m128i sums[Q];
+    for (int q = 0; q < Q; ++q) {
+        sums[q] = _mm_setzero_si128();
+    }
+    for (; p + 16 <= k; p += 16) {
+        // Sign-extend to 16 bits: each byte paired with itself, shifted down
+        const __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + p));
+        const __m128i xLow = _mm_srai_epi16(_mm_unpacklo_epi8(x, x), 8);
+        const __m128i xHigh = _mm_srai_epi16(_mm_unpackhi_epi8(x, x), 8);
+        for (int q = 0; q < Q; ++q) {
+            const __m128i y = _mm_loadu_si128(reinterpret_cast<const __m128i*>(bT + static_cast<size_t>(q) * k + p));
+            const __m128i yLow = _mm_srai_epi16(_mm_unpacklo_epi8(y, y), 8);
+            const __m128i yHigh = _mm_srai_epi16(_mm_unpackhi_epi8(y, y), 8);
+            sums[q] = _mm_add_epi32(sums[q], _mm_add_epi32(_mm_madd_epi16(xLow, yLow), _mm_madd_epi16(xHigh, yHigh)));
+        }
+    }
+    for (int q = 0; q < Q; ++q) {
+        out[q] = horizontalSum(sums[q]);
+    }
+#elif ACM_SIMD_NEON
+    int32x4_t sums[Q];
+    for (int q = 0; q < Q; ++q) {
+        sums[q] = vdupq_n_s32(0);
+    }
+    for (; p + 16 <= k; p += 16) {
+        const int8x16_t x = vld1q_s8(a + p);
+        for (int q = 0; q < Q; ++q) {
+            const int8x16_t y = vld1q_s8(bT + static_cast<size_t>(q) * k + p);
+#if defined(__ARM_FEATURE_DOTPROD)
+            sums[q] = vdotq_s32(sums[q], x, y);
+#else
+            sums[q] = vpadalq_s16(sums[q], vmull_s8(vget_low_s8(x), vget_low_s8(y)));
+            sums[q] = vpadalq_s16(sums[q], vmull_high_s8(x, y));
+#endif
+        }
+    }
+    for (int q = 0; q < Q; ++q) {
+        out[q] = vaddvq_s32(sums[q]);
+    }
+#endif
+    for (; p < k; ++p) {
+        for (int q = 0; q < Q; ++q) {
+            out[q] += static_cast<int32_t>(a[p]) * bT[static_cast<size_t>(q) * k + p];
+        }
+    }
+}
+
+} // anonymous namespace
+
+namespace AnonCam {
+
+bool halfArithmeticNative() {
+#if ACM_HALF_ARITHMETIC
+    return true;
+#else
+    return false;
+#endif
+}
+
+const char* halfArithmeticBackend() {
+    return halfArithmeticNative() ? "NEON FP16" : "emulated";
+}
+
+void gemm(const float* a, const float* b, const float* bias, float* c, int m, int n, int k) {
+    int i = 0;
+    for (; i + 4 <= m; i += 4) {
+        gemmRows<4>(a + static_cast<size_t>(i) * k, b, bias, c + static_cast<size_t>(i) * n, n, k);
+    }
+    for (; i < m; ++i) {
+        gemmRows<1>(a + static_cast<size_t>(i) * k, b, bias, c + static_cast<size_t>(i) * n, n, k);
+    }
+}
+
+void gemmHalf(const uint16_t* a, const uint16_t* b, const uint16_t* bias, uint16_t* c, int m, int n, int k,
+              HalfAccumulation accumulation) {
+#if ACM_HALF_ARITHMETIC
+    const auto* a16 = reinterpret_cast<const float16_t*>(a);
+    const auto* b16 = reinterpret_cast<const float16_t*>(b);
+    const auto* bias16 = reinterpret_cast<const float16_t*>(bias);
+    auto* c16 = reinterpret_cast<float16_t*>(c);
+    int i = 0;
+    for (; i + 4 <= m; i += 4) {
+        gemmHalfRows<4>(a16 + static_cast<size_t>(i) * k, b16, bias16, c16 + static_cast<size_t>(i) * n, n, k,
+                        accumulation);
+    }
+    for (; i < m; ++i) {
+        gemmHalfRows<1>(a16 + static_cast<size_t>(i) * k, b16, bias16, c16 + static_cast<size_t>(i) * n, n, k,
+                        accumulation);
+    }
+    // Columns past the last full vector
+    gemmHalfEmulated(a, b, bias, c, m, n, k, n / 8 * 8, accumulation);
+#else
+    gemmHalfEmulated(a, b, bias, c, m, n, k, 0, accumulation);
+#endif
+}
+
+void gemmInt8(const int8_t* a, const int8_t* bT, const int32_t* bias, int32_t* c, int m, int n, int k) {
+    int32_t dots[4];
+    for (int i = 0; i < m; ++i) {
+        const int8_t* row = a + static_cast<size_t>(i) * k;
+        int32_t* out = c + static_cast<size_t>(i) * n;
+        int j = 0;
+        for (; j + 4 <= n; j += 4) {
+            dotInt8<4>(row, bT + static_cast<size_t>(j) * k, k, dots);
+            for (int q = 0; q < 4; ++q) {
+                out[j + q] = bias[j + q] + dots[q];
+            }
+        }
+        for (; j < n; ++j) {
+            dotInt8<1>(row, bT + static_cast<size_t>(j) * k, k, dots);
+            out[j] = bias[j] + dots[0];
+        }
+    }
+}
+
+void depthwiseConv3x3(const float* input, int width, int height, int channels, const float* weights,
+                      const float* bias, float* output) {
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) {
+            float* out = output + (static_cast<size_t>(y) * width + x) * channels;
+            int ch = 0;
+#if ACM_SIMD_SSE2
+            for (; ch + 4 <= channels; ch += 4) {
+                __m128 sum = _mm_loadu_ps(bias + ch);
+                forEachTap(x, y, width, height, [&](size_t pixel, int tap) {
+                    sum = _mm_add_ps(sum, _mm_mul_ps(_mm_loadu_ps(input + pixel * channels + ch),
+                                                     _mm_loadu_ps(weights + tap * channels + ch)));
+                });
+                _mm_storeu_ps(out + ch, sum);
+            }
+#elif ACM_SIMD_NEON
+            for (; ch + 4 <= channels; ch += 4) {
+                float32x4_t sum = vld1q_f32(bias + ch);
+                forEachTap(x, y, width, height, [&](size_t pixel, int tap) {
+                    sum = vfmaq_f32(sum, vld1q_f32(input + pixel * channels + ch),
+                                    vld1q_f32(weights + tap * channels + ch));
+                });
+                vst1q_f32(out + ch, sum);
+            }
+#endif
+            for (; ch < channels; ++ch) {
+                float sum = bias[ch];
+                forEachTap(x, y, width, height, [&](size_t pixel, int tap) {
+                    sum += input[pixel * channels + ch] * weights[tap * channels + ch];
+                });
+                out[ch] = sum;
+            }
+        }
+    }
+}
+
+void depthwiseConv3x3Half(const uint16_t* input, int width, int height, int channels, const uint16_t* weights,
+                          const uint16_t* bias, uint16_t* output, HalfAccumulation accumulation) {
+#if ACM_HALF_ARITHMETIC
+    const auto* in16 = reinterpret_cast<const float16_t*>(input);
+    const auto* w16 = reinterpret_cast<const float16_t*>(weights);
+    const auto* bias16 = reinterpret_cast<const float16_t*>(bias);
+    const int vectorChannels = channels / 8 * 8;
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) {
+            float16_t* out = reinterpret_cast<float16_t*>(output) + (static_cast<size_t>(y) * width + x) * channels;
+            for (int ch = 0; ch < vectorChannels; ch += 8) {
+                if (accumulation == HalfAccumulation::Half) {
+                    float16x8_t sum = vld1q_f16(bias16 + ch);
+                    forEachTap(x, y, width, height, [&](size_t pixel, int tap) {
+                        sum = vfmaq_f16(sum, vld1q_f16(in16 + pixel * channels + ch),
+                                        vld1q_f16(w16 + tap * channels + ch));
+                    });
+                    vst1q_f16(out + ch, sum);
+                    continue;
+                }
+                const float16x8_t initial = vld1q_f16(bias16 + ch);
+                float32x4_t low = vcvt_f32_f16(vget_low_f16(initial));
+                float32x4_t high = vcvt_f32_f16(vget_high_f16(initial));
+                forEachTap(x, y, width, height, [&](size_t pixel, int tap) {
+                    const float16x8_t value = vld1q_f16(in16 + pixel * channels + ch);
+                    const float16x8_t weight = vld1q_f16(w16 + tap * channels + ch);
+                    low = vfmaq_f32(low, vcvt_f32_f16(vget_low_f16(value)), vcvt_f32_f16(vget_low_f16(weight)));
+                    high = vfmaq_f32(high, vcvt_f32_f16(vget_high_f16(value)), vcvt_f32_f16(vget_high_f16(weight)));
+                });
+                vst1q_f16(out + ch, vcombine_f16(vcvt_f16_f32(low), vcvt_f16_f32(high)));
+            }
+        }
+    }
+    depthwiseHalfEmulated(input, width, height, channels, weights, bias, output, vectorChannels, accumulation);
+#else
+    depthwiseHalfEmulated(input, width, height, channels, weights, bias, output, 0, accumulation);
+#endif
+}
+
+} // namespace AnonCam
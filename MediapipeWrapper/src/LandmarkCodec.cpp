@@ -0,0 +1,329 @@
+#include "LandmarkCodec.h"
+#include "Simd.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace {
+
+// q = (v + offset) * kScale, offset 0.5 for x/y and 1.0 for z
+constexpr float kScale = 65535.0f / 2.0f;
+constexpr float kInvScale = 2.0f / 65535.0f;
+constexpr float kOffsetXY = 0.5f;
+constexpr float kOffsetZ = 1.0f;
+
+inline float componentOffset(size_t element) {
+    return (element % 3 == 2) ? kOffsetZ : kOffsetXY;
+}
+
+inline uint16_t quantizeScalar(float value, float offset) {
+    const float q = std::nearbyint((value + offset) * kScale);
+    return static_cast<uint16_t>(std::clamp(q, 0.0f, 65535.0f));
+}
+
+} // anonymous namespace
+
+namespace AnonCam {
+
+// ============================================================================
+// Quantization kernels
+// ============================================================================
+//
+// Landmarks are processed as a flat float array (x0 y0 z0 x1 ...). Eight
+// landmarks = 24 floats = six 4-lane vectors, whose component pattern repeats
+// every three vectors, so three offset vectors cover every lane.
+
+void quantizeLandmarks(const Landmark* landmarks, size_t count, uint16_t* out) {
+    const float* src = &landmarks[0].x;
+    const size_t n = count * 3;
+    size_t i = 0;
+
+#if ACM_SIMD_SSE2
+    const __m128 scale = _mm_set1_ps(kScale);
+    const __m128 offsets[3] = {
+        _mm_setr_ps(kOffsetXY, kOffsetXY, kOffsetZ, kOffsetXY),
+        _mm_setr_ps(kOffsetXY, kOffsetZ, kOffsetXY, kOffsetXY),
+        _mm_setr_ps(kOffsetZ, kOffsetXY, kOffsetXY, kOffsetZ),
+    };
+    const __m128i bias32 = _mm_set1_epi32(32768);
+    const __m128i bias16 = _mm_set1_epi16(static_cast<short>(0x8000));
+
+    for (; i + 24 <= n; i += 24) {
+        for (int pair = 0; pair < 3; ++pair) {
+            const int k = pair * 2;
+            const __m128 a = _mm_mul_ps(_mm_add_ps(_mm_loadu_ps(src + i + k * 4), offsets[k % 3]), scale);
+            const __m128 b = _mm_mul_ps(_mm_add_ps(_mm_loadu_ps(src + i + k * 4 + 4), offsets[(k + 1) % 3]), scale);
+            // SSE2 only has a signed 32->16 saturating pack: shift into signed
+            // range, pack, then flip the sign bit back.
+            const __m128i qa = _mm_sub_epi32(_mm_cvtps_epi32(a), bias32);
+            const __m128i qb = _mm_sub_epi32(_mm_cvtps_epi32(b), bias32);
+            const __m128i packed = _mm_xor_si128(_mm_packs_epi32(qa, qb), bias16);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i + k * 4), packed);
+        }
+    }
+#elif ACM_SIMD_NEON
+    const float32x4_t scale = vdupq_n_f32(kScale);
+    const float offsetTable[3][4] = {
+        {kOffsetXY, kOffsetXY, kOffsetZ, kOffsetXY},
+        {kOffsetXY, kOffsetZ, kOffsetXY, kOffsetXY},
+        {kOffsetZ, kOffsetXY, kOffsetXY, kOffsetZ},
+    };
+    const float32x4_t offsets[3] = {
+        vld1q_f32(offsetTable[0]), vld1q_f32(offsetTable[1]), vld1q_f32(offsetTable[2]),
+    };
+
+    for (; i + 24 <= n; i += 24) {
+        for (int pair = 0; pair < 3; ++pair) {
+            const int k = pair * 2;
+            const float32x4_t a = vmulq_f32(vaddq_f32(vld1q_f32(src + i + k * 4), offsets[k % 3]), scale);
+            const float32x4_t b = vmulq_f32(vaddq_f32(vld1q_f32(src + i + k * 4 + 4), offsets[(k + 1) % 3]), scale);
+            const uint16x8_t packed = vcombine_u16(vqmovn_u32(vcvtnq_u32_f32(a)), vqmovn_u32(vcvtnq_u32_f32(b)));
+            vst1q_u16(out + i + k * 4, packed);
+        }
+    }
+#endif
+
+    for (; i < n; ++i) {
+        out[i] = quantizeScalar(src[i], componentOffset(i));
+    }
+}
+
+void dequantizeLandmarks(const uint16_t* quantized, size_t count, Landmark* out) {
+    float* dst = &out[0].x;
+    const size_t n = count * 3;
+    size_t i = 0;
+
+#if ACM_SIMD_SSE2
+    const __m128 invScale = _mm_set1_ps(kInvScale);
+    const __m128 offsets[3] = {
+        _mm_setr_ps(kOffsetXY, kOffsetXY, kOffsetZ, kOffsetXY),
+        _mm_setr_ps(kOffsetXY, kOffsetZ, kOffsetXY, kOffsetXY),
+        _mm_setr_ps(kOffsetZ, kOffsetXY, kOffsetXY, kOffsetZ),
+    };
+    const __m128i zero = _mm_setzero_si128();
+
+    for (; i + 24 <= n; i += 24) {
+        for (int pair = 0; pair < 3; ++pair) {
+            const int k = pair * 2;
+            const __m128i q = _mm_loadu_si128(reinterpret_cast<const __m128i*>(quantized + i + k * 4));
+            const __m128 a = _mm_cvtepi32_ps(_mm_unpacklo_epi16(q, zero));
+            const __m128 b = _mm_cvtepi32_ps(_mm_unpackhi_epi16(q, zero));
+            _mm_storeu_ps(dst + i + k * 4, _mm_sub_ps(_mm_mul_ps(a, invScale), offsets[k % 3]));
+            _mm_storeu_ps(dst + i + k * 4 + 4, _mm_sub_ps(_mm_mul_ps(b, invScale), offsets[(k + 1) % 3]));
+        }
+    }
+#elif ACM_SIMD_NEON
+    const float32x4_t invScale = vdupq_n_f32(kInvScale);
+    const float offsetTable[3][4] = {
+        {kOffsetXY, kOffsetXY, kOffsetZ, kOffsetXY},
+        {kOffsetXY, kOffsetZ, kOffsetXY, kOffsetXY},
+        {kOffsetZ, kOffsetXY, kOffsetXY, kOffsetZ},
+    };
+    const float32x4_t offsets[3] = {
+        vld1q_f32(offsetTable[0]), vld1q_f32(offsetTable[1]), vld1q_f32(offsetTable[2]),
+    };
+
+    for (; i + 24 <= n; i += 24) {
+        for (int pair = 0; pair < 3; ++pair) {
+            const int k = pair * 2;
+            const uint16x8_t q = vld1q_u16(quantized + i + k * 4);
+            const float32x4_t a = vcvtq_f32_u32(vmovl_u16(vget_low_u16(q)));
+            const float32x4_t b = vcvtq_f32_u32(vmovl_u16(vget_high_u16(q)));
+            vst1q_f32(dst + i + k * 4, vsubq_f32(vmulq_f32(a, invScale), offsets[k % 3]));
+            vst1q_f32(dst + i + k * 4 + 4, vsubq_f32(vmulq_f32(b, invScale), offsets[(k + 1) % 3]));
+        }
+    }
+#endif
+
+    for (; i < n; ++i) {
+        dst[i] = static_cast<float>(quantized[i]) * kInvScale - componentOffset(i);
+    }
+}
+
+namespace {
+
+// Writes current - previous (mod 2^16) as int8. Returns false if any delta
+// does not fit, in which case the output is garbage.
+bool encodeDelta8(const uint16_t* current, const uint16_t* previous, size_t n, int8_t* out) {
+    size_t i = 0;
+    bool fits = true;
+
+#if ACM_SIMD_SSE2
+    __m128i minDelta = _mm_setzero_si128();
+    __m128i maxDelta = _mm_setzero_si128();
+    for (; i + 16 <= n; i += 16) {
+        const __m128i d0 = _mm_sub_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(current + i)),
+                                         _mm_loadu_si128(reinterpret_cast<const __m128i*>(previous + i)));
+        const __m128i d1 = _mm_sub_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(current + i + 8)),
+                                         _mm_loadu_si128(reinterpret_cast<const __m128i*>(previous + i + 8)));
+        minDelta = _mm_min_epi16(minDelta, _mm_min_epi16(d0, d1));
+        maxDelta = _mm_max_epi16(maxDelta, _mm_max_epi16(d0, d1));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm_packs_epi16(d0, d1));
+    }
+    alignas(16) int16_t lanes[8];
+    _mm_store_si128(reinterpret_cast<__m128i*>(lanes), minDelta);
+    fits = *std::min_element(lanes, lanes + 8) >= -128;
+    _mm_store_si128(reinterpret_cast<__m128i*>(lanes), maxDelta);
+    fits = fits && *std::max_element(lanes, lanes + 8) <= 127;
+#elif ACM_SIMD_NEON
+    int16x8_t minDelta = vdupq_n_s16(0);
+    int16x8_t maxDelta = vdupq_n_s16(0);
+    for (; i + 16 <= n; i += 16) {
+        const int16x8_t d0 = vreinterpretq_s16_u16(vsubq_u16(vld1q_u16(current + i), vld1q_u16(previous + i)));
+        const int16x8_t d1 = vreinterpretq_s16_u16(vsubq_u16(vld1q_u16(current + i + 8), vld1q_u16(previous + i + 8)));
+        minDelta = vminq_s16(minDelta, vminq_s16(d0, d1));
+        maxDelta = vmaxq_s16(maxDelta, vmaxq_s16(d0, d1));
+        vst1q_s8(out + i, vcombine_s8(vqmovn_s16(d0), vqmovn_s16(d1)));
+    }
+    fits = vminvq_s16(minDelta) >= -128 && vmaxvq_s16(maxDelta) <= 127;
+#endif
+
+    for (; i < n && fits; ++i) {
+        const int16_t d = static_cast<int16_t>(static_cast<uint16_t>(current[i] - previous[i]));
+        fits = d >= -128 && d <= 127;
+        out[i] = static_cast<int8_t>(d);
+    }
+    return fits;
+}
+
+// previous += delta (mod 2^16), in place
+void applyDelta8(const int8_t* delta, size_t n, uint16_t* previous) {
+    size_t i = 0;
+
+#if ACM_SIMD_SSE2
+    for (; i + 16 <= n; i += 16) {
+        const __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(delta + i));
+        // Sign-extend int8 -> int16 by duplicating bytes and shifting
+        const __m128i lo = _mm_srai_epi16(_mm_unpacklo_epi8(d, d), 8);
+        const __m128i hi = _mm_srai_epi16(_mm_unpackhi_epi8(d, d), 8);
+        __m128i* p0 = reinterpret_cast<__m128i*>(previous + i);
+        __m128i* p1 = reinterpret_cast<__m128i*>(previous + i + 8);
+        _mm_storeu_si128(p0, _mm_add_epi16(_mm_loadu_si128(p0), lo));
+        _mm_storeu_si128(p1, _mm_add_epi16(_mm_loadu_si128(p1), hi));
+    }
+#elif ACM_SIMD_NEON
+    for (; i + 16 <= n; i += 16) {
+        const int8x16_t d = vld1q_s8(delta + i);
+        const uint16x8_t lo = vreinterpretq_u16_s16(vmovl_s8(vget_low_s8(d)));
+        const uint16x8_t hi = vreinterpretq_u16_s16(vmovl_s8(vget_high_s8(d)));
+        vst1q_u16(previous + i, vaddq_u16(vld1q_u16(previous + i), lo));
+        vst1q_u16(previous + i + 8, vaddq_u16(vld1q_u16(previous + i + 8), hi));
+    }
+#endif
+
+    for (; i < n; ++i) {
+        previous[i] = static_cast<uint16_t>(previous[i] + delta[i]);
+    }
+}
+
+} // anonymous namespace
+
+// ============================================================================
+// LandmarkEncoder
+// ============================================================================
+
+LandmarkEncoder::LandmarkEncoder()
+    : LandmarkEncoder(Options()) {}
+
+LandmarkEncoder::LandmarkEncoder(const Options& options)
+    : options_(options) {}
+
+void LandmarkEncoder::reset() {
+    hasPrevious_ = false;
+    packetsSinceKey_ = 0;
+}
+
+size_t LandmarkEncoder::encode(const Landmark* landmarks, size_t count, uint8_t* out) {
+    if (count > 0xFFFF) {
+        return 0;
+    }
+
+    const size_t n = count * 3;
+    current_.resize(n);
+    if (count > 0) {
+        quantizeLandmarks(landmarks, count, current_.data());
+    }
+
+    LandmarkPacketHeader header{};
+    header.count = static_cast<uint16_t>(count);
+    header.sequence = ++sequence_;
+
+    uint8_t* payload = out + sizeof(LandmarkPacketHeader);
+    size_t payloadSize = 0;
+
+    const bool tryDelta = options_.deltaCoding && hasPrevious_ && previous_.size() == n &&
+                          packetsSinceKey_ + 1 < options_.keyframeInterval;
+    if (tryDelta && encodeDelta8(current_.data(), previous_.data(), n, reinterpret_cast<int8_t*>(payload))) {
+        header.type = static_cast<uint8_t>(LandmarkPacketType::Delta8);
+        payloadSize = n;
+        ++packetsSinceKey_;
+    } else {
+        header.type = static_cast<uint8_t>(LandmarkPacketType::Key);
+        payloadSize = n * sizeof(uint16_t);
+        std::memcpy(payload, current_.data(), payloadSize);
+        packetsSinceKey_ = 0;
+    }
+
+    std::memcpy(out, &header, sizeof(header));
+    previous_.swap(current_);
+    hasPrevious_ = true;
+    return sizeof(LandmarkPacketHeader) + payloadSize;
+}
+
+// ============================================================================
+// LandmarkDecoder
+// ============================================================================
+
+void LandmarkDecoder::reset() {
+    hasPrevious_ = false;
+}
+
+bool LandmarkDecoder::decode(const uint8_t* data, size_t size, Landmark* out, size_t capacity, size_t& count) {
+    count = 0;
+    if (!data || size < sizeof(LandmarkPacketHeader)) {
+        return false;
+    }
+
+    LandmarkPacketHeader header;
+    std::memcpy(&header, data, sizeof(header));
+    const size_t n = static_cast<size_t>(header.count) * 3;
+    const uint8_t* payload = data + sizeof(LandmarkPacketHeader);
+    const size_t payloadSize = size - sizeof(LandmarkPacketHeader);
+
+    if (header.count > capacity) {
+        return false;
+    }
+
+    switch (static_cast<LandmarkPacketType>(header.type)) {
+        case LandmarkPacketType::Key:
+            if (payloadSize < n * sizeof(uint16_t)) {
+                return false;
+            }
+            previous_.resize(n);
+            std::memcpy(previous_.data(), payload, n * sizeof(uint16_t));
+            break;
+
+        case LandmarkPacketType::Delta8:
+            if (!hasPrevious_ || previous_.size() != n || header.sequence != lastSequence_ + 1 ||
+                payloadSize < n) {
+                hasPrevious_ = false;
+                return false;
+            }
+            applyDelta8(reinterpret_cast<const int8_t*>(payload), n, previous_.data());
+            break;
+
+        default:
+            return false;
+    }
+
+    hasPrevious_ = true;
+    lastSequence_ = header.sequence;
+    if (header.count > 0) {
+        dequantizeLandmarks(previous_.data(), header.count, out);
+    }
+    count = header.count;
+    return true;
+}
+
+} // namespace AnonCam
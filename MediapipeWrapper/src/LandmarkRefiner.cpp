@@ -0,0 +1,254 @@
+#include "LandmarkRefiner.h"
+#include "FaceTracker.h"
+#include "WorkerPool.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+namespace {
+
+constexpr size_t kFaceMeshLandmarks = 478;
+
+// Face Mesh v478 landmarks refined per region: eye contour plus iris, and
+// the outer and inner lip contours
+constexpr int kLeftEye[] = {33,  7,   163, 144, 145, 153, 154, 155, 133, 173, 157,
+                            158, 159, 160, 161, 246, 468, 469, 470, 471, 472};
+constexpr int kRightEye[] = {263, 249, 390, 373, 374, 380, 381, 382, 362, 398, 384,
+                             385, 386, 387, 388, 466, 473, 474, 475, 476, 477};
+constexpr int kLips[] = {61, 146, 91,  181, 84,  17,  314, 405, 321, 375, 291, 185, 40,  39,
+                         37, 0,   267, 269, 270, 409, 78,  95,  88,  178, 87,  14,  317, 402,
+                         318, 324, 308, 191, 80, 81,  82,  13,  312, 311, 310, 415};
+
+struct RegionIndices {
+    const int* indices;
+    size_t count;
+};
+
+constexpr RegionIndices kRegions[] = {
+    {kLeftEye, sizeof(kLeftEye) / sizeof(kLeftEye[0])},
+    {kRightEye, sizeof(kRightEye) / sizeof(kRightEye[0])},
+    {kLips, sizeof(kLips) / sizeof(kLips[0])},
+};
+constexpr int kRegionCount = sizeof(kRegions) / sizeof(kRegions[0]);
+
+// Luma of one pixel for any supported format
+inline float lumaAt(const AnonCam::ImageView& frame, int x, int y) {
+    const uint8_t* row = frame.row(0, y);
+    if (frame.format == AnonCam::PixelFormat::BGRA) {
+        const uint8_t* p = row + static_cast<size_t>(x) * 4;
+        return static_cast<float>((p[0] * 29 + p[1] * 150 + p[2] * 77) >> 8);
+    }
+    return row[x];
+}
+
+// Bilinear luma at a pixel position (pixel centers on integers), clamped to the frame
+float sampleLuma(const AnonCam::ImageView& frame, float x, float y) {
+    x = std::clamp(x, 0.0f, static_cast<float>(frame.width - 1));
+    y = std::clamp(y, 0.0f, static_cast<float>(frame.height - 1));
+    const int x0 = static_cast<int>(x);
+    const int y0 = static_cast<int>(y);
+    const int x1 = std::min(x0 + 1, frame.width - 1);
+    const int y1 = std::min(y0 + 1, frame.height - 1);
+    const float fx = x - x0;
+    const float fy = y - y0;
+    const float top = lumaAt(frame, x0, y0) + (lumaAt(frame, x1, y0) - lumaAt(frame, x0, y0)) * fx;
+    const float bottom = lumaAt(frame, x0, y1) + (lumaAt(frame, x1, y1) - lumaAt(frame, x0, y1)) * fx;
+    return top + (bottom - top) * fy;
+}
+
+} // anonymous namespace
+
+namespace AnonCam {
+
+LandmarkRefiner::LandmarkRefiner()
+    : LandmarkRefiner(Options()) {}
+
+LandmarkRefiner::LandmarkRefiner(const Options& options, WorkerPool* workers)
+    : options_(options), workers_(workers), regions_(kRegionCount) {
+    options_.cropSize = std::max(8, options.cropSize);
+    options_.margin = std::max(0.0f, options.margin);
+    options_.anchor = std::clamp(options.anchor, 0.0f, 1.0f);
+    options_.iterations = std::max(1, options.iterations);
+    const size_t samples = static_cast<size_t>(options_.cropSize) * options_.cropSize;
+    for (Region& region : regions_) {
+        region.crop.resize(samples);
+        region.gradientX.resize(samples);
+        region.gradientY.resize(samples);
+    }
+}
+
+void LandmarkRefiner::reset() {
+    for (Region& region : regions_) {
+        region.valid = false;
+    }
+}
+
+bool LandmarkRefiner::refine(const ImageView& frame, Landmark* landmarks, size_t count,
+                             const CancellationToken& cancel) {
+    if (!frame.isValid() || count < kFaceMeshLandmarks) {
+        return false;
+    }
+    const auto begin = std::chrono::steady_clock::now();
+
+    // Regions touch disjoint landmarks and their own state only
+    auto task = [&](int index) {
+        if (!cancel.isCancelled()) {
+            refineRegion(frame, index, landmarks);
+        }
+    };
+    if (workers_) {
+        workers_->parallelFor(kRegionCount, task);
+    } else {
+        for (int index = 0; index < kRegionCount; ++index) {
+            task(index);
+        }
+    }
+    if (cancel.isCancelled()) {
+        return false;
+    }
+
+    for (const Region& region : regions_) {
+        ++(region.tracked ? stats_.regionsTracked : stats_.regionsReset);
+    }
+    stats_.lastProcessNs = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - begin).count();
+    return true;
+}
+
+void LandmarkRefiner::refineRegion(const ImageView& frame, int index, Landmark* landmarks) {
+    const RegionIndices& indices = kRegions[index];
+    Region& region = regions_[index];
+
+    // Face model's placement of the feature (pixels)
+    float minX = static_cast<float>(frame.width), minY = static_cast<float>(frame.height);
+    float maxX = 0.0f, maxY = 0.0f, sumX = 0.0f, sumY = 0.0f;
+    for (size_t i = 0; i < indices.count; ++i) {
+        const Landmark& lm = landmarks[indices.indices[i]];
+        const float x = lm.x * frame.width;
+        const float y = lm.y * frame.height;
+        minX = std::min(minX, x);
+        minY = std::min(minY, y);
+        maxX = std::max(maxX, x);
+        maxY = std::max(maxY, y);
+        sumX += x;
+        sumY += y;
+    }
+    const float modelX = sumX / indices.count;
+    const float modelY = sumY / indices.count;
+    const float side = std::max(maxX - minX, maxY - minY) * (1.0f + 2.0f * options_.margin);
+
+    float centerX = modelX;
+    float centerY = modelY;
+    float dx = 0.0f, dy = 0.0f;
+    region.tracked = region.valid && registerRegion(frame, region, dx, dy);
+    if (region.tracked) {
+        const float trackedX = region.centerX + dx * region.step;
+        const float trackedY = region.centerY + dy * region.step;
+        const float disagreement = std::hypot(modelX - trackedX, modelY - trackedY);
+        if (disagreement <= options_.maxDisagreement * std::max(side, 1.0f)) {
+            centerX = trackedX + (modelX - trackedX) * options_.anchor;
+            centerY = trackedY + (modelY - trackedY) * options_.anchor;
+        } else {
+            region.tracked = false;
+        }
+    }
+
+    // The feature keeps the face model's shape at the refined position
+    const float offsetX = (centerX - modelX) / frame.width;
+    const float offsetY = (centerY - modelY) / frame.height;
+    for (size_t i = 0; i < indices.count; ++i) {
+        Landmark& lm = landmarks[indices.indices[i]];
+        lm.x += offsetX;
+        lm.y += offsetY;
+    }
+
+    // Crop for the next frame: native resolution unless the feature outgrows the crop
+    region.centerX = centerX;
+    region.centerY = centerY;
+    region.step = std::max(1.0f, side / options_.cropSize);
+    region.valid = updateTemplate(frame, region);
+}
+
+void LandmarkRefiner::sampleCrop(const ImageView& frame, float originX, float originY, float step,
+                                 float* crop) const {
+    const int size = options_.cropSize;
+    for (int j = 0; j < size; ++j) {
+        const float y = originY + j * step;
+        for (int i = 0; i < size; ++i) {
+            crop[j * size + i] = sampleLuma(frame, originX + i * step, y);
+        }
+    }
+}
+
+bool LandmarkRefiner::updateTemplate(const ImageView& frame, Region& region) const {
+    const int size = options_.cropSize;
+    const float half = 0.5f * (size - 1) * region.step;
+    sampleCrop(frame, region.centerX - half, region.centerY - half, region.step, region.crop.data());
+
+    // Central differences; the one-sample border carries no gradient
+    double xx = 0.0, xy = 0.0, yy = 0.0;
+    std::fill(region.gradientX.begin(), region.gradientX.end(), 0.0f);
+    std::fill(region.gradientY.begin(), region.gradientY.end(), 0.0f);
+    for (int j = 1; j < size - 1; ++j) {
+        for (int i = 1; i < size - 1; ++i) {
+            const int at = j * size + i;
+            const float gx = 0.5f * (region.crop[at + 1] - region.crop[at - 1]);
+            const float gy = 0.5f * (region.crop[at + size] - region.crop[at - size]);
+            region.gradientX[at] = gx;
+            region.gradientY[at] = gy;
+            xx += gx * gx;
+            xy += gx * gy;
+            yy += gy * gy;
+        }
+    }
+    region.hessian[0] = static_cast<float>(xx);
+    region.hessian[1] = static_cast<float>(xy);
+    region.hessian[2] = static_cast<float>(yy);
+
+    // A flat or one-directional crop (closed eye in shadow) cannot be registered
+    const double samples = static_cast<double>(size - 2) * (size - 2);
+    const double minEigen = 0.5 * (xx + yy) - std::sqrt(0.25 * (xx - yy) * (xx - yy) + xy * xy);
+    return minEigen / samples > 1.0;
+}
+
+// Translation of the region since its crop was taken, in crop samples
+// (inverse compositional Lucas-Kanade: the template's gradients and
+// Hessian are computed once, each step only resamples the frame)
+bool LandmarkRefiner::registerRegion(const ImageView& frame, const Region& region, float& dx, float& dy) const {
+    const int size = options_.cropSize;
+    const float half = 0.5f * (size - 1) * region.step;
+    const float originX = region.centerX - half;
+    const float originY = region.centerY - half;
+    const double det = static_cast<double>(region.hessian[0]) * region.hessian[2] -
+                       static_cast<double>(region.hessian[1]) * region.hessian[1];
+    if (det <= 0.0) {
+        return false;
+    }
+
+    dx = 0.0f;
+    dy = 0.0f;
+    for (int iteration = 0; iteration < options_.iterations; ++iteration) {
+        double bx = 0.0, by = 0.0;
+        for (int j = 1; j < size - 1; ++j) {
+            const float y = originY + (j + dy) * region.step;
+            for (int i = 1; i < size - 1; ++i) {
+                const int at = j * size + i;
+                const float error = sampleLuma(frame, originX + (i + dx) * region.step, y) - region.crop[at];
+                bx += region.gradientX[at] * error;
+                by += region.gradientY[at] * error;
+            }
+        }
+        const float stepX = static_cast<float>((region.hessian[2] * bx - region.hessian[1] * by) / det);
+        const float stepY = static_cast<float>((region.hessian[0] * by - region.hessian[1] * bx) / det);
+        dx -= stepX;
+        dy -= stepY;
+        if (stepX * stepX + stepY * stepY < 1e-4f) {
+            break;
+        }
+    }
+    // Beyond a quarter crop the linearization no longer holds
+    return std::abs(dx) < 0.25f * size && std::abs(dy) < 0.25f * size;
+}
+
+} // namespace AnonCam
@@ -0,0 +1,413 @@
+#include "LandmarkStream.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace {
+
+#ifdef MSG_NOSIGNAL
+constexpr int kSendFlags = MSG_NOSIGNAL;
+#else
+constexpr int kSendFlags = 0;  // SO_NOSIGPIPE is set per socket instead
+#endif
+
+bool makeAddress(const std::string& path, sockaddr_un& address) {
+    std::memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (path.empty() || path.size() >= sizeof(address.sun_path)) {
+        return false;
+    }
+    std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+    return true;
+}
+
+// Clears the way for bind(): removes a stale socket, never any other file
+bool removeStaleSocket(const std::string& path) {
+    struct stat st {};
+    if (::lstat(path.c_str(), &st) != 0) {
+        return errno == ENOENT;
+    }
+    return S_ISSOCK(st.st_mode) && ::unlink(path.c_str()) == 0;
+}
+
+void configureSocket(int fd, bool nonBlocking) {
+    if (nonBlocking) {
+        const int flags = ::fcntl(fd, F_GETFL, 0);
+        ::fcntl(fd, F_SETFL, flags | O_NONBLOCK);
+    }
+    ::fcntl(fd, F_SETFD, FD_CLOEXEC);
+#ifdef SO_NOSIGPIPE
+    const int one = 1;
+    ::setsockopt(fd, SOL_SOCKET, SO_NOSIGPIPE, &one, sizeof(one));
+#endif
+}
+
+} // anonymous namespace
+
+namespace AnonCam {
+
+// ============================================================================
+// LandmarkPublisher
+// ============================================================================
+
+LandmarkPublisher::~LandmarkPublisher() {
+    stop();
+}
+
+bool LandmarkPublisher::start(const std::string& socketPath) {
+    return start(socketPath, Options());
+}
+
+bool LandmarkPublisher::start(const std::string& socketPath, const Options& options) {
+    stop();
+
+    sockaddr_un address;
+    if (!makeAddress(socketPath, address) || options.maxClients <= 0 ||
+        options.clientBufferBytes < sizeof(StreamMessageHeader)) {
+        return false;
+    }
+
+    const int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) {
+        return false;
+    }
+    configureSocket(fd, true);
+
+    if (!removeStaleSocket(socketPath) ||
+        ::bind(fd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0 ||
+        ::listen(fd, options.maxClients) != 0) {
+        ::close(fd);
+        return false;
+    }
+
+    options_ = options;
+    socketPath_ = socketPath;
+    listenFd_ = fd;
+    clients_.assign(static_cast<size_t>(options.maxClients), Client{});
+    clientCount_ = 0;
+
+    LandmarkEncoder::Options encoderOptions;
+    encoderOptions.keyframeInterval = options.keyframeInterval;
+    encoder_ = LandmarkEncoder(encoderOptions);
+    forceKeyframe_ = true;
+    frameNumber_ = 0;
+    stats_ = Stats{};
+    return true;
+}
+
+void LandmarkPublisher::stop() {
+    for (auto& client : clients_) {
+        closeClient(client);
+    }
+    clients_.clear();
+    clientCount_ = 0;
+
+    if (listenFd_ >= 0) {
+        ::close(listenFd_);
+        ::unlink(socketPath_.c_str());
+        listenFd_ = -1;
+    }
+}
+
+void LandmarkPublisher::acceptClients() {
+    for (;;) {
+        const int fd = ::accept(listenFd_, nullptr, nullptr);
+        if (fd < 0) {
+            return;  // EAGAIN: no more pending connections
+        }
+
+        auto slot = std::find_if(clients_.begin(), clients_.end(),
+                                 [](const Client& c) { return c.fd < 0; });
+        if (slot == clients_.end()) {
+            ::close(fd);
+            continue;
+        }
+
+        configureSocket(fd, true);
+        slot->fd = fd;
+        slot->buffer.resize(options_.clientBufferBytes);
+        slot->head = 0;
+        slot->size = 0;
+        ++clientCount_;
+
+        // New subscribers need a keyframe to start decoding
+        forceKeyframe_ = true;
+    }
+}
+
+void LandmarkPublisher::closeClient(Client& client) {
+    if (client.fd >= 0) {
+        ::close(client.fd);
+        client.fd = -1;
+        client.head = 0;
+        client.size = 0;
+        --clientCount_;
+    }
+}
+
+size_t LandmarkPublisher::encodeMessage(const FaceResult& result) {
+    const std::vector<Landmark>* landmarks = &result.landmarks;
+    if (landmarks->empty() && !result.landmarksHalf.empty()) {
+        widened_.resize(result.landmarksHalf.size());
+        convertLandmarksFromHalf(result.landmarksHalf.data(), widened_.size(), widened_.data());
+        landmarks = &widened_;
+    }
+
+    const bool withLandmarks = result.hasFace && !landmarks->empty() && landmarks->size() <= kStreamMaxLandmarks;
+    const size_t maxSize = sizeof(StreamMessageHeader) + sizeof(StreamFaceSummary) +
+                           (withLandmarks ? LandmarkEncoder::maxEncodedSize(landmarks->size()) : 0);
+    if (message_.size() < maxSize) {
+        message_.resize(maxSize);
+    }
+
+    StreamFaceSummary summary{};
+    summary.hasFace = result.hasFace ? 1 : 0;
+    summary.confidence = result.confidence;
+    std::memcpy(summary.translation, result.pose.translation, sizeof(summary.translation));
+    std::memcpy(summary.rotation, result.pose.rotation, sizeof(summary.rotation));
+
+    uint8_t* cursor = message_.data() + sizeof(StreamMessageHeader);
+    std::memcpy(cursor, &summary, sizeof(summary));
+    cursor += sizeof(summary);
+
+    if (withLandmarks) {
+        if (forceKeyframe_) {
+            encoder_.reset();
+            forceKeyframe_ = false;
+        }
+        cursor += encoder_.encode(landmarks->data(), landmarks->size(), cursor);
+    }
+
+    const size_t total = static_cast<size_t>(cursor - message_.data());
+
+    StreamMessageHeader header{};
+    header.magic = kStreamMagic;
+    header.version = kStreamVersion;
+    header.headerSize = sizeof(StreamMessageHeader);
+    header.payloadSize = static_cast<uint32_t>(total - sizeof(StreamMessageHeader));
+    header.frameNumber = ++frameNumber_;
+    header.timestampNs = result.timestampNs;
+    std::memcpy(message_.data(), &header, sizeof(header));
+
+    return total;
+}
+
+bool LandmarkPublisher::enqueue(Client& client, const uint8_t* data, size_t size) {
+    const size_t capacity = client.buffer.size();
+    if (capacity - client.size < size) {
+        return false;
+    }
+
+    const size_t tail = (client.head + client.size) % capacity;
+    const size_t first = std::min(size, capacity - tail);
+    std::memcpy(client.buffer.data() + tail, data, first);
+    std::memcpy(client.buffer.data(), data + first, size - first);
+    client.size += size;
+    return true;
+}
+
+bool LandmarkPublisher::flush(Client& client) {
+    const size_t capacity = client.buffer.size();
+    while (client.size > 0) {
+        // Everything queued for this client goes out in one call
+        iovec iov[2];
+        const size_t first = std::min(client.size, capacity - client.head);
+        iov[0].iov_base = client.buffer.data() + client.head;
+        iov[0].iov_len = first;
+        iov[1].iov_base = client.buffer.data();
+        iov[1].iov_len = client.size - first;
+
+        msghdr message{};
+        message.msg_iov = iov;
+        message.msg_iovlen = iov[1].iov_len > 0 ? 2 : 1;
+
+        const ssize_t sent = ::sendmsg(client.fd, &message, kSendFlags);
+        if (sent < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return errno == EAGAIN || errno == EWOULDBLOCK;
+        }
+
+        client.head = (client.head + static_cast<size_t>(sent)) % capacity;
+        client.size -= static_cast<size_t>(sent);
+        stats_.bytesSent += static_cast<uint64_t>(sent);
+
+        if (static_cast<size_t>(sent) < first + iov[1].iov_len) {
+            return true;  // Socket buffer full; the rest goes out next frame
+        }
+    }
+    return true;
+}
+
+void LandmarkPublisher::publish(const FaceResult& result) {
+    if (listenFd_ < 0) {
+        return;
+    }
+
+    acceptClients();
+    ++stats_.framesPublished;
+    if (clientCount_ == 0) {
+        return;
+    }
+
+    const size_t size = encodeMessage(result);
+
+    for (auto& client : clients_) {
+        if (client.fd < 0) {
+            continue;
+        }
+
+        if (enqueue(client, message_.data(), size)) {
+            ++stats_.messagesQueued;
+        } else {
+            ++stats_.messagesDropped;
+            if (options_.dropPolicy == DropPolicy::Disconnect) {
+                closeClient(client);
+                ++stats_.clientsDisconnected;
+                continue;
+            }
+            // The skipped packet breaks this client's delta chain
+            forceKeyframe_ = true;
+        }
+
+        if (!flush(client)) {
+            closeClient(client);
+            ++stats_.clientsDisconnected;
+        }
+    }
+}
+
+// ============================================================================
+// LandmarkSubscriber
+// ============================================================================
+
+LandmarkSubscriber::~LandmarkSubscriber() {
+    disconnect();
+}
+
+bool LandmarkSubscriber::connect(const std::string& socketPath) {
+    disconnect();
+
+    sockaddr_un address;
+    if (!makeAddress(socketPath, address)) {
+        return false;
+    }
+
+    const int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) {
+        return false;
+    }
+    configureSocket(fd, false);
+
+    if (::connect(fd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0) {
+        ::close(fd);
+        return false;
+    }
+
+    fd_ = fd;
+    buffer_.resize(64 * 1024);
+    begin_ = 0;
+    end_ = 0;
+    decoder_.reset();
+    return true;
+}
+
+void LandmarkSubscriber::disconnect() {
+    if (fd_ >= 0) {
+        ::close(fd_);
+        fd_ = -1;
+    }
+}
+
+bool LandmarkSubscriber::readMore(int timeoutMs) {
+    if (begin_ > 0) {
+        std::memmove(buffer_.data(), buffer_.data() + begin_, end_ - begin_);
+        end_ -= begin_;
+        begin_ = 0;
+    }
+    if (end_ == buffer_.size()) {
+        buffer_.resize(buffer_.size() * 2);
+    }
+
+    pollfd pfd{fd_, POLLIN, 0};
+    int ready;
+    do {
+        ready = ::poll(&pfd, 1, timeoutMs);
+    } while (ready < 0 && errno == EINTR);
+    if (ready <= 0) {
+        return false;
+    }
+
+    const ssize_t received = ::recv(fd_, buffer_.data() + end_, buffer_.size() - end_, 0);
+    if (received <= 0) {
+        disconnect();
+        return false;
+    }
+    end_ += static_cast<size_t>(received);
+    return true;
+}
+
+bool LandmarkSubscriber::receive(StreamFrame& frame, int timeoutMs) {
+    if (fd_ < 0) {
+        return false;
+    }
+
+    while (end_ - begin_ < sizeof(StreamMessageHeader)) {
+        if (!readMore(timeoutMs)) {
+            return false;
+        }
+    }
+
+    StreamMessageHeader header;
+    std::memcpy(&header, buffer_.data() + begin_, sizeof(header));
+    if (header.magic != kStreamMagic || header.version != kStreamVersion ||
+        header.headerSize != sizeof(StreamMessageHeader) || header.payloadSize < sizeof(StreamFaceSummary) ||
+        header.payloadSize > kStreamMaxPayloadSize) {
+        disconnect();
+        return false;
+    }
+
+    const size_t total = sizeof(StreamMessageHeader) + header.payloadSize;
+    while (end_ - begin_ < total) {
+        if (buffer_.size() < total) {
+            buffer_.resize(total);
+        }
+        if (!readMore(timeoutMs)) {
+            return false;
+        }
+    }
+
+    const uint8_t* payload = buffer_.data() + begin_ + sizeof(StreamMessageHeader);
+    frame.frameNumber = header.frameNumber;
+    frame.timestampNs = header.timestampNs;
+    std::memcpy(&frame.summary, payload, sizeof(StreamFaceSummary));
+
+    const size_t packetSize = header.payloadSize - sizeof(StreamFaceSummary);
+    frame.landmarksValid = false;
+    if (frame.summary.hasFace && packetSize >= sizeof(LandmarkPacketHeader)) {
+        LandmarkPacketHeader packetHeader;
+        std::memcpy(&packetHeader, payload + sizeof(StreamFaceSummary), sizeof(packetHeader));
+        frame.landmarks.resize(std::min<size_t>(packetHeader.count, kStreamMaxLandmarks));
+
+        size_t count = 0;
+        frame.landmarksValid = decoder_.decode(payload + sizeof(StreamFaceSummary), packetSize,
+                                               frame.landmarks.data(), frame.landmarks.size(), count);
+    }
+    if (!frame.landmarksValid) {
+        frame.landmarks.clear();
+    }
+
+    begin_ += total;
+    return true;
+}
+
+} // namespace AnonCam
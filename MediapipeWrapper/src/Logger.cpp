@@ -0,0 +1,350 @@
+#include "Logger.h"
+
+#include <cinttypes>
+#include <cstdio>
+
+namespace {
+
+int64_t nowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+int ringCapacity(int records) {
+    int capacity = 2;
+    while (capacity < records) {
+        capacity *= 2;
+    }
+    return capacity;
+}
+
+// Counter written by one thread and read by another: no read-modify-write needed
+void bump(std::atomic<uint64_t>& counter) {
+    counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+}
+
+char levelLetter(AnonCam::LogLevel level) {
+    switch (level) {
+        case AnonCam::LogLevel::Debug: return 'D';
+        case AnonCam::LogLevel::Info: return 'I';
+        case AnonCam::LogLevel::Warning: return 'W';
+        case AnonCam::LogLevel::Error: return 'E';
+    }
+    return '?';
+}
+
+const char* baseName(const char* path) {
+    const char* slash = std::strrchr(path, '/');
+    return slash ? slash + 1 : path;
+}
+
+} // anonymous namespace
+
+namespace AnonCam {
+
+// Records of one logging thread: it advances tail, the background thread head
+struct Logger::Ring {
+    explicit Ring(int capacity)
+        : records(capacity), mask(static_cast<uint64_t>(capacity) - 1) {}
+
+    std::vector<Record> records;
+    const uint64_t mask;
+
+    alignas(64) std::atomic<uint64_t> head{0};
+    alignas(64) std::atomic<uint64_t> tail{0};
+    uint64_t cachedHead = 0;                    // Owning thread's last look at head
+    std::atomic<uint64_t> rateLimited{0};       // Written by the owning thread only
+    std::atomic<uint64_t> overflowed{0};
+    std::atomic<bool> closed{false};            // Owning thread exited
+
+    // Background thread only
+    uint64_t reportedOverflowed = 0;
+};
+
+Logger::Logger()
+    : Logger(Options()) {}
+
+Logger::Logger(const Options& options)
+    : id_([] {
+          static std::atomic<uint64_t> nextId{1};
+          return nextId.fetch_add(1, std::memory_order_relaxed);
+      }()),
+      capacity_(ringCapacity(options.recordsPerThread)),
+      burst_(std::max(1, options.burst)),
+      windowNs_(static_cast<int64_t>(std::max(1, options.windowMs)) * 1000000),
+      drainInterval_(std::max(1, options.drainIntervalMs)),
+      start_(std::chrono::steady_clock::now()),
+      minLevel_(options.minLevel),
+      sink_(options.sink) {
+    thread_ = std::thread([this] { run(); });
+}
+
+Logger::~Logger() {
+    {
+        std::lock_guard<std::mutex> lock(wakeMutex_);
+        stopping_ = true;
+    }
+    wake_.notify_one();
+    thread_.join();
+}
+
+Logger& Logger::shared() {
+    // Leaked: threads may still log while static objects are destroyed
+    static Logger* const logger = new Logger();
+    return *logger;
+}
+
+Logger::Ring* Logger::reserve(LogSite& site, Record*& record) {
+    if (site.level < minLevel_.load(std::memory_order_relaxed)) {
+        return nullptr;
+    }
+    Ring* ring = threadRing();
+    if (!ring) {
+        return nullptr;
+    }
+
+    // Rate limit: racing threads may let a message or two more through when
+    // a window turns over, which is all the precision a log needs
+    const int64_t now = nowNs();
+    int64_t windowStart = site.windowStartNs.load(std::memory_order_relaxed);
+    if (now - windowStart >= windowNs_ &&
+        site.windowStartNs.compare_exchange_strong(windowStart, now, std::memory_order_relaxed)) {
+        site.windowCount.store(0, std::memory_order_relaxed);
+    }
+    if (site.windowCount.load(std::memory_order_relaxed) >= static_cast<uint32_t>(burst_) ||
+        site.windowCount.fetch_add(1, std::memory_order_relaxed) >= static_cast<uint32_t>(burst_)) {
+        site.suppressed.fetch_add(1, std::memory_order_relaxed);
+        bump(ring->rateLimited);
+        return nullptr;
+    }
+
+    const uint64_t tail = ring->tail.load(std::memory_order_relaxed);
+    if (tail - ring->cachedHead > ring->mask) {
+        ring->cachedHead = ring->head.load(std::memory_order_acquire);
+        if (tail - ring->cachedHead > ring->mask) {
+            bump(ring->overflowed);
+            return nullptr;
+        }
+    }
+
+    record = &ring->records[tail & ring->mask];
+    record->site = &site;
+    record->timestampNs = now;
+    record->suppressed = site.suppressed.load(std::memory_order_relaxed) == 0
+                             ? 0
+                             : site.suppressed.exchange(0, std::memory_order_relaxed);
+    record->argumentCount = 0;
+    return ring;
+}
+
+void Logger::commit(Ring* ring) {
+    ring->tail.store(ring->tail.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
+Logger::Ring* Logger::threadRing() {
+    // Rings of the loggers this thread has used; closed when the thread exits
+    struct ThreadRings {
+        struct Entry {
+            uint64_t loggerId;
+            std::shared_ptr<Ring> ring;
+        };
+        std::vector<Entry> entries;
+
+        ~ThreadRings() {
+            for (const Entry& entry : entries) {
+                entry.ring->closed.store(true, std::memory_order_release);
+            }
+        }
+    };
+    thread_local ThreadRings threadRings;
+
+    for (const ThreadRings::Entry& entry : threadRings.entries) {
+        if (entry.loggerId == id_) {
+            return entry.ring.get();
+        }
+    }
+
+    // First message from this thread: the only allocation it makes
+    try {
+        auto ring = std::make_shared<Ring>(capacity_);
+        {
+            std::lock_guard<std::mutex> lock(ringsMutex_);
+            rings_.push_back(ring);
+        }
+        // Rings the background thread has let go of belong to destroyed loggers
+        auto& entries = threadRings.entries;
+        entries.erase(std::remove_if(entries.begin(), entries.end(),
+                                     [](const ThreadRings::Entry& entry) { return entry.ring.use_count() == 1; }),
+                      entries.end());
+        entries.push_back({id_, ring});
+        return ring.get();
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+void Logger::flush() {
+    std::unique_lock<std::mutex> lock(wakeMutex_);
+    // A drain that starts from here on sees everything logged so far
+    const uint64_t target = drainsStarted_ + 1;
+    flushRequested_ = true;
+    wake_.notify_one();
+    drained_.wait(lock, [&] { return drainsFinished_ >= target || stopping_; });
+}
+
+void Logger::setSink(Sink sink) {
+    std::lock_guard<std::mutex> lock(sinkMutex_);
+    sink_ = std::move(sink);
+}
+
+Logger::Stats Logger::stats() const {
+    Stats stats;
+    stats.written = written_.load(std::memory_order_relaxed);
+    std::lock_guard<std::mutex> lock(ringsMutex_);
+    stats.rateLimited = retiredRateLimited_;
+    stats.overflowed = retiredOverflowed_;
+    for (const auto& ring : rings_) {
+        stats.rateLimited += ring->rateLimited.load(std::memory_order_relaxed);
+        stats.overflowed += ring->overflowed.load(std::memory_order_relaxed);
+    }
+    stats.threads = static_cast<int>(rings_.size());
+    return stats;
+}
+
+void Logger::run() {
+    std::unique_lock<std::mutex> lock(wakeMutex_);
+    for (;;) {
+        wake_.wait_for(lock, drainInterval_, [&] { return stopping_ || flushRequested_; });
+        const bool stopping = stopping_;
+        flushRequested_ = false;
+        const uint64_t ticket = ++drainsStarted_;
+        lock.unlock();
+
+        drain();
+
+        lock.lock();
+        drainsFinished_ = ticket;
+        drained_.notify_all();
+        if (stopping) {
+            return;
+        }
+    }
+}
+
+void Logger::drain() {
+    {
+        std::lock_guard<std::mutex> lock(ringsMutex_);
+        draining_ = rings_;
+    }
+
+    size_t lineCount = 0;
+    for (const auto& ring : draining_) {
+        // Closed is read first: a closed ring's tail is final
+        const bool closed = ring->closed.load(std::memory_order_acquire);
+        const uint64_t head = ring->head.load(std::memory_order_relaxed);
+        const uint64_t tail = ring->tail.load(std::memory_order_acquire);
+        for (uint64_t i = head; i < tail; ++i) {
+            const Record& record = ring->records[i & ring->mask];
+            if (lineCount == lines_.size()) {
+                lines_.emplace_back();
+            }
+            Line& line = lines_[lineCount++];
+            line.timestampNs = record.timestampNs;
+            line.level = record.site->level;
+            format(record, line.text);
+        }
+        ring->head.store(tail, std::memory_order_release);
+
+        const uint64_t overflowed = ring->overflowed.load(std::memory_order_relaxed);
+        if (overflowed != ring->reportedOverflowed) {
+            if (lineCount == lines_.size()) {
+                lines_.emplace_back();
+            }
+            Line& line = lines_[lineCount++];
+            line.timestampNs = nowNs();
+            line.level = LogLevel::Warning;
+            char text[128];
+            std::snprintf(text, sizeof(text), "W %.6f logger: %" PRIu64 " messages dropped, a thread's ring was full",
+                          secondsSinceStart(line.timestampNs), overflowed - ring->reportedOverflowed);
+            line.text = text;
+            ring->reportedOverflowed = overflowed;
+        }
+
+        if (closed) {
+            std::lock_guard<std::mutex> lock(ringsMutex_);
+            retiredRateLimited_ += ring->rateLimited.load(std::memory_order_relaxed);
+            retiredOverflowed_ += overflowed;
+            rings_.erase(std::find(rings_.begin(), rings_.end(), ring));
+        }
+    }
+    draining_.clear();
+
+    // Each ring is in order; threads interleave by timestamp
+    std::stable_sort(lines_.begin(), lines_.begin() + lineCount,
+                     [](const Line& a, const Line& b) { return a.timestampNs < b.timestampNs; });
+
+    std::lock_guard<std::mutex> lock(sinkMutex_);
+    for (size_t i = 0; i < lineCount; ++i) {
+        if (sink_) {
+            sink_(lines_[i].level, lines_[i].text.c_str());
+        } else {
+            std::fprintf(stderr, "%s\n", lines_[i].text.c_str());
+        }
+    }
+    written_.fetch_add(lineCount, std::memory_order_relaxed);
+}
+
+double Logger::secondsSinceStart(int64_t timestampNs) const {
+    const int64_t startNs =
+        std::chrono::duration_cast<std::chrono::nanoseconds>(start_.time_since_epoch()).count();
+    return static_cast<double>(timestampNs - startNs) * 1e-9;
+}
+
+// "E 12.345678 FaceTracker.cpp:218 message (+N suppressed)"
+void Logger::format(const Record& record, std::string& out) const {
+    const LogSite& site = *record.site;
+    char buffer[64];
+    const double seconds = secondsSinceStart(record.timestampNs);
+    if (site.line > 0) {
+        std::snprintf(buffer, sizeof(buffer), "%c %.6f %s:%d ", levelLetter(site.level), seconds,
+                      baseName(site.file), site.line);
+    } else {
+        std::snprintf(buffer, sizeof(buffer), "%c %.6f %s: ", levelLetter(site.level), seconds, site.file);
+    }
+    out = buffer;
+
+    int next = 0;
+    for (const char* c = site.format; *c; ++c) {
+        if (c[0] != '{' || c[1] != '}' || next >= record.argumentCount) {
+            out += *c;
+            continue;
+        }
+        const Argument& argument = record.arguments[next];
+        switch (record.types[next]) {
+            case ArgumentType::Signed:
+                std::snprintf(buffer, sizeof(buffer), "%" PRId64, argument.i);
+                out += buffer;
+                break;
+            case ArgumentType::Unsigned:
+                std::snprintf(buffer, sizeof(buffer), "%" PRIu64, argument.u);
+                out += buffer;
+                break;
+            case ArgumentType::Float:
+                std::snprintf(buffer, sizeof(buffer), "%g", argument.f);
+                out += buffer;
+                break;
+            case ArgumentType::Text:
+                out.append(record.text + argument.text.offset, argument.text.length);
+                break;
+        }
+        ++next;
+        ++c;
+    }
+
+    if (record.suppressed > 0) {
+        std::snprintf(buffer, sizeof(buffer), " (+%u suppressed)", record.suppressed);
+        out += buffer;
+    }
+}
+
+} // namespace AnonCam
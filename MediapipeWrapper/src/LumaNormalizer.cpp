@@ -0,0 +1,138 @@
+#include "LumaNormalizer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace {
+
+constexpr int kSubHistograms = 4;
+
+// Count a luma row into four sub-histograms. Neither SSE2 nor NEON can
+// scatter-add, so bytes come from 64-bit loads and alternate between tables;
+// runs of equal values then do not serialize on one counter.
+void accumulateRow(const uint8_t* row, int width, uint32_t (*counts)[256]) {
+    int x = 0;
+    for (; x + 8 <= width; x += 8) {
+        uint64_t word;
+        std::memcpy(&word, row + x, sizeof(word));
+        ++counts[0][word & 0xff];
+        ++counts[1][(word >> 8) & 0xff];
+        ++counts[2][(word >> 16) & 0xff];
+        ++counts[3][(word >> 24) & 0xff];
+        ++counts[0][(word >> 32) & 0xff];
+        ++counts[1][(word >> 40) & 0xff];
+        ++counts[2][(word >> 48) & 0xff];
+        ++counts[3][word >> 56];
+    }
+    for (; x < width; ++x) {
+        ++counts[x & 3][row[x]];
+    }
+}
+
+void accumulateBgraRow(const uint8_t* row, int width, uint32_t (*counts)[256]) {
+    for (int x = 0; x < width; ++x) {
+        const uint8_t* p = row + static_cast<size_t>(x) * 4;
+        ++counts[x & 3][(p[0] * 29 + p[1] * 150 + p[2] * 77) >> 8];
+    }
+}
+
+} // anonymous namespace
+
+namespace AnonCam {
+
+LumaNormalizer::LumaNormalizer()
+    : LumaNormalizer(Options()) {}
+
+LumaNormalizer::LumaNormalizer(const Options& options)
+    : options_(options) {
+    options_.rowStep = std::max(1, options.rowStep);
+    options_.clipLimit = std::max(1.0f, options.clipLimit);
+    options_.maxGain = std::max(1.0f, options.maxGain);
+    for (int v = 0; v < 256; ++v) {
+        lut_[v] = static_cast<uint8_t>(v);
+    }
+}
+
+bool LumaNormalizer::analyze(const ImageView& frame, int x0, int y0, int x1, int y1) {
+    x0 = std::clamp(x0, 0, frame.width);
+    x1 = std::clamp(x1, x0, frame.width);
+    y0 = std::clamp(y0, 0, frame.height);
+    y1 = std::clamp(y1, y0, frame.height);
+    if (!frame.isValid() || x1 == x0 || y1 == y0) {
+        return false;
+    }
+
+    uint32_t counts[kSubHistograms][256] = {};
+    const int width = x1 - x0;
+    for (int y = y0; y < y1; y += options_.rowStep) {
+        if (frame.format == PixelFormat::BGRA) {
+            accumulateBgraRow(frame.row(0, y) + static_cast<size_t>(x0) * 4, width, counts);
+        } else {
+            accumulateRow(frame.row(0, y) + x0, width, counts);
+        }
+    }
+
+    uint32_t histogram[256];
+    uint32_t total = 0;
+    for (int v = 0; v < 256; ++v) {
+        histogram[v] = counts[0][v] + counts[1][v] + counts[2][v] + counts[3][v];
+        total += histogram[v];
+    }
+
+    if (options_.mode == Mode::Gain) {
+        buildGain(histogram, total);
+    } else {
+        buildEqualize(histogram, total);
+    }
+    return true;
+}
+
+void LumaNormalizer::buildGain(const uint32_t* histogram, uint32_t total) {
+    const auto percentile = [&](float fraction) {
+        const uint32_t target = static_cast<uint32_t>(fraction * total);
+        uint32_t sum = 0;
+        for (int v = 0; v < 256; ++v) {
+            sum += histogram[v];
+            if (sum > target) {
+                return v;
+            }
+        }
+        return 255;
+    };
+
+    const int low = percentile(options_.lowPercentile);
+    const int high = std::max(low + 1, percentile(options_.highPercentile));
+    const float gain = std::min(options_.maxGain, 255.0f / static_cast<float>(high - low));
+    for (int v = 0; v < 256; ++v) {
+        lut_[v] = static_cast<uint8_t>(std::clamp(std::lround((v - low) * gain), 0L, 255L));
+    }
+}
+
+void LumaNormalizer::buildEqualize(const uint32_t* histogram, uint32_t total) {
+    // Clip tall bins and spread the excess evenly, which bounds the slope of
+    // the mapping (and so the noise amplification) in flat regions
+    const uint32_t limit = std::max<uint32_t>(1, static_cast<uint32_t>(options_.clipLimit * total / 256.0f));
+    uint32_t clipped[256];
+    uint32_t excess = 0;
+    for (int v = 0; v < 256; ++v) {
+        clipped[v] = std::min(histogram[v], limit);
+        excess += histogram[v] - clipped[v];
+    }
+    const uint32_t share = excess / 256;
+    const uint32_t remainder = excess % 256;
+
+    uint64_t sum = 0;
+    for (int v = 0; v < 256; ++v) {
+        sum += clipped[v] + share + (static_cast<uint32_t>(v) < remainder ? 1 : 0);
+        lut_[v] = static_cast<uint8_t>(std::min<uint64_t>(255, (sum * 255 + total / 2) / total));
+    }
+}
+
+void LumaNormalizer::apply(uint8_t* samples, size_t count) const {
+    for (size_t i = 0; i < count; ++i) {
+        samples[i] = lut_[samples[i]];
+    }
+}
+
+} // namespace AnonCam
@@ -0,0 +1,83 @@
+#include "MaskStabilizer.h"
+#include "PixelKernels.h"
+#include "Segmentation.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace AnonCam {
+
+MaskStabilizer::MaskStabilizer()
+    : MaskStabilizer(Options()) {}
+
+MaskStabilizer::MaskStabilizer(const Options& options)
+    : options_(options) {
+    // Keep products within 16 bits: |d| * gain <= 255 * 64
+    options_.motionGain = std::clamp(options.motionGain, 0, 64);
+    options_.maxMasksInFlight = std::max<size_t>(2, options.maxMasksInFlight);
+    const float smoothing = std::clamp(options.smoothing, 0.0f, 1.0f);
+    baseWeight_ = std::clamp(static_cast<int>(std::lround((1.0f - smoothing) * 128.0f)), 1, 128);
+}
+
+void MaskStabilizer::reset() {
+    previous_.reset();
+}
+
+bool MaskStabilizer::stabilize(const uint8_t* mask, int width, int height, size_t bytesPerRow,
+                               SegmentationMask& output) {
+    output = SegmentationMask{};
+    if (!mask || width <= 0 || height <= 0) {
+        return false;
+    }
+
+    if (width != width_ || height != height_) {
+        width_ = width;
+        height_ = height;
+        previous_.reset();
+        pool_ = std::make_unique<BufferPool>(static_cast<size_t>(width) * height, options_.maxMasksInFlight);
+    }
+
+    auto buffer = pool_->acquire();
+    if (!buffer) {
+        return false;
+    }
+    ++stats_.frames;
+
+    // Global change decides between filtering and restarting
+    bool passThrough = !previous_;
+    if (previous_) {
+        uint64_t change = 0;
+        for (int y = 0; y < height; ++y) {
+            change += sumAbsDifference(mask + y * bytesPerRow, previous_->data() + static_cast<size_t>(y) * width,
+                                       width);
+        }
+        stats_.lastMeanChange = static_cast<float>(change) / (255.0f * width * height);
+        passThrough = stats_.lastMeanChange > options_.resetThreshold;
+    } else {
+        stats_.lastMeanChange = 0.0f;
+    }
+
+    if (passThrough) {
+        ++stats_.resets;
+        for (int y = 0; y < height; ++y) {
+            std::memcpy(buffer->data() + static_cast<size_t>(y) * width, mask + y * bytesPerRow, width);
+        }
+    } else {
+        for (int y = 0; y < height; ++y) {
+            const size_t row = static_cast<size_t>(y) * width;
+            motionAdaptiveBlend(mask + y * bytesPerRow, previous_->data() + row, baseWeight_, options_.motionGain,
+                                buffer->data() + row, width);
+        }
+    }
+
+    output.data = buffer->data();
+    output.width = width;
+    output.height = height;
+    output.bytesPerRow = static_cast<size_t>(width);
+    output.buffer = buffer;
+    previous_ = std::move(buffer);
+    return true;
+}
+
+} // namespace AnonCam
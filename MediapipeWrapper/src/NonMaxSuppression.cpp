@@ -0,0 +1,326 @@
+#include "NonMaxSuppression.h"
+#include "Simd.h"
+
+#include <algorithm>
+#include <limits>
+
+namespace {
+
+struct Box {
+    float x0, y0, x1, y1, area;
+};
+
+Box boxOf(const AnonCam::Detection& detection) {
+    const float width = std::max(0.0f, detection.width);
+    const float height = std::max(0.0f, detection.height);
+    return {detection.x, detection.y, detection.x + width, detection.y + height, width * height};
+}
+
+// IoU(a, b) > threshold, without the division: intersection > threshold * union
+bool overlaps(const Box& a, float bx0, float by0, float bx1, float by1, float barea, float threshold) {
+    const float w = std::max(0.0f, std::min(a.x1, bx1) - std::max(a.x0, bx0));
+    const float h = std::max(0.0f, std::min(a.y1, by1) - std::max(a.y0, by0));
+    const float intersection = w * h;
+    return intersection > threshold * (a.area + barea - intersection);
+}
+
+// Structure-of-arrays view of a run of boxes
+struct BoxLanes {
+    const float* x0;
+    const float* y0;
+    const float* x1;
+    const float* y1;
+    const float* area;
+};
+
+// Box `a` and the threshold splatted once per sweep rather than per group
+#if ACM_SIMD_SSE2
+struct Splat {
+    __m128 x0, y0, x1, y1, area, threshold;
+};
+
+Splat splat(const Box& a, float threshold) {
+    return {_mm_set1_ps(a.x0), _mm_set1_ps(a.y0), _mm_set1_ps(a.x1),
+            _mm_set1_ps(a.y1), _mm_set1_ps(a.area), _mm_set1_ps(threshold)};
+}
+
+// Lane k of the result is set when `a` overlaps box i + k
+inline int overlapMask4(const Splat& a, const BoxLanes& b, int i) {
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 w = _mm_max_ps(zero, _mm_sub_ps(_mm_min_ps(a.x1, _mm_loadu_ps(b.x1 + i)),
+                                                 _mm_max_ps(a.x0, _mm_loadu_ps(b.x0 + i))));
+    const __m128 h = _mm_max_ps(zero, _mm_sub_ps(_mm_min_ps(a.y1, _mm_loadu_ps(b.y1 + i)),
+                                                 _mm_max_ps(a.y0, _mm_loadu_ps(b.y0 + i))));
+    const __m128 intersection = _mm_mul_ps(w, h);
+    const __m128 unionArea = _mm_sub_ps(_mm_add_ps(a.area, _mm_loadu_ps(b.area + i)), intersection);
+    return _mm_movemask_ps(_mm_cmpgt_ps(intersection, _mm_mul_ps(a.threshold, unionArea)));
+}
+#elif ACM_SIMD_NEON
+struct Splat {
+    float32x4_t x0, y0, x1, y1, area, threshold;
+    uint32x4_t bits;
+};
+
+Splat splat(const Box& a, float threshold) {
+    const uint32_t laneBits[4] = {1, 2, 4, 8};
+    return {vdupq_n_f32(a.x0), vdupq_n_f32(a.y0), vdupq_n_f32(a.x1),      vdupq_n_f32(a.y1),
+            vdupq_n_f32(a.area), vdupq_n_f32(threshold), vld1q_u32(laneBits)};
+}
+
+inline int overlapMask4(const Splat& a, const BoxLanes& b, int i) {
+    const float32x4_t zero = vdupq_n_f32(0.0f);
+    const float32x4_t w = vmaxq_f32(zero, vsubq_f32(vminq_f32(a.x1, vld1q_f32(b.x1 + i)),
+                                                    vmaxq_f32(a.x0, vld1q_f32(b.x0 + i))));
+    const float32x4_t h = vmaxq_f32(zero, vsubq_f32(vminq_f32(a.y1, vld1q_f32(b.y1 + i)),
+                                                    vmaxq_f32(a.y0, vld1q_f32(b.y0 + i))));
+    const float32x4_t intersection = vmulq_f32(w, h);
+    const float32x4_t unionArea = vsubq_f32(vaddq_f32(a.area, vld1q_f32(b.area + i)), intersection);
+    const uint32x4_t over = vcgtq_f32(intersection, vmulq_f32(a.threshold, unionArea));
+    return static_cast<int>(vaddvq_u32(vandq_u32(over, a.bits)));
+}
+#else
+struct Splat {
+    Box box;
+    float threshold;
+};
+
+Splat splat(const Box& a, float threshold) {
+    return {a, threshold};
+}
+
+inline int overlapMask4(const Splat& a, const BoxLanes& b, int i) {
+    int mask = 0;
+    for (int k = 0; k < 4; ++k) {
+        const int j = i + k;
+        mask |= overlaps(a.box, b.x0[j], b.y0[j], b.x1[j], b.y1[j], b.area[j], a.threshold) ? 1 << k : 0;
+    }
+    return mask;
+}
+#endif
+
+// Whether `a` overlaps any of the first `count` boxes; eight per branch
+bool overlapsAny(const Box& a, const BoxLanes& b, int count, float threshold) {
+    const Splat lanes = splat(a, threshold);
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        if ((overlapMask4(lanes, b, i) | overlapMask4(lanes, b, i + 4)) != 0) {
+            return true;
+        }
+    }
+    for (; i < count; ++i) {
+        if (overlaps(a, b.x0[i], b.y0[i], b.x1[i], b.y1[i], b.area[i], threshold)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// masks[g] bit k is set when `a` overlaps box 4 * g + k. Covers `count`
+// rounded up to whole groups; lanes past `count` are garbage.
+void overlapMasks(const Box& a, const BoxLanes& b, int count, float threshold, uint8_t* masks) {
+    const Splat lanes = splat(a, threshold);
+    for (int i = 0; i < count; i += 4) {
+        masks[i / 4] = static_cast<uint8_t>(overlapMask4(lanes, b, i));
+    }
+}
+
+} // anonymous namespace
+
+namespace AnonCam {
+
+NonMaxSuppression::NonMaxSuppression() : NonMaxSuppression(Options()) {}
+
+NonMaxSuppression::NonMaxSuppression(const Options& options) : options_(options) {
+    options_.maxCandidates = std::max(1, options.maxCandidates);
+
+    // Four lanes of padding so the last vector load stays in bounds
+    const size_t slots = static_cast<size_t>(options_.maxCandidates) + 4;
+    for (std::vector<float>* lane : {&x0_, &y0_, &x1_, &y1_, &area_, &score_}) {
+        lane->assign(slots, 0.0f);
+    }
+    index_.assign(slots, 0);
+    masks_.assign(slots / 4, 0);
+    order_.assign(options_.maxCandidates, 0);
+}
+
+int NonMaxSuppression::run(const Detection* candidates, int count, Detection* output, int capacity) {
+    if (candidates == nullptr || output == nullptr || count <= 0 || capacity <= 0) {
+        return 0;
+    }
+    return options_.mode == Mode::Hard ? runHard(candidates, count, output, capacity)
+                                       : runWeighted(candidates, count, output, capacity);
+}
+
+int NonMaxSuppression::load(const Detection* candidates, int count) {
+    // Indices of the candidates above minScore. Past maxCandidates, order_
+    // becomes a min-heap on score so only the best maxCandidates remain.
+    const int limit = options_.maxCandidates;
+    const auto worse = [candidates](int a, int b) { return candidates[a].score > candidates[b].score; };
+    int n = 0;
+    for (int i = 0; i < count; ++i) {
+        if (!(candidates[i].score >= options_.minScore)) {
+            continue;
+        }
+        if (n < limit) {
+            order_[n++] = i;
+            if (n == limit) {
+                std::make_heap(order_.begin(), order_.end(), worse);
+            }
+        } else if (candidates[i].score > candidates[order_.front()].score) {
+            std::pop_heap(order_.begin(), order_.end(), worse);
+            order_.back() = i;
+            std::push_heap(order_.begin(), order_.end(), worse);
+        }
+    }
+    return n;
+}
+
+int NonMaxSuppression::runHard(const Detection* candidates, int count, Detection* output, int capacity) {
+    const int n = load(candidates, count);
+    const float threshold = options_.iouThreshold;
+    const auto better = [candidates](int a, int b) {
+        return candidates[a].score > candidates[b].score || (candidates[a].score == candidates[b].score && a < b);
+    };
+
+    // Kept boxes go to the front of the structure-of-arrays lanes
+    float* x0 = x0_.data();
+    float* y0 = y0_.data();
+    float* x1 = x1_.data();
+    float* y1 = y1_.data();
+    float* area = area_.data();
+
+    int kept = 0;
+    int sorted = 0;
+    for (int position = 0; position < n && kept < capacity; ++position) {
+        // Extend the sorted prefix only when the walk reaches its end: a few
+        // faces in hundreds of candidates never pays for a full sort. Select
+        // then sort; std::partial_sort is a heap sort and several times slower.
+        if (position == sorted) {
+            const auto first = order_.begin() + sorted;
+            const auto middle = order_.begin() + std::min(n, sorted + std::max(16, sorted));
+            std::nth_element(first, middle, order_.begin() + n, better);
+            std::sort(first, middle, better);
+            sorted = static_cast<int>(middle - order_.begin());
+        }
+
+        const Detection& candidate = candidates[order_[position]];
+        const Box box = boxOf(candidate);
+        if (overlapsAny(box, {x0, y0, x1, y1, area}, kept, threshold)) {
+            continue;
+        }
+
+        x0[kept] = box.x0;
+        y0[kept] = box.y0;
+        x1[kept] = box.x1;
+        y1[kept] = box.y1;
+        area[kept] = box.area;
+        output[kept++] = candidate;
+    }
+    return kept;
+}
+
+int NonMaxSuppression::runWeighted(const Detection* candidates, int count, Detection* output, int capacity) {
+    int n = load(candidates, count);
+    const float threshold = options_.iouThreshold;
+
+    float* x0 = x0_.data();
+    float* y0 = y0_.data();
+    float* x1 = x1_.data();
+    float* y1 = y1_.data();
+    float* area = area_.data();
+    float* score = score_.data();
+    int* index = index_.data();
+    uint8_t* masks = masks_.data();
+
+    int best = -1;
+    for (int i = 0; i < n; ++i) {
+        const int source = order_[i];
+        const Box box = boxOf(candidates[source]);
+        x0[i] = box.x0;
+        y0[i] = box.y0;
+        x1[i] = box.x1;
+        y1[i] = box.y1;
+        area[i] = box.area;
+        score[i] = candidates[source].score;
+        index[i] = source;
+        if (best < 0 || score[i] > score[best] || (score[i] == score[best] && source < index[best])) {
+            best = i;
+        }
+    }
+
+    int written = 0;
+    while (n > 0 && written < capacity) {
+        const Detection& top = candidates[index[best]];
+        const Box topBox{x0[best], y0[best], x1[best], y1[best], area[best]};
+        const int keypoints = std::clamp(top.keypointCount, 0, Detection::kMaxKeypoints);
+
+        float weight = 0.0f;
+        float sumX0 = 0.0f;
+        float sumY0 = 0.0f;
+        float sumX1 = 0.0f;
+        float sumY1 = 0.0f;
+        float sumKeypoints[Detection::kMaxKeypoints][2] = {};
+
+        // One sweep: members of the top candidate's cluster are accumulated,
+        // everything else is compacted to the front in its original order
+        // while tracking the next best score
+        overlapMasks(topBox, {x0, y0, x1, y1, area}, n, threshold, masks);
+        masks[best / 4] |= 1 << (best % 4);   // A degenerate (zero-area) top still absorbs itself
+
+        int remaining = 0;
+        int nextBest = -1;
+        for (int i = 0; i < n; i += 4) {
+            const int lanes = std::min(4, n - i);
+            const int mask = masks[i / 4];
+            for (int k = 0; k < lanes; ++k) {
+                const int j = i + k;
+                if ((mask >> k) & 1) {
+                    const float w = score[j];
+                    weight += w;
+                    sumX0 += x0[j] * w;
+                    sumY0 += y0[j] * w;
+                    sumX1 += x1[j] * w;
+                    sumY1 += y1[j] * w;
+                    const Detection& member = candidates[index[j]];
+                    for (int p = 0; p < keypoints; ++p) {
+                        sumKeypoints[p][0] += member.keypoints[p][0] * w;
+                        sumKeypoints[p][1] += member.keypoints[p][1] * w;
+                    }
+                    continue;
+                }
+                x0[remaining] = x0[j];
+                y0[remaining] = y0[j];
+                x1[remaining] = x1[j];
+                y1[remaining] = y1[j];
+                area[remaining] = area[j];
+                score[remaining] = score[j];
+                index[remaining] = index[j];
+                if (nextBest < 0 || score[remaining] > score[nextBest] ||
+                    (score[remaining] == score[nextBest] && index[remaining] < index[nextBest])) {
+                    nextBest = remaining;
+                }
+                ++remaining;
+            }
+        }
+
+        Detection& out = output[written++];
+        out = top;
+        if (weight > 0.0f) {
+            const float inverse = 1.0f / weight;
+            out.x = sumX0 * inverse;
+            out.y = sumY0 * inverse;
+            out.width = (sumX1 - sumX0) * inverse;
+            out.height = (sumY1 - sumY0) * inverse;
+            for (int p = 0; p < keypoints; ++p) {
+                out.keypoints[p][0] = sumKeypoints[p][0] * inverse;
+                out.keypoints[p][1] = sumKeypoints[p][1] * inverse;
+            }
+        }
+
+        n = remaining;
+        best = nextBest;
+    }
+    return written;
+}
+
+} // namespace AnonCam
@@ -0,0 +1,108 @@
+#include "ParameterStore.h"
+
+#include <algorithm>
+#include <limits>
+#include <thread>
+
+namespace {
+
+// First slot a thread tries: threads spread over the slots, and a thread
+// that reads every frame keeps finding its own slot free
+int slotHint() {
+    static std::atomic<int> nextHint{0};
+    thread_local const int hint = nextHint.fetch_add(1, std::memory_order_relaxed);
+    return hint;
+}
+
+} // anonymous namespace
+
+namespace AnonCam {
+
+ParameterStore::ReadGuard::ReadGuard(ReadGuard&& other) noexcept
+    : slot_(other.slot_), snapshot_(other.snapshot_) {
+    other.slot_ = nullptr;
+}
+
+ParameterStore::ReadGuard::~ReadGuard() {
+    if (slot_) {
+        slot_->store(0, std::memory_order_release);
+    }
+}
+
+ParameterStore::ParameterStore()
+    : ParameterStore(RenderParameters()) {}
+
+ParameterStore::ParameterStore(const RenderParameters& initial)
+    : current_(new Snapshot{initial, 1}) {}
+
+ParameterStore::~ParameterStore() {
+    delete current_.load(std::memory_order_acquire);
+}
+
+ParameterStore::ReadGuard ParameterStore::read() const {
+    // The epoch is announced before the pointer is loaded (both sequentially
+    // consistent): a snapshot replaced in an earlier epoch was already
+    // replaced when the load happens, so it cannot be the one returned
+    const uint64_t epoch = epoch_.load(std::memory_order_seq_cst);
+    const int first = slotHint();
+    for (;;) {
+        for (int i = 0; i < kReaderSlots; ++i) {
+            std::atomic<uint64_t>& slot = readers_[(first + i) % kReaderSlots].epoch;
+            uint64_t expected = 0;
+            if (slot.compare_exchange_strong(expected, epoch, std::memory_order_seq_cst)) {
+                return ReadGuard(&slot, current_.load(std::memory_order_seq_cst));
+            }
+        }
+        std::this_thread::yield();
+    }
+}
+
+RenderParameters ParameterStore::load(uint64_t* version) const {
+    const ReadGuard guard = read();
+    if (version) {
+        *version = guard.version();
+    }
+    return *guard;
+}
+
+uint64_t ParameterStore::version() const {
+    return read().version();
+}
+
+uint64_t ParameterStore::publish(const RenderParameters& parameters) {
+    std::lock_guard<std::mutex> lock(writerMutex_);
+    return publishLocked(parameters);
+}
+
+uint64_t ParameterStore::publishLocked(const RenderParameters& parameters) {
+    const Snapshot* previous = current_.load(std::memory_order_relaxed);
+    const uint64_t version = previous->version + 1;
+    previous = current_.exchange(new Snapshot{parameters, version}, std::memory_order_seq_cst);
+    retired_.push_back({std::unique_ptr<const Snapshot>(previous), epoch_.fetch_add(1, std::memory_order_seq_cst)});
+    ++stats_.published;
+    reclaimLocked();
+    return version;
+}
+
+void ParameterStore::reclaimLocked() {
+    // Reads that started in or before a snapshot's epoch may still hold it
+    uint64_t oldest = std::numeric_limits<uint64_t>::max();
+    for (const ReaderSlot& reader : readers_) {
+        const uint64_t epoch = reader.epoch.load(std::memory_order_seq_cst);
+        if (epoch != 0) {
+            oldest = std::min(oldest, epoch);
+        }
+    }
+    const auto held = std::partition(retired_.begin(), retired_.end(),
+                                     [oldest](const Retired& retired) { return retired.epoch >= oldest; });
+    stats_.reclaimed += static_cast<uint64_t>(retired_.end() - held);
+    retired_.erase(held, retired_.end());
+    stats_.pending = retired_.size();
+}
+
+ParameterStore::Stats ParameterStore::stats() const {
+    std::lock_guard<std::mutex> lock(writerMutex_);
+    return stats_;
+}
+
+} // namespace AnonCam
@@ -0,0 +1,82 @@
+#include "PixelKernels.h"
+#include "Simd.h"
+
+#include <algorithm>
+#include <cstdlib>
+
+namespace AnonCam {
+
+uint64_t sumAbsDifference(const uint8_t* a, const uint8_t* b, int width) {
+    uint64_t total = 0;
+    int x = 0;
+
+#if ACM_SIMD_SSE2
+    __m128i sum = _mm_setzero_si128();
+    for (; x + 16 <= width; x += 16) {
+        sum = _mm_add_epi64(sum, _mm_sad_epu8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(a + x)),
+                                              _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + x))));
+    }
+    total = static_cast<uint64_t>(_mm_cvtsi128_si32(sum)) +
+            static_cast<uint64_t>(_mm_cvtsi128_si32(_mm_unpackhi_epi64(sum, sum)));
+#elif ACM_SIMD_NEON
+    uint32x4_t sum = vdupq_n_u32(0);
+    for (; x + 16 <= width; x += 16) {
+        sum = vpadalq_u16(sum, vpaddlq_u8(vabdq_u8(vld1q_u8(a + x), vld1q_u8(b + x))));
+    }
+    total = vaddvq_u32(sum);
+#endif
+
+    for (; x < width; ++x) {
+        total += static_cast<uint64_t>(std::abs(a[x] - b[x]));
+    }
+    return total;
+}
+
+void motionAdaptiveBlend(const uint8_t* current, const uint8_t* previous, int base, int gain, uint8_t* out,
+                         int width) {
+    int x = 0;
+
+#if ACM_SIMD_SSE2
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i vBase = _mm_set1_epi16(static_cast<short>(base));
+    const __m128i vGain = _mm_set1_epi16(static_cast<short>(gain));
+    const __m128i vMax = _mm_set1_epi16(128);
+    const __m128i round = _mm_set1_epi16(64);
+    auto blend = [&](__m128i cur, __m128i prev) {
+        const __m128i d = _mm_sub_epi16(cur, prev);
+        const __m128i ad = _mm_max_epi16(d, _mm_sub_epi16(zero, d));
+        const __m128i w = _mm_min_epi16(_mm_add_epi16(vBase, _mm_mullo_epi16(ad, vGain)), vMax);
+        return _mm_add_epi16(prev, _mm_srai_epi16(_mm_add_epi16(_mm_mullo_epi16(d, w), round), 7));
+    };
+    for (; x + 16 <= width; x += 16) {
+        const __m128i cur = _mm_loadu_si128(reinterpret_cast<const __m128i*>(current + x));
+        const __m128i prev = _mm_loadu_si128(reinterpret_cast<const __m128i*>(previous + x));
+        const __m128i lo = blend(_mm_unpacklo_epi8(cur, zero), _mm_unpacklo_epi8(prev, zero));
+        const __m128i hi = blend(_mm_unpackhi_epi8(cur, zero), _mm_unpackhi_epi8(prev, zero));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + x), _mm_packus_epi16(lo, hi));
+    }
+#elif ACM_SIMD_NEON
+    const int16x8_t vBase = vdupq_n_s16(static_cast<int16_t>(base));
+    const int16x8_t vMax = vdupq_n_s16(128);
+    auto blend = [&](uint8x8_t cur, uint8x8_t prev) {
+        const int16x8_t d = vreinterpretq_s16_u16(vsubl_u8(cur, prev));
+        const int16x8_t w = vminq_s16(vmlaq_n_s16(vBase, vabsq_s16(d), static_cast<int16_t>(gain)), vMax);
+        const int16x8_t p = vreinterpretq_s16_u16(vmovl_u8(prev));
+        return vqmovun_s16(vaddq_s16(p, vrshrq_n_s16(vmulq_s16(d, w), 7)));
+    };
+    for (; x + 16 <= width; x += 16) {
+        const uint8x16_t cur = vld1q_u8(current + x);
+        const uint8x16_t prev = vld1q_u8(previous + x);
+        vst1q_u8(out + x, vcombine_u8(blend(vget_low_u8(cur), vget_low_u8(prev)),
+                                      blend(vget_high_u8(cur), vget_high_u8(prev))));
+    }
+#endif
+
+    for (; x < width; ++x) {
+        const int d = current[x] - previous[x];
+        const int w = std::min(128, base + std::abs(d) * gain);
+        out[x] = static_cast<uint8_t>(previous[x] + ((d * w + 64) >> 7));
+    }
+}
+
+} // namespace AnonCam
@@ -0,0 +1,22 @@
+#ifndef AnonCam_PixelKernels_h
+#define AnonCam_PixelKernels_h
+
+// Private helper: 8-bit row kernels shared by the temporal filters
+// (MaskStabilizer, TemporalDenoiser).
+
+#include <cstdint>
+
+namespace AnonCam {
+
+// Sum of |a - b| over a row
+uint64_t sumAbsDifference(const uint8_t* a, const uint8_t* b, int width);
+
+// Motion-adaptive recursive blend of a row:
+//   out = prev + ((cur - prev) * w + 64) >> 7,  w = min(128, base + |cur - prev| * gain)
+// base and gain are weights of 128; |d| * gain must fit in 16 bits (gain <= 64).
+void motionAdaptiveBlend(const uint8_t* current, const uint8_t* previous, int base, int gain, uint8_t* out,
+                         int width);
+
+} // namespace AnonCam
+
+#endif /* AnonCam_PixelKernels_h */
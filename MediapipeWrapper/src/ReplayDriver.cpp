@@ -0,0 +1,93 @@
+#include "ReplayDriver.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <thread>
+
+namespace AnonCam {
+
+namespace {
+
+float maxLandmarkDifference(const std::vector<Landmark>& a, const std::vector<Landmark>& b) {
+    if (a.size() != b.size()) {
+        return INFINITY;
+    }
+
+    float maxError = 0.0f;
+    for (size_t i = 0; i < a.size(); ++i) {
+        maxError = std::max(maxError, std::fabs(a[i].x - b[i].x));
+        maxError = std::max(maxError, std::fabs(a[i].y - b[i].y));
+        maxError = std::max(maxError, std::fabs(a[i].z - b[i].z));
+    }
+    return maxError;
+}
+
+} // anonymous namespace
+
+ReplayDriver::Report ReplayDriver::run(const Options& options, const FrameCallback& callback) {
+    using Clock = std::chrono::steady_clock;
+
+    Report report;
+    tracker_.reset();
+
+    CaptureRecord record;
+    std::vector<Landmark> widened;
+    const Clock::time_point wallStart = Clock::now();
+    int64_t firstTimestampNs = 0;
+    bool started = false;
+
+    for (size_t i = 0; i < reader_.recordCount(); ++i) {
+        if (!reader_.read(i, record)) {
+            break;
+        }
+        if (!record.frame.isValid()) {
+            ++report.framesSkipped;
+            continue;
+        }
+
+        if (!started) {
+            firstTimestampNs = record.timestampNs;
+            started = true;
+        }
+        if (options.pacing == Pacing::Recorded) {
+            std::this_thread::sleep_until(wallStart + std::chrono::nanoseconds(record.timestampNs - firstTimestampNs));
+        }
+
+        const Clock::time_point begin = Clock::now();
+        FaceResult replayed = tracker_.processFrame(record.frame, record.timestampNs);
+        const uint64_t elapsedNs = static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - begin).count());
+
+        report.totalProcessNs += elapsedNs;
+        report.maxProcessNs = std::max(report.maxProcessNs, elapsedNs);
+        ++report.framesReplayed;
+
+        if (options.compareResults) {
+            float error = 0.0f;
+            if (replayed.hasFace && record.result.hasFace) {
+                const std::vector<Landmark>* landmarks = &replayed.landmarks;
+                if (landmarks->empty() && !replayed.landmarksHalf.empty()) {
+                    widened.resize(replayed.landmarksHalf.size());
+                    convertLandmarksFromHalf(replayed.landmarksHalf.data(), widened.size(), widened.data());
+                    landmarks = &widened;
+                }
+                error = maxLandmarkDifference(*landmarks, record.result.landmarks);
+                if (std::isfinite(error)) {
+                    report.maxLandmarkError = std::max(report.maxLandmarkError, error);
+                }
+            }
+            if (replayed.hasFace != record.result.hasFace || !(error <= options.landmarkTolerance)) {
+                ++report.mismatches;
+            }
+        }
+
+        if (callback) {
+            callback(i, record, replayed);
+        }
+    }
+
+    return report;
+}
+
+} // namespace AnonCam
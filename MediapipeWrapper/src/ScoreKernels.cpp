@@ -0,0 +1,84 @@
+#include "ScoreKernels.h"
+#include "Simd.h"
+
+#include <cmath>
+
+namespace {
+
+// exp() range reduction and polynomial (Cephes expf), |relative error| < 2e-7
+constexpr float kExpMax = 88.3762626647949f;
+constexpr float kLog2e = 1.44269504088896341f;
+constexpr float kLn2High = 0.693359375f;
+constexpr float kLn2Low = -2.12194440e-4f;
+constexpr float kExpP0 = 1.9875691500e-4f;
+constexpr float kExpP1 = 1.3981999507e-3f;
+constexpr float kExpP2 = 8.3334519073e-3f;
+constexpr float kExpP3 = 4.1665795894e-2f;
+constexpr float kExpP4 = 1.6666665459e-1f;
+constexpr float kExpP5 = 5.0000001201e-1f;
+
+#if ACM_SIMD_SSE2
+__m128 sigmoid4(__m128 x) {
+    // exp(-x), with -x clamped so 2^n stays a normal float
+    const __m128 t = _mm_max_ps(_mm_min_ps(_mm_sub_ps(_mm_setzero_ps(), x), _mm_set1_ps(kExpMax)),
+                                _mm_set1_ps(-kExpMax));
+    __m128 fx = _mm_add_ps(_mm_mul_ps(t, _mm_set1_ps(kLog2e)), _mm_set1_ps(0.5f));
+    // floor(fx): truncate, then step down where truncation rounded up
+    __m128 n = _mm_cvtepi32_ps(_mm_cvttps_epi32(fx));
+    n = _mm_sub_ps(n, _mm_and_ps(_mm_cmpgt_ps(n, fx), _mm_set1_ps(1.0f)));
+
+    const __m128 r = _mm_sub_ps(_mm_sub_ps(t, _mm_mul_ps(n, _mm_set1_ps(kLn2High))),
+                                _mm_mul_ps(n, _mm_set1_ps(kLn2Low)));
+    __m128 y = _mm_set1_ps(kExpP0);
+    y = _mm_add_ps(_mm_mul_ps(y, r), _mm_set1_ps(kExpP1));
+    y = _mm_add_ps(_mm_mul_ps(y, r), _mm_set1_ps(kExpP2));
+    y = _mm_add_ps(_mm_mul_ps(y, r), _mm_set1_ps(kExpP3));
+    y = _mm_add_ps(_mm_mul_ps(y, r), _mm_set1_ps(kExpP4));
+    y = _mm_add_ps(_mm_mul_ps(y, r), _mm_set1_ps(kExpP5));
+    y = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_mul_ps(y, r), r), r), _mm_set1_ps(1.0f));
+
+    const __m128i exponent = _mm_slli_epi32(_mm_add_epi32(_mm_cvttps_epi32(n), _mm_set1_epi32(127)), 23);
+    const __m128 e = _mm_mul_ps(y, _mm_castsi128_ps(exponent));
+    return _mm_div_ps(_mm_set1_ps(1.0f), _mm_add_ps(_mm_set1_ps(1.0f), e));
+}
+#elif ACM_SIMD_NEON
+float32x4_t sigmoid4(float32x4_t x) {
+    const float32x4_t t = vmaxq_f32(vminq_f32(vnegq_f32(x), vdupq_n_f32(kExpMax)), vdupq_n_f32(-kExpMax));
+    const float32x4_t n = vrndmq_f32(vmlaq_n_f32(vdupq_n_f32(0.5f), t, kLog2e));
+
+    const float32x4_t r = vmlsq_n_f32(vmlsq_n_f32(t, n, kLn2High), n, kLn2Low);
+    float32x4_t y = vdupq_n_f32(kExpP0);
+    y = vmlaq_f32(vdupq_n_f32(kExpP1), y, r);
+    y = vmlaq_f32(vdupq_n_f32(kExpP2), y, r);
+    y = vmlaq_f32(vdupq_n_f32(kExpP3), y, r);
+    y = vmlaq_f32(vdupq_n_f32(kExpP4), y, r);
+    y = vmlaq_f32(vdupq_n_f32(kExpP5), y, r);
+    y = vaddq_f32(vmlaq_f32(r, vmulq_f32(y, r), r), vdupq_n_f32(1.0f));
+
+    const int32x4_t exponent = vshlq_n_s32(vaddq_s32(vcvtq_s32_f32(n), vdupq_n_s32(127)), 23);
+    const float32x4_t e = vmulq_f32(y, vreinterpretq_f32_s32(exponent));
+    return vdivq_f32(vdupq_n_f32(1.0f), vaddq_f32(vdupq_n_f32(1.0f), e));
+}
+#endif
+
+} // anonymous namespace
+
+namespace AnonCam {
+
+void sigmoidInPlace(float* values, int count) {
+    int i = 0;
+#if ACM_SIMD_SSE2
+    for (; i + 4 <= count; i += 4) {
+        _mm_storeu_ps(values + i, sigmoid4(_mm_loadu_ps(values + i)));
+    }
+#elif ACM_SIMD_NEON
+    for (; i + 4 <= count; i += 4) {
+        vst1q_f32(values + i, sigmoid4(vld1q_f32(values + i)));
+    }
+#endif
+    for (; i < count; ++i) {
+        values[i] = 1.0f / (1.0f + std::exp(-values[i]));
+    }
+}
+
+} // namespace AnonCam
@@ -0,0 +1,14 @@
+#ifndef AnonCam_ScoreKernels_h
+#define AnonCam_ScoreKernels_h
+
+// Private helper: score kernels shared by the SSD post-processing
+// (SsdDecoder, DetectionPipeline).
+
+namespace AnonCam {
+
+// values[i] = 1 / (1 + exp(-values[i])), four at a time where SIMD is available
+void sigmoidInPlace(float* values, int count);
+
+} // namespace AnonCam
+
+#endif /* AnonCam_ScoreKernels_h */
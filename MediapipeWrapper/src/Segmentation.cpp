@@ -0,0 +1,303 @@
+#include "Segmentation.h"
+#include "FaceTracker.h"
+#include "Simd.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace {
+
+constexpr int kSubsamples = 4;  // Vertical samples per mask row for anti-aliasing
+
+// Blend two rows: (a * (256 - w) + b * w + 128) >> 8, w in [0, 256]
+void blendRows(const uint8_t* a, const uint8_t* b, int w, uint8_t* dst, int width) {
+    int x = 0;
+
+#if ACM_SIMD_SSE2
+    const __m128i wa = _mm_set1_epi16(static_cast<short>(256 - w));
+    const __m128i wb = _mm_set1_epi16(static_cast<short>(w));
+    const __m128i round = _mm_set1_epi16(128);
+    const __m128i zero = _mm_setzero_si128();
+    for (; x + 16 <= width; x += 16) {
+        const __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + x));
+        const __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + x));
+        const __m128i lo = _mm_srli_epi16(
+            _mm_add_epi16(_mm_add_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(va, zero), wa),
+                                        _mm_mullo_epi16(_mm_unpacklo_epi8(vb, zero), wb)), round), 8);
+        const __m128i hi = _mm_srli_epi16(
+            _mm_add_epi16(_mm_add_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(va, zero), wa),
+                                        _mm_mullo_epi16(_mm_unpackhi_epi8(vb, zero), wb)), round), 8);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + x), _mm_packus_epi16(lo, hi));
+    }
+#elif ACM_SIMD_NEON
+    const uint16_t wa = static_cast<uint16_t>(256 - w);
+    const uint16_t wb = static_cast<uint16_t>(w);
+    for (; x + 16 <= width; x += 16) {
+        const uint8x16_t va = vld1q_u8(a + x);
+        const uint8x16_t vb = vld1q_u8(b + x);
+        const uint16x8_t lo = vmlaq_n_u16(vmulq_n_u16(vmovl_u8(vget_low_u8(va)), wa),
+                                          vmovl_u8(vget_low_u8(vb)), wb);
+        const uint16x8_t hi = vmlaq_n_u16(vmulq_n_u16(vmovl_u8(vget_high_u8(va)), wa),
+                                          vmovl_u8(vget_high_u8(vb)), wb);
+        vst1q_u8(dst + x, vcombine_u8(vrshrn_n_u16(lo, 8), vrshrn_n_u16(hi, 8)));
+    }
+#endif
+
+    for (; x < width; ++x) {
+        dst[x] = static_cast<uint8_t>((a[x] * (256 - w) + b[x] * w + 128) >> 8);
+    }
+}
+
+inline float cross(const float* o, const float* a, const float* b) {
+    return (a[0] - o[0]) * (b[1] - o[1]) - (a[1] - o[1]) * (b[0] - o[0]);
+}
+
+} // anonymous namespace
+
+namespace AnonCam {
+
+// ============================================================================
+// BilinearUpsampler
+// ============================================================================
+
+void BilinearUpsampler::prepare(int srcWidth, int srcHeight, int dstWidth, int dstHeight) {
+    if (srcWidth == srcWidth_ && srcHeight == srcHeight_ && dstWidth == dstWidth_ && dstHeight == dstHeight_) {
+        cachedRow_[0] = cachedRow_[1] = -1;
+        return;
+    }
+
+    srcWidth_ = srcWidth;
+    srcHeight_ = srcHeight;
+    dstWidth_ = dstWidth;
+    dstHeight_ = dstHeight;
+
+    // Pixel centers are aligned: sx = (x + 0.5) * srcWidth / dstWidth - 0.5
+    xIndex_.resize(dstWidth);
+    xWeight_.resize(dstWidth);
+    const float scale = static_cast<float>(srcWidth) / dstWidth;
+    for (int x = 0; x < dstWidth; ++x) {
+        const float sx = std::max(0.0f, (x + 0.5f) * scale - 0.5f);
+        const int x0 = std::min(static_cast<int>(sx), srcWidth - 1);
+        xIndex_[x] = x0;
+        xWeight_[x] = x0 + 1 < srcWidth ? static_cast<uint16_t>((sx - x0) * 256.0f + 0.5f) : 0;
+    }
+
+    rows_[0].resize(dstWidth);
+    rows_[1].resize(dstWidth);
+    cachedRow_[0] = cachedRow_[1] = -1;
+}
+
+const uint8_t* BilinearUpsampler::expandedRow(const uint8_t* src, size_t srcStride, int row) {
+    for (int slot = 0; slot < 2; ++slot) {
+        if (cachedRow_[slot] == row) {
+            return rows_[slot].data();
+        }
+    }
+
+    // Rows are requested in increasing order, so evict the older one
+    const int slot = cachedRow_[0] < cachedRow_[1] ? 0 : 1;
+    const uint8_t* in = src + static_cast<size_t>(row) * srcStride;
+    uint8_t* out = rows_[slot].data();
+    const int last = srcWidth_ - 1;
+    for (int x = 0; x < dstWidth_; ++x) {
+        const int x0 = xIndex_[x];
+        const int w = xWeight_[x];
+        out[x] = static_cast<uint8_t>((in[x0] * (256 - w) + in[std::min(x0 + 1, last)] * w + 128) >> 8);
+    }
+    cachedRow_[slot] = row;
+    return out;
+}
+
+void BilinearUpsampler::run(const uint8_t* src, int srcWidth, int srcHeight, size_t srcStride,
+                            uint8_t* dst, int dstWidth, int dstHeight, size_t dstStride) {
+    if (srcWidth <= 0 || srcHeight <= 0 || dstWidth <= 0 || dstHeight <= 0) {
+        return;
+    }
+    prepare(srcWidth, srcHeight, dstWidth, dstHeight);
+
+    const float scale = static_cast<float>(srcHeight) / dstHeight;
+    for (int y = 0; y < dstHeight; ++y) {
+        const float sy = std::max(0.0f, (y + 0.5f) * scale - 0.5f);
+        const int y0 = std::min(static_cast<int>(sy), srcHeight - 1);
+        const int y1 = std::min(y0 + 1, srcHeight - 1);
+        const int w = y1 != y0 ? static_cast<int>((sy - y0) * 256.0f + 0.5f) : 0;
+
+        uint8_t* out = dst + static_cast<size_t>(y) * dstStride;
+        const uint8_t* top = expandedRow(src, srcStride, y0);
+        if (w == 0) {
+            std::memcpy(out, top, dstWidth);
+        } else {
+            const uint8_t* bottom = expandedRow(src, srcStride, y1);
+            blendRows(top, bottom, w, out, dstWidth);
+        }
+    }
+}
+
+// ============================================================================
+// FaceSegmenter
+// ============================================================================
+
+FaceSegmenter::FaceSegmenter()
+    : FaceSegmenter(Options()) {}
+
+FaceSegmenter::FaceSegmenter(const Options& options)
+    : options_(options), refiner_(options.refinement), stabilizer_(options.stabilization) {
+    options_.lowResDivisor = std::max(1, options.lowResDivisor);
+}
+
+void FaceSegmenter::rasterizeHull(const Landmark* landmarks, size_t count) {
+    const int width = lowResWidth_;
+    const int height = lowResHeight_;
+    std::fill(lowRes_.begin(), lowRes_.end(), 0);
+    if (count < 3) {
+        return;
+    }
+
+    points_.resize(count * 2);
+    order_.resize(count);
+    for (size_t i = 0; i < count; ++i) {
+        points_[i * 2] = landmarks[i].x * width;
+        points_[i * 2 + 1] = landmarks[i].y * height;
+        order_[i] = static_cast<int>(i);
+    }
+
+    // Andrew's monotone chain, counter-clockwise
+    std::sort(order_.begin(), order_.end(), [this](int a, int b) {
+        const float* pa = &points_[a * 2];
+        const float* pb = &points_[b * 2];
+        return pa[0] < pb[0] || (pa[0] == pb[0] && pa[1] < pb[1]);
+    });
+
+    hull_.resize(count * 2);
+    size_t k = 0;
+    for (size_t i = 0; i < count; ++i) {
+        while (k >= 2 && cross(&points_[hull_[k - 2] * 2], &points_[hull_[k - 1] * 2], &points_[order_[i] * 2]) <= 0) {
+            --k;
+        }
+        hull_[k++] = order_[i];
+    }
+    for (size_t i = count - 1, lower = k + 1; i-- > 0;) {
+        while (k >= lower && cross(&points_[hull_[k - 2] * 2], &points_[hull_[k - 1] * 2], &points_[order_[i] * 2]) <= 0) {
+            --k;
+        }
+        hull_[k++] = order_[i];
+    }
+    const size_t hullSize = k - 1;  // Last point repeats the first
+    if (hullSize < 3) {
+        return;
+    }
+
+    float minY = INFINITY;
+    float maxY = -INFINITY;
+    for (size_t i = 0; i < hullSize; ++i) {
+        minY = std::min(minY, points_[hull_[i] * 2 + 1]);
+        maxY = std::max(maxY, points_[hull_[i] * 2 + 1]);
+    }
+    const int rowBegin = std::max(0, static_cast<int>(std::floor(minY)));
+    const int rowEnd = std::min(height, static_cast<int>(std::ceil(maxY)));
+
+    coverage_.resize(width);
+    for (int y = rowBegin; y < rowEnd; ++y) {
+        std::fill(coverage_.begin(), coverage_.end(), 0.0f);
+
+        for (int s = 0; s < kSubsamples; ++s) {
+            const float sy = y + (s + 0.5f) / kSubsamples;
+
+            // A convex polygon crosses each scanline in a single span
+            float left = INFINITY;
+            float right = -INFINITY;
+            for (size_t i = 0; i < hullSize; ++i) {
+                const float* a = &points_[hull_[i] * 2];
+                const float* b = &points_[hull_[(i + 1) % hullSize] * 2];
+                if ((a[1] <= sy && sy < b[1]) || (b[1] <= sy && sy < a[1])) {
+                    const float x = a[0] + (sy - a[1]) * (b[0] - a[0]) / (b[1] - a[1]);
+                    left = std::min(left, x);
+                    right = std::max(right, x);
+                }
+            }
+
+            left = std::max(left, 0.0f);
+            right = std::min(right, static_cast<float>(width));
+            if (!(left < right)) {
+                continue;
+            }
+
+            const int first = static_cast<int>(left);
+            const int last = std::min(static_cast<int>(right), width - 1);
+            if (first == last) {
+                coverage_[first] += right - left;
+                continue;
+            }
+            coverage_[first] += first + 1 - left;
+            for (int x = first + 1; x < last; ++x) {
+                coverage_[x] += 1.0f;
+            }
+            coverage_[last] += right - last;
+        }
+
+        uint8_t* out = lowRes_.data() + static_cast<size_t>(y) * width;
+        for (int x = 0; x < width; ++x) {
+            out[x] = static_cast<uint8_t>(std::min(255.0f, coverage_[x] * (255.0f / kSubsamples) + 0.5f));
+        }
+    }
+}
+
+bool FaceSegmenter::segment(const Landmark* landmarks, size_t count, int frameWidth, int frameHeight,
+                            SegmentationMask& mask) {
+    return segment(landmarks, count, frameWidth, frameHeight, nullptr, mask);
+}
+
+bool FaceSegmenter::segment(const Landmark* landmarks, size_t count, const ImageView& frame,
+                            SegmentationMask& mask) {
+    const bool refine = options_.refineEdges && frame.isValid() && frame.hasLumaPlane();
+    return segment(landmarks, count, frame.width, frame.height, refine ? &frame : nullptr, mask);
+}
+
+bool FaceSegmenter::segment(const Landmark* landmarks, size_t count, int frameWidth, int frameHeight,
+                            const ImageView* guide, SegmentationMask& mask) {
+    mask = SegmentationMask{};
+    if (frameWidth <= 0 || frameHeight <= 0) {
+        return false;
+    }
+
+    if (frameWidth != frameWidth_ || frameHeight != frameHeight_) {
+        // Masks still held by consumers keep the old pool's buffers alive
+        frameWidth_ = frameWidth;
+        frameHeight_ = frameHeight;
+        lowResWidth_ = std::max(1, frameWidth / options_.lowResDivisor);
+        lowResHeight_ = std::max(1, frameHeight / options_.lowResDivisor);
+        lowRes_.resize(static_cast<size_t>(lowResWidth_) * lowResHeight_);
+        pool_ = std::make_unique<BufferPool>(static_cast<size_t>(frameWidth) * frameHeight,
+                                             options_.maxMasksInFlight);
+    }
+
+    auto buffer = pool_->acquire();
+    if (!buffer) {
+        return false;
+    }
+
+    rasterizeHull(landmarks, count);
+
+    const uint8_t* lowRes = lowRes_.data();
+    SegmentationMask stable;
+    if (options_.temporalStabilization &&
+        stabilizer_.stabilize(lowRes_.data(), lowResWidth_, lowResHeight_, lowResWidth_, stable)) {
+        lowRes = stable.data;
+    }
+
+    if (!guide || !refiner_.refine(*guide, lowRes, lowResWidth_, lowResHeight_, lowResWidth_,
+                                   buffer->data(), frameWidth)) {
+        upsampler_.run(lowRes, lowResWidth_, lowResHeight_, lowResWidth_,
+                       buffer->data(), frameWidth, frameHeight, frameWidth);
+    }
+
+    mask.data = buffer->data();
+    mask.width = frameWidth;
+    mask.height = frameHeight;
+    mask.bytesPerRow = static_cast<size_t>(frameWidth);
+    mask.buffer = std::move(buffer);
+    return true;
+}
+
+} // namespace AnonCam
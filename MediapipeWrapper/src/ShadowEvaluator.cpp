@@ -0,0 +1,237 @@
+#include "ShadowEvaluator.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <pthread.h>
+#include <sys/resource.h>
+
+namespace {
+
+// Outer eye corners (Face Mesh v478), for the inter-ocular normalization
+constexpr int kLeftEyeOuter = 33;
+constexpr int kRightEyeOuter = 263;
+constexpr double kRadToDeg = 57.29577951308232;
+
+AnonCam::FaceTracker::Config candidateConfig(AnonCam::FaceTracker::Config config) {
+    // A shadow stream in the live batcher would hold every live batch for its window
+    config.landmarkBatcher.reset();
+    // Tiled stages inline, on the low-priority thread
+    config.workerThreads = 0;
+    return config;
+}
+
+void lowerThreadPriority() {
+#ifdef __APPLE__
+    pthread_set_qos_class_self_np(QOS_CLASS_BACKGROUND, 0);
+#else
+    // Linux applies the nice value to the calling thread only
+    setpriority(PRIO_PROCESS, 0, 19);
+#endif
+}
+
+double percentileUs(std::vector<int64_t> samples, double fraction) {
+    if (samples.empty()) {
+        return 0.0;
+    }
+    const size_t index = std::min(samples.size() - 1, static_cast<size_t>(fraction * samples.size()));
+    std::nth_element(samples.begin(), samples.begin() + index, samples.end());
+    return samples[index] / 1e3;
+}
+
+} // anonymous namespace
+
+namespace AnonCam {
+
+ShadowEvaluator::ShadowEvaluator(const FaceTracker::Config& candidate)
+    : ShadowEvaluator(candidate, Options()) {}
+
+ShadowEvaluator::ShadowEvaluator(const FaceTracker::Config& candidate, const Options& options)
+    : options_(options), candidate_(candidateConfig(candidate)) {
+    options_.sampleRate = std::clamp(options.sampleRate, 0.0f, 1.0f);
+    options_.latencyWindow = std::max(1, options.latencyWindow);
+    liveLatencyNs_.reserve(options_.latencyWindow);
+    candidateLatencyNs_.reserve(options_.latencyWindow);
+    if (candidate_.isInitialized()) {
+        thread_ = std::thread([this] { run(); });
+    }
+}
+
+ShadowEvaluator::~ShadowEvaluator() {
+    {
+        std::lock_guard<std::mutex> lock(slotMutex_);
+        stopping_ = true;
+    }
+    slotFilled_.notify_one();
+    // A frame being evaluated stops at its next check instead of finishing
+    candidate_.cancel();
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+}
+
+bool ShadowEvaluator::offer(const ImageView& frame, int64_t timestampNs, const FaceResult& liveResult,
+                            int64_t liveLatencyNs) {
+    offered_.fetch_add(1, std::memory_order_relaxed);
+    if (!thread_.joinable() || !frame.isValid()) {
+        return false;
+    }
+    // Evenly spaced samples rather than random ones
+    sampleCredit_ += options_.sampleRate;
+    if (sampleCredit_ < 1.0f) {
+        return false;
+    }
+    sampleCredit_ -= 1.0f;
+    sampled_.fetch_add(1, std::memory_order_relaxed);
+
+    // The candidate thread only holds the lock to take the slot; if it does
+    // right now, or has not taken the previous frame yet, drop this one
+    std::unique_lock<std::mutex> lock(slotMutex_, std::try_to_lock);
+    if (!lock.owns_lock() || slotFull_) {
+        dropped_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    copyFrame(frame, slot_);
+    slot_.timestampNs = timestampNs;
+    slot_.liveHasFace = liveResult.hasFace;
+    slot_.liveLandmarks.assign(liveResult.landmarks.begin(), liveResult.landmarks.end());
+    slot_.livePose = liveResult.pose;
+    slot_.liveLatencyNs = liveLatencyNs;
+    slotFull_ = true;
+    lock.unlock();
+    slotFilled_.notify_one();
+    return true;
+}
+
+void ShadowEvaluator::copyFrame(const ImageView& frame, Sample& sample) {
+    sample.frame = frame;
+    const int planes = frame.format == PixelFormat::NV12 ? 2 : 1;
+    for (int plane = 0; plane < 2; ++plane) {
+        sample.frame.planes[plane] = nullptr;
+        sample.frame.bytesPerRow[plane] = 0;
+    }
+    for (int plane = 0; plane < planes; ++plane) {
+        // NV12 CbCr: half the rows, one interleaved pair per two pixels
+        const int rows = plane == 0 ? frame.height : (frame.height + 1) / 2;
+        const size_t rowBytes = plane == 1 ? static_cast<size_t>((frame.width + 1) / 2) * 2
+                                : frame.format == PixelFormat::BGRA ? static_cast<size_t>(frame.width) * 4
+                                                                     : static_cast<size_t>(frame.width);
+        // Buffers only grow, so a steady stream reuses them
+        sample.planes[plane].resize(rowBytes * rows);
+        for (int y = 0; y < rows; ++y) {
+            std::memcpy(sample.planes[plane].data() + rowBytes * y, frame.row(plane, y), rowBytes);
+        }
+        sample.frame.planes[plane] = sample.planes[plane].data();
+        sample.frame.bytesPerRow[plane] = rowBytes;
+    }
+}
+
+void ShadowEvaluator::run() {
+    if (options_.lowPriority) {
+        lowerThreadPriority();
+    }
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(slotMutex_);
+            slotFilled_.wait(lock, [this] { return slotFull_ || stopping_; });
+            if (stopping_) {
+                return;
+            }
+            // Swapping keeps both samples' buffers allocated
+            std::swap(slot_, working_);
+            slotFull_ = false;
+        }
+        evaluate(working_);
+    }
+}
+
+void ShadowEvaluator::evaluate(const Sample& sample) {
+    const auto start = std::chrono::steady_clock::now();
+    const FaceResult result = candidate_.processFrame(sample.frame, sample.timestampNs);
+    const int64_t candidateNs = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - start).count();
+    if (result.cancelled) {
+        return;
+    }
+
+    // Landmarks as the candidate would publish them
+    std::vector<Landmark> landmarks = result.landmarks;
+    if (landmarks.empty() && !result.landmarksHalf.empty()) {
+        landmarks.resize(result.landmarksHalf.size());
+        convertLandmarksFromHalf(result.landmarksHalf.data(), result.landmarksHalf.size(), landmarks.data());
+    }
+
+    double landmarkError = -1.0;
+    double poseError = 0.0;
+    const std::vector<Landmark>& live = sample.liveLandmarks;
+    if (sample.liveHasFace && result.hasFace && live.size() == landmarks.size() &&
+        live.size() > static_cast<size_t>(kRightEyeOuter)) {
+        const double eyeDistance = std::hypot(live[kLeftEyeOuter].x - live[kRightEyeOuter].x,
+                                              live[kLeftEyeOuter].y - live[kRightEyeOuter].y);
+        double sum = 0.0;
+        for (size_t i = 0; i < live.size(); ++i) {
+            sum += std::hypot(landmarks[i].x - live[i].x, landmarks[i].y - live[i].y);
+        }
+        landmarkError = sum / live.size() / std::max(eyeDistance, 1e-6);
+        for (int axis = 0; axis < 3; ++axis) {
+            poseError += std::abs(result.pose.rotation[axis] - sample.livePose.rotation[axis]);
+        }
+        poseError = poseError / 3.0 * kRadToDeg;
+    }
+
+    std::lock_guard<std::mutex> lock(statsMutex_);
+    ++evaluated_;
+    if (sample.liveHasFace == result.hasFace) {
+        ++faceAgreements_;
+    } else if (sample.liveHasFace) {
+        ++liveOnly_;
+    } else {
+        ++candidateOnly_;
+    }
+    if (landmarkError >= 0.0) {
+        ++compared_;
+        landmarkErrorSum_ += landmarkError;
+        maxLandmarkError_ = std::max(maxLandmarkError_, landmarkError);
+        poseErrorSum_ += poseError;
+    }
+    liveLatencySumNs_ += static_cast<double>(sample.liveLatencyNs);
+    candidateLatencySumNs_ += static_cast<double>(candidateNs);
+    if (liveLatencyNs_.size() < static_cast<size_t>(options_.latencyWindow)) {
+        liveLatencyNs_.push_back(sample.liveLatencyNs);
+        candidateLatencyNs_.push_back(candidateNs);
+    } else {
+        liveLatencyNs_[latencyNext_] = sample.liveLatencyNs;
+        candidateLatencyNs_[latencyNext_] = candidateNs;
+    }
+    latencyNext_ = (latencyNext_ + 1) % options_.latencyWindow;
+}
+
+ShadowEvaluator::Stats ShadowEvaluator::stats() const {
+    Stats stats;
+    stats.offered = offered_.load(std::memory_order_relaxed);
+    stats.sampled = sampled_.load(std::memory_order_relaxed);
+    stats.dropped = dropped_.load(std::memory_order_relaxed);
+
+    std::lock_guard<std::mutex> lock(statsMutex_);
+    stats.evaluated = evaluated_;
+    stats.faceAgreements = faceAgreements_;
+    stats.liveOnly = liveOnly_;
+    stats.candidateOnly = candidateOnly_;
+    if (compared_ > 0) {
+        stats.meanLandmarkError = landmarkErrorSum_ / compared_;
+        stats.maxLandmarkError = maxLandmarkError_;
+        stats.meanPoseErrorDeg = poseErrorSum_ / compared_;
+    }
+    if (evaluated_ > 0) {
+        stats.live.meanUs = liveLatencySumNs_ / evaluated_ / 1e3;
+        stats.candidate.meanUs = candidateLatencySumNs_ / evaluated_ / 1e3;
+    }
+    stats.live.p50Us = percentileUs(liveLatencyNs_, 0.5);
+    stats.live.p95Us = percentileUs(liveLatencyNs_, 0.95);
+    stats.candidate.p50Us = percentileUs(candidateLatencyNs_, 0.5);
+    stats.candidate.p95Us = percentileUs(candidateLatencyNs_, 0.95);
+    return stats;
+}
+
+} // namespace AnonCam
@@ -0,0 +1,15 @@
+#ifndef AnonCam_Simd_h
+#define AnonCam_Simd_h
+
+// Private helper: selects the SIMD instruction set available at compile time.
+// Every kernel keeps a scalar path for targets where neither is defined.
+
+#if defined(__SSE2__) || defined(_M_X64)
+#define ACM_SIMD_SSE2 1
+#include <emmintrin.h>
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#define ACM_SIMD_NEON 1
+#include <arm_neon.h>
+#endif
+
+#endif /* AnonCam_Simd_h */
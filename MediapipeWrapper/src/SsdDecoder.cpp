@@ -0,0 +1,141 @@
+#include "SsdDecoder.h"
+#include "ScoreKernels.h"
+#include "Simd.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace AnonCam {
+
+SsdDecoder::SsdDecoder(const float* anchorX, const float* anchorY, int anchorCount, int inputWidth,
+                       int inputHeight, const Options& options)
+    : anchorX_(anchorX), anchorY_(anchorY), anchorCount_(std::max(0, anchorCount)),
+      inverseWidth_(1.0f / static_cast<float>(std::max(1, inputWidth))),
+      inverseHeight_(1.0f / static_cast<float>(std::max(1, inputHeight))), options_(options) {
+    options_.keypointCount = std::clamp(options.keypointCount, 0, Detection::kMaxKeypoints);
+    options_.scoreClip = std::max(0.0f, options.scoreClip);
+
+    // sigmoid(x) >= minScore  <=>  x >= logit(minScore)
+    if (options.minScore <= 0.0f) {
+        logitThreshold_ = -std::numeric_limits<float>::infinity();
+    } else if (options.minScore >= 1.0f) {
+        logitThreshold_ = std::numeric_limits<float>::infinity();
+    } else {
+        logitThreshold_ = std::log(options.minScore / (1.0f - options.minScore));
+    }
+
+    indices_.resize(anchorCount_);
+    scores_.resize(anchorCount_);
+}
+
+int SsdDecoder::decode(const float* boxes, const float* logits, Detection* candidates, int capacity) {
+    const float clip = options_.scoreClip;
+
+    // Pass 1: clip, threshold and compact. Every lane is stored and the
+    // cursor only advances for survivors, so there is no branch per anchor.
+    int count = 0;
+    int i = 0;
+#if ACM_SIMD_SSE2
+    const __m128 low = _mm_set1_ps(-clip);
+    const __m128 high = _mm_set1_ps(clip);
+    const __m128 threshold = _mm_set1_ps(logitThreshold_);
+    for (; i + 4 <= anchorCount_; i += 4) {
+        const __m128 clipped = _mm_max_ps(_mm_min_ps(_mm_loadu_ps(logits + i), high), low);
+        const int mask = _mm_movemask_ps(_mm_cmpge_ps(clipped, threshold));
+        if (mask == 0) {
+            continue;
+        }
+        alignas(16) float lanes[4];
+        _mm_store_ps(lanes, clipped);
+        for (int k = 0; k < 4; ++k) {
+            indices_[count] = i + k;
+            scores_[count] = lanes[k];
+            count += (mask >> k) & 1;
+        }
+    }
+#elif ACM_SIMD_NEON
+    const float32x4_t low = vdupq_n_f32(-clip);
+    const float32x4_t high = vdupq_n_f32(clip);
+    const float32x4_t threshold = vdupq_n_f32(logitThreshold_);
+    const uint32_t laneBits[4] = {1, 2, 4, 8};
+    const uint32x4_t bits = vld1q_u32(laneBits);
+    for (; i + 4 <= anchorCount_; i += 4) {
+        const float32x4_t clipped = vmaxq_f32(vminq_f32(vld1q_f32(logits + i), high), low);
+        const int mask = static_cast<int>(vaddvq_u32(vandq_u32(vcgeq_f32(clipped, threshold), bits)));
+        if (mask == 0) {
+            continue;
+        }
+        float lanes[4];
+        vst1q_f32(lanes, clipped);
+        for (int k = 0; k < 4; ++k) {
+            indices_[count] = i + k;
+            scores_[count] = lanes[k];
+            count += (mask >> k) & 1;
+        }
+    }
+#endif
+    for (; i < anchorCount_; ++i) {
+        const float clipped = std::clamp(logits[i], -clip, clip);
+        indices_[count] = i;
+        scores_[count] = clipped;
+        count += clipped >= logitThreshold_ ? 1 : 0;
+    }
+    count = std::min(count, std::max(0, capacity));
+
+    // Pass 2: sigmoid over the survivors
+    sigmoidInPlace(scores_.data(), count);
+
+    // Pass 3: boxes and keypoints. Offsets are in input pixels relative to
+    // the (1 x 1) anchor center. Members are read into locals once; stores
+    // into the candidates could otherwise alias them.
+    const int stride = valuesPerAnchor();
+    const int keypoints = options_.keypointCount;
+    const float inverseWidth = inverseWidth_;
+    const float inverseHeight = inverseHeight_;
+    const float* anchorX = anchorX_;
+    const float* anchorY = anchorY_;
+    const int* indices = indices_.data();
+    const float* scores = scores_.data();
+    for (int c = 0; c < count; ++c) {
+        const int anchor = indices[c];
+        const float* raw = boxes + static_cast<size_t>(anchor) * stride;
+        const float ax = anchorX[anchor];
+        const float ay = anchorY[anchor];
+        Detection& out = candidates[c];
+
+        const float width = raw[2] * inverseWidth;
+        const float height = raw[3] * inverseHeight;
+        out.x = raw[0] * inverseWidth + ax - width * 0.5f;
+        out.y = raw[1] * inverseHeight + ay - height * 0.5f;
+        out.width = width;
+        out.height = height;
+        out.score = scores[c];
+        out.keypointCount = keypoints;
+
+        int k = 0;
+#if ACM_SIMD_SSE2
+        const __m128 scale = _mm_setr_ps(inverseWidth, inverseHeight, inverseWidth, inverseHeight);
+        const __m128 origin = _mm_setr_ps(ax, ay, ax, ay);
+        for (; k + 2 <= keypoints; k += 2) {
+            _mm_storeu_ps(&out.keypoints[k][0],
+                          _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(raw + 4 + k * 2), scale), origin));
+        }
+#elif ACM_SIMD_NEON
+        const float scaleLanes[4] = {inverseWidth, inverseHeight, inverseWidth, inverseHeight};
+        const float originLanes[4] = {ax, ay, ax, ay};
+        const float32x4_t scale = vld1q_f32(scaleLanes);
+        const float32x4_t origin = vld1q_f32(originLanes);
+        for (; k + 2 <= keypoints; k += 2) {
+            vst1q_f32(&out.keypoints[k][0], vmlaq_f32(origin, vld1q_f32(raw + 4 + k * 2), scale));
+        }
+#endif
+        for (; k < keypoints; ++k) {
+            out.keypoints[k][0] = raw[4 + k * 2] * inverseWidth + ax;
+            out.keypoints[k][1] = raw[5 + k * 2] * inverseHeight + ay;
+        }
+    }
+    return count;
+}
+
+} // namespace AnonCam
@@ -0,0 +1,140 @@
+#include "TemporalDenoiser.h"
+#include "PixelKernels.h"
+#include "WorkerPool.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+
+namespace AnonCam {
+
+TemporalDenoiser::TemporalDenoiser()
+    : TemporalDenoiser(Options()) {}
+
+TemporalDenoiser::TemporalDenoiser(const Options& options, WorkerPool* workers)
+    : options_(options), workers_(workers) {
+    const float strength = std::clamp(options.strength, 0.0f, 1.0f);
+    baseWeight_ = std::clamp(static_cast<int>(std::lround((1.0f - strength) * 128.0f)), 1, 128);
+    // Full weight is reached at motionThreshold; the kernel caps the gain at 64
+    const int threshold = std::max(1, options.motionThreshold);
+    motionGain_ = std::clamp((128 - baseWeight_ + threshold - 1) / threshold, 0, 64);
+    // Bands must start on a chroma row
+    options_.tileRows = std::max(2, options.tileRows & ~1);
+    options_.maxFramesInFlight = std::max<size_t>(2, options.maxFramesInFlight);
+}
+
+void TemporalDenoiser::reset() {
+    previous_.reset();
+}
+
+void TemporalDenoiser::configure(const ImageView& frame) {
+    format_ = frame.format;
+    width_ = frame.width;
+    height_ = frame.height;
+
+    switch (frame.format) {
+        case PixelFormat::NV12:
+            rowBytes_[0] = static_cast<size_t>(frame.width);
+            rowBytes_[1] = static_cast<size_t>((frame.width + 1) / 2) * 2;
+            planeRows_[1] = (frame.height + 1) / 2;
+            break;
+        case PixelFormat::BGRA:
+            rowBytes_[0] = static_cast<size_t>(frame.width) * 4;
+            rowBytes_[1] = 0;
+            planeRows_[1] = 0;
+            break;
+        default:
+            rowBytes_[0] = static_cast<size_t>(frame.width);
+            rowBytes_[1] = 0;
+            planeRows_[1] = 0;
+            break;
+    }
+    planeRows_[0] = frame.height;
+    planeOffset_ = rowBytes_[0] * planeRows_[0];
+
+    previous_.reset();
+    pool_ = std::make_unique<BufferPool>(planeOffset_ + rowBytes_[1] * planeRows_[1], options_.maxFramesInFlight);
+}
+
+void TemporalDenoiser::filterBand(const ImageView& frame, uint8_t* dst, bool passThrough, int band) const {
+    for (int plane = 0; plane < 2 && rowBytes_[plane] > 0; ++plane) {
+        // Plane 1 is NV12 chroma at half the luma rows
+        const int rowsPerBand = plane == 0 ? options_.tileRows : options_.tileRows / 2;
+        const int begin = band * rowsPerBand;
+        const int end = std::min(planeRows_[plane], begin + rowsPerBand);
+        const size_t offset = plane == 0 ? 0 : planeOffset_;
+        const bool copy = passThrough || (plane == 1 && !options_.denoiseChroma);
+        const int width = static_cast<int>(rowBytes_[plane]);
+
+        for (int y = begin; y < end; ++y) {
+            const size_t row = offset + static_cast<size_t>(y) * rowBytes_[plane];
+            if (copy) {
+                std::memcpy(dst + row, frame.row(plane, y), rowBytes_[plane]);
+            } else {
+                motionAdaptiveBlend(frame.row(plane, y), previous_->data() + row, baseWeight_, motionGain_,
+                                    dst + row, width);
+            }
+        }
+    }
+}
+
+bool TemporalDenoiser::process(const ImageView& frame, DenoisedFrame& output, const CancellationToken& cancel) {
+    output = DenoisedFrame{};
+    if (!frame.isValid() || (frame.format == PixelFormat::NV12 && !frame.planes[1])) {
+        return false;
+    }
+
+    const auto begin = std::chrono::steady_clock::now();
+
+    if (!pool_ || frame.format != format_ || frame.width != width_ || frame.height != height_) {
+        configure(frame);
+    }
+
+    auto buffer = pool_->acquire();
+    if (!buffer) {
+        return false;
+    }
+    ++stats_.frames;
+
+    const bool passThrough = !previous_;
+    if (passThrough) {
+        ++stats_.resets;
+    }
+
+    uint8_t* dst = buffer->data();
+    const int bands = (height_ + options_.tileRows - 1) / options_.tileRows;
+    auto filter = [&](int band) {
+        if (!cancel.isCancelled()) {
+            filterBand(frame, dst, passThrough, band);
+        }
+    };
+    if (workers_) {
+        workers_->parallelFor(bands, filter);
+    } else {
+        for (int band = 0; band < bands && !cancel.isCancelled(); ++band) {
+            filter(band);
+        }
+    }
+    if (cancel.isCancelled()) {
+        return false;
+    }
+
+    output.view.format = format_;
+    output.view.width = width_;
+    output.view.height = height_;
+    output.view.planes[0] = dst;
+    output.view.bytesPerRow[0] = rowBytes_[0];
+    if (rowBytes_[1] > 0) {
+        output.view.planes[1] = dst + planeOffset_;
+        output.view.bytesPerRow[1] = rowBytes_[1];
+    }
+    output.buffer = buffer;
+    previous_ = std::move(buffer);
+
+    stats_.lastProcessNs = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - begin).count();
+    return true;
+}
+
+} // namespace AnonCam
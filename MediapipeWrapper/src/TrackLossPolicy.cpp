@@ -0,0 +1,88 @@
+#include "TrackLossPolicy.h"
+#include "FaceTracker.h"
+
+#include <algorithm>
+
+namespace {
+
+// Velocity is only estimated across gaps shorter than this
+constexpr double kMaxVelocityGapSeconds = 0.25;
+
+} // anonymous namespace
+
+namespace AnonCam {
+
+TrackLossPolicy::TrackLossPolicy()
+    : TrackLossPolicy(Options()) {}
+
+TrackLossPolicy::TrackLossPolicy(const Options& options)
+    : options_(options) {
+    options_.holdMs = std::max(0, options.holdMs);
+    options_.margin = std::max(0.0f, options.margin);
+    options_.growthPerSecond = std::max(0.0f, options.growthPerSecond);
+    options_.velocitySmoothing = std::clamp(options.velocitySmoothing, 0.0f, 1.0f);
+}
+
+void TrackLossPolicy::reset() {
+    seen_ = false;
+    velocity_[0] = velocity_[1] = 0.0f;
+}
+
+Anonymization TrackLossPolicy::update(bool hasFace, const Landmark* landmarks, size_t count, int64_t timestampNs) {
+    Anonymization out;
+    const double elapsed = seen_ ? std::max<int64_t>(0, timestampNs - lastSeenNs_) / 1e9 : 0.0;
+
+    if (hasFace && count > 0) {
+        float minX = 1.0f, minY = 1.0f, maxX = 0.0f, maxY = 0.0f;
+        for (size_t i = 0; i < count; ++i) {
+            minX = std::min(minX, landmarks[i].x);
+            minY = std::min(minY, landmarks[i].y);
+            maxX = std::max(maxX, landmarks[i].x);
+            maxY = std::max(maxY, landmarks[i].y);
+        }
+        const float pad = options_.margin * std::max(maxX - minX, maxY - minY);
+        const float box[4] = {minX - pad, minY - pad, maxX + pad, maxY + pad};
+
+        if (seen_ && elapsed > 0.0 && elapsed < kMaxVelocityGapSeconds) {
+            const float w = options_.velocitySmoothing;
+            for (int axis = 0; axis < 2; ++axis) {
+                const float moved = 0.5f * ((box[axis] + box[axis + 2]) - (box_[axis] + box_[axis + 2]));
+                velocity_[axis] += (static_cast<float>(moved / elapsed) - velocity_[axis]) * w;
+            }
+        } else {
+            velocity_[0] = velocity_[1] = 0.0f;
+        }
+        std::copy(box, box + 4, box_);
+        seen_ = true;
+        lastSeenNs_ = timestampNs;
+
+        out.mode = AnonymizationMode::Face;
+        for (int i = 0; i < 4; ++i) {
+            out.region[i] = std::clamp(box_[i], 0.0f, 1.0f);
+        }
+        return out;
+    }
+
+    if (seen_ && elapsed * 1e3 <= options_.holdMs) {
+        // Last bounds and where the predicted motion took them, grown by
+        // what the prediction may have missed
+        const float size = std::max(box_[2] - box_[0], box_[3] - box_[1]);
+        const float grow = options_.growthPerSecond * size * static_cast<float>(elapsed);
+        const float shiftX = velocity_[0] * static_cast<float>(elapsed);
+        const float shiftY = velocity_[1] * static_cast<float>(elapsed);
+        out.mode = AnonymizationMode::Region;
+        out.region[0] = std::clamp(box_[0] + std::min(shiftX, 0.0f) - grow, 0.0f, 1.0f);
+        out.region[1] = std::clamp(box_[1] + std::min(shiftY, 0.0f) - grow, 0.0f, 1.0f);
+        out.region[2] = std::clamp(box_[2] + std::max(shiftX, 0.0f) + grow, 0.0f, 1.0f);
+        out.region[3] = std::clamp(box_[3] + std::max(shiftY, 0.0f) + grow, 0.0f, 1.0f);
+        return out;
+    }
+
+    if (seen_ || options_.failClosedAtStart) {
+        out.mode = AnonymizationMode::FullFrame;
+        out.region[2] = out.region[3] = 1.0f;
+    }
+    return out;
+}
+
+} // namespace AnonCam
@@ -0,0 +1,96 @@
+#include "WorkerPool.h"
+
+#include <algorithm>
+
+namespace {
+
+constexpr int kMaxDefaultThreads = 3;
+
+} // anonymous namespace
+
+namespace AnonCam {
+
+WorkerPool::WorkerPool(int threadCount) {
+    threads_.reserve(std::max(0, threadCount));
+    for (int i = 0; i < threadCount; ++i) {
+        threads_.emplace_back([this] { workerLoop(); });
+    }
+}
+
+WorkerPool::~WorkerPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    wake_.notify_all();
+    for (auto& thread : threads_) {
+        thread.join();
+    }
+}
+
+int WorkerPool::defaultThreadCount() {
+    const int cores = static_cast<int>(std::thread::hardware_concurrency());
+    return std::clamp(cores - 1, 0, kMaxDefaultThreads);
+}
+
+void WorkerPool::parallelFor(int count, const std::function<void(int)>& task) {
+    if (count <= 0) {
+        return;
+    }
+    if (threads_.empty() || count == 1) {
+        for (int i = 0; i < count; ++i) {
+            task(i);
+        }
+        return;
+    }
+
+    std::lock_guard<std::mutex> callerLock(callerMutex_);
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        task_ = &task;
+        count_ = count;
+        next_.store(0, std::memory_order_relaxed);
+        ++generation_;
+    }
+    wake_.notify_all();
+
+    runItems();
+
+    // Every item is claimed; wait for the ones still running on workers
+    std::unique_lock<std::mutex> lock(mutex_);
+    done_.wait(lock, [this] { return busy_ == 0; });
+    task_ = nullptr;
+}
+
+void WorkerPool::runItems() {
+    for (int i = next_.fetch_add(1, std::memory_order_relaxed); i < count_;
+         i = next_.fetch_add(1, std::memory_order_relaxed)) {
+        (*task_)(i);
+    }
+}
+
+void WorkerPool::workerLoop() {
+    uint64_t seen = 0;
+    std::unique_lock<std::mutex> lock(mutex_);
+    for (;;) {
+        wake_.wait(lock, [&] { return stopping_ || generation_ != seen; });
+        if (stopping_) {
+            return;
+        }
+        seen = generation_;
+        // A late wake-up may find the job already finished
+        if (!task_) {
+            continue;
+        }
+
+        ++busy_;
+        lock.unlock();
+        runItems();
+        lock.lock();
+        if (--busy_ == 0) {
+            done_.notify_all();
+        }
+    }
+}
+
+} // namespace AnonCam
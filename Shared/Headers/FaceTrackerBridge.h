@@ -24,6 +24,13 @@ typedef struct {
     float z;  // Relative depth
 } ACMLandmark;
 
+/// Half-precision landmark (IEEE 754 binary16 bits, matches Metal packed_half3)
+typedef struct {
+    uint16_t x;
+    uint16_t y;
+    uint16_t z;
+} ACMLandmarkHalf;
+
 /// Head pose representation
 typedef struct {
     float translation[3];  // tx, ty, tz
@@ -43,14 +50,40 @@ typedef struct {
     ACMLandmark forehead;
 } ACMKeyPoints;
 
+/// What to anonymize in a frame (matches C++ AnonymizationMode)
+typedef enum {
+    ACMAnonymizationModeNone = 0,
+    ACMAnonymizationModeFace = 1,       // Tracked face
+    ACMAnonymizationModeRegion = 2,     // Face lost: held region (anonymizationRegion)
+    ACMAnonymizationModeFullFrame = 3,  // Hold expired: whole frame
+} ACMAnonymizationMode;
+
 /// Complete face tracking result
+///
+/// landmarks and landmarksHalf live in storage of the calling thread (see
+/// ACMFaceTrackerProcess and ACMFaceTrackerGetLastResult). segmentationMask
+/// and denoisedPixels point into pooled buffers that the result keeps
+/// (pixelBuffers) until ACMFaceResultRelease: they may be read on any thread
+/// until then, and the pool reuses them only after it.
 typedef struct {
     bool hasFace;
     float confidence;
     int landmarkCount;
     ACMLandmark *landmarks;     // Array of landmarks, owned by tracker
+    ACMLandmarkHalf *landmarksHalf; // Set instead of landmarks when halfPrecisionLandmarks is enabled
     ACMHeadPose pose;
     ACMKeyPoints keyPoints;
+    const uint8_t *segmentationMask; // 8-bit face alpha (enableSegmentation), NULL if unavailable;
+                                     // valid until ACMFaceResultRelease
+    int maskWidth;
+    int maskHeight;
+    int maskBytesPerRow;
+    const uint8_t *denoisedPixels;   // Denoised BGRA frame (enableDenoising), NULL if unavailable;
+                                     // valid until ACMFaceResultRelease
+    int denoisedBytesPerRow;
+    void *pixelBuffers;              // Holds segmentationMask and denoisedPixels, NULL if neither is set
+    ACMAnonymizationMode anonymizationMode; // Keeps anonymizing when the face is lost
+    float anonymizationRegion[4];    // Normalized x0, y0, x1, y1 (Face, Region)
 } ACMFaceResult;
 
 #pragma mark - Configuration
@@ -62,6 +95,11 @@ typedef struct {
     float minTrackingConfidence;
     bool enableSegmentation;
     bool useGPU;
+    bool halfPrecisionLandmarks;
+    bool enableDenoising;            // Temporal denoise in front of tracking (low light)
+    const char * _Nullable cascadePath; // OpenCV Haar cascade XML: detect with the CPU cascade (NULL = model)
+    int cascadeSliceBudgetUs;        // > 0: spread cascade scans over frames, at most this per frame
+    int trackLossHoldMs;             // > 0: hold the lost face's region this long before full-frame blur
 } ACMFaceTrackerConfig;
 
 /// Default configuration values
@@ -70,6 +108,8 @@ typedef struct {
 #define ACM_DEFAULT_MIN_TRACKING_CONFIDENCE 0.5f
 #define ACM_DEFAULT_ENABLE_SEGMENTATION false
 #define ACM_DEFAULT_USE_GPU false
+#define ACM_DEFAULT_HALF_PRECISION_LANDMARKS false
+#define ACM_DEFAULT_ENABLE_DENOISING false
 
 #pragma mark - C API
 
@@ -78,6 +118,13 @@ typedef struct {
 /// @return Opaque handle to the tracker instance
 void* _Nullable ACMFaceTrackerCreate(const ACMFaceTrackerConfig* _Nullable config);
 
+/// Switch a running tracker to a new configuration from its next frame on,
+/// keeping its track and every stage whose settings did not change
+/// @param handle Handle from ACMFaceTrackerCreate
+/// @param config New configuration (a changed cascade is loaded before returning)
+/// @return false if the new configuration could not be applied (the old one stays)
+bool ACMFaceTrackerUpdateConfig(void* _Nullable handle, const ACMFaceTrackerConfig* _Nonnull config);
+
 /// Destroy a FaceTracker instance
 /// @param handle Handle from ACMFaceTrackerCreate
 void ACMFaceTrackerDestroy(void* _Nullable handle);
@@ -85,7 +132,9 @@ void ACMFaceTrackerDestroy(void* _Nullable handle);
 /// Process a camera frame and extract face landmarks
 /// @param handle Handle from ACMFaceTrackerCreate
 /// @param pixelBuffer CVPixelBufferRef from AVCaptureSession
-/// @return Face tracking result (valid until next processFrame call on same thread)
+/// @return Face tracking result: landmarks valid until the next ACMFaceTrackerProcess call on the
+///         same thread; segmentationMask and denoisedPixels until ACMFaceResultRelease, which
+///         must be called once for every result (from any thread)
 ACMFaceResult ACMFaceTrackerProcess(void* _Nullable handle, CVPixelBufferRef _Nonnull pixelBuffer);
 
 /// Reset internal tracking state
@@ -94,18 +143,181 @@ void ACMFaceTrackerReset(void* _Nullable handle);
 
 /// Get last result without processing a new frame
 /// @param handle Handle from ACMFaceTrackerCreate
-/// @return Last known face tracking result
+/// @return Last known face tracking result, without segmentationMask or denoisedPixels;
+///         landmarks valid until the next ACMFaceTrackerGetLastResult call on the same
+///         thread (results of ACMFaceTrackerProcess are not affected)
 ACMFaceResult ACMFaceTrackerGetLastResult(void* _Nullable handle);
 
+/// Start recording processed frames and results to a capture file for offline replay
+/// @param handle Handle from ACMFaceTrackerCreate
+/// @param path Destination file path (truncated if it exists)
+/// @param frameDownscale Divisor for stored luma frames (0 = record results only)
+/// @return true if the capture file was created
+bool ACMFaceTrackerStartRecording(void* _Nullable handle, const char* _Nonnull path, int frameDownscale);
+
+/// Finalize the capture file started by ACMFaceTrackerStartRecording
+/// @param handle Handle from ACMFaceTrackerCreate
+void ACMFaceTrackerStopRecording(void* _Nullable handle);
+
+/// Stream results to local subscribers over a Unix domain socket
+/// @param handle Handle from ACMFaceTrackerCreate
+/// @param socketPath Filesystem path of the socket (replaced if it exists)
+/// @return true if the socket is listening
+bool ACMFaceTrackerStartPublishing(void* _Nullable handle, const char* _Nonnull socketPath);
+
+/// Close the publishing socket and disconnect all subscribers
+/// @param handle Handle from ACMFaceTrackerCreate
+void ACMFaceTrackerStopPublishing(void* _Nullable handle);
+
 /// Check if tracker is initialized successfully
 /// @param handle Handle from ACMFaceTrackerCreate
 /// @return true if ready to use
 bool ACMFaceTrackerIsInitialized(void* _Nullable handle);
 
-/// Release resources in a face result (only needed if copying results)
+/// Return the pooled buffers of a face result (segmentationMask, denoisedPixels) to
+/// the tracker; call once per ACMFaceTrackerProcess result, on any thread. The
+/// result's pixel pointers must not be used afterwards.
 /// @param result Face result to release
 void ACMFaceResultRelease(ACMFaceResult result);
 
+#pragma mark - CPU Compositing
+
+/// Background treatment (matches C++ Compositor::BackgroundMode)
+typedef enum {
+    ACMBackgroundModeKeep = 0,
+    ACMBackgroundModeBlur = 1,
+    ACMBackgroundModeReplace = 2,
+} ACMBackgroundMode;
+
+/// Face anonymization (matches C++ Compositor::FaceMode)
+typedef enum {
+    ACMFaceModeKeep = 0,
+    ACMFaceModePixelate = 1,
+    ACMFaceModeBlur = 2,
+    ACMFaceModeFill = 3,
+} ACMFaceMode;
+
+/// Compositor configuration
+typedef struct {
+    ACMBackgroundMode backgroundMode;   // Blur/Replace need a foregroundMask (ACMCompositorProcess)
+    ACMFaceMode faceMode;
+    int blurRadius;         // Box radius at quarter resolution
+    int pixelBlockSize;     // Pixelation block edge in pixels
+    uint8_t fillColor[4];   // BGRA, for ACMFaceModeFill
+} ACMCompositorConfig;
+
+/// Create a CPU compositor (background blur/replacement fused with face anonymization)
+/// @param config Configuration (use NULL for blur + pixelate)
+/// @return Opaque handle to the compositor
+void* _Nullable ACMCompositorCreate(const ACMCompositorConfig* _Nullable config);
+
+/// Destroy a compositor
+/// @param handle Handle from ACMCompositorCreate
+void ACMCompositorDestroy(void* _Nullable handle);
+
+/// Composite one BGRA frame using the segmentation mask of a face result as the face region
+/// @param handle Handle from ACMCompositorCreate
+/// @param source BGRA frame the result was computed from
+/// @param result Face result, not yet released (segmentationMask may be NULL: background
+///               treatment only); its denoisedPixels replace the source when present, and
+///               its anonymizationMode covers frames where the face was lost
+/// @param foregroundMask 8-bit person alpha at frame size, kept sharp by the background
+///                       treatment. The tracker produces none: it must come from a person
+///                       segmenter (the face result's segmentationMask would blur or replace
+///                       everything but the face). NULL keeps the background as is, which
+///                       ACMCompositorBackgroundDropped then reports
+/// @param foregroundBytesPerRow Row stride of foregroundMask
+/// @param replacement BGRA image at frame size for ACMBackgroundModeReplace, otherwise NULL
+/// @param destination BGRA buffer at frame size (may be the source)
+/// @return true if the frame was composited
+bool ACMCompositorProcess(void* _Nullable handle, CVPixelBufferRef _Nonnull source,
+                          const ACMFaceResult* _Nullable result, const uint8_t* _Nullable foregroundMask,
+                          int foregroundBytesPerRow, CVPixelBufferRef _Nullable replacement,
+                          CVPixelBufferRef _Nonnull destination);
+
+/// Whether the last ACMCompositorProcess kept the background despite a blur or replace
+/// backgroundMode, for want of a foregroundMask
+/// @param handle Handle from ACMCompositorCreate
+/// @return true if the background mode was dropped
+bool ACMCompositorBackgroundDropped(void* _Nullable handle);
+
+/// Render and anonymization settings (matches C++ RenderParameters)
+typedef struct {
+    float maskColor[4];         // RGBA
+    float maskScale;
+    float maskRoughness;
+    float maskMetallic;
+    float smoothingFactor;
+    float velocityDamping;
+    float movementThreshold;
+    bool pixelationEnabled;
+    bool mask3DEnabled;
+    bool stickerMode;
+    bool debugEnabled;
+} ACMRenderParameters;
+
+/// Create a parameter store: the UI publishes settings, the render queue
+/// reads them once per frame without locking or seeing a partial update
+/// @param initial Initial settings (use NULL for the defaults)
+/// @return Opaque handle to the store
+void* _Nullable ACMParameterStoreCreate(const ACMRenderParameters* _Nullable initial);
+
+/// Destroy a parameter store (no read may be in progress)
+/// @param handle Handle from ACMParameterStoreCreate
+void ACMParameterStoreDestroy(void* _Nullable handle);
+
+/// Replace the settings; every field changed here becomes visible together
+/// @param handle Handle from ACMParameterStoreCreate
+/// @return Version of the new settings (0 on failure)
+uint64_t ACMParameterStorePublish(void* _Nullable handle, const ACMRenderParameters* _Nonnull parameters);
+
+/// Copy the current settings (lock-free)
+/// @param handle Handle from ACMParameterStoreCreate
+/// @param parameters Receives the settings
+/// @return Their version (0 on failure); unchanged versions mean unchanged settings
+uint64_t ACMParameterStoreRead(void* _Nullable handle, ACMRenderParameters* _Nonnull parameters);
+
+/// Version of the current settings (lock-free); compare before ACMParameterStoreRead to skip unchanged frames
+/// @param handle Handle from ACMParameterStoreCreate
+uint64_t ACMParameterStoreVersion(void* _Nullable handle);
+
+#pragma mark - Logging
+
+/// Log severity (matches C++ LogLevel)
+typedef enum {
+    ACMLogLevelDebug = 0,
+    ACMLogLevelInfo = 1,
+    ACMLogLevelWarning = 2,
+    ACMLogLevelError = 3,
+} ACMLogLevel;
+
+/// Receives each formatted log line on the logger's background thread
+typedef void (*ACMLogSink)(ACMLogLevel level, const char* _Nonnull line, void* _Nullable context);
+
+/// Create the log site of one place that logs; its messages share a rate limit
+/// (create it once, e.g. as a static, and keep it: sites are never freed)
+/// @param level Severity of its messages
+/// @param category Name printed in front of its messages (copied)
+/// @return Site handle for ACMLogWrite
+void* _Nullable ACMLogSiteCreate(ACMLogLevel level, const char* _Nonnull category);
+
+/// Queue a message for the logger's background thread; never blocks and never formats on the caller
+/// (safe on the frame path: past the site's rate limit or with the thread's buffer full it is only counted)
+/// @param site Handle from ACMLogSiteCreate
+/// @param message Copied; truncated to about 400 bytes
+void ACMLogWrite(void* _Nullable site, const char* _Nonnull message);
+
+/// Route log lines to a callback instead of stderr
+/// @param sink Callback (NULL = stderr); must not call ACMLogFlush
+/// @param context Passed to every call
+void ACMLogSetSink(ACMLogSink _Nullable sink, void* _Nullable context);
+
+/// Drop messages below a severity (default ACMLogLevelInfo)
+void ACMLogSetMinLevel(ACMLogLevel level);
+
+/// Block until every message queued so far has reached the sink (e.g. before exiting)
+void ACMLogFlush(void);
+
 #pragma mark - Objective-C Wrapper (for easier Swift interop)
 
 NS_ASSUME_NONNULL_BEGIN
@@ -120,9 +332,12 @@ NS_ASSUME_NONNULL_BEGIN
 - (instancetype)init;
 - (instancetype)initWithConfig:(ACMFaceTrackerConfig)config NS_DESIGNATED_INITIALIZER;
 
-/// Process a frame
+/// Process a frame (see ACMFaceTrackerProcess; release the result with ACMFaceResultRelease)
 - (ACMFaceResult)processFrame:(CVPixelBufferRef)pixelBuffer;
 
+/// Apply a new configuration from the next frame on (no cold start)
+- (BOOL)updateConfig:(ACMFaceTrackerConfig)config;
+
 /// Reset tracking state
 - (void)reset;
 
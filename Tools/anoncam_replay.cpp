@@ -0,0 +1,72 @@
+//
+//  anoncam_replay.cpp
+//  AnonCam
+//
+//  Replays a capture file through the FaceTracker core and reports timing
+//  and divergence from the recorded results.
+//
+//  Usage: anoncam_replay <capture.acmr> [--realtime] [--verbose]
+//
+
+#include "CaptureFile.h"
+#include "FaceTracker.h"
+#include "ReplayDriver.h"
+
+#include <cstdio>
+#include <cstring>
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::fprintf(stderr, "usage: %s <capture> [--realtime] [--verbose]\n", argv[0]);
+        return 2;
+    }
+
+    AnonCam::ReplayDriver::Options options;
+    bool verbose = false;
+    for (int i = 2; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--realtime") == 0) {
+            options.pacing = AnonCam::ReplayDriver::Pacing::Recorded;
+        } else if (std::strcmp(argv[i], "--verbose") == 0) {
+            verbose = true;
+        } else {
+            std::fprintf(stderr, "unknown option: %s\n", argv[i]);
+            return 2;
+        }
+    }
+
+    AnonCam::CaptureReader reader;
+    if (!reader.open(argv[1])) {
+        std::fprintf(stderr, "failed to open capture: %s\n", argv[1]);
+        return 1;
+    }
+    if (!reader.hasFrames()) {
+        std::fprintf(stderr, "capture has results only (recorded with frame downscale 0), nothing to replay: %s\n",
+                     argv[1]);
+        return 1;
+    }
+
+    AnonCam::FaceTracker tracker;
+    AnonCam::ReplayDriver driver(tracker, reader);
+
+    AnonCam::ReplayDriver::FrameCallback callback;
+    if (verbose) {
+        callback = [](size_t index, const AnonCam::CaptureRecord& recorded, const AnonCam::FaceResult& replayed) {
+            std::printf("%6zu  t=%lld  face %d->%d  conf %.3f->%.3f\n", index,
+                        static_cast<long long>(recorded.timestampNs),
+                        recorded.result.hasFace, replayed.hasFace,
+                        recorded.result.confidence, replayed.confidence);
+        };
+    }
+
+    const auto report = driver.run(options, callback);
+    const double meanUs = report.framesReplayed
+        ? static_cast<double>(report.totalProcessNs) / report.framesReplayed / 1000.0
+        : 0.0;
+
+    std::printf("records:      %zu\n", reader.recordCount());
+    std::printf("replayed:     %zu (skipped %zu without frames)\n", report.framesReplayed, report.framesSkipped);
+    std::printf("mismatches:   %zu (max landmark error %.6f)\n", report.mismatches, report.maxLandmarkError);
+    std::printf("process time: mean %.1f us, max %.1f us\n", meanUs, report.maxProcessNs / 1000.0);
+
+    return report.mismatches == 0 ? 0 : 3;
+}
@@ -0,0 +1,49 @@
+//
+//  anoncam_subscribe.cpp
+//  AnonCam
+//
+//  Reference client for the landmark stream: connects to a publishing
+//  FaceTracker and prints one line per received frame.
+//
+//  Usage: anoncam_subscribe <socket-path> [frame-count]
+//
+
+#include "LandmarkStream.h"
+
+#include <cstdio>
+#include <cstdlib>
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::fprintf(stderr, "usage: %s <socket-path> [frame-count]\n", argv[0]);
+        return 2;
+    }
+    const long limit = argc > 2 ? std::strtol(argv[2], nullptr, 10) : -1;
+
+    AnonCam::LandmarkSubscriber subscriber;
+    if (!subscriber.connect(argv[1])) {
+        std::fprintf(stderr, "failed to connect to %s\n", argv[1]);
+        return 1;
+    }
+
+    AnonCam::StreamFrame frame;
+    for (long received = 0; limit < 0 || received < limit; ++received) {
+        if (!subscriber.receive(frame)) {
+            std::fprintf(stderr, "stream closed\n");
+            return 1;
+        }
+
+        if (!frame.summary.hasFace) {
+            std::printf("#%u t=%lld no face\n", frame.frameNumber, static_cast<long long>(frame.timestampNs));
+        } else if (!frame.landmarksValid) {
+            std::printf("#%u t=%lld face %.2f (waiting for keyframe)\n", frame.frameNumber,
+                        static_cast<long long>(frame.timestampNs), frame.summary.confidence);
+        } else {
+            const auto& nose = frame.landmarks.size() > 1 ? frame.landmarks[1] : frame.landmarks[0];
+            std::printf("#%u t=%lld face %.2f  %zu landmarks  nose (%.4f, %.4f)\n", frame.frameNumber,
+                        static_cast<long long>(frame.timestampNs), frame.summary.confidence,
+                        frame.landmarks.size(), nose.x, nose.y);
+        }
+    }
+    return 0;
+}